@@ -0,0 +1,117 @@
+#include <HuxBench/AllocationCounter.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace HuxApp
+{
+	namespace AllocationCounter
+	{
+		namespace
+		{
+			std::atomic<quint64> s_allocation_count{ 0 };
+
+			void count_allocation()
+			{
+				s_allocation_count.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		quint64 get_count()
+		{
+			return s_allocation_count.load(std::memory_order_relaxed);
+		}
+
+		bool counts_malloc()
+		{
+#if defined(__GLIBC__)
+			return true;
+#else
+			return false;
+#endif
+		}
+	}
+}
+
+#if defined(__GLIBC__)
+// Interpose the C allocation functions (operator new also ends up here), forwarding to the glibc implementation
+extern "C"
+{
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t count, size_t size);
+	void* __libc_realloc(void* pointer, size_t size);
+	void __libc_free(void* pointer);
+
+	void* malloc(size_t size) noexcept
+	{
+		HuxApp::AllocationCounter::count_allocation();
+		return __libc_malloc(size);
+	}
+
+	void* calloc(size_t count, size_t size) noexcept
+	{
+		HuxApp::AllocationCounter::count_allocation();
+		return __libc_calloc(count, size);
+	}
+
+	void* realloc(void* pointer, size_t size) noexcept
+	{
+		// Growing a buffer counts as an allocation
+		HuxApp::AllocationCounter::count_allocation();
+		return __libc_realloc(pointer, size);
+	}
+
+	void free(void* pointer) noexcept
+	{
+		__libc_free(pointer);
+	}
+}
+#else
+// Only the C++ allocations can be replaced portably
+void* operator new(std::size_t size)
+{
+	HuxApp::AllocationCounter::count_allocation();
+	if (void* pointer = std::malloc(size ? size : 1))
+	{
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	HuxApp::AllocationCounter::count_allocation();
+	return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+	return operator new(size, tag);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+#include <QtGlobal>
+
+namespace HuxApp
+{
+	// Counts the heap allocations made by the process, so the benchmarks can report the allocations per iteration
+	namespace AllocationCounter
+	{
+		quint64 get_count();
+
+		// With glibc the C allocation functions are counted as well (Qt strings and containers allocate with malloc), otherwise only operator new is counted
+		bool counts_malloc();
+	}
+}
@@ -0,0 +1,249 @@
+#include <HuxBench/BenchmarkRunner.h>
+#include <HuxBench/AllocationCounter.h>
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QTextStream>
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace HuxApp
+{
+	namespace
+	{
+		struct CaseResult
+		{
+			int m_iterations = 0;
+			qint64 m_min_ns = 0;
+			qint64 m_median_ns = 0;
+			qint64 m_mean_ns = 0;
+			qint64 m_max_ns = 0;
+			qint64 m_allocations = 0; // Median of the iterations
+		};
+
+		CaseResult get_case_result(std::vector<qint64>& iteration_times, std::vector<qint64>& iteration_allocations)
+		{
+			CaseResult result;
+			if (iteration_times.empty())
+			{
+				return result;
+			}
+
+			auto allocation_median_it = iteration_allocations.begin() + (iteration_allocations.size() / 2);
+			std::nth_element(iteration_allocations.begin(), allocation_median_it, iteration_allocations.end());
+			result.m_allocations = *allocation_median_it;
+
+			std::sort(iteration_times.begin(), iteration_times.end());
+			result.m_iterations = static_cast<int>(iteration_times.size());
+			result.m_min_ns = iteration_times.front();
+			result.m_max_ns = iteration_times.back();
+			result.m_median_ns = iteration_times[iteration_times.size() / 2];
+			result.m_mean_ns = std::accumulate(iteration_times.begin(), iteration_times.end(), qint64(0)) / result.m_iterations;
+			return result;
+		}
+
+		QString format_memory(qint64 bytes)
+		{
+			return QStringLiteral("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+		}
+
+		QString format_time(qint64 time_ns)
+		{
+			if (time_ns >= 10000000)
+			{
+				return QStringLiteral("%1 ms").arg(time_ns / 1000000.0, 0, 'f', 2);
+			}
+			return QStringLiteral("%1 us").arg(time_ns / 1000.0, 0, 'f', 2);
+		}
+	}
+
+	struct BenchmarkRunner::Internal
+	{
+		struct Case
+		{
+			QString m_name;
+			CaseFactory m_factory;
+			QJsonObject m_parameters;
+		};
+
+		std::vector<Case> m_cases;
+	};
+
+	BenchmarkRunner::BenchmarkRunner()
+		: m_internal(std::make_unique<Internal>())
+	{
+	}
+
+	BenchmarkRunner::~BenchmarkRunner() = default;
+
+	void BenchmarkRunner::add_case(const QString& name, const CaseFactory& factory, const QJsonObject& parameters)
+	{
+		m_internal->m_cases.push_back({ name, factory, parameters });
+	}
+
+	QStringList BenchmarkRunner::get_case_names() const
+	{
+		QStringList case_names;
+		for (const Internal::Case& current_case : m_internal->m_cases)
+		{
+			case_names << current_case.m_name;
+		}
+		return case_names;
+	}
+
+	QJsonObject BenchmarkRunner::run(const Config& config, QTextStream* progress_stream) const
+	{
+		const QRegularExpression filter_regex(config.m_filter);
+
+		QJsonArray case_json_array;
+		for (const Internal::Case& current_case : m_internal->m_cases)
+		{
+			if (!config.m_filter.isEmpty() && !filter_regex.match(current_case.m_name).hasMatch())
+			{
+				continue;
+			}
+
+			const CaseBody case_body = current_case.m_factory();
+			qint64 iteration_allocations = 0;
+			auto run_iteration = [&case_body, &iteration_allocations]()
+				{
+					if (case_body.m_reset)
+					{
+						case_body.m_reset();
+					}
+
+					// Only the allocations of the timed part are counted
+					const quint64 start_allocations = AllocationCounter::get_count();
+					QElapsedTimer iteration_timer;
+					iteration_timer.start();
+					case_body.m_run();
+					const qint64 iteration_time_ns = iteration_timer.nsecsElapsed();
+					iteration_allocations = static_cast<qint64>(AllocationCounter::get_count() - start_allocations);
+					return iteration_time_ns;
+				};
+
+			for (int warmup_index = 0; warmup_index < config.m_warmup_iterations; ++warmup_index)
+			{
+				run_iteration();
+			}
+
+			// Run until we have enough samples (the reset calls are not counted towards the minimum time)
+			std::vector<qint64> iteration_times;
+			std::vector<qint64> iteration_allocation_counts;
+			qint64 total_time_ns = 0;
+			while ((static_cast<int>(iteration_times.size()) < config.m_min_iterations) || (total_time_ns < (config.m_min_time_ms * 1000000)))
+			{
+				iteration_times.push_back(run_iteration());
+				iteration_allocation_counts.push_back(iteration_allocations);
+				total_time_ns += iteration_times.back();
+			}
+
+			const CaseResult result = get_case_result(iteration_times, iteration_allocation_counts);
+
+			QJsonObject case_json;
+			case_json["name"] = current_case.m_name;
+			if (!current_case.m_parameters.isEmpty())
+			{
+				case_json["parameters"] = current_case.m_parameters;
+			}
+			case_json["iterations"] = result.m_iterations;
+			case_json["min_ns"] = result.m_min_ns;
+			case_json["median_ns"] = result.m_median_ns;
+			case_json["mean_ns"] = result.m_mean_ns;
+			case_json["max_ns"] = result.m_max_ns;
+			case_json["allocations"] = result.m_allocations;
+
+			QString throughput_text = QStringLiteral(", %1 allocations").arg(result.m_allocations);
+			if (case_body.m_items_per_iteration > 0)
+			{
+				const double allocations_per_item = static_cast<double>(result.m_allocations) / case_body.m_items_per_iteration;
+				case_json["items"] = case_body.m_items_per_iteration;
+				case_json["allocations_per_item"] = allocations_per_item;
+				throughput_text += QStringLiteral(" (%1 per item)").arg(allocations_per_item, 0, 'f', 2);
+			}
+			if ((case_body.m_bytes_per_iteration > 0) && (result.m_median_ns > 0))
+			{
+				const double megabytes_per_second = (case_body.m_bytes_per_iteration / (1024.0 * 1024.0)) / (result.m_median_ns / 1000000000.0);
+				case_json["bytes"] = case_body.m_bytes_per_iteration;
+				case_json["mb_per_second"] = megabytes_per_second;
+				throughput_text += QStringLiteral(", %1 MB/s").arg(megabytes_per_second, 0, 'f', 1);
+			}
+			if (case_body.m_measure_memory)
+			{
+				const qint64 memory_bytes = case_body.m_measure_memory();
+				case_json["memory_bytes"] = memory_bytes;
+				throughput_text += QStringLiteral(", %1").arg(format_memory(memory_bytes));
+			}
+			case_json_array.append(case_json);
+
+			if (progress_stream)
+			{
+				*progress_stream << QStringLiteral("%1 median %2 (min %3, %4 iterations%5)").arg(current_case.m_name.leftJustified(40), format_time(result.m_median_ns), format_time(result.m_min_ns)).arg(result.m_iterations).arg(throughput_text) << Qt::endl;
+			}
+		}
+
+		QJsonObject results_json;
+		results_json["cases"] = case_json_array;
+		results_json["counts_malloc"] = AllocationCounter::counts_malloc(); // Allocation counts are only comparable between runs on the same platform
+		return results_json;
+	}
+
+	QString BenchmarkRunner::compare(const QJsonObject& baseline, const QJsonObject& results)
+	{
+		std::unordered_map<QString, qint64> baseline_times;
+		std::unordered_map<QString, qint64> baseline_memory;
+		std::unordered_map<QString, qint64> baseline_allocations;
+		for (const QJsonValue& current_case_value : baseline["cases"].toArray())
+		{
+			const QJsonObject current_case = current_case_value.toObject();
+			baseline_times[current_case["name"].toString()] = current_case["median_ns"].toInteger();
+			if (current_case.contains("memory_bytes"))
+			{
+				baseline_memory[current_case["name"].toString()] = current_case["memory_bytes"].toInteger();
+			}
+			if (current_case.contains("allocations"))
+			{
+				baseline_allocations[current_case["name"].toString()] = current_case["allocations"].toInteger();
+			}
+		}
+		const bool allocations_comparable = (baseline["counts_malloc"].toBool() == results["counts_malloc"].toBool());
+
+		QStringList comparison_lines;
+		for (const QJsonValue& current_case_value : results["cases"].toArray())
+		{
+			const QJsonObject current_case = current_case_value.toObject();
+			const QString case_name = current_case["name"].toString();
+			auto baseline_it = baseline_times.find(case_name);
+			if ((baseline_it == baseline_times.end()) || (baseline_it->second <= 0))
+			{
+				comparison_lines << QStringLiteral("%1 (no baseline)").arg(case_name.leftJustified(40));
+				continue;
+			}
+
+			// Positive means slower than the baseline
+			const double relative_change = (current_case["median_ns"].toDouble() / baseline_it->second - 1.0) * 100.0;
+			QString comparison_line = QStringLiteral("%1 %2 -> %3 (%4%5%)").arg(case_name.leftJustified(40), format_time(baseline_it->second), format_time(current_case["median_ns"].toInteger()), QLatin1String((relative_change >= 0) ? "+" : "")).arg(relative_change, 0, 'f', 1);
+
+			// Memory is deterministic for the same data, so any growth is worth a look
+			auto baseline_memory_it = baseline_memory.find(case_name);
+			if (current_case.contains("memory_bytes") && (baseline_memory_it != baseline_memory.end()) && (baseline_memory_it->second > 0))
+			{
+				const double relative_memory_change = (current_case["memory_bytes"].toDouble() / baseline_memory_it->second - 1.0) * 100.0;
+				comparison_line += QStringLiteral(", memory %1 -> %2 (%3%4%)").arg(format_memory(baseline_memory_it->second), format_memory(current_case["memory_bytes"].toInteger()), QLatin1String((relative_memory_change >= 0) ? "+" : "")).arg(relative_memory_change, 0, 'f', 1);
+			}
+
+			auto baseline_allocations_it = baseline_allocations.find(case_name);
+			if (allocations_comparable && current_case.contains("allocations") && (baseline_allocations_it != baseline_allocations.end()))
+			{
+				comparison_line += QStringLiteral(", allocations %1 -> %2").arg(baseline_allocations_it->second).arg(current_case["allocations"].toInteger());
+			}
+			comparison_lines << comparison_line;
+		}
+		return comparison_lines.join('\n');
+	}
+}
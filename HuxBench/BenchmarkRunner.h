@@ -0,0 +1,51 @@
+#pragma once
+#include <QJsonObject>
+#include <QString>
+
+#include <functional>
+#include <memory>
+
+class QTextStream;
+
+namespace HuxApp
+{
+	// Minimal benchmark harness: runs each case until a minimum time has passed and reports the per-iteration timings and allocations (as text or JSON)
+	class BenchmarkRunner
+	{
+	public:
+		struct CaseBody
+		{
+			std::function<void()> m_run; // Timed
+			std::function<void()> m_reset; // Optional, called before each iteration (not timed)
+			qint64 m_bytes_per_iteration = 0; // Optional, used to report throughput
+			std::function<qint64()> m_measure_memory; // Optional, called once after the timed runs (memory used by the data the case works with)
+			qint64 m_items_per_iteration = 0; // Optional, used to report the allocations per item (e.g per screen)
+		};
+
+		// Prepares the case data (only called if the case is selected), so expensive setup is not paid for filtered out cases
+		using CaseFactory = std::function<CaseBody()>;
+
+		struct Config
+		{
+			QString m_filter; // Regular expression, empty means all cases
+			qint64 m_min_time_ms = 500;
+			int m_min_iterations = 5;
+			int m_warmup_iterations = 1;
+		};
+
+		BenchmarkRunner();
+		~BenchmarkRunner();
+
+		void add_case(const QString& name, const CaseFactory& factory, const QJsonObject& parameters = QJsonObject()); // Parameters are copied to the results (e.g for scaling curves)
+		QStringList get_case_names() const;
+
+		// Returns the results as JSON ("cases" array), progress is printed to the stream (if any)
+		QJsonObject run(const Config& config, QTextStream* progress_stream) const;
+
+		// Prints the relative change of the median times (and memory use and allocations) compared to a previous run
+		static QString compare(const QJsonObject& baseline, const QJsonObject& results);
+	private:
+		struct Internal;
+		std::unique_ptr<Internal> m_internal;
+	};
+}
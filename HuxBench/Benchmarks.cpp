@@ -0,0 +1,664 @@
+#include <HuxBench/Benchmarks.h>
+#include <HuxBench/BenchmarkRunner.h>
+
+#include <HuxQt/AppCore.h>
+#include <HuxQt/Scenario/CrossReferenceIndex.h>
+#include <HuxQt/Scenario/MemoryReport.h>
+#include <HuxQt/Scenario/ScenarioBrowserModel.h>
+#include <HuxQt/Scenario/ScenarioManager.h>
+#include <HuxQt/Scenario/ScenarioValidator.h>
+#include <HuxQt/Scenario/SearchIndex.h>
+#include <HuxQt/UI/DisplayData.h>
+#include <HuxQt/UI/DisplaySystem.h>
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QGraphicsView>
+
+#include <array>
+#include <map>
+#include <memory>
+
+namespace HuxApp
+{
+	namespace Benchmarks
+	{
+		namespace
+		{
+			constexpr int TEXT_LINE_COUNT = 60;
+			constexpr int DISPLAY_LINE_COUNT = 20;
+
+			qint64 get_folder_size(const QString& folder_path)
+			{
+				qint64 folder_size = 0;
+				QDirIterator file_it(folder_path, QDir::Files, QDirIterator::Subdirectories);
+				while (file_it.hasNext())
+				{
+					folder_size += file_it.nextFileInfo().size();
+				}
+				return folder_size;
+			}
+
+			// Input for the cases which depend on the scenario size
+			struct ScenarioCaseInput
+			{
+				ScenarioGenerator::Config m_generator_config;
+				QString m_name_suffix; // Distinguishes the cases of a scaling run
+				QJsonObject m_parameters;
+				QString m_work_path;
+
+				QString get_case_name(const QString& name) const { return name + m_name_suffix; }
+				QString get_work_path(const QString& name) const { return QStringLiteral("%1/%2_%3").arg(m_work_path, name).arg(m_generator_config.m_level_count); }
+			};
+
+			// Generates each scenario once, shared by all the cases that need it (the settings do not change during a run)
+			std::shared_ptr<const Scenario> get_scenario(const ScenarioGenerator::Config& generator_config)
+			{
+				static std::map<int, std::shared_ptr<const Scenario>> scenario_cache;
+				std::shared_ptr<const Scenario>& scenario = scenario_cache[generator_config.m_level_count];
+				if (!scenario)
+				{
+					scenario = std::make_shared<const Scenario>(ScenarioGenerator(generator_config).generate_scenario());
+				}
+				return scenario;
+			}
+
+			// Used to report the allocations per screen
+			qint64 get_screen_count(const Scenario& scenario)
+			{
+				qint64 screen_count = 0;
+				for (const Level& current_level : scenario.get_levels())
+				{
+					for (const Terminal& current_terminal : current_level.get_terminals())
+					{
+						for (const Terminal::Branch& current_branch : current_terminal.get_branches())
+						{
+							screen_count += current_branch.m_screens.size();
+						}
+					}
+				}
+				return screen_count;
+			}
+
+			qint64 get_scenario_memory(const Scenario& scenario)
+			{
+				MemoryReport report;
+				report.add_scenario(scenario, scenario.get_name());
+				return report.get_total();
+			}
+
+			QString prepare_split_folder(const ScenarioCaseInput& input, const QString& folder_name)
+			{
+				const QString split_folder_path = input.get_work_path(folder_name);
+				QDir(split_folder_path).removeRecursively();
+
+				ScenarioManager scenario_manager;
+				ScenarioManager::ExportReport report;
+				Diagnostics diagnostics;
+				ScenarioGenerator(input.m_generator_config).write_pict_resources(split_folder_path, diagnostics);
+				scenario_manager.write_scenario_scripts(split_folder_path, *get_scenario(input.m_generator_config), report);
+				return split_folder_path;
+			}
+
+			QString prepare_scenario_file(const ScenarioCaseInput& input, const QString& file_name)
+			{
+				const QString scenario_file_path = input.get_work_path(file_name) + ".json";
+
+				ScenarioManager scenario_manager;
+				Diagnostics diagnostics;
+				scenario_manager.save_scenario(scenario_file_path, *get_scenario(input.m_generator_config), diagnostics);
+				return scenario_file_path;
+			}
+
+			void register_text_benchmarks(BenchmarkRunner& runner, const Settings& settings)
+			{
+				for (const bool formatting_tags : { false, true })
+				{
+					const QString variant_name = formatting_tags ? QStringLiteral("tagged") : QStringLiteral("plain");
+					ScenarioGenerator::Config generator_config = settings.m_generator_config;
+					generator_config.m_tag_density = formatting_tags ? 0.5 : 0.0;
+
+					auto generate_text = [generator_config]()
+						{
+							QRandomGenerator generator(generator_config.m_seed);
+							return ScenarioGenerator(generator_config).generate_text(generator, TEXT_LINE_COUNT);
+						};
+
+					runner.add_case(QStringLiteral("ao/wrap_text/%1").arg(variant_name), [generate_text]()
+						{
+							const QString text = generate_text();
+
+							BenchmarkRunner::CaseBody case_body;
+							case_body.m_run = [text]() { AOText::wrap_text(text, Terminal::ScreenType::INFORMATION); };
+							case_body.m_bytes_per_iteration = text.size() * sizeof(QChar);
+							return case_body;
+						}
+					);
+
+					runner.add_case(QStringLiteral("ao/convert_ao_to_html/%1").arg(variant_name), [generate_text]()
+						{
+							const QString text = generate_text();
+							const AOText::TextColorArray text_colors = AOText::get_default_text_colors();
+
+							BenchmarkRunner::CaseBody case_body;
+							case_body.m_run = [text, text_colors]() { ScenarioManager::convert_ao_to_html(text, Utils::to_integral(Terminal::ScreenType::INFORMATION), text_colors); };
+							case_body.m_bytes_per_iteration = text.size() * sizeof(QChar);
+							return case_body;
+						}
+					);
+				}
+			}
+
+			void register_script_benchmarks(BenchmarkRunner& runner, const ScenarioCaseInput& input)
+			{
+				runner.add_case(input.get_case_name(QStringLiteral("script/print_level_script")), [input]()
+					{
+						auto scenario_manager = std::make_shared<ScenarioManager>();
+						const std::shared_ptr<const Scenario> scenario = get_scenario(input.m_generator_config);
+
+						BenchmarkRunner::CaseBody case_body;
+						case_body.m_run = [scenario_manager, scenario]()
+							{
+								QString level_script;
+								QString error_msg;
+								scenario_manager->print_level_script(scenario->get_level(0), level_script, error_msg);
+							};
+
+						QString level_script;
+						QString error_msg;
+						scenario_manager->print_level_script(scenario->get_level(0), level_script, error_msg);
+						case_body.m_bytes_per_iteration = level_script.toUtf8().size();
+						return case_body;
+					}, input.m_parameters
+				);
+
+				runner.add_case(input.get_case_name(QStringLiteral("script/import_scenario")), [input]()
+					{
+						// Exercises the script parser on every level of the split folder
+						auto scenario_manager = std::make_shared<ScenarioManager>();
+						const QString split_folder_path = prepare_split_folder(input, QStringLiteral("import"));
+
+						BenchmarkRunner::CaseBody case_body;
+						case_body.m_run = [scenario_manager, split_folder_path]()
+							{
+								Scenario scenario;
+								Diagnostics diagnostics;
+								scenario_manager->import_scenario(split_folder_path, scenario, diagnostics);
+							};
+						case_body.m_measure_memory = [scenario_manager, split_folder_path]()
+							{
+								Scenario scenario;
+								Diagnostics diagnostics;
+								scenario_manager->import_scenario(split_folder_path, scenario, diagnostics);
+								return get_scenario_memory(scenario);
+							};
+						case_body.m_bytes_per_iteration = get_folder_size(split_folder_path) - get_folder_size(split_folder_path + "/Resources");
+						case_body.m_items_per_iteration = get_screen_count(*get_scenario(input.m_generator_config));
+						return case_body;
+					}, input.m_parameters
+				);
+
+				runner.add_case(input.get_case_name(QStringLiteral("script/export_scenario/written")), [input]()
+					{
+						auto scenario_manager = std::make_shared<ScenarioManager>();
+						const std::shared_ptr<const Scenario> scenario = get_scenario(input.m_generator_config);
+						const QString split_folder_path = prepare_split_folder(input, QStringLiteral("export"));
+
+						BenchmarkRunner::CaseBody case_body;
+						case_body.m_reset = [split_folder_path]()
+							{
+								// Remove the scripts, so every level has to be written again
+								QDirIterator level_dir_it(split_folder_path, QDir::Dirs | QDir::NoDotAndDotDot);
+								while (level_dir_it.hasNext())
+								{
+									const QFileInfo level_dir_info = level_dir_it.nextFileInfo();
+									if (level_dir_info.fileName() != "Resources")
+									{
+										QDir(level_dir_info.filePath()).removeRecursively();
+									}
+								}
+							};
+						case_body.m_run = [scenario_manager, scenario, split_folder_path]()
+							{
+								ScenarioManager::ExportReport report;
+								scenario_manager->write_scenario_scripts(split_folder_path, *scenario, report);
+							};
+						case_body.m_bytes_per_iteration = get_folder_size(split_folder_path) - get_folder_size(split_folder_path + "/Resources");
+						return case_body;
+					}, input.m_parameters
+				);
+
+				runner.add_case(input.get_case_name(QStringLiteral("script/export_scenario/unchanged")), [input]()
+					{
+						// Every script is already up to date, so this measures generating and hashing them
+						auto scenario_manager = std::make_shared<ScenarioManager>();
+						const std::shared_ptr<const Scenario> scenario = get_scenario(input.m_generator_config);
+						const QString split_folder_path = prepare_split_folder(input, QStringLiteral("export_unchanged"));
+
+						BenchmarkRunner::CaseBody case_body;
+						case_body.m_run = [scenario_manager, scenario, split_folder_path]()
+							{
+								ScenarioManager::ExportReport report;
+								scenario_manager->write_scenario_scripts(split_folder_path, *scenario, report);
+							};
+						case_body.m_bytes_per_iteration = get_folder_size(split_folder_path) - get_folder_size(split_folder_path + "/Resources");
+						return case_body;
+					}, input.m_parameters
+				);
+			}
+
+			void register_scenario_file_benchmarks(BenchmarkRunner& runner, const ScenarioCaseInput& input)
+			{
+				runner.add_case(input.get_case_name(QStringLiteral("scenario/save_scenario")), [input]()
+					{
+						auto scenario_manager = std::make_shared<ScenarioManager>();
+						const std::shared_ptr<const Scenario> scenario = get_scenario(input.m_generator_config);
+						const QString scenario_file_path = prepare_scenario_file(input, QStringLiteral("save"));
+
+						BenchmarkRunner::CaseBody case_body;
+						case_body.m_run = [scenario_manager, scenario, scenario_file_path]()
+							{
+								Diagnostics diagnostics;
+								scenario_manager->save_scenario(scenario_file_path, *scenario, diagnostics);
+							};
+						case_body.m_bytes_per_iteration = QFileInfo(scenario_file_path).size();
+						return case_body;
+					}, input.m_parameters
+				);
+
+				for (const bool lazy : { false, true })
+				{
+					runner.add_case(input.get_case_name(lazy ? QStringLiteral("scenario/load_scenario/lazy") : QStringLiteral("scenario/load_scenario/full")), [input, lazy]()
+						{
+							auto scenario_manager = std::make_shared<ScenarioManager>();
+							const QString scenario_file_path = prepare_scenario_file(input, QStringLiteral("load"));
+
+							BenchmarkRunner::CaseBody case_body;
+							case_body.m_run = [scenario_manager, scenario_file_path, lazy]()
+								{
+									Scenario scenario;
+									Diagnostics diagnostics;
+									scenario_manager->load_scenario(scenario_file_path, scenario, diagnostics, lazy);
+								};
+							case_body.m_measure_memory = [scenario_manager, scenario_file_path, lazy]()
+								{
+									Scenario scenario;
+									Diagnostics diagnostics;
+									scenario_manager->load_scenario(scenario_file_path, scenario, diagnostics, lazy);
+									return get_scenario_memory(scenario);
+								};
+							case_body.m_bytes_per_iteration = QFileInfo(scenario_file_path).size();
+							if (!lazy)
+							{
+								case_body.m_items_per_iteration = get_screen_count(*get_scenario(input.m_generator_config));
+							}
+							return case_body;
+						}, input.m_parameters
+					);
+				}
+
+				runner.add_case(input.get_case_name(QStringLiteral("scenario/round_trip")), [input]()
+					{
+						auto scenario_manager = std::make_shared<ScenarioManager>();
+						auto scenario = std::make_shared<Scenario>(*get_scenario(input.m_generator_config));
+						const QString scenario_file_path = input.get_work_path(QStringLiteral("round_trip")) + ".json";
+
+						BenchmarkRunner::CaseBody case_body;
+						case_body.m_run = [scenario_manager, scenario, scenario_file_path]()
+							{
+								Diagnostics diagnostics;
+								scenario_manager->save_scenario(scenario_file_path, *scenario, diagnostics);
+								scenario_manager->load_scenario(scenario_file_path, *scenario, diagnostics);
+							};
+						return case_body;
+					}, input.m_parameters
+				);
+			}
+
+			void register_browse_benchmarks(BenchmarkRunner& runner, const ScenarioCaseInput& input)
+			{
+				runner.add_case(input.get_case_name(QStringLiteral("browse/load_scenario")), [input]()
+					{
+						// Populating the scenario browser with fully loaded levels (moved in like after loading a file, so the screens should not allocate)
+						const std::shared_ptr<const Scenario> scenario = get_scenario(input.m_generator_config);
+						auto loaded_scenario = std::make_shared<Scenario>();
+
+						BenchmarkRunner::CaseBody case_body;
+						case_body.m_reset = [scenario, loaded_scenario]() { *loaded_scenario = *scenario; };
+						case_body.m_run = [loaded_scenario]()
+							{
+								ScenarioBrowserModel browser_model;
+								browser_model.load_scenario(std::move(*loaded_scenario));
+							};
+						case_body.m_measure_memory = [scenario]()
+							{
+								// Only the memory of the model (the strings it shares with the scenario are counted for the scenario)
+								ScenarioBrowserModel browser_model;
+								browser_model.load_scenario(*scenario);
+
+								MemoryReport report;
+								report.add_scenario(*scenario, scenario->get_name());
+								const int browser_entry = browser_model.report_memory(report);
+								return report.get_entries()[browser_entry].get_total();
+							};
+						case_body.m_items_per_iteration = get_screen_count(*scenario);
+						return case_body;
+					}, input.m_parameters
+				);
+
+				runner.add_case(input.get_case_name(QStringLiteral("browse/load_scenario_file")), [input]()
+					{
+						// The whole pipeline from the scenario file to the browser (the screen strings are only allocated by the loader)
+						auto scenario_manager = std::make_shared<ScenarioManager>();
+						const QString scenario_file_path = prepare_scenario_file(input, QStringLiteral("browse_load"));
+
+						BenchmarkRunner::CaseBody case_body;
+						case_body.m_run = [scenario_manager, scenario_file_path]()
+							{
+								Scenario scenario;
+								Diagnostics diagnostics;
+								scenario_manager->load_scenario(scenario_file_path, scenario, diagnostics);
+
+								ScenarioBrowserModel browser_model;
+								browser_model.load_scenario(std::move(scenario));
+							};
+						case_body.m_bytes_per_iteration = QFileInfo(scenario_file_path).size();
+						case_body.m_items_per_iteration = get_screen_count(*get_scenario(input.m_generator_config));
+						return case_body;
+					}, input.m_parameters
+				);
+
+				runner.add_case(input.get_case_name(QStringLiteral("browse/open_levels")), [input]()
+					{
+						// Opening every level of a lazily loaded scenario (deserializes the level and creates its model)
+						auto scenario_manager = std::make_shared<ScenarioManager>();
+						auto lazy_scenario = std::make_shared<Scenario>();
+						Diagnostics diagnostics;
+						scenario_manager->load_scenario(prepare_scenario_file(input, QStringLiteral("browse")), *lazy_scenario, diagnostics, true);
+
+						BenchmarkRunner::CaseBody case_body;
+						case_body.m_run = [scenario_manager, lazy_scenario]()
+							{
+								ScenarioBrowserModel browser_model;
+								browser_model.set_level_loader([scenario_manager](Level& level)
+									{
+										QString error_msg;
+										if (!scenario_manager->load_level(level, error_msg))
+										{
+											qWarning("%s", qUtf8Printable(error_msg));
+											return false;
+										}
+										return true;
+									}
+								);
+								browser_model.load_scenario(*lazy_scenario);
+								for (int level_row = 0; level_row < browser_model.get_level_list().rowCount(); ++level_row)
+								{
+									browser_model.get_level_model(browser_model.get_level_id(level_row));
+								}
+							};
+						return case_body;
+					}, input.m_parameters
+				);
+
+				runner.add_case(input.get_case_name(QStringLiteral("browse/query_rows")), [input]()
+					{
+						// The roles a view asks for when painting every row of every level
+						auto browser_model = std::make_shared<ScenarioBrowserModel>();
+						browser_model->load_scenario(*get_scenario(input.m_generator_config));
+
+						BenchmarkRunner::CaseBody case_body;
+						case_body.m_run = [browser_model]()
+							{
+								for (int level_row = 0; level_row < browser_model->get_level_list().rowCount(); ++level_row)
+								{
+									const LevelModel* level_model = browser_model->get_level_model(browser_model->get_level_id(level_row));
+									for (int terminal_row = 0; terminal_row < level_model->rowCount(); ++terminal_row)
+									{
+										const QModelIndex terminal_index = level_model->index(terminal_row);
+										level_model->data(terminal_index, Qt::DisplayRole);
+										level_model->data(terminal_index, Qt::DecorationRole);
+										level_model->data(terminal_index, Qt::FontRole);
+									}
+								}
+							};
+						return case_body;
+					}, input.m_parameters
+				);
+
+				runner.add_case(input.get_case_name(QStringLiteral("browse/export_scenario")), [input]()
+					{
+						// Snapshot taken from the browser on every save and export
+						auto browser_model = std::make_shared<ScenarioBrowserModel>();
+						browser_model->load_scenario(*get_scenario(input.m_generator_config));
+
+						BenchmarkRunner::CaseBody case_body;
+						case_body.m_run = [browser_model]() { browser_model->export_scenario(); };
+						return case_body;
+					}, input.m_parameters
+				);
+
+				runner.add_case(input.get_case_name(QStringLiteral("browse/remove_terminals")), [input]()
+					{
+						// Bulk delete of every other terminal in each level (each removed row is its own range)
+						const std::shared_ptr<const Scenario> scenario = get_scenario(input.m_generator_config);
+						auto browser_model = std::make_shared<ScenarioBrowserModel>();
+
+						BenchmarkRunner::CaseBody case_body;
+						case_body.m_reset = [scenario, browser_model]() { browser_model->load_scenario(*scenario); };
+						case_body.m_run = [browser_model]()
+							{
+								for (int level_row = 0; level_row < browser_model->get_level_list().rowCount(); ++level_row)
+								{
+									LevelModel* level_model = browser_model->get_level_model(browser_model->get_level_id(level_row));
+									QModelIndexList removed_indices;
+									for (int terminal_row = 0; terminal_row < level_model->rowCount(); terminal_row += 2)
+									{
+										removed_indices << level_model->index(terminal_row);
+									}
+									level_model->remove_terminals(removed_indices);
+								}
+							};
+						return case_body;
+					}, input.m_parameters
+				);
+			}
+
+			void register_search_benchmarks(BenchmarkRunner& runner, const ScenarioCaseInput& input)
+			{
+				runner.add_case(input.get_case_name(QStringLiteral("search/build_index")), [input]()
+					{
+						// Indexing every terminal of the scenario (done in the background when the scenario is opened)
+						const std::shared_ptr<const Scenario> scenario = get_scenario(input.m_generator_config);
+
+						BenchmarkRunner::CaseBody case_body;
+						case_body.m_run = [scenario]()
+							{
+								SearchIndex search_index;
+								int level_id = 0;
+								for (const Level& current_level : scenario->get_levels())
+								{
+									search_index.add_level(level_id++, current_level);
+								}
+							};
+						case_body.m_measure_memory = [scenario]()
+							{
+								// Only the index itself (the terminal data is shared with the scenario)
+								SearchIndex search_index;
+								int level_id = 0;
+								for (const Level& current_level : scenario->get_levels())
+								{
+									search_index.add_level(level_id++, current_level);
+								}
+
+								MemoryReport report;
+								report.add_scenario(*scenario, scenario->get_name());
+								const int index_entry = search_index.report_memory(report);
+								return report.get_entries()[index_entry].get_total();
+							};
+						case_body.m_items_per_iteration = get_screen_count(*scenario);
+						return case_body;
+					}, input.m_parameters
+				);
+
+				runner.add_case(input.get_case_name(QStringLiteral("search/build_cross_references")), [input]()
+					{
+						// Collecting the PICT, checkpoint, tag and teleport references (built next to the search index)
+						const std::shared_ptr<const Scenario> scenario = get_scenario(input.m_generator_config);
+
+						BenchmarkRunner::CaseBody case_body;
+						case_body.m_run = [scenario]()
+							{
+								CrossReferenceIndex cross_references;
+								int level_id = 0;
+								for (const Level& current_level : scenario->get_levels())
+								{
+									cross_references.add_level(level_id++, current_level);
+								}
+							};
+						case_body.m_items_per_iteration = get_screen_count(*scenario);
+						return case_body;
+					}, input.m_parameters
+				);
+
+				for (const bool cached : { false, true })
+				{
+					const QString case_name = cached ? QStringLiteral("validation/check_terminals/cached") : QStringLiteral("validation/check_terminals");
+					runner.add_case(input.get_case_name(case_name), [input, cached]()
+						{
+							// Parallel check of every terminal (the editor only checks the edited terminals again, which are usually not cached)
+							const std::shared_ptr<const Scenario> scenario = get_scenario(input.m_generator_config);
+							auto terminals = std::make_shared<std::vector<const Terminal*>>();
+							for (const Level& current_level : scenario->get_levels())
+							{
+								for (const Terminal& current_terminal : current_level.get_terminals())
+								{
+									terminals->push_back(&current_terminal);
+								}
+							}
+
+							auto validator = std::make_shared<ScenarioValidator>();
+							BenchmarkRunner::CaseBody case_body;
+							case_body.m_run = [scenario, terminals, validator, cached]()
+								{
+									if (!cached)
+									{
+										validator->clear_cache();
+									}
+									validator->check_terminals(*terminals);
+								};
+							case_body.m_items_per_iteration = get_screen_count(*scenario);
+							return case_body;
+						}, input.m_parameters
+					);
+				}
+
+				const std::array<std::pair<const char*, const char*>, 4> search_queries = {
+					std::make_pair("word", "Durandal"),
+					std::make_pair("prefix", "transm"),
+					std::make_pair("phrase", "\"lower decks\""),
+					std::make_pair("regex", "/Tycho\\s+Leela/")
+				};
+
+				for (const auto& current_query : search_queries)
+				{
+					const QString query = current_query.second;
+					runner.add_case(input.get_case_name(QStringLiteral("search/query/%1").arg(QLatin1String(current_query.first))), [input, query]()
+						{
+							// Single query over the whole scenario (the regular expression has to scan the terminals)
+							auto search_index = std::make_shared<SearchIndex>();
+							int level_id = 0;
+							for (const Level& current_level : get_scenario(input.m_generator_config)->get_levels())
+							{
+								search_index->add_level(level_id++, current_level);
+							}
+
+							BenchmarkRunner::CaseBody case_body;
+							case_body.m_run = [search_index, query]()
+								{
+									std::vector<SearchIndex::Hit> hits;
+									QString error_msg;
+									search_index->search(query, hits, error_msg);
+								};
+							return case_body;
+						}, input.m_parameters
+					);
+				}
+			}
+
+			void register_display_benchmarks(BenchmarkRunner& runner, const Settings& settings)
+			{
+				for (const Terminal::ScreenType screen_type : { Terminal::ScreenType::INFORMATION, Terminal::ScreenType::PICT })
+				{
+					const QString case_name = (screen_type == Terminal::ScreenType::PICT) ? QStringLiteral("display/update_display/pict") : QStringLiteral("display/update_display/information");
+					runner.add_case(case_name, [settings, screen_type]()
+						{
+							const QString split_folder_path = settings.m_work_path + "/display";
+							const ScenarioGenerator generator(settings.m_generator_config);
+							Diagnostics diagnostics;
+							generator.write_pict_resources(split_folder_path, diagnostics);
+
+							// The display system is owned by the app core (the main window is not needed)
+							auto core = std::make_shared<AppCore>(nullptr);
+							auto graphics_view = std::make_shared<QGraphicsView>();
+							DisplaySystem& display_system = core->get_display_system();
+							display_system.update_resources(split_folder_path + "/Resources");
+							const DisplaySystem::ViewID view_id = display_system.register_graphics_view(graphics_view.get());
+
+							// Alternate between two screens, otherwise the display system skips the update
+							const QList<int> resource_ids = generator.get_pict_resource_ids();
+							QRandomGenerator random_generator(settings.m_generator_config.m_seed);
+							std::array<DisplayData, 2> display_data;
+							int data_index = 0;
+							for (DisplayData& current_data : display_data)
+							{
+								current_data.m_screen_type = screen_type;
+								current_data.m_resource_id = resource_ids.isEmpty() ? 0 : resource_ids[data_index % resource_ids.size()];
+								current_data.m_text = ScenarioManager::convert_ao_to_html(generator.generate_text(random_generator, DISPLAY_LINE_COUNT), Utils::to_integral(screen_type), AOText::get_default_text_colors());
+								++data_index;
+							}
+
+							auto current_index = std::make_shared<int>(0);
+
+							BenchmarkRunner::CaseBody case_body;
+							case_body.m_run = [core, graphics_view, view_id, display_data, current_index]()
+								{
+									core->get_display_system().update_display(view_id, display_data[*current_index]);
+									*current_index = 1 - *current_index;
+								};
+							return case_body;
+						}
+					);
+				}
+			}
+		}
+
+		void register_benchmarks(BenchmarkRunner& runner, const Settings& settings)
+		{
+			register_text_benchmarks(runner, settings);
+			register_display_benchmarks(runner, settings);
+
+			// Cases which depend on the scenario size (repeated for each size when measuring scaling)
+			const QList<int> level_counts = settings.m_scaling_level_counts.isEmpty() ? QList<int>{ settings.m_generator_config.m_level_count } : settings.m_scaling_level_counts;
+			for (int current_level_count : level_counts)
+			{
+				ScenarioCaseInput input;
+				input.m_generator_config = settings.m_generator_config;
+				input.m_generator_config.m_level_count = current_level_count;
+				input.m_work_path = settings.m_work_path;
+				if (!settings.m_scaling_level_counts.isEmpty())
+				{
+					input.m_name_suffix = QStringLiteral("/levels_%1").arg(current_level_count);
+				}
+				input.m_parameters["levels"] = current_level_count;
+				input.m_parameters["terminals"] = current_level_count * input.m_generator_config.m_terminals_per_level;
+
+				register_script_benchmarks(runner, input);
+				register_scenario_file_benchmarks(runner, input);
+				register_browse_benchmarks(runner, input);
+				register_search_benchmarks(runner, input);
+			}
+		}
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <HuxQt/Scenario/ScenarioGenerator.h>
+
+namespace HuxApp
+{
+	class BenchmarkRunner;
+
+	namespace Benchmarks
+	{
+		struct Settings
+		{
+			ScenarioGenerator::Config m_generator_config;
+			QList<int> m_scaling_level_counts; // If set, the scenario cases are repeated for each level count (instead of the one in the generator config)
+			QString m_work_path; // Scratch folder for the file I/O cases
+		};
+
+		void register_benchmarks(BenchmarkRunner& runner, const Settings& settings);
+	}
+}
@@ -0,0 +1,154 @@
+#include <HuxBench/BenchmarkRunner.h>
+#include <HuxBench/Benchmarks.h>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+
+namespace
+{
+	constexpr int EXIT_SUCCESS_CODE = 0;
+	constexpr int EXIT_FAILURE_CODE = 1;
+	constexpr int EXIT_USAGE_CODE = 2;
+
+	bool parse_int_option(const QCommandLineParser& parser, const QCommandLineOption& option, int& value)
+	{
+		if (!parser.isSet(option))
+		{
+			return true;
+		}
+
+		bool valid_value = false;
+		value = parser.value(option).toInt(&valid_value);
+		return valid_value && (value > 0);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	// The display cases need a GUI application, but not an actual window system
+	if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+	{
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+	}
+
+	QApplication application(argc, argv);
+	QApplication::setApplicationName("hux_bench");
+
+	QTextStream out_stream(stdout);
+	QTextStream error_stream(stderr);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Benchmarks for the Hux hot paths (script parsing, scenario files, AO text conversion, display updates).");
+	parser.addHelpOption();
+
+	const QCommandLineOption filter_option("filter", "Only run the cases whose name matches the regular expression.", "regex");
+	const QCommandLineOption list_option("list", "List the available cases.");
+	const QCommandLineOption output_option(QStringList{ "o", "output" }, "Write the results as JSON to the file.", "file");
+	const QCommandLineOption json_option("json", "Print the results as JSON instead of text.");
+	const QCommandLineOption baseline_option("baseline", "Compare the results with a previous JSON output.", "file");
+	const QCommandLineOption min_time_option("min-time", "Minimum measured time per case (default: 500).", "ms");
+	const QCommandLineOption seed_option("seed", "Seed for the generated data (default: 1).", "N");
+	const QCommandLineOption levels_option("levels", "Number of levels in the generated scenario (default: 20).", "N");
+	const QCommandLineOption scaling_option("scaling", "Repeat the scenario cases for each level count (e.g 10,20,40,80), to measure how they scale.", "list");
+	parser.addOptions({ filter_option, list_option, output_option, json_option, baseline_option, min_time_option, seed_option, levels_option, scaling_option });
+	parser.process(application);
+
+	HuxApp::BenchmarkRunner::Config config;
+	config.m_filter = parser.value(filter_option);
+
+	HuxApp::Benchmarks::Settings settings;
+	int min_time_ms = static_cast<int>(config.m_min_time_ms);
+	int seed = static_cast<int>(settings.m_generator_config.m_seed);
+	if (!parse_int_option(parser, min_time_option, min_time_ms) || !parse_int_option(parser, seed_option, seed) || !parse_int_option(parser, levels_option, settings.m_generator_config.m_level_count))
+	{
+		error_stream << "Invalid option value!" << Qt::endl;
+		return EXIT_USAGE_CODE;
+	}
+	config.m_min_time_ms = min_time_ms;
+	settings.m_generator_config.m_seed = static_cast<quint32>(seed);
+
+	if (parser.isSet(scaling_option))
+	{
+		for (const QString& current_value : parser.value(scaling_option).split(','))
+		{
+			bool valid_value = false;
+			const int level_count = current_value.toInt(&valid_value);
+			if (!valid_value || (level_count < 1))
+			{
+				error_stream << "Invalid level count: " << current_value << Qt::endl;
+				return EXIT_USAGE_CODE;
+			}
+			settings.m_scaling_level_counts << level_count;
+		}
+	}
+
+	QTemporaryDir work_dir;
+	if (!work_dir.isValid())
+	{
+		error_stream << "Unable to create a temporary folder!" << Qt::endl;
+		return EXIT_FAILURE_CODE;
+	}
+	settings.m_work_path = work_dir.path();
+
+	HuxApp::BenchmarkRunner runner;
+	HuxApp::Benchmarks::register_benchmarks(runner, settings);
+
+	if (parser.isSet(list_option))
+	{
+		out_stream << runner.get_case_names().join('\n') << Qt::endl;
+		return EXIT_SUCCESS_CODE;
+	}
+
+	const bool json_output = parser.isSet(json_option);
+	QJsonObject results_json = runner.run(config, json_output ? nullptr : &out_stream);
+
+	// Record the environment, so results from different machines/versions are not compared by accident
+	results_json["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+	results_json["qt_version"] = QLatin1String(qVersion());
+	results_json["platform"] = QSysInfo::prettyProductName();
+	results_json["cpu_architecture"] = QSysInfo::currentCpuArchitecture();
+	results_json["thread_count"] = QThread::idealThreadCount();
+	results_json["seed"] = static_cast<qint64>(settings.m_generator_config.m_seed);
+	results_json["levels"] = settings.m_generator_config.m_level_count;
+	results_json["min_time_ms"] = config.m_min_time_ms;
+
+	const QByteArray results_data = QJsonDocument(results_json).toJson(QJsonDocument::Indented);
+	if (json_output)
+	{
+		out_stream << results_data;
+		out_stream.flush();
+	}
+
+	if (parser.isSet(output_option))
+	{
+		QFile output_file(parser.value(output_option));
+		if (!output_file.open(QIODevice::WriteOnly) || (output_file.write(results_data) != results_data.size()))
+		{
+			error_stream << "Unable to write \"" << output_file.fileName() << "\"!" << Qt::endl;
+			return EXIT_FAILURE_CODE;
+		}
+	}
+
+	if (parser.isSet(baseline_option))
+	{
+		QFile baseline_file(parser.value(baseline_option));
+		if (!baseline_file.open(QIODevice::ReadOnly))
+		{
+			error_stream << "Unable to read \"" << baseline_file.fileName() << "\"!" << Qt::endl;
+			return EXIT_FAILURE_CODE;
+		}
+
+		// Goes to stderr when printing JSON, so the output stays parseable
+		QTextStream& comparison_stream = json_output ? error_stream : out_stream;
+		comparison_stream << "\nCompared to " << baseline_file.fileName() << ":\n" << HuxApp::BenchmarkRunner::compare(QJsonDocument::fromJson(baseline_file.readAll()).object(), results_json) << Qt::endl;
+	}
+
+	return EXIT_SUCCESS_CODE;
+}
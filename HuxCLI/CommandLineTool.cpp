@@ -0,0 +1,890 @@
+#include <HuxCLI/CommandLineTool.h>
+
+#include <HuxQt/Scenario/ScenarioManager.h>
+#include <HuxQt/Scenario/Scenario.h>
+#include <HuxQt/Scenario/ScenarioGenerator.h>
+#include <HuxQt/Scenario/MemoryReport.h>
+#include <HuxQt/Scenario/CrossReferenceIndex.h>
+#include <HuxQt/Scenario/ScenarioValidator.h>
+
+#include <HuxQt/Utils/Trace.h>
+#include <HuxQt/Utils/Utilities.h>
+
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QTextStream>
+#include <QDir>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <unordered_map>
+
+namespace HuxApp
+{
+	namespace
+	{
+		enum class Command
+		{
+			IMPORT,
+			EXPORT,
+			CONVERT,
+			VALIDATE,
+			STATS,
+			GENERATE,
+			MEMORY,
+			REFS,
+			COMMAND_COUNT
+		};
+
+		constexpr const char* COMMAND_NAMES[Utils::to_integral(Command::COMMAND_COUNT)] = {
+			"import",
+			"export",
+			"convert",
+			"validate",
+			"stats",
+			"generate",
+			"memory",
+			"refs"
+		};
+
+		constexpr const char* COMMAND_DESCRIPTIONS[Utils::to_integral(Command::COMMAND_COUNT)] = {
+			"import <split folder> <scenario file>      Import a split folder into a Hux scenario file",
+			"export <scenario file> <split folder>      Export the terminal scripts of a Hux scenario file",
+			"convert <input> <output>                   Convert between split folders and Hux scenario files (.json)",
+			"validate <input>                           Check a scenario for errors (fails if any are found)",
+			"stats <input>                              Print statistics about a scenario",
+			"generate <output>                          Generate a synthetic scenario for stress tests (scenario file if .json, otherwise split folder)",
+			"memory <input>                             Print an estimate of the memory used by the scenario data",
+			"refs <input>                               List the PICTs, checkpoints, tags and teleport targets used by the scenario (and the missing/unused PICTs)"
+		};
+
+		constexpr int EXIT_SUCCESS_CODE = 0;
+		constexpr int EXIT_FAILURE_CODE = 1;
+		constexpr int EXIT_USAGE_CODE = 2;
+
+		constexpr const char* SCREEN_TYPE_NAMES[Utils::to_integral(Terminal::ScreenType::TYPE_COUNT)] = {
+			"none",
+			"logon",
+			"information",
+			"pict",
+			"checkpoint",
+			"logoff",
+			"tag",
+			"static"
+		};
+
+		// Values of the "--type" option
+		constexpr const char* REFERENCE_TYPE_OPTION_NAMES[Utils::to_integral(CrossReferenceIndex::ReferenceType::TYPE_COUNT)] = {
+			"pict",
+			"checkpoint",
+			"tag",
+			"level-teleport",
+			"polygon-teleport"
+		};
+
+		bool is_scenario_file_path(const QString& path)
+		{
+			return path.endsWith(".json", Qt::CaseInsensitive);
+		}
+
+		bool parse_int_option(const QCommandLineParser& parser, const QCommandLineOption& option, int min_value, int& value)
+		{
+			if (!parser.isSet(option))
+			{
+				return true;
+			}
+
+			bool valid_value = false;
+			value = parser.value(option).toInt(&valid_value);
+			return valid_value && (value >= min_value);
+		}
+
+		bool parse_ratio_option(const QCommandLineParser& parser, const QCommandLineOption& option, double& value)
+		{
+			if (!parser.isSet(option))
+			{
+				return true;
+			}
+
+			bool valid_value = false;
+			value = parser.value(option).toDouble(&valid_value);
+			return valid_value && (value >= 0.0) && (value <= 1.0);
+		}
+
+		// Ranges are given as "MIN:MAX"
+		bool parse_range_option(const QCommandLineParser& parser, const QCommandLineOption& option, int& min_value, int& max_value)
+		{
+			if (!parser.isSet(option))
+			{
+				return true;
+			}
+
+			const QStringList range_values = parser.value(option).split(':');
+			if (range_values.size() != 2)
+			{
+				return false;
+			}
+
+			bool valid_min = false;
+			bool valid_max = false;
+			min_value = range_values[0].toInt(&valid_min);
+			max_value = range_values[1].toInt(&valid_max);
+			return valid_min && valid_max && (min_value > 0) && (min_value <= max_value);
+		}
+	}
+
+	struct CommandLineTool::Internal
+	{
+		ScenarioManager m_scenario_manager;
+		Diagnostics m_diagnostics; // Problems reported while running the command
+
+		bool m_json_output = false;
+		QString m_trace_file_path; // Where to write the Chrome trace of the command (if set)
+		QJsonObject m_result; // Printed at the end (as JSON, or as text for the fields that are meant for the user)
+
+		QTextStream m_out_stream;
+		QTextStream m_error_stream;
+
+		Internal()
+			: m_out_stream(stdout)
+			, m_error_stream(stderr)
+		{
+		}
+
+		void print(const QString& message)
+		{
+			if (!m_json_output)
+			{
+				m_out_stream << message << Qt::endl;
+			}
+		}
+
+		int finish(bool success, const QString& error_msg = QString())
+		{
+			if (!error_msg.isEmpty())
+			{
+				m_diagnostics.add_error(error_msg);
+			}
+
+			if (!m_trace_file_path.isEmpty())
+			{
+				// The trace was requested, so failing to write it fails the command
+				Trace::set_enabled(false);
+				QString trace_error_msg;
+				if (!Trace::write_chrome_trace(m_trace_file_path, trace_error_msg))
+				{
+					m_diagnostics.add_error(trace_error_msg, m_trace_file_path);
+					success = false;
+				}
+			}
+
+			m_result["success"] = success;
+			if (!m_diagnostics.is_empty())
+			{
+				QJsonArray diagnostic_json_array;
+				for (const Diagnostics::Entry& current_entry : m_diagnostics.get_entries())
+				{
+					QJsonObject diagnostic_json;
+					diagnostic_json["severity"] = QLatin1String(Diagnostics::get_severity_label(current_entry.m_severity));
+					diagnostic_json["message"] = current_entry.m_message;
+					if (!current_entry.m_file_path.isEmpty())
+					{
+						diagnostic_json["file"] = current_entry.m_file_path;
+					}
+					if (current_entry.m_line >= 0)
+					{
+						diagnostic_json["line"] = current_entry.m_line;
+					}
+					diagnostic_json_array.append(diagnostic_json);
+				}
+				m_result["diagnostics"] = diagnostic_json_array;
+			}
+
+			if (m_json_output)
+			{
+				m_out_stream << QJsonDocument(m_result).toJson(QJsonDocument::Indented);
+				m_out_stream.flush();
+			}
+			else if (!m_diagnostics.is_empty())
+			{
+				m_error_stream << m_diagnostics.print() << Qt::endl;
+			}
+			return success ? EXIT_SUCCESS_CODE : EXIT_FAILURE_CODE;
+		}
+
+		bool load_input(const QString& input_path, Scenario& scenario, bool lazy = false)
+		{
+			// Split folders are imported, anything else is treated as a scenario file
+			if (QFileInfo(input_path).isDir())
+			{
+				return m_scenario_manager.import_scenario(input_path, scenario, m_diagnostics);
+			}
+			return m_scenario_manager.load_scenario(input_path, scenario, m_diagnostics, lazy);
+		}
+
+		bool write_output(const QString& output_path, const Scenario& scenario)
+		{
+			if (is_scenario_file_path(output_path))
+			{
+				return m_scenario_manager.save_scenario(output_path, scenario, m_diagnostics);
+			}
+
+			if (!QDir().mkpath(output_path))
+			{
+				m_diagnostics.add_error(QStringLiteral("Unable to create directory \"%1\"!").arg(output_path));
+				return false;
+			}
+
+			ScenarioManager::ExportReport report;
+			const bool success = m_scenario_manager.write_scenario_scripts(output_path, scenario, report);
+
+			QJsonArray level_json_array;
+			for (const ScenarioManager::ExportReport::LevelEntry& current_entry : report.m_levels)
+			{
+				QJsonObject level_json;
+				level_json["name"] = current_entry.m_level_name;
+				level_json["file"] = current_entry.m_file_path;
+				level_json["result"] = QString::fromLatin1(ScenarioManager::ExportReport::get_result_label(current_entry.m_result)).toLower();
+				level_json["elapsed_ms"] = current_entry.m_elapsed_ms;
+				level_json["size"] = current_entry.m_script_size;
+				if (!current_entry.m_error_msg.isEmpty())
+				{
+					level_json["error"] = current_entry.m_error_msg;
+				}
+				level_json_array.append(level_json);
+			}
+			m_result["levels"] = level_json_array;
+			m_result["summary"] = report.get_summary();
+
+			print(report.print());
+			if (!success)
+			{
+				m_diagnostics.add_error(QStringLiteral("Failed to export %1 level(s)!").arg(report.get_result_count(ScenarioManager::ExportReport::Result::FAILED)));
+			}
+			return success;
+		}
+
+		// Images are looked up in the given resources folder, or the "Resources" folder next to the input
+		// Returns false if the given folder has no PICTs (a missing default folder is only a warning, and nothing is found)
+		bool find_pict_files(const QString& input_path, const QString& resource_path, QMap<int, QString>& pict_files, bool& found)
+		{
+			QString pict_resource_path = resource_path;
+			if (resource_path.isEmpty())
+			{
+				const QFileInfo input_info(input_path);
+				pict_resource_path = (input_info.isDir() ? input_info.absoluteFilePath() : input_info.absolutePath()) + "/Resources";
+			}
+
+			found = QDir(pict_resource_path + "/PICT").exists();
+			if (found)
+			{
+				// Same lookup as the editor previews
+				pict_files = ScenarioManager::find_pict_resources(pict_resource_path);
+				m_result["resources"] = pict_resource_path;
+				return true;
+			}
+			else if (!resource_path.isEmpty())
+			{
+				m_diagnostics.add_error(QStringLiteral("No PICT folder in \"%1\"!").arg(resource_path));
+				return false;
+			}
+
+			m_diagnostics.add_warning(QStringLiteral("No PICT folder found, the PICTs are not checked against the images (use --resources)"), pict_resource_path);
+			return true;
+		}
+
+		int run_conversion(const QString& input_path, const QString& output_path)
+		{
+			m_result["input"] = input_path;
+			m_result["output"] = output_path;
+
+			QElapsedTimer conversion_timer;
+			conversion_timer.start();
+
+			Scenario scenario;
+			if (!load_input(input_path, scenario))
+			{
+				return finish(false);
+			}
+			m_result["load_ms"] = conversion_timer.elapsed();
+
+			const bool success = write_output(output_path, scenario);
+			m_result["elapsed_ms"] = conversion_timer.elapsed();
+
+			if (success)
+			{
+				print(QStringLiteral("Converted \"%1\" to \"%2\" (%3 levels, %4 ms)").arg(input_path, output_path).arg(scenario.get_levels().size()).arg(conversion_timer.elapsed()));
+			}
+			return finish(success);
+		}
+
+		int run_validation(const QString& input_path, const QString& resource_path)
+		{
+			m_result["input"] = input_path;
+
+			Scenario scenario;
+			if (!load_input(input_path, scenario))
+			{
+				return finish(false);
+			}
+
+			QElapsedTimer validation_timer;
+			validation_timer.start();
+
+			// Terminals are identified by the level index and their row
+			const std::vector<Level>& levels = scenario.get_levels();
+			std::vector<const Terminal*> terminals;
+			std::vector<TerminalID> terminal_ids;
+			for (int level_index = 0; level_index < static_cast<int>(levels.size()); ++level_index)
+			{
+				int terminal_row = 0;
+				for (const Terminal& current_terminal : levels[level_index].get_terminals())
+				{
+					terminals.push_back(&current_terminal);
+					terminal_ids.push_back(TerminalID{ level_index, terminal_row++ });
+				}
+			}
+
+			// Terminals are checked in parallel, then the references are checked against the scenario and the images
+			ScenarioValidator validator;
+			const std::vector<ScenarioValidator::ProblemListPtr> terminal_problems = validator.check_terminals(terminals);
+
+			std::vector<ScenarioValidator::TerminalProblem> problems;
+			for (size_t terminal_index = 0; terminal_index < terminals.size(); ++terminal_index)
+			{
+				for (const ScenarioValidator::Problem& current_problem : *terminal_problems[terminal_index])
+				{
+					problems.push_back(ScenarioValidator::TerminalProblem{ terminal_ids[terminal_index], current_problem });
+				}
+			}
+
+			CrossReferenceIndex cross_references;
+			for (int level_index = 0; level_index < static_cast<int>(levels.size()); ++level_index)
+			{
+				cross_references.add_level(level_index, levels[level_index]);
+			}
+
+			QMap<int, QString> pict_files;
+			bool pict_files_found = false;
+			if (!find_pict_files(input_path, resource_path, pict_files, pict_files_found))
+			{
+				return finish(false);
+			}
+			ScenarioValidator::check_references(cross_references, static_cast<int>(levels.size()), pict_files_found ? &pict_files : nullptr, problems);
+
+			std::stable_sort(problems.begin(), problems.end(), [](const ScenarioValidator::TerminalProblem& lhs, const ScenarioValidator::TerminalProblem& rhs)
+				{
+					return std::make_tuple(lhs.m_terminal_id.m_level_id, lhs.m_terminal_id.m_terminal_id, lhs.m_problem.m_branch, lhs.m_problem.m_screen)
+						< std::make_tuple(rhs.m_terminal_id.m_level_id, rhs.m_terminal_id.m_terminal_id, rhs.m_problem.m_branch, rhs.m_problem.m_screen);
+				}
+			);
+
+			QJsonArray issue_json_array;
+			std::array<int, Utils::to_integral(Diagnostics::Severity::SEVERITY_COUNT)> severity_counts = {};
+			auto add_issue = [this, &issue_json_array, &severity_counts](Diagnostics::Severity severity, const QString& rule, const QString& level_name, int terminal_index, Terminal::BranchType branch, int screen, const QString& message)
+				{
+					const QLatin1String severity_label(Diagnostics::get_severity_label(severity));
+
+					QJsonObject issue_json;
+					issue_json["severity"] = severity_label;
+					issue_json["rule"] = rule;
+					issue_json["level"] = level_name;
+					if (terminal_index >= 0)
+					{
+						issue_json["terminal"] = terminal_index;
+					}
+					if (branch != Terminal::BranchType::TYPE_COUNT)
+					{
+						issue_json["branch"] = QLatin1String(Terminal::get_branch_type_name(branch));
+					}
+					if (screen >= 0)
+					{
+						issue_json["screen"] = screen;
+					}
+					issue_json["message"] = message;
+					issue_json_array.append(issue_json);
+
+					++severity_counts[Utils::to_integral(severity)];
+
+					QString location_text;
+					if (terminal_index >= 0)
+					{
+						location_text = QStringLiteral("terminal %1").arg(terminal_index);
+						if (branch != Terminal::BranchType::TYPE_COUNT)
+						{
+							location_text += QStringLiteral(", %1").arg(QLatin1String(Terminal::get_branch_type_name(branch)));
+						}
+						if (screen >= 0)
+						{
+							location_text += QStringLiteral(" screen %1").arg(screen);
+						}
+						location_text = QStringLiteral(" (%1)").arg(location_text);
+					}
+					print(QStringLiteral("%1: %2%3: %4").arg(severity_label, level_name, location_text, message));
+				};
+
+			// Levels must be exported to unique files
+			std::unordered_map<QString, QString> level_script_paths;
+			auto problem_it = problems.cbegin();
+			for (int level_index = 0; level_index < static_cast<int>(levels.size()); ++level_index)
+			{
+				const Level& current_level = levels[level_index];
+				if (current_level.get_dir_name().isEmpty() || current_level.get_script_name().isEmpty())
+				{
+					add_issue(Diagnostics::Severity::ERROR, QStringLiteral("level-script"), current_level.get_name(), -1, Terminal::BranchType::TYPE_COUNT, -1, "Level folder or script name is empty");
+				}
+				else
+				{
+					const QString script_path = ScenarioManager::get_level_script_path(QString(), current_level).toLower();
+					auto emplace_result = level_script_paths.emplace(script_path, current_level.get_name());
+					if (!emplace_result.second)
+					{
+						add_issue(Diagnostics::Severity::ERROR, QStringLiteral("level-script"), current_level.get_name(), -1, Terminal::BranchType::TYPE_COUNT, -1, QStringLiteral("Level exports to the same script as \"%1\"").arg(emplace_result.first->second));
+					}
+				}
+
+				if (current_level.get_terminals().empty())
+				{
+					add_issue(Diagnostics::Severity::WARNING, QStringLiteral("empty-level"), current_level.get_name(), -1, Terminal::BranchType::TYPE_COUNT, -1, "Level has no terminals");
+				}
+
+				// Problems are sorted by level
+				for (; (problem_it != problems.cend()) && (problem_it->m_terminal_id.m_level_id == level_index); ++problem_it)
+				{
+					const ScenarioValidator::Problem& current_problem = problem_it->m_problem;
+					add_issue(current_problem.m_severity, QLatin1String(ScenarioValidator::get_rule_name(current_problem.m_rule)), current_level.get_name(), problem_it->m_terminal_id.m_terminal_id, current_problem.m_branch, current_problem.m_screen, current_problem.m_message);
+				}
+			}
+
+			const int error_count = severity_counts[Utils::to_integral(Diagnostics::Severity::ERROR)];
+			const int warning_count = severity_counts[Utils::to_integral(Diagnostics::Severity::WARNING)];
+			m_result["issues"] = issue_json_array;
+			m_result["error_count"] = error_count;
+			m_result["warning_count"] = warning_count;
+			m_result["info_count"] = severity_counts[Utils::to_integral(Diagnostics::Severity::INFO)];
+			m_result["terminal_count"] = static_cast<int>(terminals.size());
+			m_result["elapsed_ms"] = validation_timer.elapsed();
+
+			print(QStringLiteral("%1 error(s), %2 warning(s) in %3 terminal(s) (%4 ms)").arg(error_count).arg(warning_count).arg(terminals.size()).arg(validation_timer.elapsed()));
+			return finish(error_count == 0);
+		}
+
+		int run_generation(const QString& output_path, const ScenarioGenerator::Config& config)
+		{
+			m_result["output"] = output_path;
+			m_result["seed"] = static_cast<qint64>(config.m_seed);
+
+			QElapsedTimer generation_timer;
+			generation_timer.start();
+
+			const ScenarioGenerator generator(config);
+			const Scenario scenario = generator.generate_scenario();
+			m_result["generate_ms"] = generation_timer.elapsed();
+
+			// Split folders also need the images (and importing requires a Resources folder)
+			if (!is_scenario_file_path(output_path) && !generator.write_pict_resources(output_path, m_diagnostics))
+			{
+				return finish(false);
+			}
+
+			const bool success = write_output(output_path, scenario);
+			m_result["elapsed_ms"] = generation_timer.elapsed();
+
+			if (success)
+			{
+				const int terminal_count = config.m_level_count * config.m_terminals_per_level;
+				print(QStringLiteral("Generated \"%1\" (%2 levels, %3 terminals, %4 ms)").arg(output_path).arg(config.m_level_count).arg(terminal_count).arg(generation_timer.elapsed()));
+			}
+			return finish(success);
+		}
+
+		int run_memory_report(const QString& input_path, bool lazy, int depth)
+		{
+			m_result["input"] = input_path;
+
+			Scenario scenario;
+			if (!load_input(input_path, scenario, lazy))
+			{
+				return finish(false);
+			}
+
+			MemoryReport report;
+			report.add_scenario(scenario, QStringLiteral("Scenario \"%1\"").arg(scenario.get_name()));
+			m_scenario_manager.report_memory(report);
+
+			m_result["memory"] = report.to_json();
+			print(report.print(depth));
+			return finish(true);
+		}
+
+		int run_references(const QString& input_path, CrossReferenceIndex::ReferenceType type_filter, const int* id_filter, const QString& resource_path)
+		{
+			m_result["input"] = input_path;
+
+			Scenario scenario;
+			if (!load_input(input_path, scenario))
+			{
+				return finish(false);
+			}
+
+			// Levels are keyed by their index, and the terminals by row
+			CrossReferenceIndex cross_references;
+			const std::vector<Level>& levels = scenario.get_levels();
+			for (int level_index = 0; level_index < static_cast<int>(levels.size()); ++level_index)
+			{
+				cross_references.add_level(level_index, levels[level_index]);
+			}
+
+			QJsonObject references_json;
+			for (int type_index = 0; type_index < Utils::to_integral(CrossReferenceIndex::ReferenceType::TYPE_COUNT); ++type_index)
+			{
+				const CrossReferenceIndex::ReferenceType current_type = Utils::to_enum<CrossReferenceIndex::ReferenceType>(type_index);
+				if ((type_filter != CrossReferenceIndex::ReferenceType::TYPE_COUNT) && (current_type != type_filter))
+				{
+					continue;
+				}
+
+				QJsonArray id_json_array;
+				for (const int current_id : cross_references.get_ids(current_type))
+				{
+					if (id_filter && (current_id != *id_filter))
+					{
+						continue;
+					}
+
+					const std::vector<CrossReferenceIndex::Reference>& id_references = cross_references.get_references(current_type, current_id);
+					print(QStringLiteral("%1 %2: %3 use(s)").arg(QLatin1String(CrossReferenceIndex::get_reference_type_name(current_type))).arg(current_id).arg(id_references.size()));
+
+					QJsonArray use_json_array;
+					for (const CrossReferenceIndex::Reference& current_reference : id_references)
+					{
+						const QString& level_name = levels[current_reference.m_terminal_id.m_level_id].get_name();
+						const QLatin1String branch_name(Terminal::get_branch_type_name(current_reference.m_branch));
+
+						QJsonObject use_json;
+						use_json["level"] = level_name;
+						use_json["terminal"] = current_reference.m_terminal_id.m_terminal_id;
+						use_json["branch"] = branch_name;
+						if (current_reference.m_screen >= 0)
+						{
+							use_json["screen"] = current_reference.m_screen;
+						}
+						use_json_array.append(use_json);
+
+						// Only list the uses of the requested ID (the full list is in the JSON output)
+						if (id_filter)
+						{
+							const QString location_text = (current_reference.m_screen >= 0) ? QStringLiteral("%1 screen %2").arg(branch_name).arg(current_reference.m_screen) : QStringLiteral("%1 teleport").arg(branch_name);
+							print(QStringLiteral("  %1 (terminal %2): %3").arg(level_name).arg(current_reference.m_terminal_id.m_terminal_id).arg(location_text));
+						}
+					}
+
+					QJsonObject id_json;
+					id_json["id"] = current_id;
+					id_json["uses"] = use_json_array;
+					id_json_array.append(id_json);
+				}
+				references_json[REFERENCE_TYPE_OPTION_NAMES[type_index]] = id_json_array;
+			}
+			m_result["references"] = references_json;
+
+			// Compare the PICTs with the images
+			const bool check_picts = (type_filter == CrossReferenceIndex::ReferenceType::TYPE_COUNT) || (type_filter == CrossReferenceIndex::ReferenceType::PICT);
+			if (check_picts && !id_filter)
+			{
+				QMap<int, QString> pict_files;
+				bool pict_files_found = false;
+				if (!find_pict_files(input_path, resource_path, pict_files, pict_files_found))
+				{
+					return finish(false);
+				}
+
+				if (pict_files_found)
+				{
+					auto add_pict_list = [this](const char* key, const QString& label, const std::vector<int>& pict_ids)
+						{
+							QJsonArray pict_json_array;
+							QStringList pict_id_strings;
+							for (const int current_pict_id : pict_ids)
+							{
+								pict_json_array.append(current_pict_id);
+								pict_id_strings << QString::number(current_pict_id);
+							}
+							m_result[key] = pict_json_array;
+							print(QStringLiteral("%1: %2").arg(label, pict_ids.empty() ? QStringLiteral("none") : pict_id_strings.join(", ")));
+						};
+
+					add_pict_list("missing_picts", QStringLiteral("Missing PICTs"), cross_references.find_missing_picts(pict_files));
+					add_pict_list("unused_picts", QStringLiteral("Unused PICTs"), cross_references.find_unused_picts(pict_files));
+				}
+			}
+
+			return finish(true);
+		}
+
+		int run_stats(const QString& input_path)
+		{
+			m_result["input"] = input_path;
+
+			Scenario scenario;
+			if (!load_input(input_path, scenario))
+			{
+				return finish(false);
+			}
+
+			int terminal_count = 0;
+			int screen_count = 0;
+			qint64 script_length = 0;
+			std::array<int, Utils::to_integral(Terminal::ScreenType::TYPE_COUNT)> screen_type_counts = {};
+			for (const Level& current_level : scenario.get_levels())
+			{
+				terminal_count += static_cast<int>(current_level.get_terminals().size());
+				for (const Terminal& current_terminal : current_level.get_terminals())
+				{
+					for (const Terminal::Branch& current_branch : current_terminal.get_branches())
+					{
+						screen_count += static_cast<int>(current_branch.m_screens.size());
+						for (const Terminal::Screen& current_screen : current_branch.m_screens)
+						{
+							++screen_type_counts[Utils::to_integral(current_screen.m_type)];
+							script_length += current_screen.m_script.size();
+						}
+					}
+				}
+			}
+
+			QJsonObject screen_types_json;
+			for (int screen_type_index = 0; screen_type_index < Utils::to_integral(Terminal::ScreenType::TYPE_COUNT); ++screen_type_index)
+			{
+				screen_types_json[SCREEN_TYPE_NAMES[screen_type_index]] = screen_type_counts[screen_type_index];
+			}
+
+			m_result["name"] = scenario.get_name();
+			m_result["levels"] = static_cast<int>(scenario.get_levels().size());
+			m_result["terminals"] = terminal_count;
+			m_result["screens"] = screen_count;
+			m_result["screen_types"] = screen_types_json;
+			m_result["text_length"] = script_length;
+
+			print(QStringLiteral("Scenario: %1").arg(scenario.get_name()));
+			print(QStringLiteral("Levels: %1").arg(scenario.get_levels().size()));
+			print(QStringLiteral("Terminals: %1").arg(terminal_count));
+			print(QStringLiteral("Screens: %1").arg(screen_count));
+			for (int screen_type_index = 0; screen_type_index < Utils::to_integral(Terminal::ScreenType::TYPE_COUNT); ++screen_type_index)
+			{
+				print(QStringLiteral("  %1: %2").arg(SCREEN_TYPE_NAMES[screen_type_index]).arg(screen_type_counts[screen_type_index]));
+			}
+			print(QStringLiteral("Text length: %1 characters").arg(script_length));
+			return finish(true);
+		}
+	};
+
+	CommandLineTool::CommandLineTool()
+		: m_internal(std::make_unique<Internal>())
+	{
+	}
+
+	CommandLineTool::~CommandLineTool() = default;
+
+	int CommandLineTool::run(const QStringList& arguments)
+	{
+		QString command_description = "Commands:";
+		for (const char* current_description : COMMAND_DESCRIPTIONS)
+		{
+			command_description += QStringLiteral("\n  %1").arg(current_description);
+		}
+
+		QCommandLineParser parser;
+		parser.setApplicationDescription(QStringLiteral("Batch processing of Hux scenarios.\n\n%1").arg(command_description));
+		parser.addHelpOption();
+		parser.addPositionalArgument("command", "Command to run (see above).");
+		parser.addPositionalArgument("arguments", "Command arguments.", "[arguments...]");
+
+		const QCommandLineOption jobs_option(QStringList{ "j", "jobs" }, "Maximum number of worker threads (default: number of CPU cores).", "N");
+		const QCommandLineOption json_option("json", "Print the results as JSON.");
+		parser.addOption(jobs_option);
+		parser.addOption(json_option);
+		const QCommandLineOption trace_option("trace", "Record a performance trace of the command (Chrome trace format).", "file");
+		if (Trace::is_available())
+		{
+			parser.addOption(trace_option);
+		}
+
+		// Options for "generate"
+		const QCommandLineOption seed_option("seed", "Random seed (generate, default: 1).", "N");
+		const QCommandLineOption levels_option("levels", "Number of levels (generate, default: 20).", "N");
+		const QCommandLineOption terminals_option("terminals", "Terminals per level (generate, default: 8).", "N");
+		const QCommandLineOption screens_option("screens", "Screens per terminal (generate, default: 6).", "N");
+		const QCommandLineOption tag_density_option("tag-density", "Chance of a formatting tag before each word, 0-1 (generate, default: 0.25).", "ratio");
+		const QCommandLineOption pict_ratio_option("pict-ratio", "Share of screens with an image, 0-1 (generate, default: 0.25).", "ratio");
+		const QCommandLineOption line_length_option("line-length", "Line length range in characters (generate, default: 20:120).", "min:max");
+		const QCommandLineOption screen_lines_option("screen-lines", "Lines per screen range (generate, default: 4:20).", "min:max");
+		const QCommandLineOption teleports_option("teleports", "Teleport pattern: none, next, random, intralevel or mixed (generate, default: next).", "pattern");
+		parser.addOptions({ seed_option, levels_option, terminals_option, screens_option, tag_density_option, pict_ratio_option, line_length_option, screen_lines_option, teleports_option });
+
+		// Options for "memory"
+		const QCommandLineOption depth_option("depth", "Levels of detail to print: 0 = scenario, 1 = levels, 2 = terminals (memory, default: 1).", "N");
+		const QCommandLineOption lazy_option("lazy", "Load the scenario file lazily, like the editor does (memory).");
+		parser.addOptions({ depth_option, lazy_option });
+
+		// Options for "refs" (the resources are also used by "validate")
+		const QCommandLineOption type_option("type", "Only list one type: pict, checkpoint, tag, level-teleport or polygon-teleport (refs).", "type");
+		const QCommandLineOption id_option("id", "Only list one ID, including where it is used (refs).", "N");
+		const QCommandLineOption resources_option("resources", "Resources folder to check the PICTs against (refs & validate, default: \"Resources\" next to the input).", "folder");
+		parser.addOptions({ type_option, id_option, resources_option });
+
+		if (!parser.parse(arguments))
+		{
+			m_internal->m_error_stream << parser.errorText() << Qt::endl;
+			return EXIT_USAGE_CODE;
+		}
+
+		if (parser.isSet("help"))
+		{
+			m_internal->m_out_stream << parser.helpText();
+			return EXIT_SUCCESS_CODE;
+		}
+
+		m_internal->m_json_output = parser.isSet(json_option);
+
+		if (parser.isSet(jobs_option))
+		{
+			bool valid_job_count = false;
+			const int job_count = parser.value(jobs_option).toInt(&valid_job_count);
+			if (!valid_job_count || (job_count < 1))
+			{
+				m_internal->m_error_stream << "Invalid job count: " << parser.value(jobs_option) << Qt::endl;
+				return EXIT_USAGE_CODE;
+			}
+			QThreadPool::globalInstance()->setMaxThreadCount(job_count);
+		}
+
+		const QStringList positional_arguments = parser.positionalArguments();
+		const QString command_name = positional_arguments.value(0);
+		const auto command_it = std::find_if(std::begin(COMMAND_NAMES), std::end(COMMAND_NAMES), [&command_name](const char* name) { return command_name == QLatin1String(name); });
+		if (command_it == std::end(COMMAND_NAMES))
+		{
+			m_internal->m_error_stream << (command_name.isEmpty() ? QStringLiteral("No command given!") : QStringLiteral("Unknown command \"%1\"!").arg(command_name)) << Qt::endl;
+			m_internal->m_error_stream << command_description << Qt::endl;
+			return EXIT_USAGE_CODE;
+		}
+
+		if (Trace::is_available() && parser.isSet(trace_option))
+		{
+			m_internal->m_trace_file_path = parser.value(trace_option);
+			Trace::set_enabled(true);
+		}
+
+		const Command command = Utils::to_enum<Command>(std::distance(std::begin(COMMAND_NAMES), command_it));
+		const int expected_argument_count = ((command == Command::VALIDATE) || (command == Command::STATS) || (command == Command::GENERATE) || (command == Command::MEMORY) || (command == Command::REFS)) ? 1 : 2;
+		if ((positional_arguments.size() - 1) != expected_argument_count)
+		{
+			m_internal->m_error_stream << "Usage: huxcli " << COMMAND_DESCRIPTIONS[Utils::to_integral(command)] << Qt::endl;
+			return EXIT_USAGE_CODE;
+		}
+
+		m_internal->m_result["command"] = command_name;
+		const QString& input_path = positional_arguments.at(1);
+		switch (command)
+		{
+		case Command::IMPORT:
+			if (!QFileInfo(input_path).isDir())
+			{
+				return m_internal->finish(false, QStringLiteral("\"%1\" is not a split folder!").arg(input_path));
+			}
+			return m_internal->run_conversion(input_path, positional_arguments.at(2));
+		case Command::EXPORT:
+			if (QFileInfo(input_path).isDir())
+			{
+				return m_internal->finish(false, QStringLiteral("\"%1\" is not a scenario file!").arg(input_path));
+			}
+			if (is_scenario_file_path(positional_arguments.at(2)))
+			{
+				return m_internal->finish(false, "The export destination must be a split folder!");
+			}
+			return m_internal->run_conversion(input_path, positional_arguments.at(2));
+		case Command::CONVERT:
+			return m_internal->run_conversion(input_path, positional_arguments.at(2));
+		case Command::VALIDATE:
+			return m_internal->run_validation(input_path, parser.value(resources_option));
+		case Command::STATS:
+			return m_internal->run_stats(input_path);
+		case Command::MEMORY:
+		{
+			int depth = 1;
+			if (!parse_int_option(parser, depth_option, 0, depth))
+			{
+				m_internal->m_error_stream << "Invalid depth: " << parser.value(depth_option) << Qt::endl;
+				return EXIT_USAGE_CODE;
+			}
+			return m_internal->run_memory_report(input_path, parser.isSet(lazy_option), depth);
+		}
+		case Command::REFS:
+		{
+			CrossReferenceIndex::ReferenceType type_filter = CrossReferenceIndex::ReferenceType::TYPE_COUNT;
+			if (parser.isSet(type_option))
+			{
+				const QString type_name = parser.value(type_option);
+				const auto type_it = std::find_if(std::begin(REFERENCE_TYPE_OPTION_NAMES), std::end(REFERENCE_TYPE_OPTION_NAMES), [&type_name](const char* name) { return type_name == QLatin1String(name); });
+				if (type_it == std::end(REFERENCE_TYPE_OPTION_NAMES))
+				{
+					m_internal->m_error_stream << "Invalid reference type: " << type_name << Qt::endl;
+					return EXIT_USAGE_CODE;
+				}
+				type_filter = Utils::to_enum<CrossReferenceIndex::ReferenceType>(std::distance(std::begin(REFERENCE_TYPE_OPTION_NAMES), type_it));
+			}
+
+			int id = 0;
+			if (parser.isSet(id_option))
+			{
+				bool valid_id = false;
+				id = parser.value(id_option).toInt(&valid_id);
+				if (!valid_id)
+				{
+					m_internal->m_error_stream << "Invalid ID: " << parser.value(id_option) << Qt::endl;
+					return EXIT_USAGE_CODE;
+				}
+			}
+			return m_internal->run_references(input_path, type_filter, parser.isSet(id_option) ? &id : nullptr, parser.value(resources_option));
+		}
+		case Command::GENERATE:
+		{
+			ScenarioGenerator::Config generator_config;
+			int seed = static_cast<int>(generator_config.m_seed);
+			const bool valid_options = parse_int_option(parser, seed_option, 0, seed)
+				&& parse_int_option(parser, levels_option, 1, generator_config.m_level_count)
+				&& parse_int_option(parser, terminals_option, 0, generator_config.m_terminals_per_level)
+				&& parse_int_option(parser, screens_option, 0, generator_config.m_screens_per_terminal)
+				&& parse_ratio_option(parser, tag_density_option, generator_config.m_tag_density)
+				&& parse_ratio_option(parser, pict_ratio_option, generator_config.m_pict_ratio)
+				&& parse_range_option(parser, line_length_option, generator_config.m_min_line_length, generator_config.m_max_line_length)
+				&& parse_range_option(parser, screen_lines_option, generator_config.m_min_screen_lines, generator_config.m_max_screen_lines);
+			if (!valid_options)
+			{
+				m_internal->m_error_stream << "Invalid generator option!" << Qt::endl;
+				return EXIT_USAGE_CODE;
+			}
+			generator_config.m_seed = static_cast<quint32>(seed);
+
+			if (parser.isSet(teleports_option))
+			{
+				generator_config.m_teleport_pattern = ScenarioGenerator::get_teleport_pattern(parser.value(teleports_option));
+				if (generator_config.m_teleport_pattern == ScenarioGenerator::TeleportPattern::PATTERN_COUNT)
+				{
+					m_internal->m_error_stream << "Invalid teleport pattern: " << parser.value(teleports_option) << Qt::endl;
+					return EXIT_USAGE_CODE;
+				}
+			}
+			return m_internal->run_generation(positional_arguments.at(1), generator_config);
+		}
+		}
+
+		return EXIT_USAGE_CODE;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+#include <QStringList>
+
+#include <memory>
+
+namespace HuxApp
+{
+	// Headless front-end for batch processing scenarios (import, export, convert, etc.) without the GUI
+	class CommandLineTool
+	{
+	public:
+		CommandLineTool();
+		~CommandLineTool();
+
+		int run(const QStringList& arguments); // Returns the process exit code
+	private:
+		struct Internal;
+		std::unique_ptr<Internal> m_internal;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#include <HuxCLI/CommandLineTool.h>
+
+#include <QCoreApplication>
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication application(argc, argv);
+	QCoreApplication::setApplicationName("huxcli");
+
+	HuxApp::CommandLineTool tool;
+	return tool.run(application.arguments());
+}
\ No newline at end of file
@@ -9,7 +9,6 @@ namespace HuxApp
     {
         Internal(AppCore& core, HuxQt* main_window)
             : m_main_window(main_window)
-            , m_scenario_manager(core)
             , m_display_system(core)
         {}
 
@@ -0,0 +1,450 @@
+#include <HuxQt/Scenario/AOText.h>
+
+#include <HuxQt/Utils/Trace.h>
+
+#include <QRegularExpression>
+#include <QStringList>
+
+#include <algorithm>
+#include <cassert>
+
+namespace HuxApp
+{
+	namespace AOText
+	{
+		namespace
+		{
+			enum class TextFormattingTags
+			{
+				BOLD_START,
+				BOLD_END,
+				ITALICIZED_START,
+				ITALICIZED_END,
+				UNDERLINED_START,
+				UNDERLINED_END,
+				TEXT_COLOR,
+				TAG_COUNT
+			};
+
+			/*$Cn changes colors of text to color n, where n can be any number between 0 and 7.
+
+			$B  starts  bold  text.
+			$b  ends  bold  text.
+			$I  begins  italicized  text.
+			$i  ends  italics.
+			$U  starts  underlined  text.
+			$u  ends  underline*/
+
+			// Formatting tags in Aleph One 
+			constexpr const char* AO_FORMATTING_TAG_ARRAY[Utils::to_integral(TextFormattingTags::TAG_COUNT)] = {
+				"$B",
+				"$b",
+				"$I",
+				"$i",
+				"$U",
+				"$u",
+				"$C[0-7]"
+			};
+
+			// Regexp for finding color tags
+			const QRegularExpression AO_COLOR_REGEXP = QRegularExpression(R"(\$C(?<color>[0-7]))");
+			const QRegularExpression AO_LINE_SEP_REGEXP = QRegularExpression(R"([&*\+\-<=>\/^|])");
+
+			// HTML tags in Hux output
+			constexpr const char* HTML_TAG_ARRAY[Utils::to_integral(TextFormattingTags::TAG_COUNT)] = {
+				"<b>",
+				"</b>",
+				"<i>",
+				"</i>",
+				"<u>",
+				"</u>",
+				"<span style=\"color:%1\">"
+			};
+
+			// Regexp for finding color span tags in Hux output
+			const QRegularExpression HTML_COLOR_REGEXP = QRegularExpression("<span style=\"color:(?<color>\\w+)\">");
+
+			const QColor DEFAULT_QT_TEXT_COLORS_ARRAY[TEXT_COLOR_COUNT] = {
+				Qt::green,
+				Qt::white,
+				Qt::red,
+				Qt::darkGreen,
+				Qt::blue,
+				Qt::yellow,
+				Qt::darkRed,
+				Qt::darkBlue
+			};
+
+			constexpr const char* DEFAULT_HTML_COLORS_ARRAY[TEXT_COLOR_COUNT] = {
+				"Lime",
+				"White",
+				"Red",
+				"DarkGreen",
+				"LightBlue",
+				"Yellow",
+				"DarkRed",
+				"DarkBlue"
+			};
+
+			bool is_separator_character(QChar character)
+			{
+				const QRegularExpressionMatch match = AO_LINE_SEP_REGEXP.match(character);
+				return match.hasMatch();
+			}
+
+			QString get_tag_regex_string()
+			{
+				QStringList tag_regex_list;
+				for (int current_tag_index = 0; current_tag_index < Utils::to_integral(TextFormattingTags::TAG_COUNT); ++current_tag_index)
+				{
+					tag_regex_list << QStringLiteral("(\\%1)").arg(AO_FORMATTING_TAG_ARRAY[current_tag_index]);
+				}
+				return tag_regex_list.join('|');
+			}
+
+			const QRegularExpression& get_tag_regex()
+			{
+				// Create a RegEx that can match the AO formatting tags 
+				static QRegularExpression tag_regex(get_tag_regex_string());
+				return tag_regex;
+			}
+
+			void wrap_line(const QString& line, Terminal::ScreenType screen_type, QStringList& wrapped_lines)
+			{
+				const QRegularExpression& tag_regex = get_tag_regex();
+
+				// Use a struct to store the tag contents
+				struct FormattingTag
+				{
+					QString m_tag;
+					int m_offset = -1;
+				};
+
+				std::vector<FormattingTag> formatting_tags;
+
+				// Filter out the tags from the line
+				QString filtered_line = line;
+				QRegularExpressionMatch tag_match = tag_regex.match(filtered_line, 0, QRegularExpression::MatchType::PartialPreferFirstMatch);
+
+				while (tag_match.hasMatch())
+				{
+					// Found a tag, cache it and remove from processed string
+	                formatting_tags.emplace_back();
+	                FormattingTag& found_tag = formatting_tags.back();
+
+					const int last_captured_index = tag_match.lastCapturedIndex();
+					found_tag.m_offset = tag_match.capturedStart(last_captured_index); // Make sure the offset takes into account that tags will be re-added before this one
+					found_tag.m_tag = filtered_line.mid(found_tag.m_offset, tag_match.capturedLength(last_captured_index));
+					filtered_line.remove(found_tag.m_offset, tag_match.capturedLength(last_captured_index));
+
+					// Check if we have any more tags (starting from the offset we found, since we removed the tag itself)
+					tag_match = tag_regex.match(filtered_line, found_tag.m_offset, QRegularExpression::MatchType::PartialPreferFirstMatch);
+				}
+
+				// Traverse the filtered line and wrap based on line length
+				QStringList filtered_wrapped_lines;
+				{
+					int current_line_start = 0;
+					int current_line_end = 0;
+					const int character_limit = get_screen_character_limit(screen_type);
+					while (true)
+					{
+						if (current_line_end == filtered_line.length())
+						{
+							// Add whatever else was left and end the loop
+							filtered_wrapped_lines << filtered_line.mid(current_line_start);
+							break;
+						}
+
+						const int current_length = current_line_end - current_line_start;
+						if (current_length > character_limit)
+						{
+							// Reached limit, go back and see where we can wrap
+							int wrap_index = (current_line_end - 1);
+							for (; wrap_index > current_line_start; --wrap_index)
+							{
+								const QChar wrap_char = filtered_line[wrap_index];
+								if (wrap_char == ' ')
+								{
+									// Eat space
+									current_line_end = (wrap_index + 1);
+									break;
+								}
+								else if (is_separator_character(wrap_char))
+								{
+									// Found a separator, use as break point
+									current_line_end = wrap_index;
+									break;
+								}
+							}
+							assert(wrap_index >= 0);
+
+							// Add the line (if we didn't find a place to wrap, we'll simply wrap at the character limit)
+							filtered_wrapped_lines << filtered_line.mid(current_line_start, (current_line_end - current_line_start));
+							current_line_start = current_line_end;
+						}
+						else
+						{
+							++current_line_end;
+						}
+					}
+				}
+
+				if (!formatting_tags.empty())
+				{
+					// Iterate over our strings and re-insert the tags
+					int total_character_count = 0;
+					auto formatting_tag_it = formatting_tags.begin();
+
+					for (const QString& current_wrapped_line : filtered_wrapped_lines)
+					{
+						if (formatting_tag_it != formatting_tags.end())
+						{
+							QString finalized_wrapped_line;
+							int current_char_offset = 0;
+							while (current_char_offset < current_wrapped_line.length())
+							{
+								if (total_character_count == formatting_tag_it->m_offset)
+								{
+									finalized_wrapped_line += formatting_tag_it->m_tag;
+									++formatting_tag_it;
+									if (formatting_tag_it == formatting_tags.end())
+									{
+										// Finished adding all tags, just add the rest of the string
+										finalized_wrapped_line += current_wrapped_line.mid(current_char_offset);
+										break;
+									}
+									// Go again (may return in case multiple tags were at the same offset)
+									continue;
+								}
+								// Add the current character and update the offsets
+								finalized_wrapped_line += current_wrapped_line[current_char_offset];
+								++total_character_count;
+								++current_char_offset;
+							}
+							wrapped_lines << finalized_wrapped_line;
+						}
+						else
+						{
+							// No more tags, just add the rest of the lines
+							wrapped_lines << current_wrapped_line;
+						}
+					}
+
+					// If any tags were left, we add them to the end of the last line
+					if (formatting_tag_it != formatting_tags.end())
+					{
+						if (wrapped_lines.isEmpty())
+						{
+							// Add an empty string, just in case this is a completely empty line with just formatting tags in it
+							wrapped_lines << QString();
+						}
+						for (formatting_tag_it; formatting_tag_it != formatting_tags.end(); ++formatting_tag_it)
+						{
+							wrapped_lines.back() += formatting_tag_it->m_tag;
+						}
+					}
+				}
+				else
+				{
+					// No tags to process, add lines verbatim
+					wrapped_lines << filtered_wrapped_lines;
+				}
+			}
+		}
+
+		TextColorArray get_default_text_colors()
+		{
+			TextColorArray default_text_colors;
+			int current_color_index = 0;
+			for (QColor& current_color : default_text_colors)
+			{
+				current_color = DEFAULT_QT_TEXT_COLORS_ARRAY[current_color_index];
+				++current_color_index;
+			}
+			return default_text_colors;
+		}
+
+		int get_screen_character_limit(Terminal::ScreenType screen_type)
+		{
+			switch (screen_type)
+			{
+			case Terminal::ScreenType::INFORMATION:
+				return 70;
+			case Terminal::ScreenType::PICT:
+			case Terminal::ScreenType::CHECKPOINT:
+				return 43;
+			}
+
+			return -1;
+		}
+
+		QString wrap_text(const QString& ao_text, Terminal::ScreenType screen_type)
+		{
+			if (ao_text.isEmpty())
+			{
+				return QString();
+			}
+			else if ((screen_type != Terminal::ScreenType::INFORMATION)
+				&& (screen_type != Terminal::ScreenType::PICT)
+				&& (screen_type != Terminal::ScreenType::CHECKPOINT))
+			{
+				// Only perform wrapping for screen types where it's relevant
+				return ao_text;
+			}
+
+			// First split the line along line breaks
+			const QStringList lines = ao_text.split('\n');
+			QStringList wrapped_lines;
+
+			for (const QString& current_line : lines)
+			{
+				if (!current_line.isEmpty())
+				{
+					wrap_line(current_line, screen_type, wrapped_lines);
+				}
+				else
+				{
+					// Empty line, add it so we don't miss any line breaks
+					wrapped_lines << current_line;
+				}
+			}
+
+			return wrapped_lines.join('\n');
+		}
+
+		int get_line_count(const QString& ao_text, Terminal::ScreenType screen_type)
+		{
+			if (ao_text.isEmpty())
+			{
+				return 0;
+			}
+			return wrap_text(ao_text, screen_type).count('\n') + 1;
+		}
+
+		std::vector<UnmatchedTag> find_unmatched_tags(const QString& ao_text)
+		{
+			// Start and end characters of the style tags (the styles are independent, so they can overlap)
+			constexpr std::array<std::pair<char, char>, 3> STYLE_TAGS = { {
+				{ 'B', 'b' },
+				{ 'I', 'i' },
+				{ 'U', 'u' }
+			} };
+
+			std::array<int, STYLE_TAGS.size()> open_tag_lines;
+			open_tag_lines.fill(-1);
+
+			std::vector<UnmatchedTag> unmatched_tags;
+			int current_line = 0;
+			for (int char_index = 0; char_index < ao_text.length(); ++char_index)
+			{
+				const QChar current_char = ao_text[char_index];
+				if (current_char == '\n')
+				{
+					++current_line;
+					continue;
+				}
+				else if ((current_char != '$') || ((char_index + 1) == ao_text.length()))
+				{
+					continue;
+				}
+
+				const QChar tag_char = ao_text[char_index + 1];
+				for (size_t style_index = 0; style_index < STYLE_TAGS.size(); ++style_index)
+				{
+					if (tag_char == QLatin1Char(STYLE_TAGS[style_index].first))
+					{
+						// Starting a style again is harmless, only the first start is kept
+						if (open_tag_lines[style_index] < 0)
+						{
+							open_tag_lines[style_index] = current_line;
+						}
+						++char_index;
+						break;
+					}
+					else if (tag_char == QLatin1Char(STYLE_TAGS[style_index].second))
+					{
+						if (open_tag_lines[style_index] < 0)
+						{
+							unmatched_tags.push_back(UnmatchedTag{ QStringLiteral("$%1").arg(tag_char), current_line, true });
+						}
+						open_tag_lines[style_index] = -1;
+						++char_index;
+						break;
+					}
+				}
+			}
+
+			for (size_t style_index = 0; style_index < STYLE_TAGS.size(); ++style_index)
+			{
+				if (open_tag_lines[style_index] >= 0)
+				{
+					unmatched_tags.push_back(UnmatchedTag{ QStringLiteral("$%1").arg(QLatin1Char(STYLE_TAGS[style_index].first)), open_tag_lines[style_index], false });
+				}
+			}
+
+			std::stable_sort(unmatched_tags.begin(), unmatched_tags.end(), [](const UnmatchedTag& lhs, const UnmatchedTag& rhs) { return lhs.m_line < rhs.m_line; });
+			return unmatched_tags;
+		}
+
+		QString convert_to_html(const QString& ao_text, Terminal::ScreenType screen_type, const TextColorArray& text_colors)
+		{
+			HUX_TRACE_SCOPE("text", "convert_ao_to_html");
+			// Wrap the text (so it matches the AO line wrapping)
+			const QString wrapped_text = wrap_text(ao_text, screen_type);
+
+			// Parse the Aleph One formatting tags, turning them into HTML tags that Qt can display
+			QString parsed_text = wrapped_text.toHtmlEscaped(); // First make sure we have no unintended HTML tags
+			bool color_changed = false;
+
+			// Iterate through each possible tag, converting each match
+			for (int current_tag_index = 0; current_tag_index < Utils::to_integral(TextFormattingTags::TAG_COUNT); ++current_tag_index)
+			{
+				switch (static_cast<TextFormattingTags>(current_tag_index))
+				{
+				case TextFormattingTags::TEXT_COLOR:
+				{
+					// Color change is a special case, as we need to extract the color index
+					QRegularExpressionMatch color_match = AO_COLOR_REGEXP.match(parsed_text);
+					while (color_match.hasMatch())
+					{
+						// Found a match
+						QString color_tag;
+						if (color_changed)
+						{
+							// Add an end tag so we drop the previous color
+							color_tag = QStringLiteral("</span>");
+						}
+
+						// Get the color index and generate the corresponding HTML tag
+						const int new_color_index = color_match.captured("color").toInt();
+						color_tag += QString(HTML_TAG_ARRAY[Utils::to_integral(TextFormattingTags::TEXT_COLOR)]).arg(text_colors[new_color_index].name());
+						color_changed = true;
+
+						// Replace the tag and find the next match (if any)
+						parsed_text.replace(color_match.capturedStart(), color_match.capturedLength(), color_tag);
+						color_match = AO_COLOR_REGEXP.match(parsed_text);
+					}
+				}
+				default:
+				{
+					// Simply replace the tags with the corresponding HTML tags
+					parsed_text.replace(AO_FORMATTING_TAG_ARRAY[current_tag_index], HTML_TAG_ARRAY[current_tag_index]);
+				}
+				}
+			}
+
+			// Tabs in AO are a single space, so replace them
+			parsed_text.replace('\t', ' ');
+
+			// If the color was changed at some point, we need to close off the last span tag
+			if (color_changed)
+			{
+				parsed_text += QStringLiteral("</span>");
+			}
+			// Wrap the text in paragraph tags
+			parsed_text = QStringLiteral("<p style=\"white-space: pre-wrap\">%1</p>").arg(parsed_text);
+			return parsed_text;
+		}
+	}
+}
\ No newline at end of file
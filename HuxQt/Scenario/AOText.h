@@ -0,0 +1,42 @@
+#pragma once
+#include <HuxQt/Scenario/Terminal.h>
+
+#include <QColor>
+#include <QString>
+
+#include <array>
+#include <vector>
+
+namespace HuxApp
+{
+	// Aleph One terminal text processing (no dependency on the UI, all functions are thread-safe)
+	namespace AOText
+	{
+		constexpr int TEXT_COLOR_COUNT = 8;
+		constexpr int SCREEN_MAX_LINES = 22; // Lines on one page of a screen (value taken from the game)
+		using TextColorArray = std::array<QColor, TEXT_COLOR_COUNT>;
+
+		TextColorArray get_default_text_colors();
+
+		int get_screen_character_limit(Terminal::ScreenType screen_type);
+
+		// Wraps the lines to the screen width, approximating the engine's line breaking (formatting tags are kept)
+		QString wrap_text(const QString& ao_text, Terminal::ScreenType screen_type);
+
+		// Number of lines the text takes up once wrapped (0 if there is no text)
+		int get_line_count(const QString& ao_text, Terminal::ScreenType screen_type);
+
+		struct UnmatchedTag
+		{
+			QString m_tag; // Tag that has no pair (e.g "$B")
+			int m_line = 0; // Line of the tag in the script (starting from 0)
+			bool m_closing = false; // End tag without a start tag (otherwise the start tag is never closed)
+		};
+
+		// Style tags ($B/$b, $I/$i and $U/$u) which are closed without being started, or left open at the end of the text
+		std::vector<UnmatchedTag> find_unmatched_tags(const QString& ao_text);
+
+		// Converts the AO formatting tags to HTML that can be displayed by Qt
+		QString convert_to_html(const QString& ao_text, Terminal::ScreenType screen_type, const TextColorArray& text_colors);
+	}
+}
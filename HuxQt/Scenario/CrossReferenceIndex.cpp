@@ -0,0 +1,282 @@
+#include <HuxQt/Scenario/CrossReferenceIndex.h>
+
+#include <HuxQt/Scenario/Level.h>
+#include <HuxQt/Scenario/MemoryReport.h>
+
+#include <algorithm>
+
+namespace HuxApp
+{
+	namespace
+	{
+		constexpr const char* REFERENCE_TYPE_NAMES[Utils::to_integral(CrossReferenceIndex::ReferenceType::TYPE_COUNT)] = {
+			"PICT",
+			"Checkpoint",
+			"Tag",
+			"Level teleport",
+			"Polygon teleport"
+		};
+	}
+
+	void CrossReferenceIndex::add_terminal(const TerminalID& terminal_id, const Terminal& terminal)
+	{
+		remove_terminal(terminal_id);
+
+		std::vector<Key> terminal_keys;
+		auto add_reference = [this, &terminal_id, &terminal_keys](ReferenceType type, int id, Terminal::BranchType branch, int screen)
+			{
+				m_references[Utils::to_integral(type)][id].push_back(Reference{ terminal_id, branch, screen });
+				terminal_keys.push_back(Key{ type, id });
+			};
+
+		for (int branch_index = 0; branch_index < Utils::to_integral(Terminal::BranchType::TYPE_COUNT); ++branch_index)
+		{
+			const Terminal::BranchType branch_type = Utils::to_enum<Terminal::BranchType>(branch_index);
+			const Terminal::Branch& current_branch = terminal.get_branch(branch_type);
+
+			int screen_index = 0;
+			for (const Terminal::Screen& current_screen : current_branch.m_screens)
+			{
+				const ReferenceType reference_type = get_screen_reference_type(current_screen.m_type);
+				if (reference_type != ReferenceType::TYPE_COUNT)
+				{
+					add_reference(reference_type, current_screen.m_resource_id, branch_type, screen_index);
+				}
+				++screen_index;
+			}
+
+			switch (current_branch.m_teleport.m_type)
+			{
+			case Terminal::TeleportType::INTERLEVEL:
+				add_reference(ReferenceType::LEVEL_TELEPORT, current_branch.m_teleport.m_index, branch_type, -1);
+				break;
+			case Terminal::TeleportType::INTRALEVEL:
+				add_reference(ReferenceType::POLYGON_TELEPORT, current_branch.m_teleport.m_index, branch_type, -1);
+				break;
+			}
+		}
+
+		if (!terminal_keys.empty())
+		{
+			// Same ID can be referenced by multiple screens, removal only needs to visit it once
+			std::sort(terminal_keys.begin(), terminal_keys.end());
+			terminal_keys.erase(std::unique(terminal_keys.begin(), terminal_keys.end()), terminal_keys.end());
+			m_terminal_keys[terminal_id.m_level_id][terminal_id.m_terminal_id] = std::move(terminal_keys);
+		}
+	}
+
+	void CrossReferenceIndex::remove_terminal(const TerminalID& terminal_id)
+	{
+		auto level_it = m_terminal_keys.find(terminal_id.m_level_id);
+		if (level_it == m_terminal_keys.end())
+		{
+			return;
+		}
+
+		auto terminal_it = level_it->second.find(terminal_id.m_terminal_id);
+		if (terminal_it != level_it->second.end())
+		{
+			remove_references(terminal_id, terminal_it->second);
+			level_it->second.erase(terminal_it);
+		}
+	}
+
+	void CrossReferenceIndex::add_level(int level_id, const Level& level)
+	{
+		// Levels without references are still tracked, so their IDs can be set later
+		m_terminal_keys.try_emplace(level_id);
+
+		int terminal_row = 0;
+		for (const Terminal& current_terminal : level.get_terminals())
+		{
+			add_terminal(TerminalID{ level_id, terminal_row }, current_terminal);
+			++terminal_row;
+		}
+	}
+
+	bool CrossReferenceIndex::set_terminal_ids(int level_id, const std::vector<int>& terminal_ids)
+	{
+		auto level_it = m_terminal_keys.find(level_id);
+		if (level_it == m_terminal_keys.end())
+		{
+			return false;
+		}
+
+		// Drop the rows which no longer exist first (the references are still keyed by row at this point)
+		std::unordered_map<int, std::vector<Key>> level_terminals;
+		level_terminals.reserve(level_it->second.size());
+		std::vector<Key> level_keys;
+		for (auto& [current_row, current_keys] : level_it->second)
+		{
+			if ((current_row < 0) || (current_row >= static_cast<int>(terminal_ids.size())))
+			{
+				remove_references(TerminalID{ level_id, current_row }, current_keys);
+				continue;
+			}
+
+			level_keys.insert(level_keys.end(), current_keys.begin(), current_keys.end());
+			level_terminals[terminal_ids[current_row]] = std::move(current_keys);
+		}
+		level_it->second = std::move(level_terminals);
+
+		// Visit each reference once, so the rows and IDs cannot be mixed up
+		std::sort(level_keys.begin(), level_keys.end());
+		level_keys.erase(std::unique(level_keys.begin(), level_keys.end()), level_keys.end());
+		for (const Key& current_key : level_keys)
+		{
+			for (Reference& current_reference : m_references[Utils::to_integral(current_key.m_type)][current_key.m_id])
+			{
+				if (current_reference.m_terminal_id.m_level_id == level_id)
+				{
+					current_reference.m_terminal_id.m_terminal_id = terminal_ids[current_reference.m_terminal_id.m_terminal_id];
+				}
+			}
+		}
+		return true;
+	}
+
+	void CrossReferenceIndex::remove_level(int level_id)
+	{
+		auto level_it = m_terminal_keys.find(level_id);
+		if (level_it == m_terminal_keys.end())
+		{
+			return;
+		}
+
+		for (const auto& [current_terminal_id, current_keys] : level_it->second)
+		{
+			remove_references(TerminalID{ level_id, current_terminal_id }, current_keys);
+		}
+		m_terminal_keys.erase(level_it);
+	}
+
+	void CrossReferenceIndex::clear()
+	{
+		for (auto& current_references : m_references)
+		{
+			current_references.clear();
+		}
+		m_terminal_keys.clear();
+	}
+
+	const std::vector<CrossReferenceIndex::Reference>& CrossReferenceIndex::get_references(ReferenceType type, int id) const
+	{
+		static const std::vector<Reference> empty_references;
+
+		const std::map<int, std::vector<Reference>>& type_references = m_references[Utils::to_integral(type)];
+		auto reference_it = type_references.find(id);
+		return (reference_it != type_references.end()) ? reference_it->second : empty_references;
+	}
+
+	std::vector<int> CrossReferenceIndex::get_ids(ReferenceType type) const
+	{
+		const std::map<int, std::vector<Reference>>& type_references = m_references[Utils::to_integral(type)];
+
+		std::vector<int> ids;
+		ids.reserve(type_references.size());
+		for (const auto& [current_id, current_references] : type_references)
+		{
+			ids.push_back(current_id);
+		}
+		return ids;
+	}
+
+	std::vector<int> CrossReferenceIndex::find_missing_picts(const QMap<int, QString>& pict_files) const
+	{
+		std::vector<int> missing_picts;
+		for (const auto& [current_id, current_references] : m_references[Utils::to_integral(ReferenceType::PICT)])
+		{
+			if (!pict_files.contains(current_id))
+			{
+				missing_picts.push_back(current_id);
+			}
+		}
+		return missing_picts;
+	}
+
+	std::vector<int> CrossReferenceIndex::find_unused_picts(const QMap<int, QString>& pict_files) const
+	{
+		const std::map<int, std::vector<Reference>>& pict_references = m_references[Utils::to_integral(ReferenceType::PICT)];
+
+		std::vector<int> unused_picts;
+		for (auto pict_it = pict_files.keyBegin(); pict_it != pict_files.keyEnd(); ++pict_it)
+		{
+			if (pict_references.find(*pict_it) == pict_references.end())
+			{
+				unused_picts.push_back(*pict_it);
+			}
+		}
+		return unused_picts;
+	}
+
+	int CrossReferenceIndex::report_memory(MemoryReport& report, int parent) const
+	{
+		const int index_entry = report.add_entry(QStringLiteral("Cross-reference index"), parent);
+		report.add_bytes(index_entry, MemoryReport::Category::STRUCTURE, sizeof(CrossReferenceIndex));
+
+		// Tree nodes (the value and three pointers plus the color) and the reference lists
+		const qint64 node_size = sizeof(std::pair<const int, std::vector<Reference>>) + (4 * sizeof(void*));
+		for (const auto& current_references : m_references)
+		{
+			report.add_bytes(index_entry, MemoryReport::Category::CACHE, static_cast<qint64>(current_references.size()) * node_size);
+			for (const auto& [current_id, current_id_references] : current_references)
+			{
+				report.add_bytes(index_entry, MemoryReport::Category::CACHE, static_cast<qint64>(current_id_references.capacity() * sizeof(Reference)));
+			}
+		}
+
+		for (const auto& [current_level_id, current_level_terminals] : m_terminal_keys)
+		{
+			report.add_hash_map(index_entry, current_level_terminals);
+			for (const auto& [current_terminal_id, current_keys] : current_level_terminals)
+			{
+				report.add_vector(index_entry, current_keys);
+			}
+		}
+		report.add_hash_map(index_entry, m_terminal_keys);
+		return index_entry;
+	}
+
+	const char* CrossReferenceIndex::get_reference_type_name(ReferenceType type)
+	{
+		return REFERENCE_TYPE_NAMES[Utils::to_integral(type)];
+	}
+
+	CrossReferenceIndex::ReferenceType CrossReferenceIndex::get_screen_reference_type(Terminal::ScreenType screen_type)
+	{
+		switch (screen_type)
+		{
+		case Terminal::ScreenType::LOGON:
+		case Terminal::ScreenType::PICT:
+		case Terminal::ScreenType::LOGOFF:
+			return ReferenceType::PICT;
+		case Terminal::ScreenType::CHECKPOINT:
+			return ReferenceType::CHECKPOINT;
+		case Terminal::ScreenType::TAG:
+			return ReferenceType::TAG;
+		}
+
+		// Static screens store a duration
+		return ReferenceType::TYPE_COUNT;
+	}
+
+	void CrossReferenceIndex::remove_references(const TerminalID& terminal_id, const std::vector<Key>& keys)
+	{
+		for (const Key& current_key : keys)
+		{
+			std::map<int, std::vector<Reference>>& type_references = m_references[Utils::to_integral(current_key.m_type)];
+			auto reference_it = type_references.find(current_key.m_id);
+			if (reference_it == type_references.end())
+			{
+				continue;
+			}
+
+			std::vector<Reference>& id_references = reference_it->second;
+			id_references.erase(std::remove_if(id_references.begin(), id_references.end(), [&terminal_id](const Reference& reference) { return reference.m_terminal_id == terminal_id; }), id_references.end());
+			if (id_references.empty())
+			{
+				type_references.erase(reference_it);
+			}
+		}
+	}
+}
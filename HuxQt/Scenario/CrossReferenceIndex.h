@@ -0,0 +1,73 @@
+#pragma once
+#include <HuxQt/Scenario/Terminal.h>
+
+#include <QMap>
+
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace HuxApp
+{
+	class Level;
+	class MemoryReport;
+
+	// Reverse lookup of the IDs the terminals refer to (images, checkpoints, tags and teleport targets), which can be updated one terminal at a time
+	// Uses the same keys as the search index: terminals of levels which have no terminal IDs yet are keyed by row
+	class CrossReferenceIndex
+	{
+	public:
+		enum class ReferenceType
+		{
+			PICT, // PICT, LOGON and LOGOFF screens
+			CHECKPOINT,
+			TAG,
+			LEVEL_TELEPORT, // Interlevel teleports (by level index)
+			POLYGON_TELEPORT, // Intralevel teleports (by polygon index, so the same ID can refer to a different polygon in each level)
+			TYPE_COUNT
+		};
+
+		struct Reference
+		{
+			TerminalID m_terminal_id;
+			Terminal::BranchType m_branch = Terminal::BranchType::TYPE_COUNT;
+			int m_screen = -1; // Not set for teleports
+		};
+
+		void add_terminal(const TerminalID& terminal_id, const Terminal& terminal); // Replaces the terminal if it was already indexed
+		void remove_terminal(const TerminalID& terminal_id);
+
+		void add_level(int level_id, const Level& level); // Terminal IDs are the rows (same as in the search index)
+		bool set_terminal_ids(int level_id, const std::vector<int>& terminal_ids); // Returns false if the level is not indexed
+		void remove_level(int level_id);
+
+		void clear();
+
+		const std::vector<Reference>& get_references(ReferenceType type, int id) const;
+		std::vector<int> get_ids(ReferenceType type) const; // Referenced IDs in ascending order
+
+		// Compares the referenced PICTs with the image files (ID -> path, e.g the display system cache)
+		std::vector<int> find_missing_picts(const QMap<int, QString>& pict_files) const;
+		std::vector<int> find_unused_picts(const QMap<int, QString>& pict_files) const;
+
+		int report_memory(MemoryReport& report, int parent = -1) const; // Returns the report entry
+
+		static const char* get_reference_type_name(ReferenceType type);
+		static ReferenceType get_screen_reference_type(Terminal::ScreenType screen_type); // Returns TYPE_COUNT if the screen does not refer to anything
+	private:
+		struct Key
+		{
+			ReferenceType m_type = ReferenceType::TYPE_COUNT;
+			int m_id = -1;
+
+			bool operator==(const Key& rhs) const { return (m_type == rhs.m_type) && (m_id == rhs.m_id); }
+			bool operator<(const Key& rhs) const { return (m_type != rhs.m_type) ? (m_type < rhs.m_type) : (m_id < rhs.m_id); }
+		};
+
+		void remove_references(const TerminalID& terminal_id, const std::vector<Key>& keys);
+
+		std::array<std::map<int, std::vector<Reference>>, Utils::to_integral(ReferenceType::TYPE_COUNT)> m_references; // Ordered by ID
+		std::unordered_map<int, std::unordered_map<int, std::vector<Key>>> m_terminal_keys; // Level ID -> terminal ID -> referenced IDs (needed for removal)
+	};
+}
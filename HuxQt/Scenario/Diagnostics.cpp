@@ -0,0 +1,66 @@
+#include <HuxQt/Scenario/Diagnostics.h>
+
+#include <HuxQt/Utils/Utilities.h>
+
+#include <QStringList>
+
+#include <algorithm>
+
+namespace HuxApp
+{
+	namespace
+	{
+		constexpr const char* SEVERITY_LABEL_ARRAY[Utils::to_integral(Diagnostics::Severity::SEVERITY_COUNT)] = {
+			"info",
+			"warning",
+			"error"
+		};
+	}
+
+	QString Diagnostics::Entry::print() const
+	{
+		QString entry_text;
+		if (!m_file_path.isEmpty())
+		{
+			// Same location format as compilers use, so IDEs and CI logs can link to it
+			entry_text = (m_line >= 0) ? QStringLiteral("%1:%2: ").arg(m_file_path).arg(m_line) : QStringLiteral("%1: ").arg(m_file_path);
+		}
+
+		entry_text += QStringLiteral("%1: %2").arg(QLatin1String(get_severity_label(m_severity)), m_message);
+		return entry_text;
+	}
+
+	void Diagnostics::add_entry(Severity severity, const QString& message, const QString& file_path, int line)
+	{
+		Entry& new_entry = m_entries.emplace_back();
+		new_entry.m_severity = severity;
+		new_entry.m_message = message;
+		new_entry.m_file_path = file_path;
+		new_entry.m_line = line;
+	}
+
+	void Diagnostics::append(const Diagnostics& other)
+	{
+		m_entries.insert(m_entries.end(), other.m_entries.begin(), other.m_entries.end());
+	}
+
+	int Diagnostics::get_count(Severity severity) const
+	{
+		return static_cast<int>(std::count_if(m_entries.begin(), m_entries.end(), [severity](const Entry& entry) { return entry.m_severity == severity; }));
+	}
+
+	const char* Diagnostics::get_severity_label(Severity severity)
+	{
+		return SEVERITY_LABEL_ARRAY[Utils::to_integral(severity)];
+	}
+
+	QString Diagnostics::print() const
+	{
+		QStringList entry_lines;
+		for (const Entry& current_entry : m_entries)
+		{
+			entry_lines << current_entry.print();
+		}
+		return entry_lines.join('\n');
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <QString>
+
+#include <vector>
+
+namespace HuxApp
+{
+	// Collects the errors and warnings of a scenario operation, so the caller can decide how to present them (dialog, console, etc.)
+	class Diagnostics
+	{
+	public:
+		enum class Severity
+		{
+			INFO,
+			WARNING,
+			ERROR,
+			SEVERITY_COUNT
+		};
+
+		struct Entry
+		{
+			Severity m_severity = Severity::ERROR;
+			QString m_message;
+
+			// Where the problem was found (optional)
+			QString m_file_path;
+			int m_line = -1;
+
+			QString print() const;
+		};
+
+		void add_entry(Severity severity, const QString& message, const QString& file_path = QString(), int line = -1);
+		void add_info(const QString& message, const QString& file_path = QString(), int line = -1) { add_entry(Severity::INFO, message, file_path, line); }
+		void add_warning(const QString& message, const QString& file_path = QString(), int line = -1) { add_entry(Severity::WARNING, message, file_path, line); }
+		void add_error(const QString& message, const QString& file_path = QString(), int line = -1) { add_entry(Severity::ERROR, message, file_path, line); }
+
+		void append(const Diagnostics& other);
+		void clear() { m_entries.clear(); }
+
+		const std::vector<Entry>& get_entries() const { return m_entries; }
+		bool is_empty() const { return m_entries.empty(); }
+
+		int get_count(Severity severity) const;
+		bool has_errors() const { return get_count(Severity::ERROR) > 0; }
+		bool has_warnings() const { return get_count(Severity::WARNING) > 0; }
+
+		static const char* get_severity_label(Severity severity);
+
+		QString print() const; // One line per entry
+	private:
+		std::vector<Entry> m_entries;
+	};
+}
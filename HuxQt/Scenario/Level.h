@@ -3,6 +3,23 @@
 
 namespace HuxApp
 {
+	// Location of a level's serialized contents within a scenario file (used to defer deserializing the terminals until they are needed)
+	struct LevelSource
+	{
+		QByteArray m_file_data; // Implicitly shared between all the levels loaded from the same file
+		qsizetype m_offset = 0;
+		qsizetype m_length = 0;
+		int m_terminal_count = 0;
+
+		// Level attributes at the time the file was saved
+		QString m_name;
+		QString m_dir_name;
+		QString m_script_name;
+
+		bool is_valid() const { return (m_length > 0); }
+		QByteArray get_data() const { return m_file_data.mid(m_offset, m_length); }
+	};
+
 	class Level
 	{
 	public:
@@ -21,7 +38,14 @@ namespace HuxApp
 		const Terminal& get_terminal(int index) const { return m_terminals[index]; }
 		const std::vector<Terminal>& get_terminals() const { return m_terminals; }
 
-		void set_terminals(const std::vector<Terminal>& terminals) { m_terminals = terminals; }
+		void set_terminals(std::vector<Terminal> terminals) { m_terminals = std::move(terminals); m_source = LevelSource(); }
+
+		// Lazily loaded levels only have their attributes until ScenarioManager::load_level is called
+		bool is_loaded() const { return !m_source.is_valid(); }
+		const LevelSource& get_source() const { return m_source; }
+		void set_source(const LevelSource& source) { m_source = source; m_terminals.clear(); }
+
+		int get_terminal_count() const { return is_loaded() ? static_cast<int>(m_terminals.size()) : m_source.m_terminal_count; }
 	private:
 		QString m_name;
 		QString m_dir_name;
@@ -30,6 +54,9 @@ namespace HuxApp
 		std::vector<Terminal> m_terminals;
 		QString m_comments;
 
+		LevelSource m_source;
+
 		friend class ScenarioManager;
+		friend class MemoryReport;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,296 @@
+#include <HuxQt/Scenario/MemoryReport.h>
+
+#include <HuxQt/Scenario/Scenario.h>
+
+#include <QJsonArray>
+#include <QStringList>
+
+namespace HuxApp
+{
+	namespace
+	{
+		constexpr const char* CATEGORY_LABELS[Utils::to_integral(MemoryReport::Category::CATEGORY_COUNT)] = {
+			"structure",
+			"script",
+			"display_text",
+			"comments",
+			"names",
+			"source_data",
+			"cache",
+			"model"
+		};
+
+		// Header in front of the contents of QString and QByteArray allocations
+		constexpr qint64 ARRAY_DATA_HEADER_SIZE = sizeof(QArrayData);
+
+		QJsonObject get_category_json(const MemoryReport::CategoryArray& category_bytes)
+		{
+			QJsonObject category_json;
+			for (int category_index = 0; category_index < Utils::to_integral(MemoryReport::Category::CATEGORY_COUNT); ++category_index)
+			{
+				if (category_bytes[category_index] > 0)
+				{
+					category_json[QLatin1String(CATEGORY_LABELS[category_index])] = category_bytes[category_index];
+				}
+			}
+			return category_json;
+		}
+	}
+
+	qint64 MemoryReport::Entry::get_total() const
+	{
+		qint64 total = 0;
+		for (qint64 current_bytes : m_bytes)
+		{
+			total += current_bytes;
+		}
+		return total;
+	}
+
+	int MemoryReport::add_entry(const QString& name, int parent)
+	{
+		Entry new_entry;
+		new_entry.m_name = name;
+		new_entry.m_parent = parent;
+		new_entry.m_depth = (parent >= 0) ? (m_entries[parent].m_depth + 1) : 0;
+
+		m_entries.push_back(new_entry);
+		return static_cast<int>(m_entries.size()) - 1;
+	}
+
+	void MemoryReport::add_bytes(int entry_index, Category category, qint64 bytes)
+	{
+		// Add to the entry and all of its parents
+		for (int current_index = entry_index; current_index >= 0; current_index = m_entries[current_index].m_parent)
+		{
+			m_entries[current_index].m_bytes[Utils::to_integral(category)] += bytes;
+		}
+	}
+
+	void MemoryReport::add_string(int entry_index, Category category, const QString& string)
+	{
+		if (string.capacity() > 0)
+		{
+			add_shared_data(entry_index, category, string.constData(), ARRAY_DATA_HEADER_SIZE + ((string.capacity() + 1) * sizeof(QChar)));
+		}
+	}
+
+	void MemoryReport::add_byte_array(int entry_index, Category category, const QByteArray& byte_array)
+	{
+		if (byte_array.capacity() > 0)
+		{
+			add_shared_data(entry_index, category, byte_array.constData(), ARRAY_DATA_HEADER_SIZE + byte_array.capacity() + 1);
+		}
+	}
+
+	int MemoryReport::add_scenario(const Scenario& scenario, const QString& name, int parent)
+	{
+		const int scenario_entry = add_entry(name, parent);
+		if (parent < 0)
+		{
+			add_bytes(scenario_entry, Category::STRUCTURE, sizeof(Scenario));
+		}
+		add_string(scenario_entry, Category::NAMES, scenario.get_name());
+		add_vector(scenario_entry, scenario.get_levels());
+
+		for (const Level& current_level : scenario.get_levels())
+		{
+			add_level(current_level, scenario_entry);
+		}
+		return scenario_entry;
+	}
+
+	int MemoryReport::add_level(const Level& level, int parent)
+	{
+		const int level_entry = add_entry(QStringLiteral("Level \"%1\"").arg(level.get_name()), parent);
+		add_level_contents(level_entry, level);
+		return level_entry;
+	}
+
+	int MemoryReport::add_terminal(const Terminal& terminal, const QString& name, int parent)
+	{
+		const int terminal_entry = add_entry(name, parent);
+
+		// The terminal data is shared by the copies (e.g in the scenario and the models)
+		const Terminal::Data* terminal_data = terminal.m_data.constData();
+		add_shared_data(terminal_entry, Category::STRUCTURE, terminal_data, sizeof(Terminal::Data));
+		add_string(terminal_entry, Category::NAMES, terminal_data->m_name);
+		add_string(terminal_entry, Category::COMMENTS, terminal_data->m_comments);
+
+		for (const Terminal::Branch& current_branch : terminal_data->m_branches)
+		{
+			add_list(terminal_entry, current_branch.m_screens);
+			for (const Terminal::Screen& current_screen : current_branch.m_screens)
+			{
+				add_string(terminal_entry, Category::SCRIPT, current_screen.m_script);
+				add_string(terminal_entry, Category::DISPLAY_TEXT, current_screen.m_display_text);
+				add_string(terminal_entry, Category::COMMENTS, current_screen.m_comments);
+			}
+		}
+		return terminal_entry;
+	}
+
+	MemoryReport::CategoryArray MemoryReport::get_category_totals() const
+	{
+		CategoryArray category_totals = {};
+		for (const Entry& current_entry : m_entries)
+		{
+			if (current_entry.m_parent < 0)
+			{
+				for (int category_index = 0; category_index < Utils::to_integral(Category::CATEGORY_COUNT); ++category_index)
+				{
+					category_totals[category_index] += current_entry.m_bytes[category_index];
+				}
+			}
+		}
+		return category_totals;
+	}
+
+	qint64 MemoryReport::get_total() const
+	{
+		qint64 total = 0;
+		for (qint64 current_bytes : get_category_totals())
+		{
+			total += current_bytes;
+		}
+		return total;
+	}
+
+	qint64 MemoryReport::get_array_data_header_size()
+	{
+		return ARRAY_DATA_HEADER_SIZE;
+	}
+
+	const char* MemoryReport::get_category_label(Category category)
+	{
+		return CATEGORY_LABELS[Utils::to_integral(category)];
+	}
+
+	QString MemoryReport::format_bytes(qint64 bytes)
+	{
+		if (bytes >= (1024 * 1024))
+		{
+			return QStringLiteral("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 2);
+		}
+		else if (bytes >= 1024)
+		{
+			return QStringLiteral("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+		}
+		return QStringLiteral("%1 B").arg(bytes);
+	}
+
+	QString MemoryReport::print(int max_depth) const
+	{
+		QStringList report_lines;
+		report_lines << QStringLiteral("Total: %1").arg(format_bytes(get_total()));
+
+		// Breakdown of what the memory is spent on
+		const CategoryArray category_totals = get_category_totals();
+		for (int category_index = 0; category_index < Utils::to_integral(Category::CATEGORY_COUNT); ++category_index)
+		{
+			if (category_totals[category_index] > 0)
+			{
+				report_lines << QStringLiteral("  %1 %2").arg(QLatin1String(CATEGORY_LABELS[category_index]).leftJustified(16), format_bytes(category_totals[category_index]));
+			}
+		}
+		report_lines << QString();
+
+		for (const Entry& current_entry : m_entries)
+		{
+			if (current_entry.m_depth > max_depth)
+			{
+				continue;
+			}
+
+			QString entry_line = QStringLiteral("%1%2 %3").arg(QString(current_entry.m_depth * 2, ' '), current_entry.m_name.leftJustified(48 - (current_entry.m_depth * 2)), format_bytes(current_entry.get_total()));
+			if (current_entry.m_shared_bytes > 0)
+			{
+				entry_line += QStringLiteral(" (+%1 shared)").arg(format_bytes(current_entry.m_shared_bytes));
+			}
+			report_lines << entry_line;
+		}
+		return report_lines.join('\n');
+	}
+
+	QJsonObject MemoryReport::to_json() const
+	{
+		// Build the tree bottom-up (children always come after their parent), so the children of each entry are collected in reverse
+		auto to_json_array = [](std::vector<QJsonObject>& reversed_objects)
+			{
+				QJsonArray json_array;
+				for (auto object_it = reversed_objects.rbegin(); object_it != reversed_objects.rend(); ++object_it)
+				{
+					json_array.append(std::move(*object_it));
+				}
+				return json_array;
+			};
+
+		std::vector<std::vector<QJsonObject>> child_objects(m_entries.size());
+		std::vector<QJsonObject> root_objects;
+		for (int entry_index = static_cast<int>(m_entries.size()) - 1; entry_index >= 0; --entry_index)
+		{
+			const Entry& current_entry = m_entries[entry_index];
+
+			QJsonObject entry_json;
+			entry_json["name"] = current_entry.m_name;
+			entry_json["bytes"] = current_entry.get_total();
+			entry_json["categories"] = get_category_json(current_entry.m_bytes);
+			if (current_entry.m_shared_bytes > 0)
+			{
+				entry_json["shared_bytes"] = current_entry.m_shared_bytes;
+			}
+			if (!child_objects[entry_index].empty())
+			{
+				entry_json["children"] = to_json_array(child_objects[entry_index]);
+			}
+
+			std::vector<QJsonObject>& parent_objects = (current_entry.m_parent >= 0) ? child_objects[current_entry.m_parent] : root_objects;
+			parent_objects.push_back(std::move(entry_json));
+		}
+
+		QJsonObject report_json;
+		report_json["total_bytes"] = get_total();
+		report_json["categories"] = get_category_json(get_category_totals());
+		report_json["entries"] = to_json_array(root_objects);
+		return report_json;
+	}
+
+	void MemoryReport::add_level_contents(int entry_index, const Level& level)
+	{
+		add_string(entry_index, Category::NAMES, level.m_name);
+		add_string(entry_index, Category::NAMES, level.m_dir_name);
+		add_string(entry_index, Category::NAMES, level.m_script_name);
+		add_string(entry_index, Category::COMMENTS, level.m_comments);
+
+		if (!level.is_loaded())
+		{
+			// The file data is shared by all the levels loaded from the same file
+			const LevelSource& source = level.m_source;
+			add_byte_array(entry_index, Category::SOURCE_DATA, source.m_file_data);
+			add_string(entry_index, Category::NAMES, source.m_name);
+			add_string(entry_index, Category::NAMES, source.m_dir_name);
+			add_string(entry_index, Category::NAMES, source.m_script_name);
+			return;
+		}
+
+		add_vector(entry_index, level.m_terminals);
+		int terminal_index = 0;
+		for (const Terminal& current_terminal : level.m_terminals)
+		{
+			add_terminal(current_terminal, QStringLiteral("Terminal %1").arg(terminal_index), entry_index);
+			++terminal_index;
+		}
+	}
+
+	void MemoryReport::add_shared_data(int entry_index, Category category, const void* data, qint64 bytes)
+	{
+		if (m_counted_data.insert(data).second)
+		{
+			add_bytes(entry_index, category, bytes);
+		}
+		else
+		{
+			m_entries[entry_index].m_shared_bytes += bytes;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+#include <HuxQt/Utils/SlotMap.h>
+#include <HuxQt/Utils/Utilities.h>
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace HuxApp
+{
+	class Scenario;
+	class Level;
+	class Terminal;
+
+	// Estimates the memory used by the scenario data, the models and the caches (heap allocations are approximated from the container capacities)
+	// Implicitly shared data (e.g strings copied between the scenario and the models) is only counted by the first entry that references it
+	class MemoryReport
+	{
+	public:
+		enum class Category
+		{
+			STRUCTURE, // Objects and container storage
+			SCRIPT,
+			DISPLAY_TEXT,
+			COMMENTS,
+			NAMES,
+			SOURCE_DATA, // Scenario file contents kept for lazily loaded levels
+			CACHE,
+			MODEL, // Item model overhead
+			CATEGORY_COUNT
+		};
+
+		using CategoryArray = std::array<qint64, Utils::to_integral(Category::CATEGORY_COUNT)>;
+
+		struct Entry
+		{
+			QString m_name;
+			int m_parent = -1;
+			int m_depth = 0;
+
+			CategoryArray m_bytes = {}; // Includes the children
+			qint64 m_shared_bytes = 0; // Data referenced by this entry that was already counted elsewhere
+
+			qint64 get_total() const;
+		};
+
+		int add_entry(const QString& name, int parent = -1);
+
+		void add_bytes(int entry_index, Category category, qint64 bytes);
+		void add_string(int entry_index, Category category, const QString& string);
+		void add_byte_array(int entry_index, Category category, const QByteArray& byte_array);
+
+		template<typename T>
+		void add_vector(int entry_index, const std::vector<T>& vector) { add_bytes(entry_index, Category::STRUCTURE, static_cast<qint64>(vector.capacity() * sizeof(T))); }
+
+		// Implicitly shared list storage is only counted once
+		template<typename T>
+		void add_list(int entry_index, const QList<T>& list) { if (list.capacity() > 0) { add_shared_data(entry_index, Category::STRUCTURE, list.constData(), get_array_data_header_size() + static_cast<qint64>(list.capacity() * sizeof(T))); } }
+
+		template<typename T>
+		void add_slot_map(int entry_index, const Utils::SlotMap<T>& slot_map) { add_bytes(entry_index, Category::STRUCTURE, static_cast<qint64>(slot_map.get_allocated_bytes())); }
+
+		// Buckets and nodes (each node also stores the next pointer and the hash)
+		template<typename K, typename V>
+		void add_hash_map(int entry_index, const std::unordered_map<K, V>& map) { add_bytes(entry_index, Category::STRUCTURE, static_cast<qint64>((map.bucket_count() * sizeof(void*)) + (map.size() * (sizeof(typename std::unordered_map<K, V>::value_type) + (2 * sizeof(void*)))))); }
+
+		// Adds an entry for the object (the size of the object itself is counted towards the parent, unless it is a root entry)
+		int add_scenario(const Scenario& scenario, const QString& name, int parent = -1);
+		int add_level(const Level& level, int parent);
+		int add_terminal(const Terminal& terminal, const QString& name, int parent);
+
+		const std::vector<Entry>& get_entries() const { return m_entries; }
+		CategoryArray get_category_totals() const; // Sum of the root entries
+		qint64 get_total() const;
+
+		static const char* get_category_label(Category category);
+		static QString format_bytes(qint64 bytes);
+
+		QString print(int max_depth = 1) const; // Entries deeper than the limit are left out
+		QJsonObject to_json() const;
+	private:
+		static qint64 get_array_data_header_size();
+
+		void add_level_contents(int entry_index, const Level& level);
+		void add_shared_data(int entry_index, Category category, const void* data, qint64 bytes);
+
+		std::vector<Entry> m_entries;
+		std::unordered_set<const void*> m_counted_data;
+	};
+}
\ No newline at end of file
@@ -15,7 +15,7 @@ namespace HuxApp
 
 		const Level& get_level(int index) const { return m_levels[index]; }
 		const std::vector<Level>& get_levels() const { return m_levels; }
-		void set_levels(const std::vector<Level>& levels) { m_levels = levels; }
+		void set_levels(std::vector<Level> levels) { m_levels = std::move(levels); }
 
 		void reset();
 	private:
@@ -1,405 +1,756 @@
 #include <HuxQt/Scenario/ScenarioBrowserModel.h>
 
 #include <HuxQt/Scenario/Scenario.h>
+#include <HuxQt/Scenario/MemoryReport.h>
 
+#include <HuxQt/Utils/Trace.h>
 #include <HuxQt/Utils/Utilities.h>
 
 #include <QApplication>
+#include <QFont>
+#include <QIcon>
 #include <QStyle>
 
+#include <cassert>
+
 namespace HuxApp
 {
 	namespace
 	{
-		QString get_terminal_label(int terminal_id, const Terminal& terminal_data)
+		// The views ask for these on every repaint, so the objects are shared by all the rows
+		const QFont& get_row_font(bool modified)
 		{
-			return terminal_data.get_name().isEmpty() ? QStringLiteral("TERMINAL (%1)").arg(terminal_id) : terminal_data.get_name();
+			// Set font to bold if the item has been modified
+			static const QFont regular_font;
+			static const QFont bold_font = []()
+				{
+					QFont font;
+					font.setBold(true);
+					return font;
+				}();
+			return modified ? bold_font : regular_font;
 		}
 
-		class LevelStandardItem : public QStandardItem
+		const QIcon& get_level_icon()
 		{
-		public:
-			LevelStandardItem() = default;
-			LevelStandardItem(int level_id, const Level& level_data) : LevelStandardItem(level_id, level_data.get_name(), level_data.get_dir_name(), level_data.get_script_name())
-			{
-			}
+			static const QIcon level_icon = QApplication::style()->standardIcon(QStyle::StandardPixmap::SP_FileDialogStart);
+			return level_icon;
+		}
 
-			void set_custom_data(const QVariant& data, ScenarioBrowserModel::LevelDataRoles role) { QStandardItem::setData(data, Utils::to_integral(role)); }
+		const QIcon& get_terminal_icon()
+		{
+			static const QIcon terminal_icon = QApplication::style()->standardIcon(QStyle::StandardPixmap::SP_ComputerIcon);
+			return terminal_icon;
+		}
 
-			QVariant get_custom_data(ScenarioBrowserModel::LevelDataRoles role) const { return QStandardItem::data(Utils::to_integral(role)); }
+		Qt::ItemFlags get_row_flags(const QModelIndex& index, Qt::ItemFlags default_flags)
+		{
+			// Allow dragging the rows, but only allow dropping between them
+			return default_flags | (index.isValid() ? Qt::ItemFlag::ItemIsDragEnabled : Qt::ItemFlag::ItemIsDropEnabled);
+		}
 
-			QStandardItem* clone() const override { return new LevelStandardItem(*this); }
+		bool is_row_move_valid(const QModelIndex& source_parent, int source_row, int count, const QModelIndex& destination_parent, int destination_child, int row_count)
+		{
+			// The lists are flat, so only top-level rows can be moved
+			return !source_parent.isValid() && !destination_parent.isValid()
+				&& (count > 0) && (source_row >= 0) && ((source_row + count) <= row_count)
+				&& (destination_child >= 0) && (destination_child <= row_count);
+		}
+	}
 
-			void read(QDataStream& in) override
+	void ModelChangeBatch::add_changed_rows(int first_row, int last_row, const QList<int>& roles)
+	{
+		m_changed_rows.push_back({ first_row, last_row });
+		for (int current_role : roles)
+		{
+			if (!m_changed_roles.contains(current_role))
 			{
-				QStandardItem::read(in);
-
-				// Expecting this to be a move operation, so the level is modified
-				set_custom_data(true, ScenarioBrowserModel::LevelDataRoles::MODIFIED);
+				m_changed_roles << current_role;
 			}
+		}
+	}
+
+	std::vector<ModelChangeBatch::RowRange> ModelChangeBatch::take_changed_rows(QList<int>& roles)
+	{
+		std::vector<RowRange> merged_rows;
+		roles = std::exchange(m_changed_roles, QList<int>());
+		if (m_changed_rows.empty())
+		{
+			return merged_rows;
+		}
 
-			QVariant data(int role = Qt::UserRole + 1) const override
+		std::sort(m_changed_rows.begin(), m_changed_rows.end(), [](const RowRange& lhs, const RowRange& rhs) { return (lhs.m_first_row < rhs.m_first_row); });
+		merged_rows.push_back(m_changed_rows.front());
+		for (auto range_it = m_changed_rows.begin() + 1; range_it != m_changed_rows.end(); ++range_it)
+		{
+			RowRange& last_merged_range = merged_rows.back();
+			if (range_it->m_first_row <= (last_merged_range.m_last_row + 1))
 			{
-				switch (role)
-				{
-				case Qt::FontRole:
-				{
-					// Set font to bold if the level has been modified
-					const bool is_modified = get_custom_data(ScenarioBrowserModel::LevelDataRoles::MODIFIED).toBool();
-					QFont current_font;
-					if (is_modified)
-					{
-						current_font.setBold(true);
-					}
-					else
-					{
-						current_font.setBold(false);
-					}
-					return current_font;
-				}
-				break;
-				}
-
-				return QStandardItem::data(role);
+				last_merged_range.m_last_row = std::max(last_merged_range.m_last_row, range_it->m_last_row);
 			}
-
-			Level export_level() const
+			else
 			{
-				Level exported_level;
-				exported_level.set_name(text());
-				exported_level.set_script_name(get_custom_data(ScenarioBrowserModel::LevelDataRoles::SCRIPT_NAME).toString());
-				exported_level.set_dir_name(get_custom_data(ScenarioBrowserModel::LevelDataRoles::DIR_NAME).toString());
-				return exported_level;
+				merged_rows.push_back(*range_it);
 			}
+		}
+		m_changed_rows.clear();
+		return merged_rows;
+	}
 
-		private:
-			LevelStandardItem(int level_id, const QString& level_name, const QString& level_dir_name, const QString& level_script_name, bool modified = false)
-				: QStandardItem(level_name)
-			{
-				set_custom_data(level_id, ScenarioBrowserModel::LevelDataRoles::LEVEL_ID);
-				set_custom_data(level_dir_name, ScenarioBrowserModel::LevelDataRoles::DIR_NAME);
-				set_custom_data(level_script_name, ScenarioBrowserModel::LevelDataRoles::SCRIPT_NAME);
-				set_custom_data(modified, ScenarioBrowserModel::LevelDataRoles::MODIFIED);
+	LevelModel::LevelModel(int id, std::vector<Terminal> terminals)
+		: m_id(id)
+		, m_terminal_row_index_dirty(true)
+	{
+		// Add a row for each terminal
+		insert_rows(0, std::move(terminals), false);
+	}
 
-				setIcon(QApplication::style()->standardIcon(QStyle::StandardPixmap::SP_FileDialogStart));
+	int LevelModel::find_terminal_row(const TerminalID& terminal_id) const
+	{
+		// Make sure the level and terminal IDs are valid
+		if ((terminal_id.m_level_id == m_id) && m_terminal_pool.contains(terminal_id.m_terminal_id))
+		{
+			ensure_terminal_row_index();
 
-				// Allow drag, but prevent drop
-				setFlags((flags() | Qt::ItemFlag::ItemIsDragEnabled) & ~Qt::ItemFlag::ItemIsDropEnabled);
+			auto row_it = m_terminal_row_index.find(terminal_id.m_terminal_id);
+			if (row_it != m_terminal_row_index.end())
+			{
+				return row_it->second;
 			}
+		}
+		return -1;
+	}
+
+	const Terminal* LevelModel::get_terminal(const TerminalID& terminal_id) const
+	{
+		// Make sure the level and terminal IDs are valid
+		if (terminal_id.m_level_id == m_id)
+		{
+			return get_terminal_internal(terminal_id.m_terminal_id);
+		}
+		return nullptr;
+	}
+
+	QString LevelModel::get_terminal_label(int terminal_id, const Terminal& terminal_data)
+	{
+		return terminal_data.get_name().isEmpty() ? QStringLiteral("TERMINAL (%1)").arg(Utils::SlotMap<Terminal>::get_slot_index(terminal_id)) : terminal_data.get_name();
+	}
 
-			LevelStandardItem(const LevelStandardItem& other)
-				: LevelStandardItem(other.get_custom_data(ScenarioBrowserModel::LevelDataRoles::LEVEL_ID).toInt()
-					, other.text()
-					, other.get_custom_data(ScenarioBrowserModel::LevelDataRoles::DIR_NAME).toString()
-					, other.get_custom_data(ScenarioBrowserModel::LevelDataRoles::SCRIPT_NAME).toString()
-					, true) // Set modified to true, since we are sure that this was a newly added item
+	bool LevelModel::add_terminal()
+	{
+		if (!insert_rows(rowCount(), { Terminal() }, true))
+		{
+			return false;
+		}
+		level_modified_internal();
+		return true;
+	}
+
+	std::vector<Terminal> LevelModel::copy_terminals(const QModelIndexList& terminal_indices)
+	{
+		std::vector<Terminal> selected_terminals;
+		for (const QModelIndex& current_index : terminal_indices)
+		{
+			if (const Terminal* current_terminal = get_terminal_internal(current_index))
 			{
+				selected_terminals.push_back(*current_terminal);
 			}
-		};
+		}
+		return selected_terminals;
+	}
 
-		class TerminalStandardItem : public QStandardItem
+	bool LevelModel::paste_terminals(const std::vector<Terminal>& terminals, const QModelIndexList& terminal_indices)
+	{
+		// TODO: paste at the selection
+		if (!terminals.empty())
 		{
-		public:
-			TerminalStandardItem() = default;
-			TerminalStandardItem(int terminal_id, const Terminal& terminal_data) : TerminalStandardItem(terminal_id, get_terminal_label(terminal_id, terminal_data))
+			// Inserted as a single range, so we only send one update
+			if (!insert_rows(rowCount(), terminals, true))
 			{
+				return false;
 			}
+			level_modified_internal();
+		}
+		return true;
+	}
 
-			QStandardItem* clone() const override { return new TerminalStandardItem(*this); }
-
-			void read(QDataStream& in) override
+	void LevelModel::remove_terminals(const QModelIndexList& terminal_indices)
+	{
+		// Sort the rows in reverse, so removing a range does not shift the rows of the ranges still to be removed
+		std::vector<int> removed_rows;
+		removed_rows.reserve(terminal_indices.size());
+		for (const QModelIndex& current_index : terminal_indices)
+		{
+			if (checkIndex(current_index, CheckIndexOption::IndexIsValid))
 			{
-				QStandardItem::read(in);
-
-				// Expecting this to be a move operation, so the terminal is modified
-				set_custom_data(true, LevelModel::TerminalDataRoles::MODIFIED);
+				removed_rows.push_back(current_index.row());
 			}
+		}
+		std::sort(removed_rows.begin(), removed_rows.end(), std::greater<int>());
+		removed_rows.erase(std::unique(removed_rows.begin(), removed_rows.end()), removed_rows.end());
 
-			void set_custom_data(const QVariant& data, LevelModel::TerminalDataRoles role) { QStandardItem::setData(data, Utils::to_integral(role)); }
+		if (removed_rows.empty())
+		{
+			return;
+		}
 
-			QVariant get_custom_data(LevelModel::TerminalDataRoles role) const { return QStandardItem::data(Utils::to_integral(role)); }
+		ScopedModelTransaction<LevelModel> transaction(*this);
+		flush_changed_rows();
 
-			QVariant data(int role = Qt::UserRole + 1) const override
+		// Remove each contiguous range in one go (so the views only get one update per range)
+		QList<int> removed_terminal_ids;
+		removed_terminal_ids.reserve(removed_rows.size());
+		auto removed_row_it = removed_rows.begin();
+		while (removed_row_it != removed_rows.end())
+		{
+			const int last_row = *removed_row_it;
+			int first_row = last_row;
+			for (++removed_row_it; (removed_row_it != removed_rows.end()) && (*removed_row_it == (first_row - 1)); ++removed_row_it)
 			{
-				switch (role)
-				{
-				case Qt::FontRole:
-				{
-					// Set font to bold if the terminal has been modified
-					const bool is_modified = get_custom_data(LevelModel::TerminalDataRoles::MODIFIED).toBool();
-					QFont current_font;
-					current_font.setBold(is_modified);
-					return current_font;
-				}
-				break;
-				}
-
-				return QStandardItem::data(role);
+				first_row = *removed_row_it;
 			}
+			remove_rows(first_row, last_row, removed_terminal_ids);
+		}
 
-		private:
-			TerminalStandardItem(int terminal_id, const QString& terminal_name)
-				: QStandardItem(terminal_name)
-			{
-				set_custom_data(terminal_id, LevelModel::TerminalDataRoles::TERMINAL_ID);
-				setIcon(QApplication::style()->standardIcon(QStyle::StandardPixmap::SP_ComputerIcon));
-
-				// Allow drag, but prevent drop
-				setFlags((flags() | Qt::ItemFlag::ItemIsDragEnabled) & ~Qt::ItemFlag::ItemIsDropEnabled);
-			}
+		// Signal listeners
+		emit(terminals_removed(m_id, removed_terminal_ids));
+		level_modified_internal();
+	}
 
-			TerminalStandardItem(const TerminalStandardItem& other)
-				: TerminalStandardItem(other.get_custom_data(LevelModel::TerminalDataRoles::TERMINAL_ID).toInt()
-					, other.text())
+	bool LevelModel::insert_terminals(int row, std::vector<Terminal> terminals)
+	{
+		if (!terminals.empty() && (row >= 0) && (row <= rowCount()))
+		{
+			if (!insert_rows(row, std::move(terminals), true))
 			{
+				return false;
 			}
-		};
+			level_modified_internal();
+		}
+		return true;
 	}
 
-	LevelModel::LevelModel(int id, const std::vector<Terminal>& terminals)
-		: m_id(id)
-		, m_terminal_id_counter(0)
-		, m_signal_lock(false)
+	void LevelModel::remove_terminal_rows(int first_row, int last_row)
 	{
-		setColumnCount(1);
+		if ((first_row < 0) || (first_row > last_row) || (last_row >= rowCount()))
+		{
+			return;
+		}
+
+		ScopedModelTransaction<LevelModel> transaction(*this);
+		flush_changed_rows();
 
-		setItemPrototype(new TerminalStandardItem());
+		QList<int> removed_terminal_ids;
+		removed_terminal_ids.reserve((last_row - first_row) + 1);
+		remove_rows(first_row, last_row, removed_terminal_ids);
+
+		// Signal listeners
+		emit(terminals_removed(m_id, removed_terminal_ids));
+		level_modified_internal();
+	}
 
-		// Add an item for each terminal
-		for (const Terminal& current_terminal : terminals)
+	void LevelModel::export_level_contents(Level& level) const
+	{
+		// Copy the terminals in the row order (only shares the data, so this is cheap)
+		std::vector<Terminal> exported_terminals;
+		exported_terminals.reserve(m_terminal_rows.size());
+		for (const TerminalRow& current_terminal_row : m_terminal_rows)
 		{
-			add_terminal_internal(current_terminal);
+			exported_terminals.push_back(*get_terminal_internal(current_terminal_row.m_id));
 		}
 
-		connect_signals();
+		level.set_terminals(std::move(exported_terminals));
 	}
 
-	int LevelModel::find_terminal_row(const TerminalID& terminal_id) const
+	void LevelModel::clear_modified()
 	{
-		// Make sure the level and terminal IDs are valid
-		if ((terminal_id.m_level_id == m_id) && (m_terminal_pool.find(terminal_id.m_terminal_id) != m_terminal_pool.end()))
+		if (!m_terminal_rows.empty())
 		{
-			for (int current_row = 0; current_row < rowCount(); ++current_row)
+			set_rows_modified(0, rowCount() - 1, false);
+		}
+	}
+
+	void LevelModel::report_memory(MemoryReport& report, const QString& name, int parent) const
+	{
+		const int model_entry = report.add_entry(QStringLiteral("Level model \"%1\"").arg(name), parent);
+		report.add_bytes(model_entry, MemoryReport::Category::MODEL, sizeof(LevelModel) + (m_terminal_rows.capacity() * sizeof(TerminalRow))); // The level pool only holds a pointer to the model
+		report.add_slot_map(model_entry, m_terminal_pool);
+		report.add_hash_map(model_entry, m_terminal_row_index);
+
+		for (const TerminalRow& current_terminal_row : m_terminal_rows)
+		{
+			// Add the terminal first, so the label only counts if it is not the terminal name
+			if (const Terminal* terminal = get_terminal_internal(current_terminal_row.m_id))
 			{
-				if (get_custom_data(current_row, TerminalDataRoles::TERMINAL_ID).toInt() == terminal_id.m_terminal_id)
-				{
-					return current_row;
-				}
+				report.add_terminal(*terminal, current_terminal_row.m_label, model_entry);
 			}
+			report.add_string(model_entry, MemoryReport::Category::MODEL, current_terminal_row.m_label);
 		}
-		return -1;
 	}
 
-	const Terminal* LevelModel::get_terminal(const TerminalID& terminal_id) const
+	bool LevelModel::is_terminal_row_index_consistent() const
 	{
-		// Make sure the level and terminal IDs are valid
-		if (terminal_id.m_level_id == m_id)
+		if (m_terminal_row_index_dirty)
 		{
-			return get_terminal_internal(terminal_id.m_terminal_id);
+			// Will be rebuilt before it is used
+			return true;
 		}
-		return nullptr;
+
+		if (m_terminal_row_index.size() != m_terminal_rows.size())
+		{
+			return false;
+		}
+
+		for (int current_row = 0; current_row < rowCount(); ++current_row)
+		{
+			auto row_it = m_terminal_row_index.find(m_terminal_rows[current_row].m_id);
+			if ((row_it == m_terminal_row_index.end()) || (row_it->second != current_row))
+			{
+				return false;
+			}
+		}
+		return true;
 	}
 
-	void LevelModel::add_terminal()
+	int LevelModel::rowCount(const QModelIndex& parent) const
 	{
-		QStandardItem* new_terminal_item = add_terminal_internal(Terminal());
-		set_custom_data(new_terminal_item, TerminalDataRoles::MODIFIED, true);
+		return parent.isValid() ? 0 : static_cast<int>(m_terminal_rows.size());
 	}
 
-	std::vector<Terminal> LevelModel::copy_terminals(const QModelIndexList& terminal_indices)
+	QVariant LevelModel::data(const QModelIndex& index, int role) const
 	{
-		std::vector<Terminal> selected_terminals;
-		for (const QModelIndex& current_index : terminal_indices)
+		if (!index.isValid() || (index.row() >= rowCount()))
 		{
-			if (const Terminal* current_terminal = get_terminal_internal(current_index))
-			{
-				selected_terminals.push_back(*current_terminal);
-			}
+			return QVariant();
 		}
-		return selected_terminals;
+
+		const TerminalRow& terminal_row = m_terminal_rows[index.row()];
+		switch (role)
+		{
+		case Qt::DisplayRole:
+		case Qt::EditRole:
+			return terminal_row.m_label;
+		case Qt::DecorationRole:
+			return get_terminal_icon();
+		case Qt::FontRole:
+			return get_row_font(terminal_row.m_modified);
+		case Utils::to_integral(TerminalDataRoles::TERMINAL_ID):
+			return terminal_row.m_id;
+		case Utils::to_integral(TerminalDataRoles::MODIFIED):
+			return terminal_row.m_modified;
+		}
+
+		return QVariant();
 	}
 
-	void LevelModel::paste_terminals(const std::vector<Terminal>& terminals, const QModelIndexList& terminal_indices)
+	Qt::ItemFlags LevelModel::flags(const QModelIndex& index) const
 	{
-		// TODO: paste at the selection
-		m_signal_lock = true; // Lock signals so we only send one update
-		for (const Terminal& current_terminal : terminals)
+		return get_row_flags(index, QAbstractListModel::flags(index));
+	}
+
+	Qt::DropActions LevelModel::supportedDropActions() const
+	{
+		return Qt::DropAction::MoveAction;
+	}
+
+	bool LevelModel::moveRows(const QModelIndex& source_parent, int source_row, int count, const QModelIndex& destination_parent, int destination_child)
+	{
+		if (!is_row_move_valid(source_parent, source_row, count, destination_parent, destination_child, rowCount()))
 		{
-			QStandardItem* pasted_terminal_item = add_terminal_internal(current_terminal);
-			set_custom_data(pasted_terminal_item, TerminalDataRoles::MODIFIED, true);
+			return false;
 		}
+
+		// Pending changes refer to the rows before the move (and must not be sent while moving)
+		flush_changed_rows();
+
+		// The begin function also rejects moving the rows onto themselves
+		if (!beginMoveRows(source_parent, source_row, source_row + count - 1, destination_parent, destination_child))
+		{
+			return false;
+		}
+
+		const int moved_row = Utils::move_range(m_terminal_rows, source_row, count, destination_child);
+		m_terminal_row_index_dirty = true;
+		endMoveRows();
+
+		// Moved terminals count as modified
+		set_rows_modified(moved_row, moved_row + count - 1, true);
 		level_modified_internal();
-		m_signal_lock = false;
+		return true;
 	}
 
-	void LevelModel::remove_terminals(const QModelIndexList& terminal_indices)
+	bool LevelModel::insert_rows(int row, std::vector<Terminal> terminals, bool modified)
 	{
-		QModelIndexList reverse_sorted_indices = terminal_indices;
-		if (reverse_sorted_indices.size() > 1)
+		if (terminals.empty())
 		{
-			// Have to reverse sort the indices so we delete the last row first (this preserves the row indices as we delete the rows)
-			std::sort(reverse_sorted_indices.begin(), reverse_sorted_indices.end());
+			return true;
 		}
 
-		QList<int> removed_indices;
+		if (terminals.size() > m_terminal_pool.get_available_count())
+		{
+			// Out of terminal IDs (checked up front, so the rows are never partially inserted)
+			return false;
+		}
 
-		for (const QModelIndex& current_removed_index : reverse_sorted_indices)
+		const int inserted_count = static_cast<int>(terminals.size());
+		if (row < rowCount())
 		{
-			const int removed_terminal_id = get_custom_data(current_removed_index.row(), TerminalDataRoles::TERMINAL_ID).toInt();
-			removeRow(current_removed_index.row());
+			// Rows after the inserted ones will shift
+			flush_changed_rows();
+			m_terminal_row_index_dirty = true;
+		}
+
+		beginInsertRows(QModelIndex(), row, row + inserted_count - 1);
+		m_terminal_rows.insert(m_terminal_rows.begin() + row, inserted_count, TerminalRow());
+		m_terminal_pool.reserve(m_terminal_pool.size() + terminals.size());
+		for (int terminal_index = 0; terminal_index < inserted_count; ++terminal_index)
+		{
+			// Move the terminal into the pool (the handle is the terminal ID)
+			const int terminal_id = m_terminal_pool.insert(std::move(terminals[terminal_index]));
+			if (!m_terminal_row_index_dirty)
+			{
+				m_terminal_row_index[terminal_id] = row + terminal_index;
+			}
+
+			TerminalRow& new_terminal_row = m_terminal_rows[row + terminal_index];
+			new_terminal_row.m_id = terminal_id;
+			new_terminal_row.m_label = get_terminal_label(terminal_id, *m_terminal_pool.get(terminal_id));
+			new_terminal_row.m_modified = modified;
+		}
+		// Checked once per mutation (a full scan, too slow for every lookup)
+		assert(is_terminal_row_index_consistent());
+		endInsertRows();
+		return true;
+	}
 
+	void LevelModel::remove_rows(int first_row, int last_row, QList<int>& removed_terminal_ids)
+	{
+		beginRemoveRows(QModelIndex(), first_row, last_row);
+		const bool tail_removed = (last_row == (rowCount() - 1));
+		for (int current_row = first_row; current_row <= last_row; ++current_row)
+		{
+			const int removed_terminal_id = m_terminal_rows[current_row].m_id;
+			if (!m_terminal_row_index_dirty && tail_removed)
+			{
+				m_terminal_row_index.erase(removed_terminal_id);
+			}
 			m_terminal_pool.erase(removed_terminal_id);
+			removed_terminal_ids << removed_terminal_id;
+		}
 
-			removed_indices << removed_terminal_id;
+		if (!tail_removed)
+		{
+			// Rows after the removed ones will shift
+			m_terminal_row_index_dirty = true;
 		}
+		m_terminal_rows.erase(m_terminal_rows.begin() + first_row, m_terminal_rows.begin() + last_row + 1);
+		assert(is_terminal_row_index_consistent());
+		endRemoveRows();
+	}
 
-		// Signal listeners
-		emit(terminals_removed(m_id, removed_indices));
-		level_modified_internal();
+	void LevelModel::update_terminal_data(const TerminalID& terminal_id, const Terminal& terminal_data)
+	{
+		const int terminal_row = find_terminal_row(terminal_id);
+		if (terminal_row >= 0)
+		{
+			*m_terminal_pool.get(terminal_id.m_terminal_id) = terminal_data;
+
+			TerminalRow& updated_terminal_row = m_terminal_rows[terminal_row];
+			updated_terminal_row.m_label = get_terminal_label(terminal_id.m_terminal_id, terminal_data);
+			updated_terminal_row.m_modified = true;
+
+			rows_changed(terminal_row, terminal_row, { Qt::DisplayRole, Qt::EditRole, Qt::FontRole, Utils::to_integral(TerminalDataRoles::MODIFIED) });
+			level_modified_internal();
+		}
 	}
 
-	QVariant LevelModel::get_custom_data(int row, TerminalDataRoles role) const { return data(index(row, 0), Utils::to_integral(role)); }
+	void LevelModel::set_rows_modified(int first_row, int last_row, bool modified)
+	{
+		for (int current_row = first_row; current_row <= last_row; ++current_row)
+		{
+			m_terminal_rows[current_row].m_modified = modified;
+		}
+		rows_changed(first_row, last_row, { Qt::FontRole, Utils::to_integral(TerminalDataRoles::MODIFIED) });
+	}
 
-	QVariant LevelModel::get_custom_data(const QStandardItem* item, TerminalDataRoles role) const
+	void LevelModel::commit_transaction()
 	{
-		if (item)
+		if (m_change_batch.end())
 		{
-			return item->data(Utils::to_integral(role));
+			flush_changed_rows();
+			if (m_change_batch.take_modified())
+			{
+				emit(level_modified(m_id));
+			}
 		}
-		return QVariant();
 	}
 
-	void LevelModel::set_custom_data(int row, TerminalDataRoles role, const QVariant& data) { setData(index(row, 0), data, Utils::to_integral(role)); }
+	void LevelModel::rows_changed(int first_row, int last_row, const QList<int>& roles)
+	{
+		if (m_change_batch.is_active())
+		{
+			m_change_batch.add_changed_rows(first_row, last_row, roles);
+			return;
+		}
+		emit(dataChanged(index(first_row), index(last_row), roles));
+	}
 
-	void LevelModel::set_custom_data(QStandardItem* item, TerminalDataRoles role, const QVariant& data)
+	void LevelModel::flush_changed_rows()
 	{
-		if (item)
+		QList<int> changed_roles;
+		for (const ModelChangeBatch::RowRange& current_range : m_change_batch.take_changed_rows(changed_roles))
 		{
-			item->setData(data, Utils::to_integral(role));
+			emit(dataChanged(index(current_range.m_first_row), index(current_range.m_last_row), changed_roles));
 		}
 	}
 
-	void LevelModel::export_level_contents(Level& level) const
+	void LevelModel::ensure_terminal_row_index() const
 	{
-		std::vector<Terminal> exported_terminals(rowCount());
-		auto current_exported_terminal_it = exported_terminals.begin();
-		for (int current_row = 0; current_row < rowCount(); ++current_row)
+		if (!m_terminal_row_index_dirty)
 		{
-			// Get the terminal ID and copy the contents
-			Terminal& current_exported_terminal = *current_exported_terminal_it;
-			const TerminalStandardItem* current_terminal_item = static_cast<TerminalStandardItem*>(item(current_row));
-			
-			const int current_terminal_id = current_terminal_item->get_custom_data(TerminalDataRoles::TERMINAL_ID).toInt();
-			const Terminal* terminal_data = get_terminal_internal(current_terminal_id);
-			current_exported_terminal = *terminal_data;
+			return;
+		}
 
-			++current_exported_terminal_it;
+		HUX_TRACE_SCOPE("model", "rebuild_terminal_row_index");
+		m_terminal_row_index.clear();
+		m_terminal_row_index.reserve(m_terminal_rows.size());
+		for (int current_row = 0; current_row < rowCount(); ++current_row)
+		{
+			m_terminal_row_index[m_terminal_rows[current_row].m_id] = current_row;
 		}
+		m_terminal_row_index_dirty = false;
+		assert(is_terminal_row_index_consistent());
+	}
 
-		level.set_terminals(exported_terminals);
+	const Terminal* LevelModel::get_terminal_internal(int terminal_id) const
+	{
+		return m_terminal_pool.get(terminal_id);
 	}
 
-	void LevelModel::clear_modified()
+	const Terminal* LevelModel::get_terminal_internal(const QModelIndex& index) const
 	{
-		for (int current_row = 0; current_row < rowCount(); ++current_row)
+		if (checkIndex(index, CheckIndexOption::IndexIsValid))
 		{
-			set_custom_data(current_row, TerminalDataRoles::MODIFIED, false);
+			return get_terminal_internal(m_terminal_rows[index.row()].m_id);
 		}
+		return nullptr;
 	}
 
-	void LevelModel::connect_signals()
+	void LevelModel::level_modified_internal()
 	{
-		// Connect to the item changed signal (using this to detect drag & drop)
-		connect(this, &QStandardItemModel::itemChanged, this, &LevelModel::terminal_item_changed);
+		if (m_change_batch.is_active())
+		{
+			// Sent once the transaction is committed
+			m_change_batch.set_modified();
+			return;
+		}
+		emit(level_modified(m_id));
 	}
 
-	QStandardItem* LevelModel::add_terminal_internal(const Terminal& terminal)
+	int LevelListModel::rowCount(const QModelIndex& parent) const
 	{
-		// Add a new terminal to the pool (use array access operator to generate the entry)
-		const int terminal_id = m_terminal_id_counter++;
-		m_terminal_pool[terminal_id] = terminal;
+		return parent.isValid() ? 0 : static_cast<int>(m_level_rows.size());
+	}
 
-		// Add item to the model
-		TerminalStandardItem* terminal_standard_item = new TerminalStandardItem(terminal_id, terminal);
-		appendRow(terminal_standard_item);
+	QVariant LevelListModel::data(const QModelIndex& index, int role) const
+	{
+		if (!index.isValid() || (index.row() >= rowCount()))
+		{
+			return QVariant();
+		}
 
-		return terminal_standard_item;
+		const LevelRow& level_row = m_level_rows[index.row()];
+		switch (role)
+		{
+		case Qt::DisplayRole:
+		case Qt::EditRole:
+			return level_row.m_name;
+		case Qt::DecorationRole:
+			return get_level_icon();
+		case Qt::FontRole:
+			return get_row_font(level_row.m_modified);
+		case Utils::to_integral(LevelDataRoles::LEVEL_ID):
+			return level_row.m_id;
+		case Utils::to_integral(LevelDataRoles::MODIFIED):
+			return level_row.m_modified;
+		case Utils::to_integral(LevelDataRoles::DIR_NAME):
+			return level_row.m_dir_name;
+		case Utils::to_integral(LevelDataRoles::SCRIPT_NAME):
+			return level_row.m_script_name;
+		}
+
+		return QVariant();
 	}
 
-	void LevelModel::update_terminal_data(const TerminalID& terminal_id, const Terminal& terminal_data)
+	Qt::ItemFlags LevelListModel::flags(const QModelIndex& index) const
 	{
-		const int terminal_row = find_terminal_row(terminal_id);
-		if (terminal_row >= 0)
+		return get_row_flags(index, QAbstractListModel::flags(index));
+	}
+
+	Qt::DropActions LevelListModel::supportedDropActions() const
+	{
+		return Qt::DropAction::MoveAction;
+	}
+
+	bool LevelListModel::moveRows(const QModelIndex& source_parent, int source_row, int count, const QModelIndex& destination_parent, int destination_child)
+	{
+		if (!is_row_move_valid(source_parent, source_row, count, destination_parent, destination_child, rowCount()))
 		{
-			m_terminal_pool[terminal_id.m_terminal_id] = terminal_data;
+			return false;
+		}
 
-			QStandardItem* terminal_item = item(terminal_row);
-			terminal_item->setText(get_terminal_label(terminal_id.m_terminal_id, terminal_data));
+		// Pending changes refer to the rows before the move (and must not be sent while moving)
+		flush_changed_rows();
 
-			set_custom_data(terminal_row, TerminalDataRoles::MODIFIED, true);
+		// The begin function also rejects moving the rows onto themselves
+		if (!beginMoveRows(source_parent, source_row, source_row + count - 1, destination_parent, destination_child))
+		{
+			return false;
 		}
+
+		const int moved_row = Utils::move_range(m_level_rows, source_row, count, destination_child);
+		endMoveRows();
+
+		// Moved levels count as modified
+		set_rows_modified(moved_row, moved_row + count - 1, true);
+		return true;
 	}
 
-	void LevelModel::terminal_item_changed(QStandardItem* item)
+	void LevelListModel::insert_level(int row, int level_id, const Level& level, bool modified)
 	{
-		if (m_signal_lock)
+		if (row < rowCount())
 		{
-			return;
+			// Rows after the inserted one will shift
+			flush_changed_rows();
 		}
 
-		if (get_custom_data(item, TerminalDataRoles::MODIFIED).toBool())
+		beginInsertRows(QModelIndex(), row, row);
+		LevelRow new_level_row;
+		new_level_row.m_id = level_id;
+		new_level_row.m_name = level.get_name();
+		new_level_row.m_dir_name = level.get_dir_name();
+		new_level_row.m_script_name = level.get_script_name();
+		new_level_row.m_modified = modified;
+		m_level_rows.insert(m_level_rows.begin() + row, std::move(new_level_row));
+		endInsertRows();
+	}
+
+	void LevelListModel::remove_level(int row)
+	{
+		flush_changed_rows();
+		beginRemoveRows(QModelIndex(), row, row);
+		m_level_rows.erase(m_level_rows.begin() + row);
+		endRemoveRows();
+	}
+
+	void LevelListModel::update_level(int row, const LevelInfo& info)
+	{
+		LevelRow& level_row = m_level_rows[row];
+		level_row.m_name = info.m_name;
+		level_row.m_dir_name = info.m_dir_name;
+		level_row.m_script_name = info.m_script_name;
+
+		rows_changed(row, row, { Qt::DisplayRole, Qt::EditRole, Utils::to_integral(LevelDataRoles::DIR_NAME), Utils::to_integral(LevelDataRoles::SCRIPT_NAME) });
+	}
+
+	void LevelListModel::set_rows_modified(int first_row, int last_row, bool modified)
+	{
+		for (int current_row = first_row; current_row <= last_row; ++current_row)
 		{
-			level_modified_internal();
+			m_level_rows[current_row].m_modified = modified;
+		}
+		rows_changed(first_row, last_row, { Qt::FontRole, Utils::to_integral(LevelDataRoles::MODIFIED) });
+
+		if (modified)
+		{
+			levels_modified_internal();
 		}
 	}
 
-	const Terminal* LevelModel::get_terminal_internal(int terminal_id) const
+	void LevelListModel::clear()
+	{
+		// The reset covers the pending changes
+		QList<int> changed_roles;
+		m_change_batch.take_changed_rows(changed_roles);
+
+		beginResetModel();
+		m_level_rows.clear();
+		endResetModel();
+	}
+
+	void LevelListModel::commit_transaction()
 	{
-		auto terminal_it = m_terminal_pool.find(terminal_id);
-		if (terminal_it != m_terminal_pool.end())
+		if (m_change_batch.end())
 		{
-			return &terminal_it->second;
+			flush_changed_rows();
+			if (m_change_batch.take_modified())
+			{
+				emit(levels_modified());
+			}
 		}
-		return nullptr;
 	}
 
-	const Terminal* LevelModel::get_terminal_internal(const QModelIndex& index) const
+	void LevelListModel::rows_changed(int first_row, int last_row, const QList<int>& roles)
 	{
-		const int terminal_id = get_custom_data(index.row(), TerminalDataRoles::TERMINAL_ID).toInt();
-		return get_terminal_internal(terminal_id);
+		if (m_change_batch.is_active())
+		{
+			m_change_batch.add_changed_rows(first_row, last_row, roles);
+			return;
+		}
+		emit(dataChanged(index(first_row), index(last_row), roles));
 	}
 
-	void LevelModel::level_modified_internal()
+	void LevelListModel::flush_changed_rows()
 	{
-		emit(level_modified(m_id));
+		QList<int> changed_roles;
+		for (const ModelChangeBatch::RowRange& current_range : m_change_batch.take_changed_rows(changed_roles))
+		{
+			emit(dataChanged(index(current_range.m_first_row), index(current_range.m_last_row), changed_roles));
+		}
+	}
+
+	void LevelListModel::levels_modified_internal()
+	{
+		if (m_change_batch.is_active())
+		{
+			m_change_batch.set_modified();
+			return;
+		}
+		emit(levels_modified());
 	}
 
 	ScenarioBrowserModel::ScenarioBrowserModel(QObject* parent)
 		: QObject(parent)
 	{
-		m_level_list_model.setItemPrototype(new LevelStandardItem());
-
-		// Connect to the item changed signal (using this to detect drag & drop)
-		connect(&m_level_list_model, &QStandardItemModel::itemChanged, this, &ScenarioBrowserModel::level_item_changed);
+		// Levels are flagged as modified by edits and by drag & drop
+		connect(&m_level_list_model, &LevelListModel::levels_modified, this, &ScenarioBrowserModel::scenario_modified_internal);
+		connect_revision_signals(m_level_list_model);
 	}
 
-	void ScenarioBrowserModel::load_scenario(const Scenario& scenario)
+	bool ScenarioBrowserModel::load_scenario(Scenario scenario)
 	{
+		HUX_TRACE_SCOPE("model", "browser_load_scenario");
 		// First clear the current model
 		clear_internal();
 
-		m_name = scenario.get_name();
+		if (scenario.get_levels().size() > m_level_pool.get_available_count())
+		{
+			return false;
+		}
 
-		m_level_list_model.setColumnCount(1);
+		m_name = scenario.get_name();
 
-		for (const Level& current_level : scenario.get_levels())
+		// We own the scenario, so the levels can be moved into the models
+		for (Level& current_level : scenario.get_levels())
 		{
-			add_level_internal(current_level);
+			add_level_internal(std::move(current_level), m_level_list_model.rowCount(), false);
 		}
+		return true;
 	}
 
 	Scenario ScenarioBrowserModel::export_scenario() const
 	{
+		HUX_TRACE_SCOPE("model", "browser_export_scenario");
 		Scenario exported_scenario;
 		exported_scenario.set_name(m_name);
 
@@ -407,28 +758,46 @@ namespace HuxApp
 		auto current_exported_level_it = exported_levels.begin();
 		for (int current_level_row = 0; current_level_row < m_level_list_model.rowCount(); ++current_level_row)
 		{
-			// First initialize the level attributes
-			Level& current_exported_level = *current_exported_level_it;
-			const LevelStandardItem* current_level_item = static_cast<LevelStandardItem*>(m_level_list_model.item(current_level_row));
-			current_exported_level = current_level_item->export_level();
-
-			// Get the level contents from the model
-			const LevelModel* current_level_model = get_level_model(current_level_item->get_custom_data(LevelDataRoles::LEVEL_ID).toInt());
-			current_level_model->export_level_contents(current_exported_level);
-
+			*current_exported_level_it = export_level(current_level_row);
 			++current_exported_level_it;
 		}
 
-		exported_scenario.set_levels(exported_levels);
+		exported_scenario.set_levels(std::move(exported_levels));
 		return exported_scenario;
 	}
 
+	Level ScenarioBrowserModel::export_level(int row) const
+	{
+		// First initialize the level attributes
+		const LevelListModel::LevelRow& level_row = m_level_list_model.m_level_rows[row];
+		Level exported_level;
+		exported_level.set_name(level_row.m_name);
+		exported_level.set_script_name(level_row.m_script_name);
+		exported_level.set_dir_name(level_row.m_dir_name);
+
+		const int level_id = level_row.m_id;
+		if (const LevelModel* level_model = get_level_model(level_id))
+		{
+			// Get the level contents from the model
+			level_model->export_level_contents(exported_level);
+		}
+		else
+		{
+			// Level was not loaded yet, pass on the serialized contents
+			auto unloaded_level_it = m_unloaded_levels.find(level_id);
+			if (unloaded_level_it != m_unloaded_levels.end())
+			{
+				exported_level.set_source(unloaded_level_it->second.get_source());
+			}
+		}
+		return exported_level;
+	}
+
 	const LevelModel* ScenarioBrowserModel::get_level_model(int id) const
 	{
-		auto level_model_it = m_level_pool.find(id);
-		if (level_model_it != m_level_pool.end())
+		if (const std::unique_ptr<LevelModel>* level_model = m_level_pool.get(id))
 		{
-			return &(level_model_it->second);
+			return level_model->get();
 		}
 
 		return nullptr;
@@ -436,22 +805,51 @@ namespace HuxApp
 
 	LevelModel* ScenarioBrowserModel::get_level_model(int id)
 	{
+		auto unloaded_level_it = m_unloaded_levels.find(id);
+		if (unloaded_level_it != m_unloaded_levels.end())
+		{
+			// First time the level contents are needed, deserialize them and create the model
+			Level& unloaded_level = unloaded_level_it->second;
+			assert(m_level_loader);
+			if (!m_level_loader(unloaded_level))
+			{
+				// Keep the serialized contents, so the level is saved as-is (the loader reports the error)
+				return nullptr;
+			}
+
+			if (unloaded_level.get_terminal_count() > static_cast<int>(LevelModel::MAX_TERMINAL_COUNT))
+			{
+				// Stays in the unloaded levels (it is still saved and exported)
+				qWarning("Level \"%s\" has too many terminals to be opened!", qUtf8Printable(unloaded_level.get_name()));
+				return nullptr;
+			}
+
+			// The unloaded level is discarded, so its terminals can be moved into the model
+			create_level_model(id, std::move(unloaded_level.get_terminals()));
+			m_unloaded_levels.erase(unloaded_level_it);
+			emit(level_loaded(id));
+		}
+
 		return const_cast<LevelModel*>(const_cast<const ScenarioBrowserModel*>(this)->get_level_model(id));
 	}
 
 	const LevelModel* ScenarioBrowserModel::get_level_model(const QModelIndex& index) const
 	{
 		// Make sure the index is valid
-		if (m_level_list_model.itemFromIndex(index))
+		if (m_level_list_model.checkIndex(index, QAbstractItemModel::CheckIndexOption::IndexIsValid))
 		{
-			return get_level_model(get_level_custom_data(index.row(), LevelDataRoles::LEVEL_ID).toInt());
+			return get_level_model(get_level_id(index.row()));
 		}
 		return nullptr;
 	}
 
 	LevelModel* ScenarioBrowserModel::get_level_model(const QModelIndex& index)
 	{
-		return const_cast<LevelModel*>(const_cast<const ScenarioBrowserModel*>(this)->get_level_model(index));
+		if (m_level_list_model.checkIndex(index, QAbstractItemModel::CheckIndexOption::IndexIsValid))
+		{
+			return get_level_model(get_level_id(index.row()));
+		}
+		return nullptr;
 	}
 
 	LevelInfo ScenarioBrowserModel::get_level_info(int id) const
@@ -460,20 +858,20 @@ namespace HuxApp
 		const int level_row = find_level_row(id);
 		if (level_row >= 0)
 		{
+			const LevelListModel::LevelRow& level_list_row = m_level_list_model.m_level_rows[level_row];
 			level_info.m_id = id;
-			level_info.m_name = m_level_list_model.item(level_row)->text();
-			level_info.m_dir_name = get_level_custom_data(level_row, LevelDataRoles::DIR_NAME).toString();
-			level_info.m_script_name = get_level_custom_data(level_row, LevelDataRoles::SCRIPT_NAME).toString();
+			level_info.m_name = level_list_row.m_name;
+			level_info.m_dir_name = level_list_row.m_dir_name;
+			level_info.m_script_name = level_list_row.m_script_name;
 		}
 
 		return level_info;
 	}
 
-	void ScenarioBrowserModel::add_level()
+	bool ScenarioBrowserModel::add_level()
 	{
-		// Create new unique level name and folder name (start with template)
+		// Create new unique level name and folder name (start with template, the level is not added yet so the invalid ID does not match any level)
 		LevelInfo new_level_info;
-		new_level_info.m_id = m_level_id_counter + 1;
 		new_level_info.m_name = QStringLiteral("New Level");
 		new_level_info.m_script_name = new_level_info.m_name;
 		new_level_info.m_dir_name = QStringLiteral("New_Level");
@@ -494,16 +892,35 @@ namespace HuxApp
 		new_level.set_script_name(new_level_info.m_script_name);
 		new_level.set_dir_name(new_level_info.m_dir_name);
 
-		QStandardItem* new_level_item = add_level_internal(new_level);
-		set_level_custom_data(new_level_item, LevelDataRoles::MODIFIED, true);
+		if (!add_level_internal(std::move(new_level), m_level_list_model.rowCount(), true))
+		{
+			return false;
+		}
+		scenario_modified_internal();
+		return true;
+	}
+
+	bool ScenarioBrowserModel::insert_level(int row, Level level)
+	{
+		if ((row >= 0) && (row <= m_level_list_model.rowCount()))
+		{
+			if (!add_level_internal(std::move(level), row, true))
+			{
+				return false;
+			}
+			scenario_modified_internal();
+		}
+		return true;
 	}
 
 	void ScenarioBrowserModel::remove_level(const QModelIndex& index)
 	{
-		if (const LevelModel* removed_level = get_level_model(index))
+		if (m_level_list_model.checkIndex(index, QAbstractItemModel::CheckIndexOption::IndexIsValid))
 		{
-			m_level_list_model.removeRow(index.row());
-			m_level_pool.erase(removed_level->get_id());
+			const int removed_level_id = get_level_id(index.row());
+			m_level_list_model.remove_level(index.row());
+			m_level_pool.erase(removed_level_id);
+			m_unloaded_levels.erase(removed_level_id);
 			scenario_modified_internal();
 		}
 	}
@@ -517,11 +934,11 @@ namespace HuxApp
 			const int level_row = find_level_row(info.m_id);
 			if (level_row >= 0)
 			{
-				m_level_list_model.item(level_row)->setText(info.m_name);
-				set_level_custom_data(level_row, LevelDataRoles::DIR_NAME, info.m_dir_name);
-				set_level_custom_data(level_row, LevelDataRoles::SCRIPT_NAME, info.m_script_name);
+				const LevelInfo previous_info = get_level_info(info.m_id);
+				m_level_list_model.update_level(level_row, info);
 
 				level_modified(info.m_id);
+				emit(level_data_updated(info.m_id, previous_info));
 				return true;
 			}
 			else
@@ -533,16 +950,28 @@ namespace HuxApp
 		return false;
 	}
 
-	void ScenarioBrowserModel::update_terminal_data(const TerminalID& terminal_id, const Terminal& data)
+	bool ScenarioBrowserModel::update_terminal_data(const TerminalID& terminal_id, const Terminal& data)
 	{
-		if (terminal_id.is_valid())
+		if (is_terminal_valid(terminal_id))
 		{
-			if (LevelModel* level_model = get_level_model(terminal_id.m_level_id))
-			{
-				level_model->update_terminal_data(terminal_id, data);
-				terminal_modified(terminal_id.m_level_id, terminal_id.m_terminal_id);
-			}
+			LevelModel* level_model = get_level_model(terminal_id.m_level_id);
+
+			// Keep the previous data for the listeners (only shares it, so this is cheap)
+			const Terminal previous_data = *level_model->get_terminal(terminal_id);
+			level_model->update_terminal_data(terminal_id, data);
+			++m_revision;
+			emit(terminal_data_updated(terminal_id.m_level_id, terminal_id.m_terminal_id, previous_data));
+			terminal_modified(terminal_id.m_level_id, terminal_id.m_terminal_id);
+			return true;
 		}
+		return false;
+	}
+
+	bool ScenarioBrowserModel::is_terminal_valid(const TerminalID& terminal_id) const
+	{
+		// The level has to be loaded for its terminals to have IDs
+		const LevelModel* level_model = terminal_id.is_valid() ? get_level_model(terminal_id.m_level_id) : nullptr;
+		return level_model && (level_model->find_terminal_row(terminal_id) >= 0);
 	}
 
 	void ScenarioBrowserModel::copy_terminals(int level_id, const QModelIndexList& terminal_indices)
@@ -553,89 +982,165 @@ namespace HuxApp
 		}
 	}
 
-	void ScenarioBrowserModel::paste_terminals(int level_id, const QModelIndexList& terminal_indices)
+	bool ScenarioBrowserModel::paste_terminals(int level_id, const QModelIndexList& terminal_indices)
 	{
 		if (LevelModel* level_model = get_level_model(level_id))
 		{
-			level_model->paste_terminals(m_terminal_clipboard, terminal_indices);
+			return level_model->paste_terminals(m_terminal_clipboard, terminal_indices);
 		}
+		return true;
 	}
 
 	void ScenarioBrowserModel::clear_modified()
 	{
-		// Clear the flag in the model items
-		for (int current_row = 0; current_row < m_level_list_model.rowCount(); ++current_row)
+		ScopedModelTransaction<LevelListModel> transaction(m_level_list_model);
+
+		// Clear the flag in the level list
+		if (m_level_list_model.rowCount() > 0)
 		{
-			set_level_custom_data(current_row, LevelDataRoles::MODIFIED, false);
+			m_level_list_model.set_rows_modified(0, m_level_list_model.rowCount() - 1, false);
 		}
 
 		// Clear the state in the level objects
-		for (auto& current_level_pair : m_level_pool)
+		for (const std::unique_ptr<LevelModel>& current_level_model : m_level_pool)
 		{
-			current_level_pair.second.clear_modified();
+			if (current_level_model)
+			{
+				current_level_model->clear_modified();
+			}
 		}
 
 		// Clear the flag
 		m_modified = false;
 	}
 
+	int ScenarioBrowserModel::report_memory(MemoryReport& report, int parent) const
+	{
+		const int browser_entry = report.add_entry(QStringLiteral("Scenario browser"), parent);
+		report.add_bytes(browser_entry, MemoryReport::Category::STRUCTURE, sizeof(ScenarioBrowserModel));
+		report.add_slot_map(browser_entry, m_level_pool);
+		report.add_hash_map(browser_entry, m_unloaded_levels);
+
+		// Report the levels in the displayed order
+		for (const LevelListModel::LevelRow& current_level_row : m_level_list_model.m_level_rows)
+		{
+			const int level_id = current_level_row.m_id;
+			if (const LevelModel* level_model = get_level_model(level_id))
+			{
+				level_model->report_memory(report, current_level_row.m_name, browser_entry);
+				continue;
+			}
+
+			auto unloaded_level_it = m_unloaded_levels.find(level_id);
+			if (unloaded_level_it != m_unloaded_levels.end())
+			{
+				report.add_level(unloaded_level_it->second, browser_entry);
+			}
+		}
+
+		// Added after the levels, so the strings shared with the level data are not counted twice
+		const int level_list_entry = report.add_entry(QStringLiteral("Level list"), browser_entry);
+		report.add_bytes(level_list_entry, MemoryReport::Category::MODEL, m_level_list_model.m_level_rows.capacity() * sizeof(LevelListModel::LevelRow));
+		for (const LevelListModel::LevelRow& current_level_row : m_level_list_model.m_level_rows)
+		{
+			report.add_string(level_list_entry, MemoryReport::Category::MODEL, current_level_row.m_name);
+			report.add_string(level_list_entry, MemoryReport::Category::MODEL, current_level_row.m_dir_name);
+			report.add_string(level_list_entry, MemoryReport::Category::MODEL, current_level_row.m_script_name);
+		}
+
+		if (!m_terminal_clipboard.empty())
+		{
+			const int clipboard_entry = report.add_entry(QStringLiteral("Terminal clipboard"), browser_entry);
+			report.add_vector(clipboard_entry, m_terminal_clipboard);
+
+			int terminal_index = 0;
+			for (const Terminal& current_terminal : m_terminal_clipboard)
+			{
+				report.add_terminal(current_terminal, LevelModel::get_terminal_label(terminal_index, current_terminal), clipboard_entry);
+				++terminal_index;
+			}
+		}
+		return browser_entry;
+	}
+
+	void ScenarioBrowserModel::mark_levels_modified(const QList<int>& level_rows)
+	{
+		// The rows are merged into ranges, and the scenario change is only signalled once
+		ScopedModelTransaction<LevelListModel> transaction(m_level_list_model);
+		for (int current_row : level_rows)
+		{
+			// Setting the level flag will also signal the scenario change
+			m_level_list_model.set_rows_modified(current_row, current_row, true);
+		}
+	}
+
 	void ScenarioBrowserModel::clear_internal()
 	{
 		// Clear the models and the clipboard
-		m_level_pool.clear();
 		m_level_list_model.clear();
+		m_level_pool.clear(); // The slots are kept, so the IDs of the previous scenario stay invalid
+		m_unloaded_levels.clear();
 		m_terminal_clipboard.clear();
 
-		// Reset the ID counter (IDs start from 1, 0 is considered an invalid ID)
-		m_level_id_counter = 0;
-
 		// Clear the flag
 		m_modified = false;
 	}
 
-	QStandardItem* ScenarioBrowserModel::add_level_internal(const Level& level)
+	bool ScenarioBrowserModel::add_level_internal(Level level, int row, bool modified)
 	{
-		// Prepare a model for the level
-		const int level_id = m_level_id_counter++;
-		LevelModel& level_model = m_level_pool.emplace(std::piecewise_construct, std::forward_as_tuple(level_id), std::forward_as_tuple(level_id, level.get_terminals())).first->second;
-
-		// Add an item to the level list model
-		LevelStandardItem* level_standard_item = new LevelStandardItem(level_id, level);
-		m_level_list_model.appendRow(level_standard_item);
-
-		connect(&level_model, &LevelModel::level_modified, this, &ScenarioBrowserModel::level_modified);
-		connect(&level_model, &LevelModel::terminals_removed, this, &ScenarioBrowserModel::terminals_removed);
-
-		return level_standard_item;
-	}
+		// Reserve the ID (the model is only created once the level is loaded)
+		const int level_id = m_level_pool.insert(nullptr);
+		if (level_id == Utils::SlotMap<std::unique_ptr<LevelModel>>::INVALID_HANDLE)
+		{
+			return false;
+		}
 
-	QVariant ScenarioBrowserModel::get_level_custom_data(int row, LevelDataRoles role) const { return m_level_list_model.data(m_level_list_model.index(row, 0), Utils::to_integral(role)); }
+		// Levels with too many terminals for a model are kept as they are (same as the unloaded levels, which get a model once opened)
+		if (level.is_loaded() && (level.get_terminal_count() <= static_cast<int>(LevelModel::MAX_TERMINAL_COUNT)))
+		{
+			// Prepare a model for the level (only the terminals are moved, the attributes are still needed for the row)
+			create_level_model(level_id, std::move(level.get_terminals()));
 
-	QVariant ScenarioBrowserModel::get_level_custom_data(const QStandardItem* item, LevelDataRoles role) const 
-	{
-		if (item)
+			// Add a row to the level list model
+			m_level_list_model.insert_level(row, level_id, level, modified);
+		}
+		else
 		{
-			return item->data(Utils::to_integral(role));
+			// Store the level until its contents are needed, then add a row to the level list model
+			const Level& unloaded_level = m_unloaded_levels.emplace(level_id, std::move(level)).first->second;
+			m_level_list_model.insert_level(row, level_id, unloaded_level, modified);
 		}
-
-		return QVariant();
+		return true;
 	}
 
-	void ScenarioBrowserModel::set_level_custom_data(int row, LevelDataRoles role, const QVariant& data) { m_level_list_model.setData(m_level_list_model.index(row, 0), data, Utils::to_integral(role)); }
-
-	void ScenarioBrowserModel::set_level_custom_data(QStandardItem* item, LevelDataRoles role, const QVariant& data) 
+	LevelModel& ScenarioBrowserModel::create_level_model(int level_id, std::vector<Terminal> terminals)
 	{
-		if (item)
-		{
-			item->setData(data, Utils::to_integral(role));
-		}
+		HUX_TRACE_SCOPE("model", "create_level_model");
+		std::unique_ptr<LevelModel>& level_model_ptr = *m_level_pool.get(level_id);
+		level_model_ptr = std::make_unique<LevelModel>(level_id, std::move(terminals));
+		LevelModel& level_model = *level_model_ptr;
+
+		connect(&level_model, &LevelModel::level_modified, this, &ScenarioBrowserModel::level_modified);
+		connect(&level_model, &LevelModel::terminals_removed, this, &ScenarioBrowserModel::terminals_removed);
+		connect_revision_signals(level_model);
+
+		connect(&level_model, &QAbstractItemModel::rowsInserted, this,
+			[this, level_id](const QModelIndex&, int first, int last) { emit(terminal_rows_inserted(level_id, first, last)); });
+		connect(&level_model, &QAbstractItemModel::rowsAboutToBeRemoved, this,
+			[this, level_id](const QModelIndex&, int first, int last) { emit(terminal_rows_about_to_be_removed(level_id, first, last)); });
+		connect(&level_model, &QAbstractItemModel::rowsRemoved, this,
+			[this, level_id](const QModelIndex&, int first, int last) { emit(terminal_rows_removed(level_id, first, last)); });
+		connect(&level_model, &QAbstractItemModel::rowsMoved, this,
+			[this, level_id](const QModelIndex&, int first, int last, const QModelIndex&, int destination_row) { emit(terminal_rows_moved(level_id, first, last, destination_row)); });
+
+		return level_model;
 	}
 
 	int ScenarioBrowserModel::find_level_row(int level_id) const
 	{
 		for (int current_row = 0; current_row < m_level_list_model.rowCount(); ++current_row)
 		{
-			if (get_level_custom_data(current_row, LevelDataRoles::LEVEL_ID).toInt() == level_id)
+			if (m_level_list_model.m_level_rows[current_row].m_id == level_id)
 			{
 				return current_row;
 			}
@@ -643,8 +1148,33 @@ namespace HuxApp
 		return -1;
 	}
 
+	int ScenarioBrowserModel::get_level_id(int row) const
+	{
+		if ((row >= 0) && (row < m_level_list_model.rowCount()))
+		{
+			return m_level_list_model.m_level_rows[row].m_id;
+		}
+		return -1;
+	}
+
+	bool ScenarioBrowserModel::is_level_loaded(int id) const
+	{
+		return (m_unloaded_levels.find(id) == m_unloaded_levels.end());
+	}
+
+	void ScenarioBrowserModel::connect_revision_signals(QAbstractItemModel& model)
+	{
+		// Any change to the model contents counts as a new revision (including drag & drop, which bypasses our own edit functions)
+		auto increment_revision = [this]() { ++m_revision; };
+		connect(&model, &QAbstractItemModel::dataChanged, this, increment_revision);
+		connect(&model, &QAbstractItemModel::rowsInserted, this, increment_revision);
+		connect(&model, &QAbstractItemModel::rowsRemoved, this, increment_revision);
+		connect(&model, &QAbstractItemModel::rowsMoved, this, increment_revision);
+	}
+
 	void ScenarioBrowserModel::scenario_modified_internal()
 	{
+		++m_revision;
 		m_modified = true;
 		emit(scenario_modified());
 	}
@@ -654,16 +1184,8 @@ namespace HuxApp
 		const int level_row = find_level_row(level_id);
 		if (level_row >= 0)
 		{
-			// Setting the level data will also signal the scenario change
-			set_level_custom_data(level_row, LevelDataRoles::MODIFIED, true);
-		}
-	}
-
-	void ScenarioBrowserModel::level_item_changed(QStandardItem* item)
-	{
-		if (get_level_custom_data(item, LevelDataRoles::MODIFIED).toBool())
-		{
-			scenario_modified_internal();
+			// Setting the level flag will also signal the scenario change
+			m_level_list_model.set_rows_modified(level_row, level_row, true);
 		}
 	}
 
@@ -675,17 +1197,13 @@ namespace HuxApp
 			return false;
 		}
 		// Make sure the name is unique
-		QList<QStandardItem*> matched_levels = m_level_list_model.findItems(info.m_name);
-		if (!matched_levels.isEmpty())
+		for (const LevelListModel::LevelRow& current_level_row : m_level_list_model.m_level_rows)
 		{
-			for (QStandardItem* current_level_item : matched_levels)
+			if ((current_level_row.m_id != info.m_id) && (current_level_row.m_name == info.m_name))
 			{
-				if (get_level_custom_data(current_level_item->row(), LevelDataRoles::LEVEL_ID).toInt() != info.m_id)
-				{
-					// Found a level other than the one we just edited having the same name
-					error_msg = QStringLiteral("level name must be unique");
-					return false;
-				}
+				// Found a level other than the one we just edited having the same name
+				error_msg = QStringLiteral("level name must be unique");
+				return false;
 			}
 		}
 		return true;
@@ -711,11 +1229,9 @@ namespace HuxApp
 		}
 
 		// Make sure the folder name is unique
-		for (int current_row = 0; current_row < m_level_list_model.rowCount(); ++current_row)
+		for (const LevelListModel::LevelRow& current_level_row : m_level_list_model.m_level_rows)
 		{
-			const int current_level_id = get_level_custom_data(current_row, LevelDataRoles::LEVEL_ID).toInt();
-			const QString current_level_folder_name = get_level_custom_data(current_row, LevelDataRoles::DIR_NAME).toString();
-			if ((current_level_id != info.m_id) && (current_level_folder_name == info.m_dir_name))
+			if ((current_level_row.m_id != info.m_id) && (current_level_row.m_dir_name == info.m_dir_name))
 			{
 				// Found a level other than the one we just edited having the same folder name
 				error_msg = QStringLiteral("folder name must be unique");
@@ -1,12 +1,20 @@
 #pragma once
-#include <HuxQt/Scenario/Terminal.h>
+#include <HuxQt/Scenario/Level.h>
+#include <HuxQt/Utils/SlotMap.h>
 
-#include <QStandardItemModel>
+#include <QAbstractListModel>
+
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace HuxApp
 {
 	class Scenario;
-	class Level;
+	class MemoryReport;
 
 	struct TerminalID;
 
@@ -18,7 +26,49 @@ namespace HuxApp
 		QString m_script_name;
 	};
 
-	class LevelModel : public QStandardItemModel
+	// Collects the data changes made during a model transaction, so they can be signalled once per contiguous row range when it is committed
+	class ModelChangeBatch
+	{
+	public:
+		struct RowRange
+		{
+			int m_first_row;
+			int m_last_row;
+		};
+
+		void begin() { ++m_depth; }
+		bool end() { assert(m_depth > 0); return (--m_depth == 0); } // Returns true if the outermost transaction ended
+		bool is_active() const { return (m_depth > 0); }
+
+		void add_changed_rows(int first_row, int last_row, const QList<int>& roles);
+		std::vector<RowRange> take_changed_rows(QList<int>& roles); // Adjacent and overlapping ranges are merged (the roles are the union of all the changes)
+
+		void set_modified() { m_modified = true; }
+		bool take_modified() { return std::exchange(m_modified, false); }
+	private:
+		int m_depth = 0;
+		bool m_modified = false;
+		std::vector<RowRange> m_changed_rows;
+		QList<int> m_changed_roles;
+	};
+
+	// Begins a transaction on the model, and commits it when going out of scope
+	template<typename MODEL>
+	class ScopedModelTransaction
+	{
+	public:
+		explicit ScopedModelTransaction(MODEL& model) : m_model(model) { m_model.begin_transaction(); }
+		~ScopedModelTransaction() { m_model.commit_transaction(); }
+
+		ScopedModelTransaction(const ScopedModelTransaction&) = delete;
+		ScopedModelTransaction& operator=(const ScopedModelTransaction&) = delete;
+	private:
+		MODEL& m_model;
+	};
+
+	// Flat list of the terminals in a level (the terminal data is kept in a pool, so the rows can move without invalidating it)
+	// Terminal IDs are pool handles, so IDs of removed terminals are never valid again
+	class LevelModel : public QAbstractListModel
 	{
 		Q_OBJECT
 	public:
@@ -28,36 +78,65 @@ namespace HuxApp
 			MODIFIED
 		};
 
-		LevelModel(int id, const std::vector<Terminal>& terminals);
+		static constexpr size_t MAX_TERMINAL_COUNT = Utils::SlotMap<Terminal>::MAX_SLOT_COUNT; // Levels with more terminals cannot be opened in the browser
+
+		LevelModel(int id, std::vector<Terminal> terminals); // Expects at most MAX_TERMINAL_COUNT terminals
 
 		int get_id() const { return m_id; }
 
 		int find_terminal_row(const TerminalID& terminal_id) const;
-		const Terminal* get_terminal(const TerminalID& terminal_id) const;
+		int get_terminal_id(int row) const { return m_terminal_rows[row].m_id; }
+		const Terminal* get_terminal(const TerminalID& terminal_id) const; // Only valid until terminals are added or removed
 
-		void add_terminal();
+		static QString get_terminal_label(int terminal_id, const Terminal& terminal_data); // Name of the terminal, or its slot if it has none (the generation of the ID is meaningless to the user)
+
+		// Adding terminals returns false if the level cannot hold any more of them (nothing is added)
+		bool add_terminal();
 		std::vector<Terminal> copy_terminals(const QModelIndexList& terminal_indices);
-		void paste_terminals(const std::vector<Terminal>& terminals, const QModelIndexList& terminal_indices);
+		bool paste_terminals(const std::vector<Terminal>& terminals, const QModelIndexList& terminal_indices);
 		void remove_terminals(const QModelIndexList& terminal_indices);
 
-		QVariant get_custom_data(int row, TerminalDataRoles role) const;
-		QVariant get_custom_data(const QStandardItem* item, TerminalDataRoles role) const;
-
-		void set_custom_data(int row, TerminalDataRoles role, const QVariant& data);
-		void set_custom_data(QStandardItem* item, TerminalDataRoles role, const QVariant& data);
+		// Positional edits (e.g to restore a previous state of the level), the affected terminals count as modified
+		bool insert_terminals(int row, std::vector<Terminal> terminals);
+		void remove_terminal_rows(int first_row, int last_row);
 
 		void export_level_contents(Level& level) const;
 
 		void clear_modified();
+
+		// Changes made during a transaction are signalled on commit (one dataChanged per contiguous row range and a single level_modified), transactions can be nested
+		void begin_transaction() { m_change_batch.begin(); }
+		void commit_transaction();
+
+		void report_memory(MemoryReport& report, const QString& name, int parent) const;
+
+		bool is_terminal_row_index_consistent() const; // Debug check that the row index matches the model contents (full scan, asserted after each rebuild or mutation)
+
+		int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+		QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+		Qt::ItemFlags flags(const QModelIndex& index) const override;
+		Qt::DropActions supportedDropActions() const override;
+		bool moveRows(const QModelIndex& source_parent, int source_row, int count, const QModelIndex& destination_parent, int destination_child) override; // Used by the views for drag & drop
 	signals:
 		void level_modified(int id);
 		void terminals_removed(int level_id, const QList<int>& terminal_ids);
 	private:
-		void connect_signals();
+		struct TerminalRow
+		{
+			int m_id = -1;
+			QString m_label;
+			bool m_modified = false;
+		};
 
-		QStandardItem* add_terminal_internal(const Terminal& terminal);
+		bool insert_rows(int row, std::vector<Terminal> terminals, bool modified); // Takes the terminals by value so callers can move them into the pool, returns false if they do not fit
+		void remove_rows(int first_row, int last_row, QList<int>& removed_terminal_ids);
 		void update_terminal_data(const TerminalID& terminal_id, const Terminal& terminal_data);
-		void terminal_item_changed(QStandardItem* item);
+		void set_rows_modified(int first_row, int last_row, bool modified);
+
+		void rows_changed(int first_row, int last_row, const QList<int>& roles);
+		void flush_changed_rows(); // Has to be called before removing or moving rows (the pending ranges would no longer match the rows)
+
+		void ensure_terminal_row_index() const;
 
 		const Terminal* get_terminal_internal(int terminal_id) const;
 		const Terminal* get_terminal_internal(const QModelIndex& index) const;
@@ -65,14 +144,20 @@ namespace HuxApp
 		void level_modified_internal();
 
 		int m_id;
-		int m_terminal_id_counter;
-		std::unordered_map<int, Terminal> m_terminal_pool;
-		bool m_signal_lock;
+		std::vector<TerminalRow> m_terminal_rows;
+		Utils::SlotMap<Terminal> m_terminal_pool;
+
+		// Maps terminal IDs to model rows (appends and tail removals are applied directly, other changes trigger a rebuild on the next lookup)
+		mutable std::unordered_map<int, int> m_terminal_row_index;
+		mutable bool m_terminal_row_index_dirty;
+
+		ModelChangeBatch m_change_batch;
 
 		friend class ScenarioBrowserModel;
 	};
 
-	class ScenarioBrowserModel : public QObject
+	// Flat list of the levels in the scenario (the contents are in the level models, this only holds what the list displays)
+	class LevelListModel : public QAbstractListModel
 	{
 		Q_OBJECT
 	public:
@@ -84,8 +169,56 @@ namespace HuxApp
 			SCRIPT_NAME
 		};
 
+		int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+		QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+		Qt::ItemFlags flags(const QModelIndex& index) const override;
+		Qt::DropActions supportedDropActions() const override;
+		bool moveRows(const QModelIndex& source_parent, int source_row, int count, const QModelIndex& destination_parent, int destination_child) override; // Used by the views for drag & drop
+
+		// Same as the level model transactions (a single levels_modified is sent on commit)
+		void begin_transaction() { m_change_batch.begin(); }
+		void commit_transaction();
+	signals:
+		void levels_modified();
+	private:
+		struct LevelRow
+		{
+			int m_id = -1;
+			QString m_name;
+			QString m_dir_name;
+			QString m_script_name;
+			bool m_modified = false;
+		};
+
+		void insert_level(int row, int level_id, const Level& level, bool modified);
+		void remove_level(int row);
+		void update_level(int row, const LevelInfo& info);
+		void set_rows_modified(int first_row, int last_row, bool modified);
+		void clear();
+
+		void rows_changed(int first_row, int last_row, const QList<int>& roles);
+		void flush_changed_rows();
+		void levels_modified_internal();
+
+		std::vector<LevelRow> m_level_rows;
+		ModelChangeBatch m_change_batch;
+
+		friend class ScenarioBrowserModel;
+	};
+
+	class ScenarioBrowserModel : public QObject
+	{
+		Q_OBJECT
+	public:
+		using LevelDataRoles = LevelListModel::LevelDataRoles;
+
+		// Used to deserialize lazily loaded levels the first time their contents are needed (returns false if the level could not be loaded, in which case it stays unloaded)
+		using LevelLoader = std::function<bool(Level&)>;
+
 		ScenarioBrowserModel(QObject* parent = nullptr);
 
+		void set_level_loader(const LevelLoader& loader) { m_level_loader = loader; }
+
 		void set_name(const QString& name) { m_name = name; emit(scenario_name_changed()); }
 		const QString& get_name() const { return m_name; }
 
@@ -97,11 +230,20 @@ namespace HuxApp
 
 		bool is_modified() const { return m_modified; }
 
-		void load_scenario(const Scenario& scenario);
-		Scenario export_scenario() const;
+		// Incremented on every change to the model contents (used to check whether an exported snapshot is still up to date)
+		quint64 get_revision() const { return m_revision; }
+
+		bool load_scenario(Scenario scenario); // Pass an rvalue to move the scenario contents into the models, returns false if there are too many levels (the model is left empty)
+		Scenario export_scenario() const; // Levels which were not loaded yet are exported as-is
+		Level export_level(int row) const;
+
+		LevelListModel& get_level_list() { return m_level_list_model; }
 
-		QStandardItemModel& get_level_list() { return m_level_list_model; }
+		// Groups changes to the level list (e.g the flags of many levels), so the views get one update per row range and a single scenario_modified is sent
+		void begin_transaction() { m_level_list_model.begin_transaction(); }
+		void commit_transaction() { m_level_list_model.commit_transaction(); }
 		
+		// The non-const getters create the level model on demand (i.e if the level was not loaded yet), null if the level could not be loaded
 		const LevelModel* get_level_model(int id) const;
 		LevelModel* get_level_model(int id);
 
@@ -109,39 +251,55 @@ namespace HuxApp
 		LevelModel* get_level_model(const QModelIndex& index);
 
 		LevelInfo get_level_info(int id) const;
+		int find_level_row(int level_id) const;
+		int get_level_id(int row) const;
+		bool is_level_loaded(int id) const;
 
-		void add_level();
+		// Adding levels returns false if the model cannot hold any more of them (nothing is added)
+		bool add_level();
+		bool insert_level(int row, Level level); // Adds the level at the given row (e.g to restore a removed level), the level counts as modified
 		void remove_level(const QModelIndex& index);
 
 		bool update_level_data(const LevelInfo& info, QString& error_msg);
-		void update_terminal_data(const TerminalID& terminal_id, const Terminal& data);
+		bool update_terminal_data(const TerminalID& terminal_id, const Terminal& data); // Returns false if the terminal no longer exists
+
+		bool is_terminal_valid(const TerminalID& terminal_id) const; // Stale IDs (e.g of removed terminals or levels) are never valid again
 
 		void copy_terminals(int level_id, const QModelIndexList& terminal_indices);
-		void paste_terminals(int level_id, const QModelIndexList& terminal_indices);
+		bool paste_terminals(int level_id, const QModelIndexList& terminal_indices); // Returns false if the level cannot hold the terminals
 
 		void clear_modified();
+		void mark_levels_modified(const QList<int>& level_rows);
 
 		std::vector<Terminal>& get_terminal_clipboard() { return m_terminal_clipboard; }
+
+		int report_memory(MemoryReport& report, int parent = -1) const; // Models, unloaded levels and the clipboard (returns the report entry)
 	signals:
 		void scenario_name_changed();
 		void scenario_modified();
+		void level_loaded(int level_id); // The contents of a lazily loaded level were deserialized (its terminals now have IDs)
 		void terminal_modified(int level_id, int terminal_id);
 		void terminals_removed(int level_id, const QList<int>& terminal_ids);
+
+		// Sent after the data was replaced (before terminal_modified), with the data it had before
+		void terminal_data_updated(int level_id, int terminal_id, const Terminal& previous_data);
+		void level_data_updated(int level_id, const LevelInfo& previous_info);
+
+		// Row-level changes in the level models (includes drag & drop)
+		void terminal_rows_inserted(int level_id, int first_row, int last_row);
+		void terminal_rows_about_to_be_removed(int level_id, int first_row, int last_row); // The terminals can still be accessed
+		void terminal_rows_removed(int level_id, int first_row, int last_row);
+		void terminal_rows_moved(int level_id, int first_row, int last_row, int destination_row); // Destination is the row before the move
 	private:
 		void clear_internal();
 
-		QStandardItem* add_level_internal(const Level& level);
-
-		QVariant get_level_custom_data(int row, LevelDataRoles role) const;
-		QVariant get_level_custom_data(const QStandardItem* item, LevelDataRoles role) const;
-		void set_level_custom_data(int row, LevelDataRoles role, const QVariant& data);
-		void set_level_custom_data(QStandardItem* item, LevelDataRoles role, const QVariant& data);
+		bool add_level_internal(Level level, int row, bool modified);
+		LevelModel& create_level_model(int level_id, std::vector<Terminal> terminals);
 
-		int find_level_row(int level_id) const;
+		void connect_revision_signals(QAbstractItemModel& model);
 
 		void scenario_modified_internal();
 		void level_modified(int level_id);
-		void level_item_changed(QStandardItem* item);
 
 		bool validate_level_name(const LevelInfo& info, QString& error_msg);
 		bool validate_level_script_name(const LevelInfo& info, QString& error_msg);
@@ -151,11 +309,13 @@ namespace HuxApp
 		QString m_file_name;
 		QString m_path;
 
-		int m_level_id_counter = 0;
 		bool m_modified = false;
+		quint64 m_revision = 0;
 
-		QStandardItemModel m_level_list_model;
-		std::unordered_map<int, LevelModel> m_level_pool;
+		LevelListModel m_level_list_model;
+		Utils::SlotMap<std::unique_ptr<LevelModel>> m_level_pool; // Level IDs are the handles (the model is null until the level is loaded)
+		std::unordered_map<int, Level> m_unloaded_levels;
+		LevelLoader m_level_loader;
 		std::vector<Terminal> m_terminal_clipboard;
 	};
 }
\ No newline at end of file
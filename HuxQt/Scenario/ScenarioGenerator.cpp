@@ -0,0 +1,250 @@
+#include <HuxQt/Scenario/ScenarioGenerator.h>
+
+#include <HuxQt/Scenario/AOText.h>
+#include <HuxQt/Scenario/Diagnostics.h>
+
+#include <QColor>
+#include <QDir>
+#include <QImage>
+#include <QStringList>
+
+#include <algorithm>
+#include <iterator>
+
+namespace HuxApp
+{
+	namespace
+	{
+		constexpr const char* WORD_ARRAY[] = {
+			"the", "ship", "Durandal", "Pfhor", "security", "sector", "compiler", "reactor", "teleport",
+			"marine", "we", "have", "detected", "a", "breach", "in", "lower", "decks", "proceed", "to",
+			"terminal", "access", "granted", "S'pht", "alien", "Tycho", "Leela", "engine", "mission", "objective",
+			"core", "-", "shields", "at", "percent", "/", "transmission", "interrupted", "coordinates", "+"
+		};
+
+		constexpr const char* FORMATTING_TAG_ARRAY[] = { "$B", "$b", "$I", "$i", "$U", "$u", "$C0", "$C1", "$C2", "$C3", "$C4", "$C5", "$C6", "$C7" };
+
+		constexpr const char* TELEPORT_PATTERN_NAMES[Utils::to_integral(ScenarioGenerator::TeleportPattern::PATTERN_COUNT)] = {
+			"none",
+			"next",
+			"random",
+			"intralevel",
+			"mixed"
+		};
+
+		constexpr int MAX_POLYGON_INDEX = 1024; // For intralevel teleports (only needs to be plausible)
+		constexpr int PICT_WIDTH = 320;
+		constexpr int PICT_HEIGHT = 240;
+
+		template<typename ARRAY>
+		const char* pick(QRandomGenerator& generator, const ARRAY& array)
+		{
+			return array[generator.bounded(static_cast<int>(std::size(array)))];
+		}
+
+		int bounded_range(QRandomGenerator& generator, int min_value, int max_value)
+		{
+			return (max_value > min_value) ? generator.bounded(min_value, max_value + 1) : min_value;
+		}
+	}
+
+	ScenarioGenerator::ScenarioGenerator(const Config& config)
+		: m_config(config)
+	{
+	}
+
+	Scenario ScenarioGenerator::generate_scenario() const
+	{
+		QRandomGenerator generator(m_config.m_seed);
+
+		Scenario scenario;
+		scenario.set_name(QStringLiteral("Generated_%1").arg(m_config.m_seed));
+
+		std::vector<Level> levels(m_config.m_level_count);
+		for (int level_index = 0; level_index < m_config.m_level_count; ++level_index)
+		{
+			// Prefix the folders with the index, like in split folders
+			Level& current_level = levels[level_index];
+			const QString level_name = QStringLiteral("Level %1").arg(level_index + 1);
+			current_level.set_name(level_name);
+			current_level.set_dir_name(QStringLiteral("%1 %2").arg(level_index, 2, 10, QChar('0')).arg(level_name));
+			current_level.set_script_name(level_name);
+
+			std::vector<Terminal>& terminals = current_level.get_terminals();
+			terminals.reserve(m_config.m_terminals_per_level);
+			for (int terminal_index = 0; terminal_index < m_config.m_terminals_per_level; ++terminal_index)
+			{
+				terminals.push_back(generate_terminal(generator, level_index));
+			}
+		}
+
+		scenario.set_levels(std::move(levels));
+		return scenario;
+	}
+
+	QString ScenarioGenerator::generate_text(QRandomGenerator& generator, int line_count) const
+	{
+		QStringList lines;
+		for (int line_index = 0; line_index < line_count; ++line_index)
+		{
+			const int line_length = bounded_range(generator, m_config.m_min_line_length, m_config.m_max_line_length);
+
+			QString line;
+			int visible_length = 0;
+			while (visible_length < line_length)
+			{
+				if (visible_length > 0)
+				{
+					line += ' ';
+					++visible_length;
+				}
+
+				if (generator.generateDouble() < m_config.m_tag_density)
+				{
+					line += QLatin1String(pick(generator, FORMATTING_TAG_ARRAY));
+				}
+
+				const QLatin1String word(pick(generator, WORD_ARRAY));
+				line += word;
+				visible_length += word.size();
+			}
+			lines << line;
+		}
+		return lines.join('\n');
+	}
+
+	bool ScenarioGenerator::write_pict_resources(const QString& split_folder_path, Diagnostics& diagnostics) const
+	{
+		const QString pict_path = split_folder_path + "/Resources/PICT";
+		if (!QDir().mkpath(pict_path))
+		{
+			diagnostics.add_error(QStringLiteral("Unable to create directory \"%1\"!").arg(pict_path));
+			return false;
+		}
+
+		for (int current_resource_id : get_pict_resource_ids())
+		{
+			// Draw a gradient with a distinct hue per image (no fonts, so this also works without a GUI application)
+			QImage pict_image(PICT_WIDTH, PICT_HEIGHT, QImage::Format_RGB32);
+			const int hue = ((current_resource_id - PICT_RESOURCE_BASE_ID) * 47) % 360;
+			for (int y = 0; y < PICT_HEIGHT; ++y)
+			{
+				QRgb* scan_line = reinterpret_cast<QRgb*>(pict_image.scanLine(y));
+				for (int x = 0; x < PICT_WIDTH; ++x)
+				{
+					scan_line[x] = QColor::fromHsv(hue, 255, 64 + ((x + y) * 191) / (PICT_WIDTH + PICT_HEIGHT)).rgb();
+				}
+			}
+
+			const QString image_path = QStringLiteral("%1/%2.png").arg(pict_path).arg(current_resource_id);
+			if (!pict_image.save(image_path))
+			{
+				diagnostics.add_error(QStringLiteral("Unable to write image \"%1\"!").arg(image_path));
+				return false;
+			}
+		}
+		return true;
+	}
+
+	QList<int> ScenarioGenerator::get_pict_resource_ids() const
+	{
+		QList<int> resource_ids;
+		for (int resource_index = 0; resource_index < m_config.m_pict_count; ++resource_index)
+		{
+			resource_ids << (PICT_RESOURCE_BASE_ID + resource_index);
+		}
+		return resource_ids;
+	}
+
+	const char* ScenarioGenerator::get_teleport_pattern_name(TeleportPattern pattern)
+	{
+		return TELEPORT_PATTERN_NAMES[Utils::to_integral(pattern)];
+	}
+
+	ScenarioGenerator::TeleportPattern ScenarioGenerator::get_teleport_pattern(const QString& name)
+	{
+		const auto pattern_it = std::find_if(std::begin(TELEPORT_PATTERN_NAMES), std::end(TELEPORT_PATTERN_NAMES), [&name](const char* pattern_name) { return name == QLatin1String(pattern_name); });
+		return Utils::to_enum<TeleportPattern>(std::distance(std::begin(TELEPORT_PATTERN_NAMES), pattern_it));
+	}
+
+	Terminal ScenarioGenerator::generate_terminal(QRandomGenerator& generator, int level_index) const
+	{
+		Terminal terminal;
+
+		// Logon, the main screens, then logoff
+		Terminal::ScreenVector& unfinished_screens = terminal.get_branch(Terminal::BranchType::UNFINISHED).m_screens;
+		unfinished_screens.push_back(generate_screen(generator, Terminal::ScreenType::LOGON));
+		for (int screen_index = 0; screen_index < m_config.m_screens_per_terminal; ++screen_index)
+		{
+			const bool has_image = (generator.generateDouble() < m_config.m_pict_ratio);
+			unfinished_screens.push_back(generate_screen(generator, has_image ? Terminal::ScreenType::PICT : Terminal::ScreenType::INFORMATION));
+		}
+		unfinished_screens.push_back(generate_screen(generator, Terminal::ScreenType::LOGOFF));
+
+		// Shorter finished branch, which is where the teleports usually are
+		Terminal::Branch& finished_branch = terminal.get_branch(Terminal::BranchType::FINISHED);
+		finished_branch.m_screens.push_back(generate_screen(generator, Terminal::ScreenType::LOGON));
+		finished_branch.m_screens.push_back(generate_screen(generator, Terminal::ScreenType::INFORMATION));
+		finished_branch.m_screens.push_back(generate_screen(generator, Terminal::ScreenType::LOGOFF));
+		finished_branch.m_teleport = generate_teleport(generator, level_index);
+
+		return terminal;
+	}
+
+	Terminal::Screen ScenarioGenerator::generate_screen(QRandomGenerator& generator, Terminal::ScreenType type) const
+	{
+		Terminal::Screen screen;
+		screen.m_type = type;
+
+		int line_count = 0;
+		switch (type)
+		{
+		case Terminal::ScreenType::LOGON:
+		case Terminal::ScreenType::LOGOFF:
+			screen.m_resource_id = PICT_RESOURCE_BASE_ID + generator.bounded(std::max(m_config.m_pict_count, 1));
+			line_count = 1;
+			break;
+		case Terminal::ScreenType::PICT:
+			screen.m_resource_id = PICT_RESOURCE_BASE_ID + generator.bounded(std::max(m_config.m_pict_count, 1));
+			screen.m_alignment = (generator.bounded(2) == 0) ? Terminal::ScreenAlignment::LEFT : Terminal::ScreenAlignment::RIGHT;
+			line_count = bounded_range(generator, m_config.m_min_screen_lines, m_config.m_max_screen_lines);
+			break;
+		default:
+			line_count = bounded_range(generator, m_config.m_min_screen_lines, m_config.m_max_screen_lines);
+			break;
+		}
+
+		screen.m_script = generate_text(generator, line_count);
+		screen.m_display_text = AOText::convert_to_html(screen.m_script, type, AOText::get_default_text_colors());
+		return screen;
+	}
+
+	Terminal::Teleport ScenarioGenerator::generate_teleport(QRandomGenerator& generator, int level_index) const
+	{
+		TeleportPattern pattern = m_config.m_teleport_pattern;
+		if (pattern == TeleportPattern::MIXED)
+		{
+			pattern = Utils::to_enum<TeleportPattern>(generator.bounded(Utils::to_integral(TeleportPattern::MIXED)));
+		}
+
+		Terminal::Teleport teleport;
+		switch (pattern)
+		{
+		case TeleportPattern::NEXT_LEVEL:
+			teleport.m_type = Terminal::TeleportType::INTERLEVEL;
+			teleport.m_index = (level_index + 1) % std::max(m_config.m_level_count, 1);
+			break;
+		case TeleportPattern::RANDOM_LEVEL:
+			teleport.m_type = Terminal::TeleportType::INTERLEVEL;
+			teleport.m_index = generator.bounded(std::max(m_config.m_level_count, 1));
+			break;
+		case TeleportPattern::INTRALEVEL:
+			teleport.m_type = Terminal::TeleportType::INTRALEVEL;
+			teleport.m_index = generator.bounded(MAX_POLYGON_INDEX);
+			break;
+		default:
+			break;
+		}
+		return teleport;
+	}
+}
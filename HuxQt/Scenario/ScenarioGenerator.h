@@ -0,0 +1,66 @@
+#pragma once
+#include <HuxQt/Scenario/Scenario.h>
+
+#include <QRandomGenerator>
+
+namespace HuxApp
+{
+	class Diagnostics;
+
+	// Generates synthetic scenarios for stress and scaling tests (the same config always produces the same scenario)
+	class ScenarioGenerator
+	{
+	public:
+		enum class TeleportPattern
+		{
+			NONE,
+			NEXT_LEVEL, // Finished branch teleports to the next level
+			RANDOM_LEVEL,
+			INTRALEVEL,
+			MIXED, // Any of the above
+			PATTERN_COUNT
+		};
+
+		struct Config
+		{
+			quint32 m_seed = 1;
+
+			int m_level_count = 20;
+			int m_terminals_per_level = 8;
+			int m_screens_per_terminal = 6; // Not counting the logon/logoff screens
+
+			double m_tag_density = 0.25; // Chance of a formatting tag before each word
+			int m_min_line_length = 20; // In characters (not counting the tags)
+			int m_max_line_length = 120;
+			int m_min_screen_lines = 4;
+			int m_max_screen_lines = 20;
+
+			double m_pict_ratio = 0.25; // Share of the screens which have an image
+			int m_pict_count = 8; // Number of distinct PICT resources
+
+			TeleportPattern m_teleport_pattern = TeleportPattern::NEXT_LEVEL;
+		};
+
+		static constexpr int PICT_RESOURCE_BASE_ID = 1000;
+
+		explicit ScenarioGenerator(const Config& config);
+
+		const Config& get_config() const { return m_config; }
+
+		Scenario generate_scenario() const;
+		QString generate_text(QRandomGenerator& generator, int line_count) const;
+
+		// Writes the images referenced by the scenario to "<split folder>/Resources/PICT"
+		bool write_pict_resources(const QString& split_folder_path, Diagnostics& diagnostics) const;
+		QList<int> get_pict_resource_ids() const;
+
+		static const char* get_teleport_pattern_name(TeleportPattern pattern);
+		static TeleportPattern get_teleport_pattern(const QString& name); // Returns PATTERN_COUNT if the name is invalid
+	private:
+		Terminal generate_terminal(QRandomGenerator& generator, int level_index) const;
+		Terminal::Screen generate_screen(QRandomGenerator& generator, Terminal::ScreenType type) const;
+		Terminal::Teleport generate_teleport(QRandomGenerator& generator, int level_index) const;
+
+		Config m_config;
+	};
+}
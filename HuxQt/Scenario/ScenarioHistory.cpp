@@ -0,0 +1,591 @@
+#include <HuxQt/Scenario/ScenarioHistory.h>
+
+#include <HuxQt/Scenario/ScenarioBrowserModel.h>
+#include <HuxQt/Scenario/MemoryReport.h>
+
+#include <QAction>
+#include <QUndoStack>
+
+#include <utility>
+
+namespace HuxApp
+{
+	namespace
+	{
+		// Commands refer to the levels and terminals by row (removing and inserting them again assigns new IDs)
+		class HistoryCommand : public QUndoCommand
+		{
+		public:
+			HistoryCommand(const QString& text, ScenarioBrowserModel& model, QUndoCommand* parent)
+				: QUndoCommand(text, parent)
+				, m_model(model)
+			{
+			}
+
+			virtual void report_memory(MemoryReport& report, int parent) const = 0;
+		protected:
+			LevelModel* get_level_model(int level_row) const
+			{
+				const int level_id = m_model.get_level_id(level_row);
+				return (level_id >= 0) ? m_model.get_level_model(level_id) : nullptr;
+			}
+
+			ScenarioBrowserModel& m_model;
+		};
+
+		// The commands recorded for one operation (e.g removing a selection of terminals)
+		// The edits were already made when the step is pushed, so the first redo is skipped
+		class HistoryStep : public QUndoCommand
+		{
+		public:
+			explicit HistoryStep(bool& applying)
+				: m_applying(applying)
+			{
+			}
+
+			void undo() override
+			{
+				// Changes made by the commands are not recorded
+				const bool was_applying = std::exchange(m_applying, true);
+				QUndoCommand::undo();
+				m_applying = was_applying;
+				update_obsolete();
+			}
+
+			void redo() override
+			{
+				if (std::exchange(m_recorded, false))
+				{
+					return;
+				}
+
+				const bool was_applying = std::exchange(m_applying, true);
+				QUndoCommand::redo();
+				m_applying = was_applying;
+				update_obsolete();
+			}
+		private:
+			void update_obsolete()
+			{
+				// The stack only checks the step itself
+				for (int child_index = 0; child_index < childCount(); ++child_index)
+				{
+					if (child(child_index)->isObsolete())
+					{
+						setObsolete(true);
+						return;
+					}
+				}
+			}
+
+			bool& m_applying;
+			bool m_recorded = true;
+		};
+
+		// Terminals inserted into or removed from a level (the terminals share their data with the model)
+		class TerminalRowsCommand : public HistoryCommand
+		{
+		public:
+			TerminalRowsCommand(ScenarioBrowserModel& model, bool inserted, int level_row, int first_row, std::vector<Terminal> terminals, QUndoCommand* parent)
+				: HistoryCommand(inserted ? QStringLiteral("Add Terminals") : QStringLiteral("Remove Terminals"), model, parent)
+				, m_inserted(inserted)
+				, m_level_row(level_row)
+				, m_first_row(first_row)
+				, m_terminals(std::move(terminals))
+			{
+			}
+
+			void undo() override { m_inserted ? remove_terminals() : insert_terminals(); }
+			void redo() override { m_inserted ? insert_terminals() : remove_terminals(); }
+
+			void report_memory(MemoryReport& report, int parent) const override
+			{
+				const int command_entry = report.add_entry(text(), parent);
+				report.add_bytes(command_entry, MemoryReport::Category::STRUCTURE, sizeof(TerminalRowsCommand));
+				report.add_vector(command_entry, m_terminals);
+
+				int terminal_row = m_first_row;
+				for (const Terminal& current_terminal : m_terminals)
+				{
+					report.add_terminal(current_terminal, QStringLiteral("Terminal %1").arg(terminal_row), command_entry);
+					++terminal_row;
+				}
+			}
+		private:
+			void insert_terminals()
+			{
+				LevelModel* level_model = get_level_model(m_level_row);
+				if (level_model && !level_model->insert_terminals(m_first_row, m_terminals))
+				{
+					// The level is full, the later steps would no longer match it (the stack drops the obsolete step)
+					setObsolete(true);
+				}
+			}
+
+			void remove_terminals()
+			{
+				if (LevelModel* level_model = get_level_model(m_level_row))
+				{
+					level_model->remove_terminal_rows(m_first_row, m_first_row + static_cast<int>(m_terminals.size()) - 1);
+				}
+			}
+
+			const bool m_inserted;
+			const int m_level_row;
+			const int m_first_row;
+			const std::vector<Terminal> m_terminals;
+		};
+
+		// Levels inserted into or removed from the scenario (levels which were not loaded only keep their source)
+		class LevelRowsCommand : public HistoryCommand
+		{
+		public:
+			LevelRowsCommand(ScenarioBrowserModel& model, bool inserted, int first_row, std::vector<Level> levels, QUndoCommand* parent)
+				: HistoryCommand(inserted ? QStringLiteral("Add Levels") : QStringLiteral("Remove Levels"), model, parent)
+				, m_inserted(inserted)
+				, m_first_row(first_row)
+				, m_levels(std::move(levels))
+			{
+			}
+
+			void undo() override { m_inserted ? remove_levels() : insert_levels(); }
+			void redo() override { m_inserted ? insert_levels() : remove_levels(); }
+
+			void report_memory(MemoryReport& report, int parent) const override
+			{
+				const int command_entry = report.add_entry(text(), parent);
+				report.add_bytes(command_entry, MemoryReport::Category::STRUCTURE, sizeof(LevelRowsCommand));
+				report.add_vector(command_entry, m_levels);
+
+				for (const Level& current_level : m_levels)
+				{
+					report.add_level(current_level, command_entry);
+				}
+			}
+		private:
+			void insert_levels()
+			{
+				int level_row = m_first_row;
+				for (const Level& current_level : m_levels)
+				{
+					if (!m_model.insert_level(level_row, current_level))
+					{
+						// Out of level IDs, the later steps would no longer match the model (the stack drops the obsolete step)
+						setObsolete(true);
+						return;
+					}
+					++level_row;
+				}
+			}
+
+			void remove_levels()
+			{
+				// Remove from the back, so the rows of the other levels do not shift
+				LevelListModel& level_list = m_model.get_level_list();
+				for (int level_row = m_first_row + static_cast<int>(m_levels.size()) - 1; level_row >= m_first_row; --level_row)
+				{
+					m_model.remove_level(level_list.index(level_row));
+				}
+			}
+
+			const bool m_inserted;
+			const int m_first_row;
+			const std::vector<Level> m_levels;
+		};
+
+		// Rows moved within the level list or a level (e.g by drag & drop)
+		class RowsMovedCommand : public HistoryCommand
+		{
+		public:
+			RowsMovedCommand(ScenarioBrowserModel& model, int level_row, int first_row, int count, int destination_row, QUndoCommand* parent)
+				: HistoryCommand((level_row >= 0) ? QStringLiteral("Move Terminals") : QStringLiteral("Move Levels"), model, parent)
+				, m_level_row(level_row)
+				, m_first_row(first_row)
+				, m_count(count)
+				, m_destination_row(destination_row)
+			{
+			}
+
+			void undo() override
+			{
+				// The destination is the row before the move, so the moved rows are either before or after the original position
+				if (m_destination_row < m_first_row)
+				{
+					move_rows(m_destination_row, m_first_row + m_count);
+				}
+				else
+				{
+					move_rows(m_destination_row - m_count, m_first_row);
+				}
+			}
+
+			void redo() override { move_rows(m_first_row, m_destination_row); }
+
+			void report_memory(MemoryReport& report, int parent) const override
+			{
+				const int command_entry = report.add_entry(text(), parent);
+				report.add_bytes(command_entry, MemoryReport::Category::STRUCTURE, sizeof(RowsMovedCommand));
+			}
+		private:
+			void move_rows(int first_row, int destination_row)
+			{
+				// Level row is only set for terminal moves
+				QAbstractItemModel* row_model = &m_model.get_level_list();
+				if (m_level_row >= 0)
+				{
+					row_model = get_level_model(m_level_row);
+				}
+
+				if (row_model)
+				{
+					row_model->moveRows(QModelIndex(), first_row, m_count, QModelIndex(), destination_row);
+				}
+			}
+
+			const int m_level_row;
+			const int m_first_row;
+			const int m_count;
+			const int m_destination_row;
+		};
+
+		class TerminalUpdatedCommand : public HistoryCommand
+		{
+		public:
+			TerminalUpdatedCommand(ScenarioBrowserModel& model, int level_row, int terminal_row, const Terminal& previous_data, const Terminal& data, QUndoCommand* parent)
+				: HistoryCommand(QStringLiteral("Edit Terminal"), model, parent)
+				, m_level_row(level_row)
+				, m_terminal_row(terminal_row)
+				, m_previous_data(previous_data)
+				, m_data(data)
+			{
+			}
+
+			void undo() override { update_terminal(m_previous_data); }
+			void redo() override { update_terminal(m_data); }
+
+			void report_memory(MemoryReport& report, int parent) const override
+			{
+				// Unchanged parts (e.g the other branches) are shared between the two versions
+				const int command_entry = report.add_entry(text(), parent);
+				report.add_bytes(command_entry, MemoryReport::Category::STRUCTURE, sizeof(TerminalUpdatedCommand));
+				report.add_terminal(m_previous_data, QStringLiteral("Previous"), command_entry);
+				report.add_terminal(m_data, QStringLiteral("Current"), command_entry);
+			}
+		private:
+			void update_terminal(const Terminal& data)
+			{
+				const LevelModel* level_model = get_level_model(m_level_row);
+				if (level_model && (m_terminal_row < level_model->rowCount()))
+				{
+					m_model.update_terminal_data(TerminalID{ level_model->get_id(), level_model->get_terminal_id(m_terminal_row) }, data);
+				}
+			}
+
+			const int m_level_row;
+			const int m_terminal_row;
+			const Terminal m_previous_data;
+			const Terminal m_data;
+		};
+
+		class LevelUpdatedCommand : public HistoryCommand
+		{
+		public:
+			LevelUpdatedCommand(ScenarioBrowserModel& model, int level_row, const LevelInfo& previous_info, const LevelInfo& info, QUndoCommand* parent)
+				: HistoryCommand(QStringLiteral("Edit Level"), model, parent)
+				, m_level_row(level_row)
+				, m_previous_info(previous_info)
+				, m_info(info)
+			{
+			}
+
+			void undo() override { update_level(m_previous_info); }
+			void redo() override { update_level(m_info); }
+
+			void report_memory(MemoryReport& report, int parent) const override
+			{
+				const int command_entry = report.add_entry(text(), parent);
+				report.add_bytes(command_entry, MemoryReport::Category::STRUCTURE, sizeof(LevelUpdatedCommand));
+				for (const LevelInfo* current_info : { &m_previous_info, &m_info })
+				{
+					report.add_string(command_entry, MemoryReport::Category::NAMES, current_info->m_name);
+					report.add_string(command_entry, MemoryReport::Category::NAMES, current_info->m_dir_name);
+					report.add_string(command_entry, MemoryReport::Category::NAMES, current_info->m_script_name);
+				}
+			}
+		private:
+			void update_level(const LevelInfo& info)
+			{
+				// Use the current ID of the level in the row
+				LevelInfo updated_info = info;
+				updated_info.m_id = m_model.get_level_id(m_level_row);
+
+				QString error_msg;
+				m_model.update_level_data(updated_info, error_msg);
+			}
+
+			const int m_level_row;
+			const LevelInfo m_previous_info;
+			const LevelInfo m_info;
+		};
+	}
+
+	struct ScenarioHistory::Internal
+	{
+		ScenarioBrowserModel* m_model = nullptr;
+		QUndoStack m_undo_stack;
+
+		// Commands recorded since the last step was pushed
+		std::unique_ptr<HistoryStep> m_pending_step;
+		bool m_applying = false; // Set while a step is undone or redone (the resulting model changes are not recorded)
+
+		QUndoCommand* get_pending_step(ScenarioHistory& history)
+		{
+			if (!m_pending_step)
+			{
+				// Push once control returns to the event loop, so everything done by the current operation ends up in the same step
+				m_pending_step = std::make_unique<HistoryStep>(m_applying);
+				QMetaObject::invokeMethod(&history, &ScenarioHistory::push_pending_step, Qt::QueuedConnection);
+			}
+			return m_pending_step.get();
+		}
+
+		bool is_recording() const { return m_model && !m_applying; }
+	};
+
+	ScenarioHistory::ScenarioHistory(QObject* parent)
+		: QObject(parent)
+		, m_internal(std::make_unique<Internal>())
+	{
+	}
+
+	ScenarioHistory::~ScenarioHistory()
+	{
+		stop();
+	}
+
+	void ScenarioHistory::start(ScenarioBrowserModel& model)
+	{
+		stop();
+
+		m_internal->m_model = &model;
+		connect_signals();
+	}
+
+	void ScenarioHistory::stop()
+	{
+		if (!is_active())
+		{
+			return;
+		}
+
+		// Disconnect from the model
+		disconnect(m_internal->m_model, nullptr, this, nullptr);
+		disconnect(&m_internal->m_model->get_level_list(), nullptr, this, nullptr);
+		m_internal->m_model = nullptr;
+
+		// The commands refer to the model, so they cannot outlive the session
+		m_internal->m_pending_step.reset();
+		m_internal->m_undo_stack.clear();
+	}
+
+	bool ScenarioHistory::is_active() const
+	{
+		return (m_internal->m_model != nullptr);
+	}
+
+	QUndoStack& ScenarioHistory::get_undo_stack()
+	{
+		return m_internal->m_undo_stack;
+	}
+
+	QAction* ScenarioHistory::create_undo_action(QObject* parent) const
+	{
+		QAction* undo_action = m_internal->m_undo_stack.createUndoAction(parent);
+		undo_action->setShortcut(QKeySequence::Undo);
+		return undo_action;
+	}
+
+	QAction* ScenarioHistory::create_redo_action(QObject* parent) const
+	{
+		QAction* redo_action = m_internal->m_undo_stack.createRedoAction(parent);
+		redo_action->setShortcut(QKeySequence::Redo);
+		return redo_action;
+	}
+
+	int ScenarioHistory::report_memory(MemoryReport& report, int parent) const
+	{
+		const int history_entry = report.add_entry(QStringLiteral("Undo history"), parent);
+		report.add_bytes(history_entry, MemoryReport::Category::STRUCTURE, sizeof(ScenarioHistory) + sizeof(Internal));
+
+		const QUndoStack& undo_stack = m_internal->m_undo_stack;
+		for (int step_index = 0; step_index < undo_stack.count(); ++step_index)
+		{
+			const QUndoCommand* current_step = undo_stack.command(step_index);
+			const int step_entry = report.add_entry(QStringLiteral("Step %1 \"%2\"").arg(step_index).arg(current_step->text()), history_entry);
+			report.add_bytes(step_entry, MemoryReport::Category::STRUCTURE, sizeof(HistoryStep));
+
+			for (int command_index = 0; command_index < current_step->childCount(); ++command_index)
+			{
+				static_cast<const HistoryCommand*>(current_step->child(command_index))->report_memory(report, step_entry);
+			}
+		}
+		return history_entry;
+	}
+
+	void ScenarioHistory::connect_signals()
+	{
+		ScenarioBrowserModel* model = m_internal->m_model;
+		LevelListModel* level_list = &model->get_level_list();
+
+		connect(level_list, &QAbstractItemModel::rowsInserted, this, &ScenarioHistory::level_rows_inserted);
+		connect(level_list, &QAbstractItemModel::rowsAboutToBeRemoved, this, &ScenarioHistory::level_rows_about_to_be_removed);
+		connect(level_list, &QAbstractItemModel::rowsMoved, this, &ScenarioHistory::level_rows_moved);
+
+		connect(model, &ScenarioBrowserModel::level_data_updated, this, &ScenarioHistory::level_data_updated);
+		connect(model, &ScenarioBrowserModel::terminal_rows_inserted, this, &ScenarioHistory::terminal_rows_inserted);
+		connect(model, &ScenarioBrowserModel::terminal_rows_about_to_be_removed, this, &ScenarioHistory::terminal_rows_about_to_be_removed);
+		connect(model, &ScenarioBrowserModel::terminal_rows_moved, this, &ScenarioHistory::terminal_rows_moved);
+		connect(model, &ScenarioBrowserModel::terminal_data_updated, this, &ScenarioHistory::terminal_data_updated);
+	}
+
+	void ScenarioHistory::push_pending_step()
+	{
+		if (!m_internal->m_pending_step)
+		{
+			return;
+		}
+
+		// Name the step after the first change
+		HistoryStep* pending_step = m_internal->m_pending_step.release();
+		if (pending_step->childCount() > 0)
+		{
+			pending_step->setText(pending_step->child(0)->text());
+		}
+		m_internal->m_undo_stack.push(pending_step);
+	}
+
+	void ScenarioHistory::level_rows_inserted(const QModelIndex& parent, int first, int last)
+	{
+		if (!m_internal->is_recording())
+		{
+			return;
+		}
+
+		// Keep the inserted levels for redo (only shares the terminal data)
+		std::vector<Level> inserted_levels;
+		inserted_levels.reserve((last - first) + 1);
+		for (int current_row = first; current_row <= last; ++current_row)
+		{
+			inserted_levels.push_back(m_internal->m_model->export_level(current_row));
+		}
+		new LevelRowsCommand(*m_internal->m_model, true, first, std::move(inserted_levels), m_internal->get_pending_step(*this));
+	}
+
+	void ScenarioHistory::level_rows_about_to_be_removed(const QModelIndex& parent, int first, int last)
+	{
+		if (!m_internal->is_recording())
+		{
+			return;
+		}
+
+		std::vector<Level> removed_levels;
+		removed_levels.reserve((last - first) + 1);
+		for (int current_row = first; current_row <= last; ++current_row)
+		{
+			removed_levels.push_back(m_internal->m_model->export_level(current_row));
+		}
+		new LevelRowsCommand(*m_internal->m_model, false, first, std::move(removed_levels), m_internal->get_pending_step(*this));
+	}
+
+	void ScenarioHistory::level_rows_moved(const QModelIndex& parent, int first, int last, const QModelIndex& destination_parent, int destination_row)
+	{
+		if (m_internal->is_recording())
+		{
+			new RowsMovedCommand(*m_internal->m_model, -1, first, (last - first) + 1, destination_row, m_internal->get_pending_step(*this));
+		}
+	}
+
+	void ScenarioHistory::level_data_updated(int level_id, const LevelInfo& previous_info)
+	{
+		const int level_row = m_internal->m_model->find_level_row(level_id);
+		if (m_internal->is_recording() && (level_row >= 0))
+		{
+			new LevelUpdatedCommand(*m_internal->m_model, level_row, previous_info, m_internal->m_model->get_level_info(level_id), m_internal->get_pending_step(*this));
+		}
+	}
+
+	void ScenarioHistory::terminal_rows_inserted(int level_id, int first_row, int last_row)
+	{
+		if (!m_internal->is_recording())
+		{
+			return;
+		}
+
+		const LevelModel* level_model = m_internal->m_model->get_level_model(level_id);
+		const int level_row = m_internal->m_model->find_level_row(level_id);
+		if (!level_model || (level_row < 0))
+		{
+			return;
+		}
+
+		std::vector<Terminal> inserted_terminals;
+		inserted_terminals.reserve((last_row - first_row) + 1);
+		for (int current_row = first_row; current_row <= last_row; ++current_row)
+		{
+			inserted_terminals.push_back(*level_model->get_terminal(TerminalID{ level_id, level_model->get_terminal_id(current_row) }));
+		}
+		new TerminalRowsCommand(*m_internal->m_model, true, level_row, first_row, std::move(inserted_terminals), m_internal->get_pending_step(*this));
+	}
+
+	void ScenarioHistory::terminal_rows_about_to_be_removed(int level_id, int first_row, int last_row)
+	{
+		if (!m_internal->is_recording())
+		{
+			return;
+		}
+
+		const LevelModel* level_model = m_internal->m_model->get_level_model(level_id);
+		const int level_row = m_internal->m_model->find_level_row(level_id);
+		if (!level_model || (level_row < 0))
+		{
+			return;
+		}
+
+		// Keep the removed terminals for undo (only shares their data)
+		std::vector<Terminal> removed_terminals;
+		removed_terminals.reserve((last_row - first_row) + 1);
+		for (int current_row = first_row; current_row <= last_row; ++current_row)
+		{
+			removed_terminals.push_back(*level_model->get_terminal(TerminalID{ level_id, level_model->get_terminal_id(current_row) }));
+		}
+		new TerminalRowsCommand(*m_internal->m_model, false, level_row, first_row, std::move(removed_terminals), m_internal->get_pending_step(*this));
+	}
+
+	void ScenarioHistory::terminal_rows_moved(int level_id, int first_row, int last_row, int destination_row)
+	{
+		const int level_row = m_internal->m_model->find_level_row(level_id);
+		if (m_internal->is_recording() && (level_row >= 0))
+		{
+			new RowsMovedCommand(*m_internal->m_model, level_row, first_row, (last_row - first_row) + 1, destination_row, m_internal->get_pending_step(*this));
+		}
+	}
+
+	void ScenarioHistory::terminal_data_updated(int level_id, int terminal_id, const Terminal& previous_data)
+	{
+		if (!m_internal->is_recording())
+		{
+			return;
+		}
+
+		const LevelModel* level_model = m_internal->m_model->get_level_model(level_id);
+		const int level_row = m_internal->m_model->find_level_row(level_id);
+		const TerminalID updated_terminal_id{ level_id, terminal_id };
+		const int terminal_row = level_model ? level_model->find_terminal_row(updated_terminal_id) : -1;
+		if ((level_row < 0) || (terminal_row < 0))
+		{
+			return;
+		}
+
+		new TerminalUpdatedCommand(*m_internal->m_model, level_row, terminal_row, previous_data, *level_model->get_terminal(updated_terminal_id), m_internal->get_pending_step(*this));
+	}
+}
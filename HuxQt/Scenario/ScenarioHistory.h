@@ -0,0 +1,55 @@
+#pragma once
+#include <QObject>
+
+#include <memory>
+
+class QAction;
+class QModelIndex;
+class QUndoStack;
+
+namespace HuxApp
+{
+	class ScenarioBrowserModel;
+	class MemoryReport;
+	class Terminal;
+	struct LevelInfo;
+
+	// Undo stack for the edits made to the browser model (recorded from the model signals, same as the journal)
+	// Steps only keep the terminals and levels they changed, which share their data with the models, so a step costs memory proportional to the change
+	// Undoing and redoing goes through the models, so the views, the journal and the editors are updated like for any other edit
+	class ScenarioHistory : public QObject
+	{
+		Q_OBJECT
+	public:
+		ScenarioHistory(QObject* parent = nullptr);
+		~ScenarioHistory();
+
+		// Starts recording the model edits (the history starts out empty)
+		void start(ScenarioBrowserModel& model);
+		void stop();
+		bool is_active() const;
+
+		QUndoStack& get_undo_stack();
+
+		// Actions which follow the state of the stack (enabled and text)
+		QAction* create_undo_action(QObject* parent) const;
+		QAction* create_redo_action(QObject* parent) const;
+
+		int report_memory(MemoryReport& report, int parent = -1) const; // Returns the report entry
+	private:
+		void connect_signals();
+		void push_pending_step(); // Edits made by the same operation are grouped into one step
+
+		void level_rows_inserted(const QModelIndex& parent, int first, int last);
+		void level_rows_about_to_be_removed(const QModelIndex& parent, int first, int last);
+		void level_rows_moved(const QModelIndex& parent, int first, int last, const QModelIndex& destination_parent, int destination_row);
+		void level_data_updated(int level_id, const LevelInfo& previous_info);
+		void terminal_rows_inserted(int level_id, int first_row, int last_row);
+		void terminal_rows_about_to_be_removed(int level_id, int first_row, int last_row);
+		void terminal_rows_moved(int level_id, int first_row, int last_row, int destination_row);
+		void terminal_data_updated(int level_id, int terminal_id, const Terminal& previous_data);
+
+		struct Internal;
+		std::unique_ptr<Internal> m_internal;
+	};
+}
@@ -0,0 +1,784 @@
+#include <HuxQt/Scenario/ScenarioJournal.h>
+
+#include <HuxQt/Scenario/ScenarioManager.h>
+#include <HuxQt/Scenario/ScenarioBrowserModel.h>
+#include <HuxQt/Scenario/Scenario.h>
+
+#include <HuxQt/Utils/Utilities.h>
+
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+namespace HuxApp
+{
+	namespace
+	{
+		constexpr int JOURNAL_VERSION = 1;
+		constexpr const char* JOURNAL_SUFFIX = ".journal";
+		constexpr const char* JOURNAL_BACKUP_SUFFIX = ".journal.bak";
+
+		// Once the journal gets this large, we replace the records with a snapshot
+		constexpr qint64 JOURNAL_COMPACTION_SIZE = 4 * 1024 * 1024;
+
+		enum class RecordType
+		{
+			SNAPSHOT,
+			LEVELS_INSERTED,
+			LEVELS_REMOVED,
+			LEVEL_UPDATED,
+			TERMINALS_INSERTED,
+			TERMINALS_REMOVED,
+			TERMINAL_UPDATED,
+			LEVELS_MOVED,
+			TERMINALS_MOVED,
+			TYPE_COUNT
+		};
+
+		constexpr const char* RECORD_TYPE_NAMES[Utils::to_integral(RecordType::TYPE_COUNT)] = {
+			"SNAPSHOT",
+			"LEVELS_INSERTED",
+			"LEVELS_REMOVED",
+			"LEVEL_UPDATED",
+			"TERMINALS_INSERTED",
+			"TERMINALS_REMOVED",
+			"TERMINAL_UPDATED",
+			"LEVELS_MOVED",
+			"TERMINALS_MOVED"
+		};
+
+		RecordType get_record_type(const QString& type_name)
+		{
+			for (int type_index = 0; type_index < Utils::to_integral(RecordType::TYPE_COUNT); ++type_index)
+			{
+				if (type_name == RECORD_TYPE_NAMES[type_index])
+				{
+					return Utils::to_enum<RecordType>(type_index);
+				}
+			}
+			return RecordType::TYPE_COUNT;
+		}
+
+		QJsonObject create_record(RecordType type)
+		{
+			QJsonObject record_json;
+			record_json["TYPE"] = RECORD_TYPE_NAMES[Utils::to_integral(type)];
+			return record_json;
+		}
+
+		QJsonObject create_header(const QString& scenario_file_path)
+		{
+			// Store the state of the scenario file, so we can tell if the journal no longer applies to it
+			const QFileInfo scenario_file_info(scenario_file_path);
+
+			QJsonObject header_json;
+			header_json["HUX_JOURNAL"] = JOURNAL_VERSION;
+			header_json["BASE_SIZE"] = scenario_file_info.size();
+			header_json["BASE_MODIFIED"] = scenario_file_info.lastModified().toMSecsSinceEpoch();
+			return header_json;
+		}
+
+		bool header_matches_file(const QJsonObject& header_json, const QString& scenario_file_path)
+		{
+			const QFileInfo scenario_file_info(scenario_file_path);
+			return (header_json["BASE_SIZE"].toInteger() == scenario_file_info.size())
+				&& (header_json["BASE_MODIFIED"].toInteger() == scenario_file_info.lastModified().toMSecsSinceEpoch());
+		}
+
+		QByteArray to_record_line(const QJsonObject& record_json)
+		{
+			// One record per line, so appending never has to touch the existing contents
+			QByteArray record_line = QJsonDocument(record_json).toJson(QJsonDocument::Compact);
+			record_line += '\n';
+			return record_line;
+		}
+
+		bool is_row_range_valid(int first_row, int count, size_t size)
+		{
+			return (first_row >= 0) && (count >= 0) && (static_cast<size_t>(first_row + count) <= size);
+		}
+
+		bool is_row_move_valid(int first_row, int count, int destination_row, size_t size)
+		{
+			// Same rules as the model, the destination must be outside the moved range
+			return is_row_range_valid(first_row, count, size) && (count > 0)
+				&& (destination_row >= 0) && (static_cast<size_t>(destination_row) <= size)
+				&& ((destination_row < first_row) || (destination_row > (first_row + count)));
+		}
+	}
+
+	struct ScenarioJournal::Internal
+	{
+		const ScenarioManager& m_scenario_manager;
+
+		ScenarioBrowserModel* m_model = nullptr;
+		QString m_scenario_file_path;
+
+		QFile m_journal_file;
+		QByteArray m_record_buffer;
+
+		Internal(const ScenarioManager& scenario_manager)
+			: m_scenario_manager(scenario_manager)
+		{
+		}
+
+		void add_record(const QJsonObject& record_json)
+		{
+			// Only buffer here, the records are written in batches when the journal is flushed
+			m_record_buffer += to_record_line(record_json);
+		}
+
+		QJsonObject export_terminal(const LevelModel& level_model, int terminal_row) const
+		{
+			const TerminalID terminal_id{ level_model.get_id(), level_model.get_terminal_id(terminal_row) };
+			if (const Terminal* terminal = level_model.get_terminal(terminal_id))
+			{
+				return m_scenario_manager.serialize_terminal(*terminal);
+			}
+			return m_scenario_manager.serialize_terminal(Terminal());
+		}
+
+		bool write_header()
+		{
+			return (m_journal_file.write(to_record_line(create_header(m_scenario_file_path))) != -1) && m_journal_file.flush();
+		}
+
+		// Writes a journal for the given scenario file which only has the header (and a snapshot of the model contents, if requested)
+		// Written separately, so an existing journal stays intact unless the new one was written completely
+		bool write_journal(const QString& journal_path, const QString& scenario_file_path, bool snapshot, QString& error_msg)
+		{
+			std::vector<QByteArray> journal_lines{ to_record_line(create_header(scenario_file_path)) };
+			if (snapshot)
+			{
+				QJsonArray levels_json;
+				const int level_count = m_model->get_level_list().rowCount();
+				for (int current_row = 0; current_row < level_count; ++current_row)
+				{
+					// Keep the existing records if a level could not be loaded (the snapshot would lose its contents)
+					QJsonObject current_level_json;
+					if (!m_scenario_manager.serialize_level(m_model->export_level(current_row), current_level_json, error_msg))
+					{
+						return false;
+					}
+					levels_json.append(current_level_json);
+				}
+
+				QJsonObject snapshot_json = create_record(RecordType::SNAPSHOT);
+				snapshot_json["LEVELS"] = levels_json;
+				journal_lines.push_back(to_record_line(snapshot_json));
+			}
+
+			QSaveFile journal_file(journal_path);
+			if (!journal_file.open(QIODevice::WriteOnly))
+			{
+				error_msg = QStringLiteral("Unable to open journal file \"%1\"!").arg(journal_path);
+				return false;
+			}
+			for (const QByteArray& current_line : journal_lines)
+			{
+				if (journal_file.write(current_line) != current_line.size())
+				{
+					// Never replace the journal with a partial one (e.g the disk is full)
+					error_msg = QStringLiteral("Unable to write journal file \"%1\"! Error: \"%2\"").arg(journal_path, journal_file.errorString());
+					journal_file.cancelWriting();
+					return false;
+				}
+			}
+
+			// Close our handle before the file is replaced (reopened afterwards either way)
+			const bool replaces_open_journal = m_journal_file.isOpen() && (m_journal_file.fileName() == journal_path);
+			if (replaces_open_journal)
+			{
+				m_journal_file.close();
+			}
+
+			const bool committed = journal_file.commit();
+			if (!committed)
+			{
+				error_msg = QStringLiteral("Unable to write journal file \"%1\"! Error: \"%2\"").arg(journal_path, journal_file.errorString());
+			}
+
+			if (replaces_open_journal && !m_journal_file.open(QIODevice::WriteOnly | QIODevice::Append))
+			{
+				error_msg = QStringLiteral("Unable to open journal file \"%1\"!").arg(journal_path);
+				return false;
+			}
+			return committed;
+		}
+	};
+
+	namespace
+	{
+		// Replaces the previous backup, fails if the journal could not be moved (it is left in place)
+		bool backup_journal(const QString& scenario_file_path)
+		{
+			const QString backup_path = ScenarioJournal::get_backup_path(scenario_file_path);
+			if (QFile::exists(backup_path) && !QFile::remove(backup_path))
+			{
+				return false;
+			}
+			return QFile::rename(ScenarioJournal::get_journal_path(scenario_file_path), backup_path);
+		}
+	}
+
+	ScenarioJournal::ScenarioJournal(const ScenarioManager& scenario_manager, QObject* parent)
+		: QObject(parent)
+		, m_internal(std::make_unique<Internal>(scenario_manager))
+	{
+	}
+
+	ScenarioJournal::~ScenarioJournal()
+	{
+		stop(false);
+	}
+
+	QString ScenarioJournal::get_journal_path(const QString& scenario_file_path)
+	{
+		return scenario_file_path + JOURNAL_SUFFIX;
+	}
+
+	QString ScenarioJournal::get_backup_path(const QString& scenario_file_path)
+	{
+		return scenario_file_path + JOURNAL_BACKUP_SUFFIX;
+	}
+
+	bool ScenarioJournal::has_records(const QString& scenario_file_path)
+	{
+		QFile journal_file(get_journal_path(scenario_file_path));
+		if (!journal_file.open(QIODevice::ReadOnly))
+		{
+			return false;
+		}
+
+		// Skip the header, check if there is anything after it
+		journal_file.readLine();
+		while (!journal_file.atEnd())
+		{
+			if (!journal_file.readLine().trimmed().isEmpty())
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool ScenarioJournal::start(ScenarioBrowserModel& model, const QString& scenario_file_path, bool keep_records, QString& error_msg)
+	{
+		stop(false);
+
+		m_internal->m_scenario_file_path = scenario_file_path;
+		m_internal->m_journal_file.setFileName(get_journal_path(scenario_file_path));
+
+		if (keep_records && m_internal->m_journal_file.exists())
+		{
+			// Continue from the existing records
+			if (!m_internal->m_journal_file.open(QIODevice::WriteOnly | QIODevice::Append))
+			{
+				error_msg = QStringLiteral("Unable to open journal file \"%1\"!").arg(m_internal->m_journal_file.fileName());
+				return false;
+			}
+		}
+		else
+		{
+			// Keep the records we are about to overwrite (e.g the user declined to recover them, or they could not be replayed)
+			if (has_records(scenario_file_path) && !backup_journal(scenario_file_path))
+			{
+				error_msg = QStringLiteral("Unable to move journal file \"%1\" to \"%2\"!").arg(m_internal->m_journal_file.fileName(), get_backup_path(scenario_file_path));
+				return false;
+			}
+
+			// Start a new journal for the current state of the scenario file
+			if (!m_internal->m_journal_file.open(QIODevice::WriteOnly | QIODevice::Truncate) || !m_internal->write_header())
+			{
+				error_msg = QStringLiteral("Unable to write journal file \"%1\"!").arg(m_internal->m_journal_file.fileName());
+				m_internal->m_journal_file.close();
+				return false;
+			}
+		}
+
+		m_internal->m_model = &model;
+		connect_signals();
+		return true;
+	}
+
+	void ScenarioJournal::stop(bool discard)
+	{
+		if (!is_active())
+		{
+			return;
+		}
+
+		// Write everything out, even if discarded the records are kept in the backup
+		flush();
+
+		// Disconnect from the model
+		disconnect(m_internal->m_model, nullptr, this, nullptr);
+		disconnect(&m_internal->m_model->get_level_list(), nullptr, this, nullptr);
+		m_internal->m_model = nullptr;
+
+		m_internal->m_journal_file.close();
+		if (discard)
+		{
+			if (has_records(m_internal->m_scenario_file_path))
+			{
+				// If the journal can't be moved aside it is left in place (recovery is offered the next time)
+				backup_journal(m_internal->m_scenario_file_path);
+			}
+			else
+			{
+				m_internal->m_journal_file.remove();
+			}
+		}
+
+		m_internal->m_record_buffer.clear();
+		m_internal->m_scenario_file_path.clear();
+	}
+
+	bool ScenarioJournal::is_active() const
+	{
+		return (m_internal->m_model != nullptr);
+	}
+
+	bool ScenarioJournal::flush()
+	{
+		if (!is_active())
+		{
+			return false;
+		}
+
+		if (m_internal->m_record_buffer.isEmpty())
+		{
+			return true;
+		}
+
+		if ((m_internal->m_journal_file.write(m_internal->m_record_buffer) == -1) || !m_internal->m_journal_file.flush())
+		{
+			return false;
+		}
+		m_internal->m_record_buffer.clear();
+
+		if (m_internal->m_journal_file.size() > JOURNAL_COMPACTION_SIZE)
+		{
+			return compact();
+		}
+		return true;
+	}
+
+	bool ScenarioJournal::compact()
+	{
+		if (!is_active())
+		{
+			return false;
+		}
+
+		// Snapshot the current state of the model (already includes anything still in the buffer)
+		QString error_msg;
+		if (!m_internal->write_journal(m_internal->m_journal_file.fileName(), m_internal->m_scenario_file_path, true, error_msg))
+		{
+			return false;
+		}
+		m_internal->m_record_buffer.clear();
+		return true;
+	}
+
+	bool ScenarioJournal::rebase(const QString& scenario_file_path, bool keep_edits, QString& error_msg)
+	{
+		if (!is_active())
+		{
+			error_msg = QStringLiteral("Journal is not active!");
+			return false;
+		}
+
+		const QString old_journal_path = m_internal->m_journal_file.fileName();
+		const QString journal_path = get_journal_path(scenario_file_path);
+		if (!m_internal->write_journal(journal_path, scenario_file_path, keep_edits, error_msg))
+		{
+			// Keep the edits in the old journal
+			flush();
+			return false;
+		}
+		m_internal->m_record_buffer.clear();
+		m_internal->m_scenario_file_path = scenario_file_path;
+
+		if (journal_path != old_journal_path)
+		{
+			// Saved to a new file, the old journal no longer applies to anything
+			m_internal->m_journal_file.close();
+			QFile::remove(old_journal_path);
+
+			m_internal->m_journal_file.setFileName(journal_path);
+			if (!m_internal->m_journal_file.open(QIODevice::WriteOnly | QIODevice::Append))
+			{
+				error_msg = QStringLiteral("Unable to open journal file \"%1\"!").arg(journal_path);
+				stop(false);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool ScenarioJournal::replay(const QString& scenario_file_path, Scenario& scenario, QList<int>& modified_level_rows, QString& error_msg) const
+	{
+		QFile journal_file(get_journal_path(scenario_file_path));
+		if (!journal_file.open(QIODevice::ReadOnly))
+		{
+			error_msg = QStringLiteral("Unable to open journal file \"%1\"!").arg(journal_file.fileName());
+			return false;
+		}
+
+		const QJsonObject header_json = QJsonDocument::fromJson(journal_file.readLine()).object();
+		if (header_json["HUX_JOURNAL"].toInt() != JOURNAL_VERSION)
+		{
+			error_msg = QStringLiteral("Invalid or unsupported journal file!");
+			return false;
+		}
+		const bool base_matches = header_matches_file(header_json, scenario_file_path);
+
+		// Apply the records on a copy, so the scenario is left untouched if anything goes wrong
+		std::vector<Level> levels = scenario.get_levels();
+		std::vector<bool> modified_levels(levels.size(), false);
+
+		// Terminal records need the level contents (in case the scenario was loaded lazily)
+		auto is_level_row_valid = [this, &levels, &error_msg](int level_row)
+			{
+				return is_row_range_valid(level_row, 1, levels.size()) && m_internal->m_scenario_manager.load_level(levels[level_row], error_msg);
+			};
+
+		int record_index = 0;
+		while (!journal_file.atEnd())
+		{
+			const QByteArray record_line = journal_file.readLine();
+			if (record_line.trimmed().isEmpty())
+			{
+				continue;
+			}
+
+			QJsonParseError parse_error;
+			const QJsonDocument record_document = QJsonDocument::fromJson(record_line, &parse_error);
+			if (parse_error.error != QJsonParseError::NoError)
+			{
+				if (journal_file.atEnd())
+				{
+					// The last record may have been cut off (e.g the app crashed while writing it), skip it
+					break;
+				}
+				error_msg = QStringLiteral("Invalid journal record! Error: \"%1\"").arg(parse_error.errorString());
+				return false;
+			}
+
+			const QJsonObject record_json = record_document.object();
+			const RecordType record_type = get_record_type(record_json["TYPE"].toString());
+			if ((record_index == 0) && (record_type != RecordType::SNAPSHOT) && !base_matches)
+			{
+				// Records are relative to the scenario file, which was changed since the journal was written
+				error_msg = QStringLiteral("The scenario file was modified after the journal was written!");
+				return false;
+			}
+			++record_index;
+
+			const int level_row = record_json["LEVEL"].toInt(-1);
+			const int row = record_json["ROW"].toInt(-1);
+			bool valid_record = true;
+
+			switch (record_type)
+			{
+			case RecordType::SNAPSHOT:
+			{
+				levels.clear();
+				for (const QJsonValue& current_level_value : record_json["LEVELS"].toArray())
+				{
+					levels.push_back(m_internal->m_scenario_manager.deserialize_level(current_level_value.toObject()));
+				}
+				modified_levels.assign(levels.size(), true);
+			}
+			break;
+			case RecordType::LEVELS_INSERTED:
+			{
+				const QJsonArray levels_json = record_json["LEVELS"].toArray();
+				valid_record = is_row_range_valid(row, 0, levels.size());
+				if (valid_record)
+				{
+					int current_row = row;
+					for (const QJsonValue& current_level_value : levels_json)
+					{
+						levels.insert(levels.begin() + current_row, m_internal->m_scenario_manager.deserialize_level(current_level_value.toObject()));
+						modified_levels.insert(modified_levels.begin() + current_row, true);
+						++current_row;
+					}
+				}
+			}
+			break;
+			case RecordType::LEVELS_REMOVED:
+			{
+				const int count = record_json["COUNT"].toInt();
+				valid_record = is_row_range_valid(row, count, levels.size());
+				if (valid_record)
+				{
+					levels.erase(levels.begin() + row, levels.begin() + row + count);
+					modified_levels.erase(modified_levels.begin() + row, modified_levels.begin() + row + count);
+				}
+			}
+			break;
+			case RecordType::LEVEL_UPDATED:
+			{
+				valid_record = is_row_range_valid(row, 1, levels.size());
+				if (valid_record)
+				{
+					Level& updated_level = levels[row];
+					updated_level.set_name(record_json["NAME"].toString());
+					updated_level.set_dir_name(record_json["DIR_NAME"].toString());
+					updated_level.set_script_name(record_json["SCRIPT_NAME"].toString());
+					modified_levels[row] = true;
+				}
+			}
+			break;
+			case RecordType::TERMINALS_INSERTED:
+			{
+				valid_record = is_level_row_valid(level_row) && is_row_range_valid(row, 0, levels[level_row].get_terminals().size());
+				if (valid_record)
+				{
+					std::vector<Terminal>& terminals = levels[level_row].get_terminals();
+					int current_row = row;
+					for (const QJsonValue& current_terminal_value : record_json["TERMINALS"].toArray())
+					{
+						terminals.insert(terminals.begin() + current_row, m_internal->m_scenario_manager.deserialize_terminal(current_terminal_value.toObject()));
+						++current_row;
+					}
+					modified_levels[level_row] = true;
+				}
+			}
+			break;
+			case RecordType::TERMINALS_REMOVED:
+			{
+				const int count = record_json["COUNT"].toInt();
+				valid_record = is_level_row_valid(level_row) && is_row_range_valid(row, count, levels[level_row].get_terminals().size());
+				if (valid_record)
+				{
+					std::vector<Terminal>& terminals = levels[level_row].get_terminals();
+					terminals.erase(terminals.begin() + row, terminals.begin() + row + count);
+					modified_levels[level_row] = true;
+				}
+			}
+			break;
+			case RecordType::LEVELS_MOVED:
+			{
+				const int count = record_json["COUNT"].toInt();
+				const int destination_row = record_json["DESTINATION"].toInt(-1);
+				valid_record = is_row_move_valid(row, count, destination_row, levels.size());
+				if (valid_record)
+				{
+					const int moved_row = Utils::move_range(levels, row, count, destination_row);
+					Utils::move_range(modified_levels, row, count, destination_row);
+					std::fill(modified_levels.begin() + moved_row, modified_levels.begin() + moved_row + count, true);
+				}
+			}
+			break;
+			case RecordType::TERMINALS_MOVED:
+			{
+				const int count = record_json["COUNT"].toInt();
+				const int destination_row = record_json["DESTINATION"].toInt(-1);
+				valid_record = is_level_row_valid(level_row) && is_row_move_valid(row, count, destination_row, levels[level_row].get_terminals().size());
+				if (valid_record)
+				{
+					Utils::move_range(levels[level_row].get_terminals(), row, count, destination_row);
+					modified_levels[level_row] = true;
+				}
+			}
+			break;
+			case RecordType::TERMINAL_UPDATED:
+			{
+				valid_record = is_level_row_valid(level_row) && is_row_range_valid(row, 1, levels[level_row].get_terminals().size());
+				if (valid_record)
+				{
+					levels[level_row].get_terminal(row) = m_internal->m_scenario_manager.deserialize_terminal(record_json["TERMINAL"].toObject());
+					modified_levels[level_row] = true;
+				}
+			}
+			break;
+			default:
+				valid_record = false;
+				break;
+			}
+
+			if (!valid_record)
+			{
+				error_msg = QStringLiteral("Journal record %1 does not match the scenario contents!").arg(record_index);
+				return false;
+			}
+		}
+
+		// All records applied, update the scenario
+		scenario.set_levels(std::move(levels));
+
+		modified_level_rows.clear();
+		for (size_t current_row = 0; current_row < modified_levels.size(); ++current_row)
+		{
+			if (modified_levels[current_row])
+			{
+				modified_level_rows << static_cast<int>(current_row);
+			}
+		}
+		return true;
+	}
+
+	void ScenarioJournal::connect_signals()
+	{
+		ScenarioBrowserModel* model = m_internal->m_model;
+		LevelListModel* level_list = &model->get_level_list();
+
+		connect(level_list, &QAbstractItemModel::rowsInserted, this, &ScenarioJournal::level_rows_inserted);
+		connect(level_list, &QAbstractItemModel::rowsRemoved, this, &ScenarioJournal::level_rows_removed);
+		connect(level_list, &QAbstractItemModel::rowsMoved, this, &ScenarioJournal::level_rows_moved);
+		connect(level_list, &QAbstractItemModel::dataChanged, this, &ScenarioJournal::level_data_changed);
+
+		connect(model, &ScenarioBrowserModel::terminal_rows_inserted, this, &ScenarioJournal::terminal_rows_inserted);
+		connect(model, &ScenarioBrowserModel::terminal_rows_removed, this, &ScenarioJournal::terminal_rows_removed);
+		connect(model, &ScenarioBrowserModel::terminal_rows_moved, this, &ScenarioJournal::terminal_rows_moved);
+		connect(model, &ScenarioBrowserModel::terminal_modified, this, &ScenarioJournal::terminal_modified);
+	}
+
+	void ScenarioJournal::level_rows_inserted(const QModelIndex& parent, int first, int last)
+	{
+		QJsonArray levels_json;
+		for (int current_row = first; current_row <= last; ++current_row)
+		{
+			QJsonObject current_level_json;
+			QString error_msg;
+			if (!m_internal->m_scenario_manager.serialize_level(m_internal->m_model->export_level(current_row), current_level_json, error_msg))
+			{
+				// The level can't be recorded (e.g restored level which could not be loaded), so the later records could not be replayed either
+				// Stop here, the journal can still recover the edits made so far
+				stop(false);
+				return;
+			}
+			levels_json.append(current_level_json);
+		}
+
+		QJsonObject record_json = create_record(RecordType::LEVELS_INSERTED);
+		record_json["ROW"] = first;
+		record_json["LEVELS"] = levels_json;
+		m_internal->add_record(record_json);
+	}
+
+	void ScenarioJournal::level_rows_removed(const QModelIndex& parent, int first, int last)
+	{
+		QJsonObject record_json = create_record(RecordType::LEVELS_REMOVED);
+		record_json["ROW"] = first;
+		record_json["COUNT"] = (last - first) + 1;
+		m_internal->add_record(record_json);
+	}
+
+	void ScenarioJournal::level_rows_moved(const QModelIndex& parent, int first, int last, const QModelIndex& destination_parent, int destination_row)
+	{
+		QJsonObject record_json = create_record(RecordType::LEVELS_MOVED);
+		record_json["ROW"] = first;
+		record_json["COUNT"] = (last - first) + 1;
+		record_json["DESTINATION"] = destination_row;
+		m_internal->add_record(record_json);
+	}
+
+	void ScenarioJournal::level_data_changed(const QModelIndex& top_left, const QModelIndex& bottom_right, const QList<int>& roles)
+	{
+		// Ignore changes that only affect the modified flag
+		const bool level_info_changed = roles.isEmpty()
+			|| roles.contains(Qt::DisplayRole)
+			|| roles.contains(Qt::EditRole)
+			|| roles.contains(Utils::to_integral(ScenarioBrowserModel::LevelDataRoles::DIR_NAME))
+			|| roles.contains(Utils::to_integral(ScenarioBrowserModel::LevelDataRoles::SCRIPT_NAME));
+		if (!level_info_changed)
+		{
+			return;
+		}
+
+		for (int current_row = top_left.row(); current_row <= bottom_right.row(); ++current_row)
+		{
+			const LevelInfo level_info = m_internal->m_model->get_level_info(m_internal->m_model->get_level_id(current_row));
+
+			QJsonObject record_json = create_record(RecordType::LEVEL_UPDATED);
+			record_json["ROW"] = current_row;
+			record_json["NAME"] = level_info.m_name;
+			record_json["DIR_NAME"] = level_info.m_dir_name;
+			record_json["SCRIPT_NAME"] = level_info.m_script_name;
+			m_internal->add_record(record_json);
+		}
+	}
+
+	void ScenarioJournal::terminal_rows_inserted(int level_id, int first_row, int last_row)
+	{
+		const LevelModel* level_model = m_internal->m_model->get_level_model(level_id);
+		const int level_row = m_internal->m_model->find_level_row(level_id);
+		if (!level_model || (level_row < 0))
+		{
+			return;
+		}
+
+		QJsonArray terminals_json;
+		for (int current_row = first_row; current_row <= last_row; ++current_row)
+		{
+			terminals_json.append(m_internal->export_terminal(*level_model, current_row));
+		}
+
+		QJsonObject record_json = create_record(RecordType::TERMINALS_INSERTED);
+		record_json["LEVEL"] = level_row;
+		record_json["ROW"] = first_row;
+		record_json["TERMINALS"] = terminals_json;
+		m_internal->add_record(record_json);
+	}
+
+	void ScenarioJournal::terminal_rows_removed(int level_id, int first_row, int last_row)
+	{
+		const int level_row = m_internal->m_model->find_level_row(level_id);
+		if (level_row < 0)
+		{
+			return;
+		}
+
+		QJsonObject record_json = create_record(RecordType::TERMINALS_REMOVED);
+		record_json["LEVEL"] = level_row;
+		record_json["ROW"] = first_row;
+		record_json["COUNT"] = (last_row - first_row) + 1;
+		m_internal->add_record(record_json);
+	}
+
+	void ScenarioJournal::terminal_rows_moved(int level_id, int first_row, int last_row, int destination_row)
+	{
+		const int level_row = m_internal->m_model->find_level_row(level_id);
+		if (level_row < 0)
+		{
+			return;
+		}
+
+		QJsonObject record_json = create_record(RecordType::TERMINALS_MOVED);
+		record_json["LEVEL"] = level_row;
+		record_json["ROW"] = first_row;
+		record_json["COUNT"] = (last_row - first_row) + 1;
+		record_json["DESTINATION"] = destination_row;
+		m_internal->add_record(record_json);
+	}
+
+	void ScenarioJournal::terminal_modified(int level_id, int terminal_id)
+	{
+		const LevelModel* level_model = m_internal->m_model->get_level_model(level_id);
+		const int level_row = m_internal->m_model->find_level_row(level_id);
+		if (!level_model || (level_row < 0))
+		{
+			return;
+		}
+
+		const int terminal_row = level_model->find_terminal_row(TerminalID{ level_id, terminal_id });
+		if (terminal_row < 0)
+		{
+			return;
+		}
+
+		QJsonObject record_json = create_record(RecordType::TERMINAL_UPDATED);
+		record_json["LEVEL"] = level_row;
+		record_json["ROW"] = terminal_row;
+		record_json["TERMINAL"] = m_internal->export_terminal(*level_model, terminal_row);
+		m_internal->add_record(record_json);
+	}
+}
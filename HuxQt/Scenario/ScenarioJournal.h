@@ -0,0 +1,53 @@
+#pragma once
+#include <QObject>
+
+namespace HuxApp
+{
+	class Scenario;
+	class ScenarioManager;
+	class ScenarioBrowserModel;
+
+	// Append-only log of the edits made to the browser model since the scenario file was last saved
+	// Stored next to the scenario file, so unsaved changes can be recovered by replaying it on the saved scenario
+	class ScenarioJournal : public QObject
+	{
+		Q_OBJECT
+	public:
+		ScenarioJournal(const ScenarioManager& scenario_manager, QObject* parent = nullptr);
+		~ScenarioJournal();
+
+		static QString get_journal_path(const QString& scenario_file_path);
+		static QString get_backup_path(const QString& scenario_file_path); // Discarded records are moved here (replacing the previous backup)
+		static bool has_records(const QString& scenario_file_path);
+
+		// Starts recording the model edits (if requested, existing records are kept, i.e the journal was replayed on the model contents)
+		// Otherwise a journal with records is moved to the backup path before starting a new one
+		bool start(ScenarioBrowserModel& model, const QString& scenario_file_path, bool keep_records, QString& error_msg);
+		void stop(bool discard); // Discarded records are moved to the backup path (the journal is only removed if it has no records)
+		bool is_active() const;
+
+		bool flush(); // Appends the buffered records to the file (compacts the journal if it got too large)
+		bool compact(); // Replaces all records with a snapshot of the current model contents
+
+		// Continues the journal from the saved scenario file (if the model was edited since the saved state, the new journal starts with a snapshot)
+		// The old journal is only replaced once the new one is written, on failure it is kept (with the buffered records) and the journal stays active
+		bool rebase(const QString& scenario_file_path, bool keep_edits, QString& error_msg);
+
+		// Applies the journal records to the scenario loaded from the given file, returning the rows of the levels which were changed
+		bool replay(const QString& scenario_file_path, Scenario& scenario, QList<int>& modified_level_rows, QString& error_msg) const;
+	private:
+		void connect_signals();
+
+		void level_rows_inserted(const QModelIndex& parent, int first, int last);
+		void level_rows_removed(const QModelIndex& parent, int first, int last);
+		void level_rows_moved(const QModelIndex& parent, int first, int last, const QModelIndex& destination_parent, int destination_row);
+		void level_data_changed(const QModelIndex& top_left, const QModelIndex& bottom_right, const QList<int>& roles);
+		void terminal_rows_inserted(int level_id, int first_row, int last_row);
+		void terminal_rows_removed(int level_id, int first_row, int last_row);
+		void terminal_rows_moved(int level_id, int first_row, int last_row, int destination_row);
+		void terminal_modified(int level_id, int terminal_id);
+
+		struct Internal;
+		std::unique_ptr<Internal> m_internal;
+	};
+}
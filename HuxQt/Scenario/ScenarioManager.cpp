@@ -1,19 +1,28 @@
 #include <HuxQt/Scenario/ScenarioManager.h>
 
-#include <HuxQt/AppCore.h>
-#include <HuxQt/UI/HuxQt.h>
-
 #include <HuxQt/Scenario/Scenario.h>
-#include <HuxQt/Scenario/ScenarioBrowserModel.h>
+#include <HuxQt/Scenario/MemoryReport.h>
 
+#include <HuxQt/Utils/Trace.h>
 #include <HuxQt/Utils/Utilities.h>
 
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDirIterator>
-
-#include <QMessageBox>
+#include <QSaveFile>
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QStringEncoder>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <numeric>
 
 namespace HuxApp
 {
@@ -22,6 +31,11 @@ namespace HuxApp
 		constexpr auto TERMINAL_SCRIPT_ENCODING = QStringConverter::Encoding::Utf8;
 		constexpr const char* TERMINAL_SCRIPT_SUFFIX = ".term.txt";
 
+		// Scenario files start with an index of the levels (on a single line), so the level contents can be loaded on demand
+		constexpr int SCENARIO_INDEX_VERSION = 1;
+		constexpr const char* SCENARIO_INDEX_KEY = "\"HUX_INDEX\":";
+		constexpr const char* SCENARIO_LEVELS_KEY = "\"LEVELS\": [";
+
 		enum class ScriptKeywords
 		{
 			TERMINAL,
@@ -91,78 +105,6 @@ namespace HuxApp
 			return "";
 		}
 
-		enum class TextFormattingTags
-		{
-			BOLD_START,
-			BOLD_END,
-			ITALICIZED_START,
-			ITALICIZED_END,
-			UNDERLINED_START,
-			UNDERLINED_END,
-			TEXT_COLOR,
-			TAG_COUNT
-		};
-
-		/*$Cn changes colors of text to color n, where n can be any number between 0 and 7.
-
-		$B  starts  bold  text.
-		$b  ends  bold  text.
-		$I  begins  italicized  text.
-		$i  ends  italics.
-		$U  starts  underlined  text.
-		$u  ends  underline*/
-
-		// Formatting tags in Aleph One 
-		constexpr const char* AO_FORMATTING_TAG_ARRAY[Utils::to_integral(TextFormattingTags::TAG_COUNT)] = {
-			"$B",
-			"$b",
-			"$I",
-			"$i",
-			"$U",
-			"$u",
-			"$C[0-7]"
-		};
-
-		// Regexp for finding color tags
-		const QRegularExpression AO_COLOR_REGEXP = QRegularExpression(R"(\$C(?<color>[0-7]))");
-		const QRegularExpression AO_LINE_SEP_REGEXP = QRegularExpression(R"([&*\+\-<=>\/^|])");
-
-		// HTML tags in Hux output
-		constexpr const char* HTML_TAG_ARRAY[Utils::to_integral(TextFormattingTags::TAG_COUNT)] = {
-			"<b>",
-			"</b>",
-			"<i>",
-			"</i>",
-			"<u>",
-			"</u>",
-			"<span style=\"color:%1\">"
-		};
-
-		// Regexp for finding color span tags in Hux output
-		const QRegularExpression HTML_COLOR_REGEXP = QRegularExpression("<span style=\"color:(?<color>\\w+)\">");
-
-		const QColor DEFAULT_QT_TEXT_COLORS_ARRAY[ScenarioManager::TEXT_COLOR_COUNT] = {
-			Qt::green,
-			Qt::white,
-			Qt::red,
-			Qt::darkGreen,
-			Qt::blue,
-			Qt::yellow,
-			Qt::darkRed,
-			Qt::darkBlue
-		};
-
-		constexpr const char* DEFAULT_HTML_COLORS_ARRAY[ScenarioManager::TEXT_COLOR_COUNT] = {
-			"Lime",
-			"White",
-			"Red",
-			"DarkGreen",
-			"LightBlue",
-			"Yellow",
-			"DarkRed",
-			"DarkBlue"
-		};
-
 		bool validate_scenario_folder(const QString& path, QStringList& level_dir_list)
 		{
 			// Assume we were given a path to a split map folder (e.g via Atque)
@@ -276,272 +218,44 @@ namespace HuxApp
 			return true;
 		}
 
-		void export_terminal_screens(const std::vector<Terminal::Screen>& terminal_screens, QString& terminal_script_text)
-		{
-			for (const Terminal::Screen& current_screen : terminal_screens)
-			{
-				// First add the screen header
-				switch (current_screen.m_type)
-				{
-				case Terminal::ScreenType::NONE:
-					break;
-				case Terminal::ScreenType::INFORMATION:
-					terminal_script_text += QStringLiteral("%1\n").arg(get_script_keyword(ScriptKeywords::INFORMATION));
-					break;
-				case Terminal::ScreenType::PICT:
-				{
-					if (current_screen.m_alignment == Terminal::ScreenAlignment::LEFT)
-					{
-						terminal_script_text += QStringLiteral("%1 %2\n").arg(get_script_keyword(ScriptKeywords::PICT), QString::number(current_screen.m_resource_id));
-					}
-					else
-					{
-						const int alignment_index = Utils::to_integral(current_screen.m_alignment);
-						terminal_script_text += QStringLiteral("%1 %2 %3\n").arg(get_script_keyword(ScriptKeywords::PICT), QString::number(current_screen.m_resource_id), SCREEN_ALIGNMENT_KEYWORDS[alignment_index]);
-					}
-					break;
-				}
-				default:
-					// Add the keyword and the resource ID
-					terminal_script_text += QStringLiteral("%1 %2\n").arg(get_screen_keyword(current_screen.m_type), QString::number(current_screen.m_resource_id));
-					break;
-				}
-
-				// Add any text we might have
-				if (screen_has_text(current_screen) && !current_screen.m_script.isEmpty())
-				{
-					terminal_script_text += current_screen.m_script;
-					terminal_script_text += "\n";
-				}
-			}
-		}
-
-		void export_terminal_teleport(const Terminal::Teleport& teleport_info, QString& terminal_script_text)
-		{
-			switch (teleport_info.m_type)
-			{
-			case Terminal::TeleportType::INTERLEVEL:
-				terminal_script_text += QStringLiteral("%1 %2\n").arg(get_script_keyword(ScriptKeywords::INTERLEVEL_TELEPORT), QString::number(teleport_info.m_index));
-				break;
-			case Terminal::TeleportType::INTRALEVEL:
-				terminal_script_text += QStringLiteral("%1 %2\n").arg(get_script_keyword(ScriptKeywords::INTRALEVEL_TELEPORT), QString::number(teleport_info.m_index));
-				break;
-			}
-		}	
-
-		int get_screen_character_limit(Terminal::ScreenType screen_type)
-		{
-			switch (screen_type)
-			{
-			case Terminal::ScreenType::INFORMATION:
-				return 70;
-			case Terminal::ScreenType::PICT:
-			case Terminal::ScreenType::CHECKPOINT:
-				return 43;
-			}
-
-			return -1;
-		}
-
-		bool is_separator_character(QChar character)
-		{
-			const QRegularExpressionMatch match = AO_LINE_SEP_REGEXP.match(character);
-			return match.hasMatch();
-		}
-
-		QString get_tag_regex_string()
-		{
-			QStringList tag_regex_list;
-			for (int current_tag_index = 0; current_tag_index < Utils::to_integral(TextFormattingTags::TAG_COUNT); ++current_tag_index)
-			{
-				tag_regex_list << QStringLiteral("(\\%1)").arg(AO_FORMATTING_TAG_ARRAY[current_tag_index]);
-			}
-			return tag_regex_list.join('|');
-		}
-
-		const QRegularExpression& get_tag_regex()
-		{
-			// Create a RegEx that can match the AO formatting tags 
-			static QRegularExpression tag_regex(get_tag_regex_string());
-			return tag_regex;
-		}
+		constexpr QCryptographicHash::Algorithm SCRIPT_HASH_ALGORITHM = QCryptographicHash::Sha1;
 
-		void wrap_line(const QString& line, Terminal::ScreenType screen_type, QStringList& wrapped_lines)
+		bool hash_script_file(const QString& file_path, QByteArray& file_hash)
 		{
-			const QRegularExpression& tag_regex = get_tag_regex();
-
-			// Use a struct to store the tag contents
-			struct FormattingTag
-			{
-				QString m_tag;
-				int m_offset = -1;
-			};
-
-			std::vector<FormattingTag> formatting_tags;
-
-			// Filter out the tags from the line
-			QString filtered_line = line;
-			QRegularExpressionMatch tag_match = tag_regex.match(filtered_line, 0, QRegularExpression::MatchType::PartialPreferFirstMatch);
-
-			while (tag_match.hasMatch())
+			// Read in text mode, so line endings match what we would write
+			QFile script_file(file_path);
+			if (!script_file.open(QIODevice::ReadOnly | QIODevice::Text))
 			{
-				// Found a tag, cache it and remove from processed string
-                formatting_tags.emplace_back();
-                FormattingTag& found_tag = formatting_tags.back();
-
-				const int last_captured_index = tag_match.lastCapturedIndex();
-				found_tag.m_offset = tag_match.capturedStart(last_captured_index); // Make sure the offset takes into account that tags will be re-added before this one
-				found_tag.m_tag = filtered_line.mid(found_tag.m_offset, tag_match.capturedLength(last_captured_index));
-				filtered_line.remove(found_tag.m_offset, tag_match.capturedLength(last_captured_index));
-
-				// Check if we have any more tags (starting from the offset we found, since we removed the tag itself)
-				tag_match = tag_regex.match(filtered_line, found_tag.m_offset, QRegularExpression::MatchType::PartialPreferFirstMatch);
+				return false;
 			}
 
-			// Traverse the filtered line and wrap based on line length
-			QStringList filtered_wrapped_lines;
+			QCryptographicHash script_hash(SCRIPT_HASH_ALGORITHM);
+			if (!script_hash.addData(&script_file))
 			{
-				int current_line_start = 0;
-				int current_line_end = 0;
-				const int character_limit = get_screen_character_limit(screen_type);
-				while (true)
-				{
-					if (current_line_end == filtered_line.length())
-					{
-						// Add whatever else was left and end the loop
-						filtered_wrapped_lines << filtered_line.mid(current_line_start);
-						break;
-					}
-
-					const int current_length = current_line_end - current_line_start;
-					if (current_length > character_limit)
-					{
-						// Reached limit, go back and see where we can wrap
-						int wrap_index = (current_line_end - 1);
-						for (; wrap_index > current_line_start; --wrap_index)
-						{
-							const QChar wrap_char = filtered_line[wrap_index];
-							if (wrap_char == ' ')
-							{
-								// Eat space
-								current_line_end = (wrap_index + 1);
-								break;
-							}
-							else if (is_separator_character(wrap_char))
-							{
-								// Found a separator, use as break point
-								current_line_end = wrap_index;
-								break;
-							}
-						}
-						assert(wrap_index >= 0);
-
-						// Add the line (if we didn't find a place to wrap, we'll simply wrap at the character limit)
-						filtered_wrapped_lines << filtered_line.mid(current_line_start, (current_line_end - current_line_start));
-						current_line_start = current_line_end;
-					}
-					else
-					{
-						++current_line_end;
-					}
-				}
+				return false;
 			}
 
-			if (!formatting_tags.empty())
-			{
-				// Iterate over our strings and re-insert the tags
-				int total_character_count = 0;
-				auto formatting_tag_it = formatting_tags.begin();
-
-				for (const QString& current_wrapped_line : filtered_wrapped_lines)
-				{
-					if (formatting_tag_it != formatting_tags.end())
-					{
-						QString finalized_wrapped_line;
-						int current_char_offset = 0;
-						while (current_char_offset < current_wrapped_line.length())
-						{
-							if (total_character_count == formatting_tag_it->m_offset)
-							{
-								finalized_wrapped_line += formatting_tag_it->m_tag;
-								++formatting_tag_it;
-								if (formatting_tag_it == formatting_tags.end())
-								{
-									// Finished adding all tags, just add the rest of the string
-									finalized_wrapped_line += current_wrapped_line.mid(current_char_offset);
-									break;
-								}
-								// Go again (may return in case multiple tags were at the same offset)
-								continue;
-							}
-							// Add the current character and update the offsets
-							finalized_wrapped_line += current_wrapped_line[current_char_offset];
-							++total_character_count;
-							++current_char_offset;
-						}
-						wrapped_lines << finalized_wrapped_line;
-					}
-					else
-					{
-						// No more tags, just add the rest of the lines
-						wrapped_lines << current_wrapped_line;
-					}
-				}
-
-				// If any tags were left, we add them to the end of the last line
-				if (formatting_tag_it != formatting_tags.end())
-				{
-					if (wrapped_lines.isEmpty())
-					{
-						// Add an empty string, just in case this is a completely empty line with just formatting tags in it
-						wrapped_lines << QString();
-					}
-					for (formatting_tag_it; formatting_tag_it != formatting_tags.end(); ++formatting_tag_it)
-					{
-						wrapped_lines.back() += formatting_tag_it->m_tag;
-					}
-				}
-			}
-			else
-			{
-				// No tags to process, add lines verbatim
-				wrapped_lines << filtered_wrapped_lines;
-			}
+			file_hash = script_hash.result();
+			return true;
 		}
 
-		QString wrap_ao_text(const QString& ao_text, Terminal::ScreenType screen_type)
+		// Write-only device that just hashes the data (so we can compare generated scripts without storing them)
+		class HashSinkDevice : public QIODevice
 		{
-			if (ao_text.isEmpty())
-			{
-				return QString();
-			}
-			else if ((screen_type != Terminal::ScreenType::INFORMATION)
-				&& (screen_type != Terminal::ScreenType::PICT)
-				&& (screen_type != Terminal::ScreenType::CHECKPOINT))
-			{
-				// Only perform wrapping for screen types where it's relevant
-				return ao_text;
-			}
+		public:
+			HashSinkDevice(QCryptographicHash::Algorithm algorithm) : m_hash(algorithm) {}
 
-			// First split the line along line breaks
-			const QStringList lines = ao_text.split('\n');
-			QStringList wrapped_lines;
-
-			for (const QString& current_line : lines)
+			QByteArray get_result() const { return m_hash.result(); }
+		protected:
+			qint64 readData(char* /*data*/, qint64 /*max_size*/) override { return -1; }
+			qint64 writeData(const char* data, qint64 size) override
 			{
-				if (!current_line.isEmpty())
-				{
-					wrap_line(current_line, screen_type, wrapped_lines);
-				}
-				else
-				{
-					// Empty line, add it so we don't miss any line breaks
-					wrapped_lines << current_line;
-				}
+				m_hash.addData(QByteArrayView(data, size));
+				return size;
 			}
-
-			return wrapped_lines.join('\n');
-		}
+		private:
+			QCryptographicHash m_hash;
+		};
 	}
 
 	class ScenarioManager::ScriptParser
@@ -554,6 +268,7 @@ namespace HuxApp
 
 		bool parse_level(const QFileInfo& level_file_info)
 		{
+			HUX_TRACE_SCOPE("scenario", "parse_level");
 			QFile level_file(level_file_info.absoluteFilePath());
 			if (level_file.open(QIODevice::ReadOnly))
 			{
@@ -584,6 +299,8 @@ namespace HuxApp
 
 			return false;
 		}
+
+		int get_line_number() const { return m_line_number; } // Last line that was read (1-based, 0 if nothing was read)
 	private:
 		enum class ParserState
 		{
@@ -597,6 +314,7 @@ namespace HuxApp
 		void read_line()
 		{
 			m_current_line = m_file_stream.readLine();
+			++m_line_number;
 			parse_current_line_type();
 		}
 
@@ -661,7 +379,7 @@ namespace HuxApp
 			}
 		}
 
-		void validate_end_terminal(const Terminal& terminal, int terminal_id)
+		void validate_end_terminal(Terminal& terminal, int terminal_id)
 		{
 			// Validate that the ID matches the one we were parsing
 			QStringList terminal_header_strings = m_current_line.split(' ');
@@ -675,9 +393,9 @@ namespace HuxApp
 
 			if (end_id == terminal_id)
 			{
-				// We are done with this terminal
+				// We are done with this terminal (hand over the parsed data instead of copying it)
 				m_state = ParserState::NONE;
-				m_level.m_terminals.push_back(terminal);
+				m_level.m_terminals.push_back(std::move(terminal));
 			}
 			else
 			{
@@ -691,7 +409,7 @@ namespace HuxApp
 			Terminal new_terminal;
 
 			// Store comments buffered up to this point
-			new_terminal.m_comments = m_comment_buffer;
+			new_terminal.set_comments(m_comment_buffer);
 			m_comment_buffer.clear();
 
 			// Start with the first received line (has the terminal ID)
@@ -763,7 +481,7 @@ namespace HuxApp
 						// Was parsing info for a valid screen, and we hit a new keyword, so we can now store this screen
 						current_screen.m_script.chop(1); // Parsing will add a redundant endline at the very end, remove it
 						current_screen.m_display_text = m_scenario_manager.convert_ao_to_html(current_screen.m_script, Utils::to_integral(current_screen.m_type));
-						selected_branch.m_screens.push_back(current_screen);
+						selected_branch.m_screens.push_back(std::move(current_screen));
 						current_screen.reset();
 						current_screen.m_comments = m_comment_buffer; // All comments up to this point will be interpreted as for this screen
 						m_comment_buffer.clear();
@@ -882,6 +600,7 @@ namespace HuxApp
 
 		QTextStream m_file_stream;
 		QString m_current_line;
+		int m_line_number = 0;
 		ScriptKeywords m_current_line_type = ScriptKeywords::KEYWORD_COUNT;
 		QString m_comment_buffer;
 	};
@@ -923,12 +642,12 @@ namespace HuxApp
 		static void serialize_terminal_json(const Terminal& terminal, QJsonObject& terminal_json)
 		{
 			// Serialize name and all the valid branches
-			terminal_json["NAME"] = terminal.m_name;
+			terminal_json["NAME"] = terminal.get_name();
 
 			QJsonObject branches_json;
 
 			int current_branch_index = 0;
-			for (const Terminal::Branch& current_branch : terminal.m_branches)
+			for (const Terminal::Branch& current_branch : terminal.get_branches())
 			{
 				const Terminal::BranchType current_branch_type = Utils::to_enum<Terminal::BranchType>(current_branch_index);
 				if (current_branch.is_valid())
@@ -967,7 +686,7 @@ namespace HuxApp
 			teleport.m_index = teleport_json["INDEX"].toInt();
 		}
 
-		static void deserialize_screen_json(const ScenarioManager& scenario_manager, const QJsonObject& screen_json, Terminal::Screen& screen)
+		static void deserialize_screen_json(const TextColorArray& text_colors, const QJsonObject& screen_json, Terminal::Screen& screen)
 		{
 			screen.m_type = Utils::to_enum<Terminal::ScreenType>(screen_json["TYPE"].toInt());
 			screen.m_alignment = Utils::to_enum<Terminal::ScreenAlignment>(screen_json["ALIGNMENT"].toInt());
@@ -975,27 +694,28 @@ namespace HuxApp
 			screen.m_script = screen_json["SCRIPT"].toString();
 
 			// Have to parse the script to get the display text
-			screen.m_display_text = scenario_manager.convert_ao_to_html(screen.m_script, Utils::to_integral(screen.m_type));
+			screen.m_display_text = ScenarioManager::convert_ao_to_html(screen.m_script, Utils::to_integral(screen.m_type), text_colors);
 		}
 
-		static void deserialize_terminal_branch_json(const ScenarioManager& scenario_manager, const QJsonObject& terminal_branch_json, Terminal::Branch& terminal_branch)
+		static void deserialize_terminal_branch_json(const TextColorArray& text_colors, const QJsonObject& terminal_branch_json, Terminal::Branch& terminal_branch)
 		{
 			const QJsonArray screens_array = terminal_branch_json["SCREENS"].toArray();
+			terminal_branch.m_screens.reserve(screens_array.size());
 			for (const QJsonValue& current_screen_json_value : screens_array)
 			{
                 terminal_branch.m_screens.emplace_back();
                 Terminal::Screen& current_screen = terminal_branch.m_screens.back();
 				const QJsonObject current_screen_json = current_screen_json_value.toObject();
-				deserialize_screen_json(scenario_manager, current_screen_json, current_screen);
+				deserialize_screen_json(text_colors, current_screen_json, current_screen);
 			}
 
 			const QJsonObject teleport_json = terminal_branch_json["TELEPORT"].toObject();
 			deserialize_teleport_info(teleport_json, terminal_branch.m_teleport);
 		}
 
-		static void deserialize_terminal_json(const ScenarioManager& scenario_manager, const QJsonObject& terminal_json, Terminal& terminal)
+		static void deserialize_terminal_json(const TextColorArray& text_colors, const QJsonObject& terminal_json, Terminal& terminal)
 		{
-			terminal.m_name = terminal_json["NAME"].toString();
+			terminal.set_name(terminal_json["NAME"].toString());
 
 			const QJsonObject terminal_branches_json = terminal_json["BRANCHES"].toObject();
 
@@ -1004,196 +724,733 @@ namespace HuxApp
 				const QJsonObject current_branch_object = terminal_branches_json[current_key].toObject();
 				Terminal::Branch& current_branch = terminal.get_branch(get_branch_type(current_key));
 
-				deserialize_terminal_branch_json(scenario_manager, current_branch_object, current_branch);
+				deserialize_terminal_branch_json(text_colors, current_branch_object, current_branch);
 			}
 		}
 
-		static void deserialize_level_json(const ScenarioManager& scenario_manager, const QJsonObject& level_json, Scenario& scenario, Level& level)
+		static void deserialize_level_json(const TextColorArray& text_colors, const QJsonObject& level_json, Level& level)
 		{
 			level.m_name = level_json["NAME"].toString();
 			level.m_dir_name = level_json["DIR_NAME"].toString();
 			level.m_script_name = level_json["SCRIPT_NAME"].toString();
 
+			deserialize_level_terminals(text_colors, level_json, level);
+		}
+
+		static void deserialize_level_terminals(const TextColorArray& text_colors, const QJsonObject& level_json, Level& level)
+		{
 			const QJsonArray terminal_array = level_json["TERMINALS"].toArray();
+			level.m_terminals.reserve(terminal_array.size());
 			for (const QJsonValue& current_terminal_value : terminal_array)
 			{
                 level.m_terminals.emplace_back();
                 Terminal& current_terminal = level.m_terminals.back();
 				const QJsonObject current_terminal_json = current_terminal_value.toObject();
-				deserialize_terminal_json(scenario_manager, current_terminal_json, current_terminal);
+				deserialize_terminal_json(text_colors, current_terminal_json, current_terminal);
 			}
 		}
-	};
-
-	struct ScenarioManager::Internal
-	{
-		std::unique_ptr<Terminal> m_screen_clipboard;
-
-		std::unordered_map<int, Level> m_level_pool;
-		std::unordered_map<int, Terminal> m_terminal_pool;
-
-		int m_id_counter = 0;
 
-		TextColorArray m_text_colors;
-
-		Internal()
+		static QJsonObject serialize_level_index_entry(const Level& level, qint64 offset, qint64 length)
 		{
-			reset();
+			QJsonObject index_entry_json;
+			index_entry_json["NAME"] = level.get_name();
+			index_entry_json["DIR_NAME"] = level.get_dir_name();
+			index_entry_json["SCRIPT_NAME"] = level.get_script_name();
+			index_entry_json["TERMINAL_COUNT"] = level.get_terminal_count();
+			index_entry_json["OFFSET"] = offset;
+			index_entry_json["LENGTH"] = length;
+			return index_entry_json;
 		}
 
-		void reset()
+		static bool deserialize_level_index(const QByteArray& scenario_file_data, std::vector<Level>& levels)
 		{
-			int current_color_index = 0;
-			for (QColor& current_color : m_text_colors)
+			// Expected layout: opening brace, index line, line opening the level array, then the level objects
+			const qsizetype first_line_end = scenario_file_data.indexOf('\n');
+			const qsizetype index_line_end = (first_line_end >= 0) ? scenario_file_data.indexOf('\n', first_line_end + 1) : -1;
+			const qsizetype levels_line_end = (index_line_end >= 0) ? scenario_file_data.indexOf('\n', index_line_end + 1) : -1;
+			if (levels_line_end < 0)
 			{
-				current_color = DEFAULT_QT_TEXT_COLORS_ARRAY[current_color_index];
-				++current_color_index;
+				return false;
 			}
-		}
-	};
-
-	ScenarioManager::~ScenarioManager() = default;
-
-	bool ScenarioManager::save_scenario(const QString& file_path, const Scenario& scenario)
-	{
-		// Prepare the JSON file
-		QFile scenario_file(file_path);
-		if (!scenario_file.open(QIODevice::WriteOnly))
-		{
-			QMessageBox::warning(m_core.get_main_window(), "File I/O Error", QStringLiteral("Unable to open file \"%1\"!").arg(file_path));
-			return false;
-		}
 
-		// Create JSON root object
-		QJsonObject scenario_root_json;
-
-		// Serialize the levels
-		QJsonArray levels_json_array;
-		for (const Level& current_level : scenario.m_levels)
-		{
-			QJsonObject current_level_json;
-			ScriptJSONSerializer::serialize_level_json(current_level, current_level_json);
-			levels_json_array.append(current_level_json);
-		}
+			QByteArray index_line = scenario_file_data.mid(first_line_end + 1, index_line_end - first_line_end - 1).trimmed();
+			const QByteArray levels_line = scenario_file_data.mid(index_line_end + 1, levels_line_end - index_line_end - 1).trimmed();
+			if (!index_line.startsWith(SCENARIO_INDEX_KEY) || !index_line.endsWith(',') || (levels_line != SCENARIO_LEVELS_KEY))
+			{
+				return false;
+			}
+			index_line = index_line.mid(qstrlen(SCENARIO_INDEX_KEY));
+			index_line.chop(1);
 
-		// Store the level array
-		scenario_root_json["LEVELS"] = levels_json_array;
+			const QJsonObject index_json = QJsonDocument::fromJson(index_line).object();
+			if (index_json["VERSION"].toInt() != SCENARIO_INDEX_VERSION)
+			{
+				return false;
+			}
 
-		// Write to file
-		if (scenario_file.write(QJsonDocument(scenario_root_json).toJson()) == -1)
-		{
-			QMessageBox::warning(m_core.get_main_window(), "File I/O Error", QStringLiteral("Error writing to file \"%1\"!").arg(file_path));
-			return false;
-		}
+			// Offsets are relative to the start of the level data
+			const qsizetype level_data_start = levels_line_end + 1;
+			const QJsonArray index_entries_json = index_json["LEVELS"].toArray();
 
-		return true;
-	}
+			// The ranges have to cover the level data end to end (e.g a merge may have kept the index of one side while the other added a level)
+			qsizetype expected_offset = level_data_start;
 
-	bool ScenarioManager::export_scenario(const QString& split_folder_path, const Scenario& scenario)
-	{
-		for (const Level& current_level : scenario.m_levels)
-		{
-			// Open a file for each level, create folder if necessary
-			const QString level_dir_path = split_folder_path + "/" + current_level.get_dir_name();
-			QDir level_dir;
-			if (!level_dir.exists(level_dir_path))
+			std::vector<Level> indexed_levels(index_entries_json.size());
+			auto current_level_it = indexed_levels.begin();
+			for (const QJsonValue& current_entry_value : index_entries_json)
 			{
-				if (!level_dir.mkpath(level_dir_path))
+				const QJsonObject current_entry_json = current_entry_value.toObject();
+
+				LevelSource level_source;
+				level_source.m_file_data = scenario_file_data;
+				level_source.m_offset = level_data_start + current_entry_json["OFFSET"].toInteger(-1);
+				level_source.m_length = current_entry_json["LENGTH"].toInteger(-1);
+				level_source.m_terminal_count = current_entry_json["TERMINAL_COUNT"].toInt();
+				level_source.m_name = current_entry_json["NAME"].toString();
+				level_source.m_dir_name = current_entry_json["DIR_NAME"].toString();
+				level_source.m_script_name = current_entry_json["SCRIPT_NAME"].toString();
+
+				// Make sure the range is plausible (e.g the file may have been edited by hand, in which case we have to parse everything)
+				const qsizetype level_data_end = level_source.m_offset + level_source.m_length;
+				if ((level_source.m_offset != expected_offset) || (level_source.m_length < 2) || (level_data_end > scenario_file_data.size())
+					|| (scenario_file_data[level_source.m_offset - 1] != '\n') || (scenario_file_data[level_source.m_offset] != '{') || (scenario_file_data[level_data_end - 1] != '}'))
+				{
+					return false;
+				}
+
+				// Levels are separated by ",\n", the last one is only followed by a line break
+				const bool last_level = (std::next(current_level_it) == indexed_levels.end());
+				const QByteArrayView level_separator = last_level ? QByteArrayView("\n") : QByteArrayView(",\n");
+				if (!QByteArrayView(scenario_file_data).sliced(level_data_end).startsWith(level_separator))
 				{
-					QMessageBox::warning(m_core.get_main_window(), "File I/O Error", QStringLiteral("Unable to save to directory \"%1\"!").arg(level_dir_path));
 					return false;
 				}
+				expected_offset = level_data_end + level_separator.size();
+
+				Level& current_level = *current_level_it;
+				current_level.m_name = level_source.m_name;
+				current_level.m_dir_name = level_source.m_dir_name;
+				current_level.m_script_name = level_source.m_script_name;
+				current_level.set_source(level_source);
+				++current_level_it;
 			}
 
-			const QString level_file_path = QStringLiteral("%1/%2.term.txt").arg(level_dir_path).arg(current_level.get_script_name());
-			QFile level_file(level_file_path);
-			if (!level_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+			// Nothing but the end of the level array and the root object may follow
+			QByteArray file_end;
+			for (const char current_char : QByteArrayView(scenario_file_data).sliced(expected_offset))
+			{
+				if (!QChar::isSpace(static_cast<uchar>(current_char)))
+				{
+					file_end += current_char;
+				}
+			}
+			if (file_end != "]}")
 			{
-				QMessageBox::warning(m_core.get_main_window(), "File I/O Error", QStringLiteral("Unable to save to file \"%1\"!").arg(level_file_path));
-				level_file.close();
 				return false;
 			}
-			export_level_script(level_file, current_level);
-		}
 
-		return true;
-	}
+			levels = std::move(indexed_levels);
+			return true;
+		}
+	};
 
-	bool ScenarioManager::load_scenario(const QString& file_path, Scenario& scenario)
+	// Emits the terminal scripts, encoding the text straight into a buffer which is flushed to the target device
+	// Keywords and numbers are written as-is, so no temporary strings are needed
+	class ScenarioManager::ScriptWriter
 	{
-		// First make sure the file exists and is the correct type
-		QFileInfo file_info(file_path);
-		if (!file_info.isFile())
+	public:
+		static constexpr qsizetype DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+		ScriptWriter(QIODevice& device, qsizetype buffer_size = DEFAULT_BUFFER_SIZE)
+			: m_device(device)
+			, m_encoder(TERMINAL_SCRIPT_ENCODING)
 		{
-			return false;
+			m_buffer.resize(buffer_size);
 		}
 
-		// Open the file
-		QFile scenario_file(file_path);
-		if (!scenario_file.open(QIODevice::ReadOnly))
+		~ScriptWriter()
 		{
-			QMessageBox::warning(m_core.get_main_window(), "File I/O Error", QStringLiteral("Unable to open file \"%1\"!").arg(file_path));
-			return false;
+			flush();
 		}
 
-		// Load the JSON data and parse it
-		QByteArray scenario_file_data = scenario_file.readAll();
-
-		QJsonParseError parse_error;
-		QJsonDocument scenario_json_document = QJsonDocument::fromJson(scenario_file_data, &parse_error);
-		if (parse_error.error != QJsonParseError::NoError)
+		bool flush()
 		{
-			QMessageBox::warning(m_core.get_main_window(), "Scenario File Error", QStringLiteral("Invalid scenario file! Error: \"%1\"!").arg(parse_error.errorString()));
-			return false;
+			if ((m_buffer_used > 0) && !m_error)
+			{
+				if (m_device.write(m_buffer.constData(), m_buffer_used) != m_buffer_used)
+				{
+					m_error = true;
+				}
+				m_bytes_written += m_buffer_used;
+			}
+			m_buffer_used = 0;
+			return !m_error;
 		}
 
-		// Parse successful, reset the scenario contents
-		scenario.reset();
-
-		// Use the file name as the scenario name
-		scenario.m_name = file_info.baseName();
+		bool has_error() const { return m_error; }
+		qint64 get_bytes_written() const { return m_bytes_written + m_buffer_used; }
 
-		// Load the scenario from the root object
-		const QJsonObject scenario_root_json = scenario_json_document.object();
-		const QJsonArray levels_json_array = scenario_root_json["LEVELS"].toArray();
-		for (const QJsonValue& current_level_value : levels_json_array)
-		{            
-            scenario.m_levels.emplace_back();
-            Level& current_level = scenario.m_levels.back();
-			const QJsonObject current_level_json = current_level_value.toObject();
-			ScriptJSONSerializer::deserialize_level_json(*this, current_level_json, scenario, current_level);
+		void write_level(const Level& level)
+		{
+			const std::vector<Terminal>& terminals = level.get_terminals();
+			const int terminal_count = static_cast<int>(terminals.size());
+			for (int terminal_index = 0; terminal_index < terminal_count; ++terminal_index)
+			{
+				write_terminal(terminals[terminal_index], terminal_index);
+				if (terminal_index < (terminal_count - 1))
+				{
+					write_char('\n');
+				}
+			}
 		}
 
-		QDir file_dir = file_info.absoluteDir();
-		if (!file_dir.cd("Resources"))
+		void write_terminal(const Terminal& terminal, int terminal_index)
 		{
-			QMessageBox::warning(m_core.get_main_window(), "Scenario Warning", QStringLiteral("No Resources folder present for this scenario file! Images will not be available for terminal previews!"));
-		}
+			// Start with a comment tag (apparently needed for formatting?)
+			write_raw(";\n", 2);
 
-		m_internal->reset();
-		return true;
-	}
+			// Add the terminal header
+			write_keyword_line(ScriptKeywords::TERMINAL, terminal_index);
 
-	bool ScenarioManager::import_scenario(const QString& split_folder_path, Scenario& scenario)
-	{
-		QStringList level_dir_list;
-		if (!validate_scenario_folder(split_folder_path, level_dir_list))
-		{
-			QMessageBox::warning(m_core.get_main_window(), "Scenario Load Error", "The selected folder does not contain a valid Aleph One scenario!");
-			return false;
-		}
+			int current_branch_index = 0;
+			for (const Terminal::Branch& current_branch : terminal.get_branches())
+			{
+				const Terminal::BranchType current_branch_type = Utils::to_enum<Terminal::BranchType>(current_branch_index);
+				if (current_branch.is_valid())
+				{
+					// Add the branch type header
+					write_keyword(get_script_keyword(get_branch_type_keyword(current_branch_type)));
+					write_char('\n');
 
-		// Reset the scenario contents
-		scenario.reset();
+					// Add screens and teleport info
+					write_screens(current_branch.m_screens);
+					write_teleport(current_branch.m_teleport);
 
-		scenario.m_name = QDir(split_folder_path).dirName();
+					// Add the end header
+					write_keyword(get_script_keyword(ScriptKeywords::END));
+					write_char('\n');
+				}
+				++current_branch_index;
+			}
 
-		for (const QString& level_dir_name : level_dir_list)
+			// Add the terminal end header (no line break, the caller adds it if needed)
+			write_keyword(get_script_keyword(ScriptKeywords::END_TERMINAL));
+			write_char(' ');
+			write_int(terminal_index);
+		}
+	private:
+		void write_screens(const Terminal::ScreenVector& terminal_screens)
 		{
-			const QDir current_level_dir(split_folder_path + "/" + level_dir_name);
-			const QFileInfoList file_info_list = current_level_dir.entryInfoList(QDir::Files);
-
-			for (const QFileInfo& current_file : file_info_list)
+			for (const Terminal::Screen& current_screen : terminal_screens)
+			{
+				// First add the screen header
+				switch (current_screen.m_type)
+				{
+				case Terminal::ScreenType::NONE:
+					break;
+				case Terminal::ScreenType::INFORMATION:
+					write_keyword(get_script_keyword(ScriptKeywords::INFORMATION));
+					write_char('\n');
+					break;
+				case Terminal::ScreenType::PICT:
+				{
+					write_keyword(get_script_keyword(ScriptKeywords::PICT));
+					write_char(' ');
+					write_int(current_screen.m_resource_id);
+					if (current_screen.m_alignment != Terminal::ScreenAlignment::LEFT)
+					{
+						write_char(' ');
+						write_keyword(SCREEN_ALIGNMENT_KEYWORDS[Utils::to_integral(current_screen.m_alignment)]);
+					}
+					write_char('\n');
+					break;
+				}
+				default:
+					// Add the keyword and the resource ID
+					write_keyword(get_screen_keyword(current_screen.m_type));
+					write_char(' ');
+					write_int(current_screen.m_resource_id);
+					write_char('\n');
+					break;
+				}
+
+				// Add any text we might have
+				if (screen_has_text(current_screen) && !current_screen.m_script.isEmpty())
+				{
+					write_text(current_screen.m_script);
+					write_char('\n');
+				}
+			}
+		}
+
+		void write_teleport(const Terminal::Teleport& teleport_info)
+		{
+			switch (teleport_info.m_type)
+			{
+			case Terminal::TeleportType::INTERLEVEL:
+				write_keyword_line(ScriptKeywords::INTERLEVEL_TELEPORT, teleport_info.m_index);
+				break;
+			case Terminal::TeleportType::INTRALEVEL:
+				write_keyword_line(ScriptKeywords::INTRALEVEL_TELEPORT, teleport_info.m_index);
+				break;
+			}
+		}
+
+		void write_keyword_line(ScriptKeywords keyword, int value)
+		{
+			write_keyword(get_script_keyword(keyword));
+			write_char(' ');
+			write_int(value);
+			write_char('\n');
+		}
+
+		// Keywords are plain ASCII, so they are the same in UTF-8
+		void write_keyword(const char* keyword) { write_raw(keyword, static_cast<qsizetype>(std::strlen(keyword))); }
+
+		void write_int(int value)
+		{
+			char digits[16];
+			const std::to_chars_result result = std::to_chars(std::begin(digits), std::end(digits), value);
+			write_raw(digits, result.ptr - digits);
+		}
+
+		void write_char(char character)
+		{
+			reserve(1);
+			m_buffer[m_buffer_used++] = character;
+		}
+
+		void write_raw(const char* data, qsizetype size)
+		{
+			reserve(size);
+			std::memcpy(m_buffer.data() + m_buffer_used, data, size);
+			m_buffer_used += size;
+		}
+
+		void write_text(QStringView text)
+		{
+			// Encode in chunks, so we never need more than the buffer capacity
+			const qsizetype chunk_length = std::max<qsizetype>(m_buffer.size() / 4, 1);
+			while (!text.isEmpty())
+			{
+				QStringView current_chunk = text.first(std::min(chunk_length, text.size()));
+				if ((current_chunk.size() < text.size()) && current_chunk.back().isHighSurrogate())
+				{
+					// Don't split surrogate pairs
+					current_chunk.chop(1);
+				}
+
+				reserve(m_encoder.requiredSpace(current_chunk.size()));
+				char* const buffer_end = m_encoder.appendToBuffer(m_buffer.data() + m_buffer_used, current_chunk);
+				m_buffer_used = buffer_end - m_buffer.constData();
+				text = text.sliced(current_chunk.size());
+			}
+		}
+
+		void reserve(qsizetype size)
+		{
+			if ((m_buffer_used + size) > m_buffer.size())
+			{
+				flush();
+				if (size > m_buffer.size())
+				{
+					m_buffer.resize(size);
+				}
+			}
+		}
+
+		QIODevice& m_device;
+		QStringEncoder m_encoder;
+
+		QByteArray m_buffer;
+		qsizetype m_buffer_used = 0;
+		qint64 m_bytes_written = 0;
+		bool m_error = false;
+	};
+
+	struct ScenarioManager::Internal
+	{
+		std::unique_ptr<Terminal> m_screen_clipboard;
+
+		// Never modified in place, only replaced (so worker threads can keep using the snapshot they got)
+		std::shared_ptr<const TextColorArray> m_text_colors;
+
+		Internal()
+		{
+			reset();
+		}
+
+		void reset()
+		{
+			set_text_colors(AOText::get_default_text_colors());
+		}
+
+		std::shared_ptr<const TextColorArray> get_text_colors() const { return std::atomic_load(&m_text_colors); }
+		void set_text_colors(const TextColorArray& text_colors) { std::atomic_store(&m_text_colors, std::make_shared<const TextColorArray>(text_colors)); }
+	};
+
+	ScenarioManager::~ScenarioManager() = default;
+
+	bool ScenarioManager::save_scenario(const QString& file_path, const Scenario& scenario, Diagnostics& diagnostics)
+	{
+		HUX_TRACE_SCOPE("scenario", "save_scenario");
+		QString error_msg;
+		QByteArray scenario_data;
+		if (!serialize_scenario(scenario, scenario_data, error_msg) || !write_scenario_file(file_path, scenario_data, error_msg))
+		{
+			diagnostics.add_error(error_msg, file_path);
+			return false;
+		}
+
+		return true;
+	}
+
+	int ScenarioManager::ExportReport::get_result_count(Result result) const
+	{
+		return static_cast<int>(std::count_if(m_levels.begin(), m_levels.end(), [result](const LevelEntry& entry) { return entry.m_result == result; }));
+	}
+
+	QString ScenarioManager::ExportReport::get_summary() const
+	{
+		qint64 total_script_size = 0;
+		for (const LevelEntry& current_entry : m_levels)
+		{
+			total_script_size += current_entry.m_script_size;
+		}
+
+		// Throughput of generating (and if needed, writing) the scripts
+		const double throughput = (m_elapsed_ms > 0) ? ((total_script_size / (1024.0 * 1024.0)) / (m_elapsed_ms / 1000.0)) : 0.0;
+		return QStringLiteral("%1 written, %2 unchanged, %3 failed (%4 ms, %5 MB/s)")
+			.arg(get_result_count(Result::WRITTEN))
+			.arg(get_result_count(Result::SKIPPED))
+			.arg(get_result_count(Result::FAILED))
+			.arg(m_elapsed_ms)
+			.arg(throughput, 0, 'f', 1);
+	}
+
+	const char* ScenarioManager::ExportReport::get_result_label(Result result)
+	{
+		constexpr const char* RESULT_LABELS[Utils::to_integral(Result::RESULT_COUNT)] =
+		{
+			"WRITTEN",
+			"SKIPPED",
+			"FAILED"
+		};
+
+		return RESULT_LABELS[Utils::to_integral(result)];
+	}
+
+	QString ScenarioManager::ExportReport::print() const
+	{
+		// List the failures first, as those need attention
+		QString report_text;
+		for (const Result current_result : { Result::FAILED, Result::WRITTEN, Result::SKIPPED })
+		{
+			for (const LevelEntry& current_entry : m_levels)
+			{
+				if (current_entry.m_result != current_result)
+				{
+					continue;
+				}
+
+				report_text += QStringLiteral("[%1] %2 -> \"%3\" (%4 ms)\n")
+					.arg(QLatin1String(get_result_label(current_result)), current_entry.m_level_name, current_entry.m_file_path)
+					.arg(current_entry.m_elapsed_ms);
+				if (!current_entry.m_error_msg.isEmpty())
+				{
+					report_text += QStringLiteral("    %1\n").arg(current_entry.m_error_msg);
+				}
+			}
+		}
+		report_text += get_summary();
+		return report_text;
+	}
+
+	bool ScenarioManager::export_scenario(const QString& split_folder_path, const Scenario& scenario, Diagnostics& diagnostics)
+	{
+		HUX_TRACE_SCOPE("scenario", "export_scenario");
+		ExportReport report;
+		const bool success = write_scenario_scripts(split_folder_path, scenario, report);
+		for (const ExportReport::LevelEntry& current_entry : report.m_levels)
+		{
+			if (current_entry.m_result == ExportReport::Result::FAILED)
+			{
+				diagnostics.add_error(QStringLiteral("Unable to export level \"%1\": %2").arg(current_entry.m_level_name, current_entry.m_error_msg), current_entry.m_file_path);
+			}
+		}
+
+		return success;
+	}
+
+	bool ScenarioManager::serialize_scenario(const Scenario& scenario, QByteArray& scenario_data, QString& error_msg, const ProgressCallback& progress) const
+	{
+		HUX_TRACE_SCOPE("scenario", "serialize_scenario");
+		// Serialize the levels one by one, recording where each of them is stored so we can write an index
+		const int level_count = static_cast<int>(scenario.m_levels.size());
+		int current_level_index = 0;
+
+		QByteArray level_data;
+		QJsonArray level_index_json_array;
+		for (const Level& current_level : scenario.m_levels)
+		{
+			if (progress)
+			{
+				progress(current_level_index, level_count);
+			}
+
+			QByteArray current_level_data;
+			const LevelSource& current_level_source = current_level.get_source();
+			if (!current_level.is_loaded()
+				&& (current_level_source.m_name == current_level.get_name())
+				&& (current_level_source.m_dir_name == current_level.get_dir_name())
+				&& (current_level_source.m_script_name == current_level.get_script_name()))
+			{
+				// Level was never loaded or renamed, we can copy it from the original file as-is
+				current_level_data = current_level_source.get_data();
+			}
+			else
+			{
+				QJsonObject current_level_json;
+				if (!serialize_level(current_level, current_level_json, error_msg))
+				{
+					// Never write a level we could not load (it would replace the contents in the file)
+					return false;
+				}
+				current_level_data = QJsonDocument(current_level_json).toJson();
+				current_level_data.chop(1); // Remove the trailing line break
+			}
+
+			level_index_json_array.append(ScriptJSONSerializer::serialize_level_index_entry(current_level, level_data.size(), current_level_data.size()));
+
+			level_data += current_level_data;
+			level_data += (current_level_index < (level_count - 1)) ? ",\n" : "\n";
+			++current_level_index;
+		}
+
+		QJsonObject level_index_json;
+		level_index_json["VERSION"] = SCENARIO_INDEX_VERSION;
+		level_index_json["LEVELS"] = level_index_json_array;
+
+		// Write the file by hand (still valid JSON), so the index is guaranteed to be on its own line before the level data
+		scenario_data.clear();
+		scenario_data.reserve(level_data.size() + 1024);
+		scenario_data += "{\n    ";
+		scenario_data += SCENARIO_INDEX_KEY;
+		scenario_data += ' ';
+		scenario_data += QJsonDocument(level_index_json).toJson(QJsonDocument::Compact);
+		scenario_data += ",\n    ";
+		scenario_data += SCENARIO_LEVELS_KEY;
+		scenario_data += '\n';
+		scenario_data += level_data;
+		scenario_data += "    ]\n}\n";
+
+		if (progress)
+		{
+			progress(level_count, level_count);
+		}
+
+		return true;
+	}
+
+	bool ScenarioManager::write_scenario_file(const QString& file_path, const QByteArray& scenario_data, QString& error_msg) const
+	{
+		// Write to a temporary file which only replaces the target once everything was written (so a failed save can't corrupt the previous file)
+		QSaveFile scenario_file(file_path);
+		if (!scenario_file.open(QIODevice::WriteOnly))
+		{
+			error_msg = QStringLiteral("Unable to open file \"%1\"!").arg(file_path);
+			return false;
+		}
+
+		if (scenario_file.write(scenario_data) == -1)
+		{
+			scenario_file.cancelWriting();
+			error_msg = QStringLiteral("Error writing to file \"%1\"!").arg(file_path);
+			return false;
+		}
+
+		if (!scenario_file.commit())
+		{
+			error_msg = QStringLiteral("Error writing to file \"%1\"! Error: \"%2\"").arg(file_path, scenario_file.errorString());
+			return false;
+		}
+
+		return true;
+	}
+
+	bool ScenarioManager::write_scenario_scripts(const QString& split_folder_path, const Scenario& scenario, ExportReport& report, const ProgressCallback& progress, const LevelScriptCache& script_cache) const
+	{
+		HUX_TRACE_SCOPE("scenario", "write_scenario_scripts");
+		QElapsedTimer export_timer;
+		export_timer.start();
+
+		const int level_count = static_cast<int>(scenario.m_levels.size());
+		report.m_levels.clear();
+		report.m_levels.resize(level_count);
+
+		if (progress)
+		{
+			progress(0, level_count);
+		}
+
+		// Levels are written to separate files, so each of them can be exported independently
+		std::vector<int> level_indices(level_count);
+		std::iota(level_indices.begin(), level_indices.end(), 0);
+
+		std::atomic<int> finished_level_count = 0;
+		QMutex progress_mutex;
+		QtConcurrent::blockingMap(level_indices, [this, &split_folder_path, &scenario, &report, &progress, &script_cache, &finished_level_count, &progress_mutex, level_count](int level_index)
+			{
+				auto cached_script_it = script_cache.find(level_index);
+				const QByteArray* cached_script = (cached_script_it != script_cache.end()) ? &cached_script_it->second : nullptr;
+				export_level_script(split_folder_path, scenario.m_levels[level_index], cached_script, report.m_levels[level_index]);
+
+				const int current_finished_count = ++finished_level_count;
+				if (progress)
+				{
+					QMutexLocker progress_lock(&progress_mutex);
+					progress(current_finished_count, level_count);
+				}
+			}
+		);
+
+		report.m_elapsed_ms = export_timer.elapsed();
+		return !report.has_failures();
+	}
+
+	bool ScenarioManager::load_scenario(const QString& file_path, Scenario& scenario, Diagnostics& diagnostics, bool lazy)
+	{
+		HUX_TRACE_SCOPE("scenario", "load_scenario");
+		// First make sure the file exists and is the correct type
+		QFileInfo file_info(file_path);
+		if (!file_info.isFile())
+		{
+			diagnostics.add_error(QStringLiteral("File \"%1\" does not exist!").arg(file_path));
+			return false;
+		}
+
+		// Open the file
+		QFile scenario_file(file_path);
+		if (!scenario_file.open(QIODevice::ReadOnly))
+		{
+			diagnostics.add_error(QStringLiteral("Unable to open file \"%1\"!").arg(file_path));
+			return false;
+		}
+
+		// Load the JSON data and parse it
+		QByteArray scenario_file_data = scenario_file.readAll();
+
+		std::vector<Level> indexed_levels;
+		if (ScriptJSONSerializer::deserialize_level_index(scenario_file_data, indexed_levels))
+		{
+			if (!lazy)
+			{
+				// Each level is stored separately in the file, so we can parse them in parallel (each worker writes into its own error slot)
+				std::vector<QString> level_errors(indexed_levels.size());
+				std::vector<int> level_indices(indexed_levels.size());
+				std::iota(level_indices.begin(), level_indices.end(), 0);
+
+				QtConcurrent::blockingMap(level_indices, [this, &indexed_levels, &level_errors](int level_index)
+					{
+						load_level(indexed_levels[level_index], level_errors[level_index]);
+					}
+				);
+
+				// Fail the whole load, otherwise saving the scenario would replace the broken levels with empty ones
+				bool levels_loaded = true;
+				for (const QString& current_error : level_errors)
+				{
+					if (!current_error.isEmpty())
+					{
+						diagnostics.add_error(current_error, file_path);
+						levels_loaded = false;
+					}
+				}
+
+				if (!levels_loaded)
+				{
+					return false;
+				}
+			}
+
+			// If lazy, we only read the index, the level contents will be deserialized on demand
+			scenario.reset();
+			scenario.m_name = file_info.baseName();
+			scenario.m_levels = std::move(indexed_levels);
+		}
+		else if (!load_scenario_json(scenario_file_data, file_info, scenario, diagnostics))
+		{
+			return false;
+		}
+
+		m_internal->reset();
+		return true;
+	}
+
+	bool ScenarioManager::load_scenario_json(const QByteArray& scenario_file_data, const QFileInfo& file_info, Scenario& scenario, Diagnostics& diagnostics)
+	{
+		QJsonParseError parse_error;
+		QJsonDocument scenario_json_document = QJsonDocument::fromJson(scenario_file_data, &parse_error);
+		if (parse_error.error != QJsonParseError::NoError)
+		{
+			diagnostics.add_error(QStringLiteral("Invalid scenario file! Error: \"%1\"!").arg(parse_error.errorString()), file_info.filePath());
+			return false;
+		}
+
+		// Parse successful, reset the scenario contents
+		scenario.reset();
+
+		// Use the file name as the scenario name
+		scenario.m_name = file_info.baseName();
+
+		// Load the scenario from the root object
+		const QJsonObject scenario_root_json = scenario_json_document.object();
+		const QJsonArray levels_json_array = scenario_root_json["LEVELS"].toArray();
+
+		// Each level is independent, so deserialize them in parallel (each worker writes into its own slot)
+		std::vector<QJsonObject> level_json_objects;
+		level_json_objects.reserve(levels_json_array.size());
+		for (const QJsonValue& current_level_value : levels_json_array)
+		{
+			level_json_objects.push_back(current_level_value.toObject());
+		}
+		scenario.m_levels.resize(level_json_objects.size());
+
+		std::vector<int> level_indices(level_json_objects.size());
+		std::iota(level_indices.begin(), level_indices.end(), 0);
+
+		// Use the same snapshot of the text colors for all the workers
+		const std::shared_ptr<const TextColorArray> text_colors = m_internal->get_text_colors();
+		QtConcurrent::blockingMap(level_indices, [&scenario, &level_json_objects, &text_colors](int level_index)
+			{
+				ScriptJSONSerializer::deserialize_level_json(*text_colors, level_json_objects[level_index], scenario.m_levels[level_index]);
+			}
+		);
+
+		return true;
+	}
+
+	bool ScenarioManager::import_scenario(const QString& split_folder_path, Scenario& scenario, Diagnostics& diagnostics)
+	{
+		HUX_TRACE_SCOPE("scenario", "import_scenario");
+		QStringList level_dir_list;
+		if (!validate_scenario_folder(split_folder_path, level_dir_list))
+		{
+			diagnostics.add_error(QStringLiteral("The folder \"%1\" does not contain a valid Aleph One scenario!").arg(split_folder_path));
+			return false;
+		}
+
+		// Reset the scenario contents
+		scenario.reset();
+
+		scenario.m_name = QDir(split_folder_path).dirName();
+
+		for (const QString& level_dir_name : level_dir_list)
+		{
+			const QDir current_level_dir(split_folder_path + "/" + level_dir_name);
+			const QFileInfoList file_info_list = current_level_dir.entryInfoList(QDir::Files);
+
+			for (const QFileInfo& current_file : file_info_list)
 			{
 				// Need to check the end to make sure we catch the correct suffix (using the QFileInfo helper func might return an incorrect suffix)
 				const QString file_name = current_file.fileName();
@@ -1212,7 +1469,12 @@ namespace HuxApp
 					if (parser.parse_level(current_file))
 					{
 						// Level successfully parsed
-						scenario.m_levels.push_back(parsed_level);
+						scenario.m_levels.push_back(std::move(parsed_level));
+					}
+					else
+					{
+						// Skip the level, but let the user know why it is missing
+						diagnostics.add_warning(QStringLiteral("Unable to parse terminal script, level \"%1\" was skipped!").arg(parsed_level.m_name), current_file.absoluteFilePath(), parser.get_line_number());
 					}
 					break;
 				}
@@ -1223,30 +1485,146 @@ namespace HuxApp
 		return true;
 	}
 
-	const ScenarioManager::TextColorArray& ScenarioManager::get_text_colors() const
+	bool ScenarioManager::load_level(Level& level, QString& error_msg) const
+	{
+		HUX_TRACE_SCOPE("scenario", "load_level");
+		if (level.is_loaded())
+		{
+			return true;
+		}
+
+		QJsonParseError parse_error;
+		const QJsonDocument level_json_document = QJsonDocument::fromJson(level.get_source().get_data(), &parse_error);
+		if ((parse_error.error != QJsonParseError::NoError) || !level_json_document.isObject())
+		{
+			// Keep the source, so the level is still saved as it was in the file
+			const QString error_string = (parse_error.error != QJsonParseError::NoError) ? parse_error.errorString() : QStringLiteral("level is not an object");
+			error_msg = QStringLiteral("Unable to load level \"%1\"! Error: \"%2\"").arg(level.get_name(), error_string);
+			return false;
+		}
+
+		// Only need the terminals, the level attributes may have been changed since
+		level.set_source(LevelSource());
+		const std::shared_ptr<const TextColorArray> text_colors = m_internal->get_text_colors();
+		ScriptJSONSerializer::deserialize_level_terminals(*text_colors, level_json_document.object(), level);
+		return true;
+	}
+
+	bool ScenarioManager::serialize_level(const Level& level, QJsonObject& level_json, QString& error_msg) const
+	{
+		Level loaded_level;
+		const Level* serialized_level = get_loaded_level(level, loaded_level, error_msg);
+		if (!serialized_level)
+		{
+			return false;
+		}
+
+		level_json = QJsonObject();
+		ScriptJSONSerializer::serialize_level_json(*serialized_level, level_json);
+		return true;
+	}
+
+	Level ScenarioManager::deserialize_level(const QJsonObject& level_json) const
+	{
+		Level level;
+		const std::shared_ptr<const TextColorArray> text_colors = m_internal->get_text_colors();
+		ScriptJSONSerializer::deserialize_level_json(*text_colors, level_json, level);
+		return level;
+	}
+
+	QJsonObject ScenarioManager::serialize_terminal(const Terminal& terminal) const
+	{
+		QJsonObject terminal_json;
+		ScriptJSONSerializer::serialize_terminal_json(terminal, terminal_json);
+		return terminal_json;
+	}
+
+	Terminal ScenarioManager::deserialize_terminal(const QJsonObject& terminal_json) const
 	{
-		return m_internal->m_text_colors;
+		Terminal terminal;
+		const std::shared_ptr<const TextColorArray> text_colors = m_internal->get_text_colors();
+		ScriptJSONSerializer::deserialize_terminal_json(*text_colors, terminal_json, terminal);
+		return terminal;
+	}
+
+	std::shared_ptr<const ScenarioManager::TextColorArray> ScenarioManager::get_text_colors() const
+	{
+		return m_internal->get_text_colors();
 	}
 
 	void ScenarioManager::set_text_colors(const TextColorArray& colors)
 	{
-		m_internal->m_text_colors = colors;
+		m_internal->set_text_colors(colors);
 	}
 
-	QString ScenarioManager::print_level_script(const Level& level) const
+	bool ScenarioManager::print_level_script(const Level& level, QString& level_script, QString& error_msg) const
 	{
-		QString level_script_text;
-		int terminal_index = 0;
-		for (const Terminal& current_terminal : level.m_terminals)
+		QByteArray level_script_data;
+		QBuffer level_script_buffer(&level_script_data);
+		level_script_buffer.open(QIODevice::WriteOnly);
+		if (!write_level_script(level_script_buffer, level, error_msg))
 		{
-			export_terminal_script(current_terminal, terminal_index, level_script_text);
-			if (terminal_index < (level.m_terminals.size() - 1))
-			{
-				level_script_text += "\n";
-			}
-			++terminal_index;
+			return false;
+		}
+
+		level_script = QString::fromUtf8(level_script_data);
+		return true;
+	}
+
+	bool ScenarioManager::write_level_script(QIODevice& device, const Level& source_level, QString& error_msg) const
+	{
+		Level loaded_level;
+		const Level* level = get_loaded_level(source_level, loaded_level, error_msg);
+		if (!level)
+		{
+			return false;
+		}
+
+		ScriptWriter script_writer(device);
+		script_writer.write_level(*level);
+		if (!script_writer.flush())
+		{
+			error_msg = QStringLiteral("Unable to write the script of level \"%1\"!").arg(source_level.get_name());
+			return false;
 		}
-		return level_script_text;
+		return true;
+	}
+
+	QString ScenarioManager::get_level_script_path(const QString& split_folder_path, const Level& level)
+	{
+		return QStringLiteral("%1/%2/%3%4").arg(split_folder_path, level.get_dir_name(), level.get_script_name(), QString::fromLatin1(TERMINAL_SCRIPT_SUFFIX));
+	}
+
+	QMap<int, QString> ScenarioManager::find_pict_resources(const QString& resource_path)
+	{
+		// Images are named after their resource ID (e.g "1200.png")
+		QMap<int, QString> pict_files;
+		const QFileInfoList pict_file_list = QDir(resource_path + "/PICT").entryInfoList(QDir::Files);
+		for (const QFileInfo& current_pict_file : pict_file_list)
+		{
+			pict_files.insert(current_pict_file.baseName().toInt(), current_pict_file.filePath());
+		}
+		return pict_files;
+	}
+
+	ScenarioManager::ScriptStatus ScenarioManager::get_level_script_status(const QString& split_folder_path, const Level& level, const QByteArray* cached_script) const
+	{
+		QByteArray existing_file_hash;
+		if (!hash_script_file(get_level_script_path(split_folder_path, level), existing_file_hash))
+		{
+			return ScriptStatus::NEW;
+		}
+
+		Level loaded_level;
+		QString error_msg;
+		const Level* compared_level = cached_script ? &level : get_loaded_level(level, loaded_level, error_msg);
+		if (!compared_level)
+		{
+			return ScriptStatus::INVALID;
+		}
+
+		qint64 script_size = 0;
+		return (hash_level_script(*compared_level, cached_script, script_size) == existing_file_hash) ? ScriptStatus::UNCHANGED : ScriptStatus::MODIFIED;
 	}
 
 	const Terminal* ScenarioManager::get_screen_clipboard() const
@@ -1271,111 +1649,141 @@ namespace HuxApp
 		}
 	}
 
-	QString ScenarioManager::convert_ao_to_html(const QString& ao_text, int screen_type) const
+	int ScenarioManager::report_memory(MemoryReport& report, int parent) const
 	{
-		// Wrap the text (so it matches the AO line wrapping)
-		const QString wrapped_text = wrap_ao_text(ao_text, Utils::to_enum<Terminal::ScreenType>(screen_type));
-
-		// Parse the Aleph One formatting tags, turning them into HTML tags that Qt can display
-		QString parsed_text = wrapped_text.toHtmlEscaped(); // First make sure we have no unintended HTML tags
-		bool color_changed = false;
-
-		// Iterate through each possible tag, converting each match
-		for (int current_tag_index = 0; current_tag_index < Utils::to_integral(TextFormattingTags::TAG_COUNT); ++current_tag_index)
+		const int manager_entry = report.add_entry(QStringLiteral("Scenario manager"), parent);
+		if (m_internal->m_screen_clipboard)
 		{
-			switch (static_cast<TextFormattingTags>(current_tag_index))
-			{
-			case TextFormattingTags::TEXT_COLOR:
-			{
-				// Color change is a special case, as we need to extract the color index
-				QRegularExpressionMatch color_match = AO_COLOR_REGEXP.match(parsed_text);
-				while (color_match.hasMatch())
-				{
-					// Found a match
-					QString color_tag;
-					if (color_changed)
-					{
-						// Add an end tag so we drop the previous color
-						color_tag = QStringLiteral("</span>");
-					}
-
-					// Get the color index and generate the corresponding HTML tag
-					const int new_color_index = color_match.captured("color").toInt();
-					color_tag += QString(HTML_TAG_ARRAY[Utils::to_integral(TextFormattingTags::TEXT_COLOR)]).arg(m_internal->m_text_colors[new_color_index].name());
-					color_changed = true;
-
-					// Replace the tag and find the next match (if any)
-					parsed_text.replace(color_match.capturedStart(), color_match.capturedLength(), color_tag);
-					color_match = AO_COLOR_REGEXP.match(parsed_text);
-				}
-			}
-			default:
-			{
-				// Simply replace the tags with the corresponding HTML tags
-				parsed_text.replace(AO_FORMATTING_TAG_ARRAY[current_tag_index], HTML_TAG_ARRAY[current_tag_index]);
-			}
-			}
+			report.add_bytes(manager_entry, MemoryReport::Category::STRUCTURE, sizeof(Terminal));
+			report.add_terminal(*m_internal->m_screen_clipboard, QStringLiteral("Screen clipboard"), manager_entry);
 		}
+		return manager_entry;
+	}
 
-		// Tabs in AO are a single space, so replace them
-		parsed_text.replace('\t', ' ');
+	QString ScenarioManager::convert_ao_to_html(const QString& ao_text, int screen_type) const
+	{
+		const std::shared_ptr<const TextColorArray> text_colors = m_internal->get_text_colors();
+		return convert_ao_to_html(ao_text, screen_type, *text_colors);
+	}
 
-		// If the color was changed at some point, we need to close off the last span tag
-		if (color_changed)
-		{
-			parsed_text += QStringLiteral("</span>");
-		}
-		// Wrap the text in paragraph tags
-		parsed_text = QStringLiteral("<p style=\"white-space: pre-wrap\">%1</p>").arg(parsed_text);
-		return parsed_text;
+	QString ScenarioManager::convert_ao_to_html(const QString& ao_text, int screen_type, const TextColorArray& text_colors)
+	{
+		return AOText::convert_to_html(ao_text, Utils::to_enum<Terminal::ScreenType>(screen_type), text_colors);
 	}
 
-	ScenarioManager::ScenarioManager(AppCore& core)
-		: m_core(core)
-		, m_internal(std::make_unique<Internal>())
+	ScenarioManager::ScenarioManager()
+		: m_internal(std::make_unique<Internal>())
 	{
 	}
 
-	void ScenarioManager::export_level_script(QFile& level_file, const Level& level) const
+	const Level* ScenarioManager::get_loaded_level(const Level& level, Level& loaded_level, QString& error_msg) const
 	{
-		QString level_script_text = print_level_script(level);
-		QTextStream text_stream(&level_file);
-		text_stream.setEncoding(TERMINAL_SCRIPT_ENCODING);
-		text_stream << level_script_text;
+		if (level.is_loaded())
+		{
+			return &level;
+		}
+
+		// Deserialize into the provided storage
+		loaded_level = level;
+		return load_level(loaded_level, error_msg) ? &loaded_level : nullptr;
 	}
 
-	void ScenarioManager::export_terminal_script(const Terminal& terminal, int terminal_index, QString& level_script_text) const
+	void ScenarioManager::export_level_script(const QString& split_folder_path, const Level& level, const QByteArray* cached_script, ExportReport::LevelEntry& report_entry) const
 	{
-		// Start with a comment tag (apparently needed for formatting?)
-		level_script_text += ";\n";
+		HUX_TRACE_SCOPE("scenario", "export_level_script");
+		QElapsedTimer level_timer;
+		level_timer.start();
 
-		// Add the terminal header
-		const QString terminal_id_string = QString::number(terminal_index);
-		level_script_text += QStringLiteral("%1 %2\n").arg(get_script_keyword(ScriptKeywords::TERMINAL), terminal_id_string);
+		const QString level_dir_path = split_folder_path + "/" + level.get_dir_name();
+		report_entry.m_level_name = level.get_name();
+		report_entry.m_file_path = get_level_script_path(split_folder_path, level);
 
-		int current_branch_index = 0;
-		for (const Terminal::Branch& current_branch : terminal.m_branches)
-		{
-			const Terminal::BranchType current_branch_type = Utils::to_enum<Terminal::BranchType>(current_branch_index);
-			if (current_branch.is_valid())
+		auto finish_entry = [&report_entry, &level_timer](ExportReport::Result result, const QString& error_msg = QString())
 			{
-				// Add the branch type header
-				level_script_text += QStringLiteral("%1\n").arg(get_script_keyword(get_branch_type_keyword(current_branch_type)));
+				report_entry.m_result = result;
+				report_entry.m_error_msg = error_msg;
+				report_entry.m_elapsed_ms = level_timer.elapsed();
+			};
 
-				// Add screens and teleport info
-				export_terminal_screens(current_branch.m_screens, level_script_text);
-				if (current_branch.m_teleport.m_type != Terminal::TeleportType::NONE)
-				{
-					export_terminal_teleport(current_branch.m_teleport, level_script_text);
-				}
+		// Only load the level if we don't already have its script
+		Level loaded_level;
+		QString error_msg;
+		const Level* exported_level = cached_script ? &level : get_loaded_level(level, loaded_level, error_msg);
+		if (!exported_level)
+		{
+			// Nothing is written, the existing script is left as-is
+			finish_entry(ExportReport::Result::FAILED, error_msg);
+			return;
+		}
 
-				// Add the end header
-				level_script_text += QStringLiteral("%1\n").arg(get_script_keyword(ScriptKeywords::END));
+		// Compare with the existing file
+		QByteArray existing_file_hash;
+		if (hash_script_file(report_entry.m_file_path, existing_file_hash))
+		{
+			if (hash_level_script(*exported_level, cached_script, report_entry.m_script_size) == existing_file_hash)
+			{
+				// Nothing changed, leave the file (and its timestamp) as-is
+				finish_entry(ExportReport::Result::SKIPPED);
+				return;
 			}
-			++current_branch_index;
 		}
 
-		// Add the terminal end header
-		level_script_text += QStringLiteral("%1 %2").arg(get_script_keyword(ScriptKeywords::END_TERMINAL), terminal_id_string);
+		// Create folder if necessary
+		QDir level_dir;
+		if (!level_dir.exists(level_dir_path) && !level_dir.mkpath(level_dir_path))
+		{
+			finish_entry(ExportReport::Result::FAILED, QStringLiteral("Unable to save to directory \"%1\"!").arg(level_dir_path));
+			return;
+		}
+
+		QSaveFile level_file(report_entry.m_file_path);
+		if (!level_file.open(QIODevice::WriteOnly | QIODevice::Text))
+		{
+			finish_entry(ExportReport::Result::FAILED, QStringLiteral("Unable to save to file \"%1\"!").arg(report_entry.m_file_path));
+			return;
+		}
+
+		bool write_success = false;
+		if (cached_script)
+		{
+			write_success = (level_file.write(*cached_script) == cached_script->size());
+			report_entry.m_script_size = cached_script->size();
+		}
+		else
+		{
+			ScriptWriter file_writer(level_file);
+			file_writer.write_level(*exported_level);
+			write_success = file_writer.flush();
+			report_entry.m_script_size = file_writer.get_bytes_written();
+		}
+
+		if (!write_success || !level_file.commit())
+		{
+			level_file.cancelWriting();
+			finish_entry(ExportReport::Result::FAILED, QStringLiteral("Error writing to file \"%1\"! Error: \"%2\"").arg(report_entry.m_file_path, level_file.errorString()));
+			return;
+		}
+
+		finish_entry(ExportReport::Result::WRITTEN);
+	}
+
+	QByteArray ScenarioManager::hash_level_script(const Level& level, const QByteArray* cached_script, qint64& script_size) const
+	{
+		// Only hash the generated script, so we don't have to store it
+		HashSinkDevice script_hash(SCRIPT_HASH_ALGORITHM);
+		script_hash.open(QIODevice::WriteOnly);
+		if (cached_script)
+		{
+			script_hash.write(*cached_script);
+			script_size = cached_script->size();
+		}
+		else
+		{
+			ScriptWriter hash_writer(script_hash);
+			hash_writer.write_level(level);
+			hash_writer.flush();
+			script_size = hash_writer.get_bytes_written();
+		}
+		return script_hash.get_result();
 	}
 }
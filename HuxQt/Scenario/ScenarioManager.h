@@ -1,13 +1,24 @@
 #pragma once
+#include <HuxQt/Scenario/AOText.h>
+#include <HuxQt/Scenario/Diagnostics.h>
+
 #include <QColor>
 #include <QFile>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QMap>
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace HuxApp
 {
-	class AppCore;
 	class Scenario;
 	class Level;
 	class Terminal;
+	class MemoryReport;
 
 	class ScenarioManager
 	{
@@ -20,39 +31,110 @@ namespace HuxApp
 			FONT_COUNT
 		};
 
-		static constexpr int TEXT_COLOR_COUNT = 8;
-		using TextColorArray = std::array<QColor, TEXT_COLOR_COUNT>;
+		static constexpr int TEXT_COLOR_COUNT = AOText::TEXT_COLOR_COUNT;
+		using TextColorArray = AOText::TextColorArray;
+
+		// Reports progress as (current step, total step count)
+		using ProgressCallback = std::function<void(int, int)>;
+
+		// State of a level script compared to the file in a split folder
+		enum class ScriptStatus
+		{
+			UNCHANGED,
+			MODIFIED,
+			NEW,
+			INVALID // The level could not be loaded (nothing would be written)
+		};
+
+		// Scripts which were already generated (level index -> UTF-8 script)
+		using LevelScriptCache = std::unordered_map<int, QByteArray>;
+
+		// Outcome of writing the level scripts to a split folder
+		struct ExportReport
+		{
+			enum class Result
+			{
+				WRITTEN,
+				SKIPPED, // Script was unchanged, the file was left as-is
+				FAILED,
+				RESULT_COUNT
+			};
+
+			struct LevelEntry
+			{
+				QString m_level_name;
+				QString m_file_path;
+				Result m_result = Result::FAILED;
+				QString m_error_msg;
+				qint64 m_elapsed_ms = 0;
+				qint64 m_script_size = 0; // Size of the generated script (in bytes)
+			};
+
+			std::vector<LevelEntry> m_levels; // Same order as in the scenario
+			qint64 m_elapsed_ms = 0;
 
+			int get_result_count(Result result) const;
+			bool has_failures() const { return get_result_count(Result::FAILED) > 0; }
+
+			static const char* get_result_label(Result result);
+
+			QString get_summary() const;
+			QString print() const;
+		};
+
+		// Does not depend on the UI (problems are reported via the diagnostics), so it can also be used by the command line tool
+		ScenarioManager();
 		~ScenarioManager();
 
-		bool save_scenario(const QString& file_path, const Scenario& scenario); // Save to Hux-specific file
-		bool export_scenario(const QString& split_folder_path, const Scenario& scenario); // Export to split folder
-		bool load_scenario(const QString& file_path, Scenario& scenario); // Load from Hux-specific file
-		bool import_scenario(const QString& split_folder_path, Scenario& scenario); // Import from split folder
+		// Return false on errors, warnings (e.g skipped levels) are only added to the diagnostics
+		bool save_scenario(const QString& file_path, const Scenario& scenario, Diagnostics& diagnostics); // Save to Hux-specific file
+		bool export_scenario(const QString& split_folder_path, const Scenario& scenario, Diagnostics& diagnostics); // Export to split folder
+		bool load_scenario(const QString& file_path, Scenario& scenario, Diagnostics& diagnostics, bool lazy = false); // Load from Hux-specific file (lazy: only read the level index, see load_level)
+		bool import_scenario(const QString& split_folder_path, Scenario& scenario, Diagnostics& diagnostics); // Import from split folder
+
+		// Variants that do not interact with the UI, safe to run from a worker thread (given the scenario is a snapshot owned by the caller)
+		bool serialize_scenario(const Scenario& scenario, QByteArray& scenario_data, QString& error_msg, const ProgressCallback& progress = ProgressCallback()) const; // Fails if a level which has to be serialized could not be loaded
+		bool write_scenario_file(const QString& file_path, const QByteArray& scenario_data, QString& error_msg) const;
+		bool write_scenario_scripts(const QString& split_folder_path, const Scenario& scenario, ExportReport& report, const ProgressCallback& progress = ProgressCallback(), const LevelScriptCache& script_cache = LevelScriptCache()) const; // Levels are exported in parallel, returns false if any of them failed
+
+		// Deserializes the contents of a lazily loaded level (thread-safe, uses a snapshot of the current text colors), the level is left unloaded on failure
+		bool load_level(Level& level, QString& error_msg) const;
 
-		const TextColorArray& get_text_colors() const;
+		// JSON conversion of individual elements (same format as in the scenario file)
+		bool serialize_level(const Level& level, QJsonObject& level_json, QString& error_msg) const; // Loads the level if needed, fails if it could not be loaded
+		Level deserialize_level(const QJsonObject& level_json) const;
+		QJsonObject serialize_terminal(const Terminal& terminal) const;
+		Terminal deserialize_terminal(const QJsonObject& terminal_json) const;
+
+		std::shared_ptr<const TextColorArray> get_text_colors() const; // Snapshot of the current colors (stays valid if they are changed)
 		void set_text_colors(const TextColorArray& colors);
 
-		QString print_level_script(const Level& level) const;
+		bool print_level_script(const Level& level, QString& level_script, QString& error_msg) const;
+		bool write_level_script(QIODevice& device, const Level& level, QString& error_msg) const; // Streams the script as UTF-8, returns false if the level could not be loaded or writing to the device failed
+
+		static QString get_level_script_path(const QString& split_folder_path, const Level& level);
+		static QMap<int, QString> find_pict_resources(const QString& resource_path); // Maps the PICT IDs to the image files in "<resource path>/PICT"
+		ScriptStatus get_level_script_status(const QString& split_folder_path, const Level& level, const QByteArray* cached_script = nullptr) const; // Only compares hashes (thread-safe)
 
 		const Terminal* get_screen_clipboard() const;
 		void set_screen_clipboard(const Terminal& terminal_data);
 		void clear_screen_clipboard();
 
+		int report_memory(MemoryReport& report, int parent = -1) const; // Data kept by the manager, e.g the clipboard (returns the report entry)
+
 		QString convert_ao_to_html(const QString& ao_text, int screen_type) const;
+		static QString convert_ao_to_html(const QString& ao_text, int screen_type, const TextColorArray& text_colors); // Thread-safe (colors should be a snapshot)
 	private:
-		ScenarioManager(AppCore& core);
-
-		void export_level_script(QFile& level_file, const Level& level) const;
-		void export_terminal_script(const Terminal& terminal, int terminal_index, QString& level_script_text) const;
-
-		AppCore& m_core;
+		bool load_scenario_json(const QByteArray& scenario_file_data, const QFileInfo& file_info, Scenario& scenario, Diagnostics& diagnostics);
+		const Level* get_loaded_level(const Level& level, Level& loaded_level, QString& error_msg) const; // Null if the level could not be loaded
+		void export_level_script(const QString& split_folder_path, const Level& level, const QByteArray* cached_script, ExportReport::LevelEntry& report_entry) const;
+		QByteArray hash_level_script(const Level& level, const QByteArray* cached_script, qint64& script_size) const;
 
 		struct Internal;
 		std::unique_ptr<Internal> m_internal;
 
 		class ScriptParser;
+		class ScriptWriter;
 		class ScriptJSONSerializer;
-		friend AppCore;
 	};
 }
\ No newline at end of file
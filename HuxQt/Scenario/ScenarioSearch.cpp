@@ -0,0 +1,539 @@
+#include <HuxQt/Scenario/ScenarioSearch.h>
+
+#include <HuxQt/Scenario/ScenarioManager.h>
+#include <HuxQt/Scenario/ScenarioBrowserModel.h>
+#include <HuxQt/Scenario/MemoryReport.h>
+
+#include <HuxQt/Utils/Trace.h>
+
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace HuxApp
+{
+	namespace
+	{
+		// Level contents at the time the build was started
+		struct LevelSnapshot
+		{
+			int m_level_id = -1;
+			Level m_level;
+			std::vector<int> m_terminal_ids; // Empty if the level was not loaded (the terminals are keyed by row)
+		};
+	}
+
+	struct ScenarioSearch::Internal
+	{
+		const ScenarioManager& m_scenario_manager;
+
+		ScenarioBrowserModel* m_model = nullptr;
+		std::shared_ptr<ScenarioValidator> m_validator = std::make_shared<ScenarioValidator>(); // Shared with the build (the cache is thread-safe)
+		std::shared_ptr<Indices> m_indices = std::make_shared<Indices>(m_validator);
+
+		QFutureWatcher<std::shared_ptr<Indices>> m_build_watcher;
+		bool m_building = false;
+		std::unordered_set<int> m_dirty_levels;
+
+		Internal(const ScenarioManager& scenario_manager)
+			: m_scenario_manager(scenario_manager)
+		{
+		}
+
+		void add_terminals(int level_id, int first_row, int last_row)
+		{
+			const LevelModel* level_model = m_model->get_level_model(level_id);
+			for (int current_row = first_row; current_row <= last_row; ++current_row)
+			{
+				const TerminalID terminal_id{ level_id, level_model->get_terminal_id(current_row) };
+				m_indices->add_terminal(terminal_id, *level_model->get_terminal(terminal_id));
+			}
+		}
+
+		void resolve_terminal(const TerminalID& terminal_id, const std::unordered_map<int, int>& level_rows, Location& location) const
+		{
+			const ScenarioBrowserModel& model = *m_model;
+			location.m_level_row = level_rows.at(terminal_id.m_level_id);
+			location.m_level_name = model.get_level_info(terminal_id.m_level_id).m_name;
+			if (const LevelModel* level_model = model.get_level_model(terminal_id.m_level_id))
+			{
+				location.m_terminal_row = level_model->find_terminal_row(terminal_id);
+				if (location.m_terminal_row >= 0)
+				{
+					location.m_terminal_name = level_model->data(level_model->index(location.m_terminal_row)).toString();
+				}
+			}
+			else
+			{
+				// Not loaded yet, the ID is the row
+				location.m_terminal_row = terminal_id.m_terminal_id;
+				location.m_terminal_name = QStringLiteral("TERMINAL (%1)").arg(location.m_terminal_row);
+			}
+		}
+
+		std::unordered_map<int, int> get_level_rows() const
+		{
+			std::unordered_map<int, int> level_rows;
+			for (int current_row = 0; current_row < m_model->get_level_list().rowCount(); ++current_row)
+			{
+				level_rows[m_model->get_level_id(current_row)] = current_row;
+			}
+			return level_rows;
+		}
+	};
+
+	void ScenarioSearch::Indices::add_terminal(const TerminalID& terminal_id, const Terminal& terminal)
+	{
+		m_search_index.add_terminal(terminal_id, terminal);
+		m_cross_references.add_terminal(terminal_id, terminal);
+		m_validation.add_terminal(terminal_id, terminal);
+	}
+
+	void ScenarioSearch::Indices::remove_terminal(const TerminalID& terminal_id)
+	{
+		m_search_index.remove_terminal(terminal_id);
+		m_cross_references.remove_terminal(terminal_id);
+		m_validation.remove_terminal(terminal_id);
+	}
+
+	void ScenarioSearch::Indices::add_level(int level_id, const Level& level)
+	{
+		m_search_index.add_level(level_id, level);
+		m_cross_references.add_level(level_id, level);
+		m_validation.add_level(level_id, level);
+	}
+
+	bool ScenarioSearch::Indices::set_terminal_ids(int level_id, const std::vector<int>& terminal_ids)
+	{
+		const bool search_index_updated = m_search_index.set_terminal_ids(level_id, terminal_ids);
+		const bool cross_references_updated = m_cross_references.set_terminal_ids(level_id, terminal_ids);
+		const bool validation_updated = m_validation.set_terminal_ids(level_id, terminal_ids);
+		return search_index_updated && cross_references_updated && validation_updated;
+	}
+
+	void ScenarioSearch::Indices::remove_level(int level_id)
+	{
+		m_search_index.remove_level(level_id);
+		m_cross_references.remove_level(level_id);
+		m_validation.remove_level(level_id);
+	}
+
+	void ScenarioSearch::Indices::clear()
+	{
+		m_search_index.clear();
+		m_cross_references.clear();
+		m_validation.clear();
+	}
+
+	ScenarioSearch::ScenarioSearch(const ScenarioManager& scenario_manager, QObject* parent)
+		: QObject(parent)
+		, m_internal(std::make_unique<Internal>(scenario_manager))
+	{
+		connect(&m_internal->m_build_watcher, &QFutureWatcher<std::shared_ptr<Indices>>::finished, this, &ScenarioSearch::build_finished);
+	}
+
+	ScenarioSearch::~ScenarioSearch()
+	{
+		stop();
+
+		// The build uses the scenario manager
+		m_internal->m_build_watcher.waitForFinished();
+	}
+
+	void ScenarioSearch::start(ScenarioBrowserModel& model)
+	{
+		HUX_TRACE_SCOPE("search", "start_index_build");
+		stop();
+
+		m_internal->m_model = &model;
+		connect_signals();
+
+		// Take a snapshot of the levels (only shares the terminal data, and the unloaded levels are deserialized by the worker)
+		const ScenarioBrowserModel& const_model = model;
+		std::vector<LevelSnapshot> level_snapshots(model.get_level_list().rowCount());
+		for (int current_row = 0; current_row < static_cast<int>(level_snapshots.size()); ++current_row)
+		{
+			LevelSnapshot& current_snapshot = level_snapshots[current_row];
+			current_snapshot.m_level_id = model.get_level_id(current_row);
+			current_snapshot.m_level = model.export_level(current_row);
+			if (const LevelModel* level_model = const_model.get_level_model(current_snapshot.m_level_id))
+			{
+				current_snapshot.m_terminal_ids.reserve(level_model->rowCount());
+				for (int terminal_row = 0; terminal_row < level_model->rowCount(); ++terminal_row)
+				{
+					current_snapshot.m_terminal_ids.push_back(level_model->get_terminal_id(terminal_row));
+				}
+			}
+		}
+
+		m_internal->m_building = true;
+		const ScenarioManager& scenario_manager = m_internal->m_scenario_manager;
+		QFuture<std::shared_ptr<Indices>> build_future = QtConcurrent::run(
+			[&scenario_manager, validator = m_internal->m_validator, level_snapshots = std::move(level_snapshots)]() mutable
+			{
+				HUX_TRACE_SCOPE("search", "build_index");
+				auto indices = std::make_shared<Indices>(validator);
+				for (LevelSnapshot& current_snapshot : level_snapshots)
+				{
+					QString error_msg;
+					if (!scenario_manager.load_level(current_snapshot.m_level, error_msg))
+					{
+						// Skip the level, it is indexed again once it is opened
+						continue;
+					}
+
+					// Levels are added as a whole, so the terminals are validated in parallel (loaded levels are keyed by row until their IDs are set)
+					indices->add_level(current_snapshot.m_level_id, current_snapshot.m_level);
+					if (!current_snapshot.m_terminal_ids.empty())
+					{
+						indices->set_terminal_ids(current_snapshot.m_level_id, current_snapshot.m_terminal_ids);
+					}
+				}
+				return indices;
+			}
+		);
+		m_internal->m_build_watcher.setFuture(build_future);
+	}
+
+	void ScenarioSearch::stop()
+	{
+		if (!is_active())
+		{
+			return;
+		}
+
+		// Disconnect from the model
+		disconnect(m_internal->m_model, nullptr, this, nullptr);
+		disconnect(&m_internal->m_model->get_level_list(), nullptr, this, nullptr);
+		m_internal->m_model = nullptr;
+
+		// A build that is still running is discarded once it finishes
+		m_internal->m_building = false;
+		m_internal->m_dirty_levels.clear();
+		m_internal->m_indices->clear();
+		m_internal->m_validator->clear_cache();
+	}
+
+	bool ScenarioSearch::is_active() const
+	{
+		return (m_internal->m_model != nullptr);
+	}
+
+	bool ScenarioSearch::is_ready() const
+	{
+		return is_active() && !m_internal->m_building;
+	}
+
+	bool ScenarioSearch::search(const QString& query, std::vector<Result>& results, QString& error_msg, int max_hits) const
+	{
+		results.clear();
+		if (!is_ready())
+		{
+			error_msg = QStringLiteral("The search index is not ready yet!");
+			return false;
+		}
+
+		std::vector<SearchIndex::Hit> hits;
+		if (!m_internal->m_indices->m_search_index.search(query, hits, error_msg, max_hits))
+		{
+			return false;
+		}
+
+		// Resolve the rows and labels
+		const std::unordered_map<int, int> level_rows = m_internal->get_level_rows();
+		results.reserve(hits.size());
+		for (SearchIndex::Hit& current_hit : hits)
+		{
+			if (level_rows.find(current_hit.m_terminal_id.m_level_id) == level_rows.end())
+			{
+				continue;
+			}
+
+			Result& new_result = results.emplace_back();
+			m_internal->resolve_terminal(current_hit.m_terminal_id, level_rows, new_result.m_location);
+			new_result.m_hit = std::move(current_hit);
+		}
+
+		std::sort(results.begin(), results.end(), [](const Result& lhs, const Result& rhs)
+			{
+				return std::make_tuple(lhs.m_location.m_level_row, lhs.m_location.m_terminal_row, lhs.m_hit.m_branch, lhs.m_hit.m_screen, lhs.m_hit.m_field)
+					< std::make_tuple(rhs.m_location.m_level_row, rhs.m_location.m_terminal_row, rhs.m_hit.m_branch, rhs.m_hit.m_screen, rhs.m_hit.m_field);
+			}
+		);
+		return true;
+	}
+
+	bool ScenarioSearch::find_references(CrossReferenceIndex::ReferenceType type, int id, std::vector<ReferenceResult>& results) const
+	{
+		results.clear();
+		if (!is_ready())
+		{
+			return false;
+		}
+
+		const std::unordered_map<int, int> level_rows = m_internal->get_level_rows();
+		for (const CrossReferenceIndex::Reference& current_reference : m_internal->m_indices->m_cross_references.get_references(type, id))
+		{
+			if (level_rows.find(current_reference.m_terminal_id.m_level_id) == level_rows.end())
+			{
+				continue;
+			}
+
+			ReferenceResult& new_result = results.emplace_back();
+			m_internal->resolve_terminal(current_reference.m_terminal_id, level_rows, new_result.m_location);
+			new_result.m_reference = current_reference;
+		}
+
+		std::sort(results.begin(), results.end(), [](const ReferenceResult& lhs, const ReferenceResult& rhs)
+			{
+				return std::make_tuple(lhs.m_location.m_level_row, lhs.m_location.m_terminal_row, lhs.m_reference.m_branch, lhs.m_reference.m_screen)
+					< std::make_tuple(rhs.m_location.m_level_row, rhs.m_location.m_terminal_row, rhs.m_reference.m_branch, rhs.m_reference.m_screen);
+			}
+		);
+		return true;
+	}
+
+	const CrossReferenceIndex& ScenarioSearch::get_cross_references() const
+	{
+		return m_internal->m_indices->m_cross_references;
+	}
+
+	bool ScenarioSearch::find_problems(const QMap<int, QString>* pict_files, std::vector<ProblemResult>& results) const
+	{
+		HUX_TRACE_SCOPE("search", "find_problems");
+		results.clear();
+		if (!is_ready())
+		{
+			return false;
+		}
+
+		// Checks which depend on the rest of the scenario are cheap enough to run each time
+		std::vector<ScenarioValidator::TerminalProblem> problems;
+		m_internal->m_indices->m_validation.get_problems(problems);
+		ScenarioValidator::check_references(m_internal->m_indices->m_cross_references, m_internal->m_model->get_level_list().rowCount(), pict_files, problems);
+
+		const std::unordered_map<int, int> level_rows = m_internal->get_level_rows();
+		results.reserve(problems.size());
+		for (ScenarioValidator::TerminalProblem& current_problem : problems)
+		{
+			if (level_rows.find(current_problem.m_terminal_id.m_level_id) == level_rows.end())
+			{
+				continue;
+			}
+
+			ProblemResult& new_result = results.emplace_back();
+			m_internal->resolve_terminal(current_problem.m_terminal_id, level_rows, new_result.m_location);
+			new_result.m_problem = std::move(current_problem);
+		}
+
+		std::sort(results.begin(), results.end(), [](const ProblemResult& lhs, const ProblemResult& rhs)
+			{
+				return std::make_tuple(lhs.m_location.m_level_row, lhs.m_location.m_terminal_row, lhs.m_problem.m_problem.m_branch, lhs.m_problem.m_problem.m_screen, lhs.m_problem.m_problem.m_rule)
+					< std::make_tuple(rhs.m_location.m_level_row, rhs.m_location.m_terminal_row, rhs.m_problem.m_problem.m_branch, rhs.m_problem.m_problem.m_screen, rhs.m_problem.m_problem.m_rule);
+			}
+		);
+		return true;
+	}
+
+	TerminalID ScenarioSearch::get_terminal_id(const TerminalID& indexed_terminal_id)
+	{
+		if (!is_active())
+		{
+			return TerminalID();
+		}
+
+		const bool level_loaded = m_internal->m_model->is_level_loaded(indexed_terminal_id.m_level_id);
+
+		// Opening the level assigns the terminal IDs (and updates the indices)
+		const LevelModel* level_model = m_internal->m_model->get_level_model(indexed_terminal_id.m_level_id);
+		if (!level_model)
+		{
+			return TerminalID();
+		}
+
+		if (level_loaded)
+		{
+			return (level_model->find_terminal_row(indexed_terminal_id) >= 0) ? indexed_terminal_id : TerminalID();
+		}
+
+		const int terminal_row = indexed_terminal_id.m_terminal_id;
+		return (terminal_row < level_model->rowCount()) ? TerminalID{ indexed_terminal_id.m_level_id, level_model->get_terminal_id(terminal_row) } : TerminalID();
+	}
+
+	int ScenarioSearch::report_memory(MemoryReport& report, int parent) const
+	{
+		const int search_entry = report.add_entry(QStringLiteral("Scenario search"), parent);
+		m_internal->m_indices->m_search_index.report_memory(report, search_entry);
+		m_internal->m_indices->m_cross_references.report_memory(report, search_entry);
+		m_internal->m_indices->m_validation.report_memory(report, search_entry);
+		m_internal->m_validator->report_memory(report, search_entry);
+		return search_entry;
+	}
+
+	void ScenarioSearch::connect_signals()
+	{
+		ScenarioBrowserModel* model = m_internal->m_model;
+		LevelListModel* level_list = &model->get_level_list();
+
+		connect(level_list, &QAbstractItemModel::rowsInserted, this, &ScenarioSearch::level_rows_inserted);
+		connect(level_list, &QAbstractItemModel::rowsAboutToBeRemoved, this, &ScenarioSearch::level_rows_about_to_be_removed);
+
+		connect(model, &ScenarioBrowserModel::level_loaded, this, &ScenarioSearch::level_loaded);
+		connect(model, &ScenarioBrowserModel::terminal_rows_inserted, this, &ScenarioSearch::terminal_rows_inserted);
+		connect(model, &ScenarioBrowserModel::terminal_rows_about_to_be_removed, this, &ScenarioSearch::terminal_rows_about_to_be_removed);
+		connect(model, &ScenarioBrowserModel::terminal_modified, this, &ScenarioSearch::terminal_modified);
+	}
+
+	void ScenarioSearch::build_finished()
+	{
+		if (!m_internal->m_building)
+		{
+			// The scenario was closed in the meantime
+			return;
+		}
+
+		m_internal->m_indices = m_internal->m_build_watcher.result();
+		m_internal->m_building = false;
+
+		// Catch up with the changes made during the build
+		for (const int current_level_id : m_internal->m_dirty_levels)
+		{
+			if (m_internal->m_model->find_level_row(current_level_id) >= 0)
+			{
+				index_level(current_level_id);
+			}
+			else
+			{
+				m_internal->m_indices->remove_level(current_level_id);
+			}
+		}
+		m_internal->m_dirty_levels.clear();
+
+		emit(index_ready());
+	}
+
+	void ScenarioSearch::index_level(int level_id)
+	{
+		m_internal->m_indices->remove_level(level_id);
+
+		const ScenarioBrowserModel& model = *m_internal->m_model;
+		if (const LevelModel* level_model = model.get_level_model(level_id))
+		{
+			if (level_model->rowCount() > 0)
+			{
+				m_internal->add_terminals(level_id, 0, level_model->rowCount() - 1);
+			}
+			return;
+		}
+
+		// Index a deserialized copy (the level stays unloaded in the model)
+		Level level_copy = model.export_level(model.find_level_row(level_id));
+		QString error_msg;
+		if (m_internal->m_scenario_manager.load_level(level_copy, error_msg))
+		{
+			m_internal->m_indices->add_level(level_id, level_copy);
+		}
+	}
+
+	bool ScenarioSearch::defer_level_update(int level_id)
+	{
+		if (m_internal->m_building)
+		{
+			m_internal->m_dirty_levels.insert(level_id);
+			return true;
+		}
+		return false;
+	}
+
+	void ScenarioSearch::level_rows_inserted(const QModelIndex& parent, int first, int last)
+	{
+		for (int current_row = first; current_row <= last; ++current_row)
+		{
+			const int level_id = m_internal->m_model->get_level_id(current_row);
+			if (!defer_level_update(level_id))
+			{
+				index_level(level_id);
+				emit(index_updated());
+			}
+		}
+	}
+
+	void ScenarioSearch::level_rows_about_to_be_removed(const QModelIndex& parent, int first, int last)
+	{
+		for (int current_row = first; current_row <= last; ++current_row)
+		{
+			const int level_id = m_internal->m_model->get_level_id(current_row);
+			if (!defer_level_update(level_id))
+			{
+				m_internal->m_indices->remove_level(level_id);
+				emit(index_updated());
+			}
+		}
+	}
+
+	void ScenarioSearch::level_loaded(int level_id)
+	{
+		if (defer_level_update(level_id))
+		{
+			return;
+		}
+
+		// The terminals were indexed from a copy, only the keys have to be updated
+		const LevelModel* level_model = m_internal->m_model->get_level_model(level_id);
+		std::vector<int> terminal_ids;
+		terminal_ids.reserve(level_model->rowCount());
+		for (int terminal_row = 0; terminal_row < level_model->rowCount(); ++terminal_row)
+		{
+			terminal_ids.push_back(level_model->get_terminal_id(terminal_row));
+		}
+		if (!m_internal->m_indices->set_terminal_ids(level_id, terminal_ids))
+		{
+			// Level was not in the index (e.g the copy could not be deserialized)
+			index_level(level_id);
+		}
+		emit(index_updated());
+	}
+
+	void ScenarioSearch::terminal_rows_inserted(int level_id, int first_row, int last_row)
+	{
+		if (!defer_level_update(level_id))
+		{
+			m_internal->add_terminals(level_id, first_row, last_row);
+			emit(index_updated());
+		}
+	}
+
+	void ScenarioSearch::terminal_rows_about_to_be_removed(int level_id, int first_row, int last_row)
+	{
+		if (defer_level_update(level_id))
+		{
+			return;
+		}
+
+		const LevelModel* level_model = m_internal->m_model->get_level_model(level_id);
+		for (int current_row = first_row; current_row <= last_row; ++current_row)
+		{
+			m_internal->m_indices->remove_terminal(TerminalID{ level_id, level_model->get_terminal_id(current_row) });
+		}
+		emit(index_updated());
+	}
+
+	void ScenarioSearch::terminal_modified(int level_id, int terminal_id)
+	{
+		if (defer_level_update(level_id))
+		{
+			return;
+		}
+
+		const TerminalID modified_terminal_id{ level_id, terminal_id };
+		if (const Terminal* terminal = m_internal->m_model->get_level_model(level_id)->get_terminal(modified_terminal_id))
+		{
+			m_internal->m_indices->add_terminal(modified_terminal_id, *terminal);
+			emit(index_updated());
+		}
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <HuxQt/Scenario/SearchIndex.h>
+#include <HuxQt/Scenario/CrossReferenceIndex.h>
+#include <HuxQt/Scenario/ScenarioValidator.h>
+
+#include <QObject>
+
+#include <memory>
+#include <vector>
+
+class QModelIndex;
+
+namespace HuxApp
+{
+	class ScenarioManager;
+	class ScenarioBrowserModel;
+	class MemoryReport;
+
+	// Keeps a search index, a cross-reference index and the validation results of the browser model contents (built in the background when the scenario is loaded, then updated with each edit)
+	// Levels which were not opened yet are indexed from a deserialized copy, so their terminals are keyed by row until the level is loaded
+	class ScenarioSearch : public QObject
+	{
+		Q_OBJECT
+	public:
+		// Where an indexed terminal is in the browser
+		struct Location
+		{
+			int m_level_row = -1;
+			int m_terminal_row = -1;
+			QString m_level_name;
+			QString m_terminal_name;
+		};
+
+		struct Result
+		{
+			SearchIndex::Hit m_hit;
+			Location m_location;
+		};
+
+		struct ReferenceResult
+		{
+			CrossReferenceIndex::Reference m_reference;
+			Location m_location;
+		};
+
+		struct ProblemResult
+		{
+			ScenarioValidator::TerminalProblem m_problem;
+			Location m_location;
+		};
+
+		ScenarioSearch(const ScenarioManager& scenario_manager, QObject* parent = nullptr);
+		~ScenarioSearch();
+
+		void start(ScenarioBrowserModel& model); // Starts building the index in the background
+		void stop();
+		bool is_active() const;
+		bool is_ready() const; // The index is built (searching is not possible before)
+
+		// Results are ordered by level and terminal row
+		bool search(const QString& query, std::vector<Result>& results, QString& error_msg, int max_hits = SearchIndex::DEFAULT_MAX_HITS) const;
+		bool find_references(CrossReferenceIndex::ReferenceType type, int id, std::vector<ReferenceResult>& results) const; // Same order as the search results
+		const CrossReferenceIndex& get_cross_references() const;
+
+		// Problems of every terminal, plus the missing PICTs (if the image files are given) and the teleports to levels which do not exist
+		bool find_problems(const QMap<int, QString>* pict_files, std::vector<ProblemResult>& results) const; // Same order as the search results
+
+		TerminalID get_terminal_id(const TerminalID& indexed_terminal_id); // Loads the level of a result if needed (returns an invalid ID if the terminal no longer exists)
+
+		int report_memory(MemoryReport& report, int parent = -1) const; // Returns the report entry
+	signals:
+		void index_ready();
+		void index_updated(); // Emitted after each incremental update
+	private:
+		// The indices are updated together (and built in the same pass)
+		struct Indices
+		{
+			SearchIndex m_search_index;
+			CrossReferenceIndex m_cross_references;
+			ValidationIndex m_validation;
+
+			Indices(std::shared_ptr<ScenarioValidator> validator) : m_validation(std::move(validator)) {}
+
+			void add_terminal(const TerminalID& terminal_id, const Terminal& terminal);
+			void remove_terminal(const TerminalID& terminal_id);
+			void add_level(int level_id, const Level& level);
+			bool set_terminal_ids(int level_id, const std::vector<int>& terminal_ids);
+			void remove_level(int level_id);
+			void clear();
+		};
+
+		void connect_signals();
+		void build_finished();
+
+		void index_level(int level_id);
+		bool defer_level_update(int level_id); // Returns true while the index is being built (the level is indexed again once the build is done)
+
+		void level_rows_inserted(const QModelIndex& parent, int first, int last);
+		void level_rows_about_to_be_removed(const QModelIndex& parent, int first, int last);
+		void level_loaded(int level_id);
+		void terminal_rows_inserted(int level_id, int first_row, int last_row);
+		void terminal_rows_about_to_be_removed(int level_id, int first_row, int last_row);
+		void terminal_modified(int level_id, int terminal_id);
+
+		struct Internal;
+		std::unique_ptr<Internal> m_internal;
+	};
+}
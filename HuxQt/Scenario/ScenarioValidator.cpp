@@ -0,0 +1,393 @@
+#include <HuxQt/Scenario/ScenarioValidator.h>
+
+#include <HuxQt/Scenario/AOText.h>
+#include <HuxQt/Scenario/CrossReferenceIndex.h>
+#include <HuxQt/Scenario/Level.h>
+#include <HuxQt/Scenario/MemoryReport.h>
+
+#include <HuxQt/Utils/Trace.h>
+
+#include <QHash>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <numeric>
+
+namespace HuxApp
+{
+	namespace
+	{
+		// Results of edited terminals pile up in the cache, so it is trimmed once it grows past this (or twice the size after the last trim)
+		constexpr size_t MIN_CACHE_TRIM_SIZE = 4096;
+
+		constexpr const char* RULE_NAMES[Utils::to_integral(ScenarioValidator::Rule::RULE_COUNT)] = {
+			"empty-terminal",
+			"empty-branch",
+			"text-overflow",
+			"centered-pict-text",
+			"unmatched-tag",
+			"invalid-polygon-teleport",
+			"missing-pict",
+			"invalid-level-teleport"
+		};
+
+		constexpr const char* EMPTY_BRANCH_MESSAGES[Utils::to_integral(Terminal::BranchType::TYPE_COUNT)] = {
+			"Branch is empty, the terminal shows nothing until the level is finished",
+			"Branch is empty, the terminal shows nothing once the level is finished",
+			"Branch is empty, the terminal shows nothing once the level is failed"
+		};
+
+		bool screen_has_text(const Terminal::Screen& screen)
+		{
+			switch (screen.m_type)
+			{
+			case Terminal::ScreenType::LOGON:
+			case Terminal::ScreenType::INFORMATION:
+			case Terminal::ScreenType::CHECKPOINT:
+			case Terminal::ScreenType::LOGOFF:
+				return true;
+			case Terminal::ScreenType::PICT:
+				// Centered images take up the whole screen
+				return (screen.m_alignment != Terminal::ScreenAlignment::CENTER);
+			}
+
+			return false;
+		}
+	}
+
+	ScenarioValidator::ProblemListPtr ScenarioValidator::check_terminal(const Terminal& terminal)
+	{
+		const size_t terminal_hash = hash_terminal(terminal);
+		{
+			QMutexLocker cache_lock(&m_cache_mutex);
+			auto cache_it = m_cache.find(terminal_hash);
+			if ((cache_it != m_cache.end()) && compare_terminals(cache_it->second.m_terminal, terminal))
+			{
+				return cache_it->second.m_problems;
+			}
+		}
+
+		// Checked without holding the lock, so the other terminals can be checked in the meantime
+		ProblemListPtr problems = std::make_shared<const ProblemList>(check_terminal_contents(terminal));
+
+		QMutexLocker cache_lock(&m_cache_mutex);
+		auto emplace_result = m_cache.try_emplace(terminal_hash, CacheEntry{ terminal, problems });
+		if (!compare_terminals(emplace_result.first->second.m_terminal, terminal))
+		{
+			// Hash collision, the cached results stay in place (still used by the other terminal) and these are not cached
+			return problems;
+		}
+
+		// Take a reference before trimming, otherwise the new entry would be dropped right away
+		ProblemListPtr cached_problems = emplace_result.first->second.m_problems;
+		if (m_cache.size() > m_trim_size)
+		{
+			trim_cache();
+		}
+		return cached_problems;
+	}
+
+	std::vector<ScenarioValidator::ProblemListPtr> ScenarioValidator::check_terminals(const std::vector<const Terminal*>& terminals)
+	{
+		HUX_TRACE_SCOPE("validation", "check_terminals");
+		std::vector<ProblemListPtr> terminal_problems(terminals.size());
+
+		std::vector<int> terminal_indices(terminals.size());
+		std::iota(terminal_indices.begin(), terminal_indices.end(), 0);
+		QtConcurrent::blockingMap(terminal_indices, [this, &terminals, &terminal_problems](int terminal_index)
+			{
+				terminal_problems[terminal_index] = check_terminal(*terminals[terminal_index]);
+			}
+		);
+		return terminal_problems;
+	}
+
+	void ScenarioValidator::check_references(const CrossReferenceIndex& cross_references, int level_count, const QMap<int, QString>* pict_files, std::vector<TerminalProblem>& problems)
+	{
+		auto add_problems = [&cross_references, &problems](CrossReferenceIndex::ReferenceType type, int id, Rule rule, const QString& message)
+			{
+				for (const CrossReferenceIndex::Reference& current_reference : cross_references.get_references(type, id))
+				{
+					problems.push_back(TerminalProblem{ current_reference.m_terminal_id, Problem{ rule, Diagnostics::Severity::ERROR, current_reference.m_branch, current_reference.m_screen, message } });
+				}
+			};
+
+		if (pict_files)
+		{
+			for (const int current_pict_id : cross_references.find_missing_picts(*pict_files))
+			{
+				add_problems(CrossReferenceIndex::ReferenceType::PICT, current_pict_id, Rule::MISSING_PICT, QStringLiteral("PICT %1 is not in the resources").arg(current_pict_id));
+			}
+		}
+
+		// Interlevel teleports use the level index
+		for (const int current_level_index : cross_references.get_ids(CrossReferenceIndex::ReferenceType::LEVEL_TELEPORT))
+		{
+			if ((current_level_index < 0) || (current_level_index >= level_count))
+			{
+				add_problems(CrossReferenceIndex::ReferenceType::LEVEL_TELEPORT, current_level_index, Rule::INVALID_LEVEL_TELEPORT, QStringLiteral("Teleport to level %1, but the scenario has %2 level(s)").arg(current_level_index).arg(level_count));
+			}
+		}
+	}
+
+	int ScenarioValidator::get_cache_size() const
+	{
+		QMutexLocker cache_lock(&m_cache_mutex);
+		return static_cast<int>(m_cache.size());
+	}
+
+	void ScenarioValidator::clear_cache()
+	{
+		QMutexLocker cache_lock(&m_cache_mutex);
+		m_cache.clear();
+		m_trim_size = 0;
+	}
+
+	int ScenarioValidator::report_memory(MemoryReport& report, int parent) const
+	{
+		QMutexLocker cache_lock(&m_cache_mutex);
+
+		const int cache_entry = report.add_entry(QStringLiteral("Validation cache (%1 terminals)").arg(m_cache.size()), parent);
+		report.add_bytes(cache_entry, MemoryReport::Category::STRUCTURE, sizeof(ScenarioValidator));
+		report.add_hash_map(cache_entry, m_cache);
+
+		// Shared pointers allocate the list and the reference counts together (the terminals share their data with the scenario, so they are not counted)
+		const qint64 list_size = sizeof(ProblemList) + (2 * sizeof(void*));
+		for (const auto& [current_hash, current_entry] : m_cache)
+		{
+			const ProblemList& current_problems = *current_entry.m_problems;
+			report.add_bytes(cache_entry, MemoryReport::Category::CACHE, list_size + static_cast<qint64>(current_problems.capacity() * sizeof(Problem)));
+			for (const Problem& current_problem : current_problems)
+			{
+				report.add_string(cache_entry, MemoryReport::Category::CACHE, current_problem.m_message);
+			}
+		}
+		return cache_entry;
+	}
+
+	size_t ScenarioValidator::hash_terminal(const Terminal& terminal)
+	{
+		// Names, comments and the display text do not affect the results
+		size_t terminal_hash = 0;
+		for (const Terminal::Branch& current_branch : terminal.get_branches())
+		{
+			terminal_hash = qHashMulti(terminal_hash, current_branch.m_screens.size(), Utils::to_integral(current_branch.m_teleport.m_type), current_branch.m_teleport.m_index);
+			for (const Terminal::Screen& current_screen : current_branch.m_screens)
+			{
+				terminal_hash = qHashMulti(terminal_hash, Utils::to_integral(current_screen.m_type), Utils::to_integral(current_screen.m_alignment), current_screen.m_resource_id, current_screen.m_script);
+			}
+		}
+		return terminal_hash;
+	}
+
+	bool ScenarioValidator::compare_terminals(const Terminal& lhs, const Terminal& rhs)
+	{
+		if (lhs.is_shared_with(rhs))
+		{
+			return true;
+		}
+
+		const Terminal::BranchArray& lhs_branches = lhs.get_branches();
+		const Terminal::BranchArray& rhs_branches = rhs.get_branches();
+		for (int branch_index = 0; branch_index < Utils::to_integral(Terminal::BranchType::TYPE_COUNT); ++branch_index)
+		{
+			const Terminal::Branch& lhs_branch = lhs_branches[branch_index];
+			const Terminal::Branch& rhs_branch = rhs_branches[branch_index];
+			if ((lhs_branch.m_teleport != rhs_branch.m_teleport) || (lhs_branch.m_screens.size() != rhs_branch.m_screens.size()))
+			{
+				return false;
+			}
+
+			for (qsizetype screen_index = 0; screen_index < lhs_branch.m_screens.size(); ++screen_index)
+			{
+				const Terminal::Screen& lhs_screen = lhs_branch.m_screens[screen_index];
+				const Terminal::Screen& rhs_screen = rhs_branch.m_screens[screen_index];
+				if ((lhs_screen.m_type != rhs_screen.m_type) || (lhs_screen.m_alignment != rhs_screen.m_alignment) || (lhs_screen.m_resource_id != rhs_screen.m_resource_id) || (lhs_screen.m_script != rhs_screen.m_script))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	const char* ScenarioValidator::get_rule_name(Rule rule)
+	{
+		return RULE_NAMES[Utils::to_integral(rule)];
+	}
+
+	ScenarioValidator::ProblemList ScenarioValidator::check_terminal_contents(const Terminal& terminal)
+	{
+		ProblemList problems;
+		auto add_problem = [&problems](Rule rule, Diagnostics::Severity severity, Terminal::BranchType branch, int screen, const QString& message)
+			{
+				problems.push_back(Problem{ rule, severity, branch, screen, message });
+			};
+
+		const Terminal::BranchArray& branches = terminal.get_branches();
+		if (std::none_of(branches.begin(), branches.end(), [](const Terminal::Branch& branch) { return branch.is_valid(); }))
+		{
+			add_problem(Rule::EMPTY_TERMINAL, Diagnostics::Severity::WARNING, Terminal::BranchType::TYPE_COUNT, -1, QStringLiteral("Terminal has no screens or teleports"));
+			return problems;
+		}
+
+		for (int branch_index = 0; branch_index < Utils::to_integral(Terminal::BranchType::TYPE_COUNT); ++branch_index)
+		{
+			const Terminal::BranchType branch_type = Utils::to_enum<Terminal::BranchType>(branch_index);
+			const Terminal::Branch& current_branch = branches[branch_index];
+
+			if (!current_branch.is_valid())
+			{
+				// The unfinished branch is shown for most of the level, the others only once the level is finished (or failed), so those are less likely to be a mistake
+				const Diagnostics::Severity severity = (branch_type == Terminal::BranchType::UNFINISHED) ? Diagnostics::Severity::WARNING : Diagnostics::Severity::INFO;
+				add_problem(Rule::EMPTY_BRANCH, severity, branch_type, -1, QString::fromLatin1(EMPTY_BRANCH_MESSAGES[branch_index]));
+				continue;
+			}
+
+			int screen_index = 0;
+			for (const Terminal::Screen& current_screen : current_branch.m_screens)
+			{
+				if ((current_screen.m_type == Terminal::ScreenType::PICT) && (current_screen.m_alignment == Terminal::ScreenAlignment::CENTER) && !current_screen.m_script.trimmed().isEmpty())
+				{
+					add_problem(Rule::CENTERED_PICT_TEXT, Diagnostics::Severity::WARNING, branch_type, screen_index, QStringLiteral("Centered PICT has text, which is not displayed"));
+				}
+				else if (screen_has_text(current_screen))
+				{
+					// Text of information screens is expected to span multiple pages, but next to an image it is easy to miss
+					const int line_count = AOText::get_line_count(current_screen.m_script, current_screen.m_type);
+					if (line_count > AOText::SCREEN_MAX_LINES)
+					{
+						const int page_count = (line_count + AOText::SCREEN_MAX_LINES - 1) / AOText::SCREEN_MAX_LINES;
+						const Diagnostics::Severity severity = (current_screen.m_type == Terminal::ScreenType::INFORMATION) ? Diagnostics::Severity::INFO : Diagnostics::Severity::WARNING;
+						add_problem(Rule::TEXT_OVERFLOW, severity, branch_type, screen_index, QStringLiteral("Text has %1 lines, which span %2 pages (%3 lines per page)").arg(line_count).arg(page_count).arg(AOText::SCREEN_MAX_LINES));
+					}
+
+					for (const AOText::UnmatchedTag& current_tag : AOText::find_unmatched_tags(current_screen.m_script))
+					{
+						const QString message = current_tag.m_closing ? QStringLiteral("\"%1\" on line %2 ends a style which was not started") : QStringLiteral("\"%1\" on line %2 is never closed");
+						add_problem(Rule::UNMATCHED_TAG, Diagnostics::Severity::WARNING, branch_type, screen_index, message.arg(current_tag.m_tag).arg(current_tag.m_line + 1));
+					}
+				}
+				++screen_index;
+			}
+
+			if ((current_branch.m_teleport.m_type == Terminal::TeleportType::INTRALEVEL) && (current_branch.m_teleport.m_index < 0))
+			{
+				add_problem(Rule::INVALID_POLYGON_TELEPORT, Diagnostics::Severity::ERROR, branch_type, -1, QStringLiteral("Teleport to polygon %1, which does not exist").arg(current_branch.m_teleport.m_index));
+			}
+		}
+		return problems;
+	}
+
+	void ScenarioValidator::trim_cache()
+	{
+		for (auto cache_it = m_cache.begin(); cache_it != m_cache.end();)
+		{
+			// Only referenced by the cache (e.g an earlier version of an edited terminal)
+			if (cache_it->second.m_problems.use_count() == 1)
+			{
+				cache_it = m_cache.erase(cache_it);
+			}
+			else
+			{
+				++cache_it;
+			}
+		}
+		m_trim_size = std::max(MIN_CACHE_TRIM_SIZE, m_cache.size() * 2);
+	}
+
+	ValidationIndex::ValidationIndex(std::shared_ptr<ScenarioValidator> validator)
+		: m_validator(std::move(validator))
+	{
+	}
+
+	void ValidationIndex::add_terminal(const TerminalID& terminal_id, const Terminal& terminal)
+	{
+		// Unchanged contents are found in the cache (e.g the terminal was only renamed, or an edit was undone)
+		m_level_terminals[terminal_id.m_level_id][terminal_id.m_terminal_id] = m_validator->check_terminal(terminal);
+	}
+
+	void ValidationIndex::remove_terminal(const TerminalID& terminal_id)
+	{
+		auto level_it = m_level_terminals.find(terminal_id.m_level_id);
+		if (level_it != m_level_terminals.end())
+		{
+			level_it->second.erase(terminal_id.m_terminal_id);
+		}
+	}
+
+	void ValidationIndex::add_level(int level_id, const Level& level)
+	{
+		const std::vector<Terminal>& terminals = level.get_terminals();
+		std::vector<const Terminal*> checked_terminals;
+		checked_terminals.reserve(terminals.size());
+		for (const Terminal& current_terminal : terminals)
+		{
+			checked_terminals.push_back(&current_terminal);
+		}
+		std::vector<ScenarioValidator::ProblemListPtr> terminal_problems = m_validator->check_terminals(checked_terminals);
+
+		std::unordered_map<int, ScenarioValidator::ProblemListPtr>& level_terminals = m_level_terminals[level_id];
+		for (int terminal_row = 0; terminal_row < static_cast<int>(terminal_problems.size()); ++terminal_row)
+		{
+			level_terminals[terminal_row] = std::move(terminal_problems[terminal_row]);
+		}
+	}
+
+	bool ValidationIndex::set_terminal_ids(int level_id, const std::vector<int>& terminal_ids)
+	{
+		auto level_it = m_level_terminals.find(level_id);
+		if (level_it == m_level_terminals.end())
+		{
+			return false;
+		}
+
+		std::unordered_map<int, ScenarioValidator::ProblemListPtr> level_terminals;
+		level_terminals.reserve(level_it->second.size());
+		for (auto& [current_row, current_problems] : level_it->second)
+		{
+			if ((current_row >= 0) && (current_row < static_cast<int>(terminal_ids.size())))
+			{
+				level_terminals[terminal_ids[current_row]] = std::move(current_problems);
+			}
+		}
+		level_it->second = std::move(level_terminals);
+		return true;
+	}
+
+	void ValidationIndex::remove_level(int level_id)
+	{
+		m_level_terminals.erase(level_id);
+	}
+
+	void ValidationIndex::clear()
+	{
+		m_level_terminals.clear();
+	}
+
+	void ValidationIndex::get_problems(std::vector<ScenarioValidator::TerminalProblem>& problems) const
+	{
+		for (const auto& [current_level_id, current_level_terminals] : m_level_terminals)
+		{
+			for (const auto& [current_terminal_id, current_problems] : current_level_terminals)
+			{
+				for (const ScenarioValidator::Problem& current_problem : *current_problems)
+				{
+					problems.push_back(ScenarioValidator::TerminalProblem{ TerminalID{ current_level_id, current_terminal_id }, current_problem });
+				}
+			}
+		}
+	}
+
+	int ValidationIndex::report_memory(MemoryReport& report, int parent) const
+	{
+		const int index_entry = report.add_entry(QStringLiteral("Validation index"), parent);
+		report.add_bytes(index_entry, MemoryReport::Category::STRUCTURE, sizeof(ValidationIndex));
+		for (const auto& [current_level_id, current_level_terminals] : m_level_terminals)
+		{
+			report.add_hash_map(index_entry, current_level_terminals);
+		}
+		report.add_hash_map(index_entry, m_level_terminals);
+		return index_entry;
+	}
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <HuxQt/Scenario/Diagnostics.h>
+#include <HuxQt/Scenario/Terminal.h>
+
+#include <QMap>
+#include <QMutex>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace HuxApp
+{
+	class Level;
+	class CrossReferenceIndex;
+	class MemoryReport;
+
+	// Checks the terminals for problems which otherwise only show up in the preview or in the game
+	// The results of each terminal are cached by the hash of its contents, so unchanged terminals are never checked again (all functions are thread-safe)
+	// Each result keeps the terminal it was checked for (shares the data), so a hash collision is detected instead of returning the results of another terminal
+	class ScenarioValidator
+	{
+	public:
+		enum class Rule
+		{
+			EMPTY_TERMINAL,
+			EMPTY_BRANCH,
+			TEXT_OVERFLOW,
+			CENTERED_PICT_TEXT,
+			UNMATCHED_TAG,
+			INVALID_POLYGON_TELEPORT,
+
+			// Depend on the rest of the scenario (checked with the cross-reference index)
+			MISSING_PICT,
+			INVALID_LEVEL_TELEPORT,
+			RULE_COUNT
+		};
+
+		struct Problem
+		{
+			Rule m_rule = Rule::RULE_COUNT;
+			Diagnostics::Severity m_severity = Diagnostics::Severity::WARNING;
+			Terminal::BranchType m_branch = Terminal::BranchType::TYPE_COUNT; // Not set if the whole terminal is affected
+			int m_screen = -1; // Not set for branches and teleports
+			QString m_message;
+		};
+
+		using ProblemList = std::vector<Problem>;
+		using ProblemListPtr = std::shared_ptr<const ProblemList>; // Shared by the terminals with the same contents
+
+		struct TerminalProblem
+		{
+			TerminalID m_terminal_id;
+			Problem m_problem;
+		};
+
+		ProblemListPtr check_terminal(const Terminal& terminal);
+		std::vector<ProblemListPtr> check_terminals(const std::vector<const Terminal*>& terminals); // Checks the terminals in parallel (results are in the same order)
+
+		// Missing PICTs are only checked if the image files are given (ID -> path, e.g the display system cache)
+		static void check_references(const CrossReferenceIndex& cross_references, int level_count, const QMap<int, QString>* pict_files, std::vector<TerminalProblem>& problems);
+
+		int get_cache_size() const;
+		void clear_cache();
+
+		int report_memory(MemoryReport& report, int parent = -1) const; // Returns the report entry
+
+		static size_t hash_terminal(const Terminal& terminal); // Only hashes the fields which are checked
+		static bool compare_terminals(const Terminal& lhs, const Terminal& rhs); // Only compares the fields which are checked (same as the hash)
+		static const char* get_rule_name(Rule rule);
+	private:
+		struct CacheEntry
+		{
+			Terminal m_terminal;
+			ProblemListPtr m_problems;
+		};
+
+		static ProblemList check_terminal_contents(const Terminal& terminal);
+		void trim_cache(); // Drops the results which are no longer used by any terminal (expects the cache to be locked)
+
+		mutable QMutex m_cache_mutex;
+		std::unordered_map<size_t, CacheEntry> m_cache;
+		size_t m_trim_size = 0;
+	};
+
+	// Validation results of each terminal, which can be updated one terminal at a time
+	// Uses the same keys as the search index: terminals of levels which have no terminal IDs yet are keyed by row
+	class ValidationIndex
+	{
+	public:
+		ValidationIndex(std::shared_ptr<ScenarioValidator> validator);
+
+		void add_terminal(const TerminalID& terminal_id, const Terminal& terminal); // Replaces the results if the terminal was already indexed
+		void remove_terminal(const TerminalID& terminal_id);
+
+		void add_level(int level_id, const Level& level); // Terminal IDs are the rows (same as in the search index)
+		bool set_terminal_ids(int level_id, const std::vector<int>& terminal_ids); // Returns false if the level is not indexed
+		void remove_level(int level_id);
+
+		void clear();
+
+		void get_problems(std::vector<ScenarioValidator::TerminalProblem>& problems) const; // Appends the problems of every terminal (in no particular order)
+
+		int report_memory(MemoryReport& report, int parent = -1) const; // Returns the report entry (the results are counted with the validator cache)
+	private:
+		std::shared_ptr<ScenarioValidator> m_validator;
+		std::unordered_map<int, std::unordered_map<int, ScenarioValidator::ProblemListPtr>> m_level_terminals; // Level ID -> terminal ID -> results
+	};
+}
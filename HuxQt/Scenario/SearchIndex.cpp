@@ -0,0 +1,571 @@
+#include <HuxQt/Scenario/SearchIndex.h>
+
+#include <HuxQt/Scenario/Level.h>
+#include <HuxQt/Scenario/MemoryReport.h>
+
+#include <HuxQt/Utils/Trace.h>
+
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <iterator>
+
+namespace HuxApp
+{
+	namespace
+	{
+		constexpr const char* FIELD_NAMES[Utils::to_integral(SearchIndex::Field::FIELD_COUNT)] = {
+			"name",
+			"comments",
+			"script",
+			"screen comments"
+		};
+
+		// Context shown around the match in the snippets
+		constexpr int SNIPPET_PREFIX_LENGTH = 30;
+		constexpr int SNIPPET_SUFFIX_LENGTH = 60;
+
+		// Postings of removed terminals are dropped once they outnumber the others (and there are enough of them to be worth a pass over the index)
+		constexpr qint64 COMPACTION_MIN_STALE_POSTINGS = 4096;
+
+		bool is_word_char(QChar c)
+		{
+			return c.isLetterOrNumber() || (c == '_');
+		}
+
+		// Length of the AO formatting tag at the given position (e.g "$B" or "$C2"), zero if there is none
+		qsizetype get_tag_length(const QString& text, qsizetype index)
+		{
+			if ((text[index] != '$') || ((index + 1) >= text.size()))
+			{
+				return 0;
+			}
+
+			switch (text[index + 1].unicode())
+			{
+			case 'B':
+			case 'b':
+			case 'I':
+			case 'i':
+			case 'U':
+			case 'u':
+				return 2;
+			case 'C':
+				return (((index + 2) < text.size()) && (text[index + 2] >= '0') && (text[index + 2] <= '7')) ? 3 : 0;
+			}
+			return 0;
+		}
+
+		// Words start after anything but a word character, including the end of a tag (tags are usually glued to the text, e.g "$BDurandal$b")
+		bool is_word_boundary(const QString& text, qsizetype index)
+		{
+			return (index == 0) || !is_word_char(text[index - 1])
+				|| ((index >= 2) && (get_tag_length(text, index - 2) == 2))
+				|| ((index >= 3) && (get_tag_length(text, index - 3) == 3));
+		}
+
+		// Words are case-folded, tags are separate words (so the tagged words are found as well)
+		template<typename FUNC>
+		void for_each_word(const QString& text, FUNC&& function)
+		{
+			QString word;
+			const qsizetype text_length = text.size();
+			qsizetype current_index = 0;
+			while (current_index < text_length)
+			{
+				const qsizetype tag_length = get_tag_length(text, current_index);
+				if (tag_length > 0)
+				{
+					function(text.mid(current_index, tag_length).toCaseFolded());
+					current_index += tag_length;
+					continue;
+				}
+
+				if (!is_word_char(text[current_index]))
+				{
+					++current_index;
+					continue;
+				}
+
+				word.clear();
+				for (; (current_index < text_length) && is_word_char(text[current_index]); ++current_index)
+				{
+					word += text[current_index].toCaseFolded();
+				}
+				function(word);
+			}
+		}
+
+		template<typename FUNC>
+		void for_each_field(const Terminal& terminal, FUNC&& function)
+		{
+			function(SearchIndex::Field::TERMINAL_NAME, Terminal::BranchType::TYPE_COUNT, -1, terminal.get_name());
+			function(SearchIndex::Field::TERMINAL_COMMENTS, Terminal::BranchType::TYPE_COUNT, -1, terminal.get_comments());
+
+			for (int branch_index = 0; branch_index < Utils::to_integral(Terminal::BranchType::TYPE_COUNT); ++branch_index)
+			{
+				const Terminal::BranchType branch_type = Utils::to_enum<Terminal::BranchType>(branch_index);
+				int screen_index = 0;
+				for (const Terminal::Screen& current_screen : terminal.get_branch(branch_type).m_screens)
+				{
+					function(SearchIndex::Field::SCREEN_SCRIPT, branch_type, screen_index, current_screen.m_script);
+					function(SearchIndex::Field::SCREEN_COMMENTS, branch_type, screen_index, current_screen.m_comments);
+					++screen_index;
+				}
+			}
+		}
+
+		struct QueryTerm
+		{
+			QStringList m_parts; // Split at the whitespace, any whitespace (e.g a line break) matches between the parts
+			QStringList m_words;
+		};
+
+		// Splits the query into words and quoted phrases
+		std::vector<QueryTerm> parse_query_terms(const QString& query)
+		{
+			std::vector<QueryTerm> terms;
+			auto add_term = [&terms](const QString& text)
+				{
+					const QStringList text_parts = text.split(QRegularExpression(QStringLiteral("\\s+")), Qt::SkipEmptyParts);
+					if (text_parts.isEmpty())
+					{
+						return;
+					}
+
+					QueryTerm& new_term = terms.emplace_back();
+					new_term.m_parts = text_parts;
+					for_each_word(text, [&new_term](const QString& word) { new_term.m_words << word; });
+				};
+
+			QString current_text;
+			bool in_phrase = false;
+			for (const QChar current_char : query)
+			{
+				if (current_char == '"')
+				{
+					add_term(current_text);
+					current_text.clear();
+					in_phrase = !in_phrase;
+				}
+				else if (current_char.isSpace() && !in_phrase)
+				{
+					add_term(current_text);
+					current_text.clear();
+				}
+				else
+				{
+					current_text += current_char;
+				}
+			}
+			add_term(current_text);
+			return terms;
+		}
+
+		// Terms have to start at a word boundary (unless they start with punctuation), returns the position and sets the length of the match
+		qsizetype find_term(const QString& text, const QueryTerm& term, qsizetype& match_length)
+		{
+			const QString& first_part = term.m_parts.front();
+			const bool word_start = is_word_char(first_part.front());
+			for (qsizetype match_index = text.indexOf(first_part, 0, Qt::CaseInsensitive); match_index >= 0; match_index = text.indexOf(first_part, match_index + 1, Qt::CaseInsensitive))
+			{
+				if (word_start && !is_word_boundary(text, match_index))
+				{
+					continue;
+				}
+
+				// The rest of the phrase has to follow after some whitespace (tags around it are skipped, e.g "$BLower$b decks")
+				qsizetype match_end = match_index + first_part.size();
+				bool phrase_match = true;
+				for (qsizetype part_index = 1; part_index < term.m_parts.size(); ++part_index)
+				{
+					const QString& current_part = term.m_parts[part_index];
+					const bool skip_tags = (get_tag_length(current_part, 0) == 0); // Unless the query has a tag itself
+
+					bool found_whitespace = false;
+					while (match_end < text.size())
+					{
+						if (text[match_end].isSpace())
+						{
+							found_whitespace = true;
+							++match_end;
+						}
+						else if (const qsizetype tag_length = skip_tags ? get_tag_length(text, match_end) : 0)
+						{
+							match_end += tag_length;
+						}
+						else
+						{
+							break;
+						}
+					}
+
+					if (!found_whitespace || !QStringView(text).mid(match_end).startsWith(current_part, Qt::CaseInsensitive))
+					{
+						phrase_match = false;
+						break;
+					}
+					match_end += current_part.size();
+				}
+
+				if (phrase_match)
+				{
+					match_length = match_end - match_index;
+					return match_index;
+				}
+			}
+			return -1;
+		}
+
+		QString get_snippet(const QString& text, qsizetype position, qsizetype length)
+		{
+			const qsizetype snippet_start = std::max<qsizetype>(0, position - SNIPPET_PREFIX_LENGTH);
+			const qsizetype snippet_end = std::min<qsizetype>(text.size(), position + length + SNIPPET_SUFFIX_LENGTH);
+
+			QString snippet = text.mid(snippet_start, snippet_end - snippet_start).simplified();
+			if (snippet_start > 0)
+			{
+				snippet.prepend(QStringLiteral("..."));
+			}
+			if (snippet_end < text.size())
+			{
+				snippet += QStringLiteral("...");
+			}
+			return snippet;
+		}
+
+		std::vector<int> intersect_handles(const std::vector<int>& lhs, const std::vector<int>& rhs)
+		{
+			std::vector<int> intersection;
+			std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(intersection));
+			return intersection;
+		}
+	}
+
+	void SearchIndex::add_terminal(const TerminalID& terminal_id, const Terminal& terminal)
+	{
+		remove_terminal(terminal_id);
+
+		IndexedTerminal indexed_terminal;
+		indexed_terminal.m_id = terminal_id;
+		indexed_terminal.m_terminal = terminal;
+
+		// Only add one posting per word
+		std::vector<QString> terminal_words;
+		for_each_field(terminal, [&terminal_words](Field, Terminal::BranchType, int, const QString& text)
+			{
+				for_each_word(text, [&terminal_words](const QString& word) { terminal_words.push_back(word); });
+			}
+		);
+		std::sort(terminal_words.begin(), terminal_words.end());
+		terminal_words.erase(std::unique(terminal_words.begin(), terminal_words.end()), terminal_words.end());
+		indexed_terminal.m_word_count = static_cast<int>(terminal_words.size());
+
+		const TerminalHandle handle = m_terminals.insert(std::move(indexed_terminal));
+		if (handle == Utils::SlotMap<IndexedTerminal>::INVALID_HANDLE)
+		{
+			// Out of handles, the terminal is left out of the results
+			return;
+		}
+
+		for (const QString& current_word : terminal_words)
+		{
+			m_postings[current_word].push_back(handle);
+		}
+		m_posting_count += static_cast<qint64>(terminal_words.size());
+
+		m_level_terminals[terminal_id.m_level_id][terminal_id.m_terminal_id] = handle;
+	}
+
+	void SearchIndex::remove_terminal(const TerminalID& terminal_id)
+	{
+		auto level_it = m_level_terminals.find(terminal_id.m_level_id);
+		if (level_it == m_level_terminals.end())
+		{
+			return;
+		}
+
+		auto terminal_it = level_it->second.find(terminal_id.m_terminal_id);
+		if (terminal_it != level_it->second.end())
+		{
+			remove_terminal_internal(terminal_it->second);
+			level_it->second.erase(terminal_it);
+			compact_postings();
+		}
+	}
+
+	void SearchIndex::add_level(int level_id, const Level& level)
+	{
+		int terminal_row = 0;
+		for (const Terminal& current_terminal : level.get_terminals())
+		{
+			add_terminal(TerminalID{ level_id, terminal_row }, current_terminal);
+			++terminal_row;
+		}
+	}
+
+	bool SearchIndex::set_terminal_ids(int level_id, const std::vector<int>& terminal_ids)
+	{
+		auto level_it = m_level_terminals.find(level_id);
+		if (level_it == m_level_terminals.end())
+		{
+			return false;
+		}
+
+		// Only the keys change, the terminals do not have to be indexed again
+		std::unordered_map<int, TerminalHandle> level_terminals;
+		level_terminals.reserve(level_it->second.size());
+		for (const auto& [current_row, current_handle] : level_it->second)
+		{
+			IndexedTerminal* indexed_terminal = m_terminals.get(current_handle);
+			if ((current_row < 0) || (current_row >= static_cast<int>(terminal_ids.size())))
+			{
+				remove_terminal_internal(current_handle);
+				continue;
+			}
+
+			indexed_terminal->m_id.m_terminal_id = terminal_ids[current_row];
+			level_terminals[terminal_ids[current_row]] = current_handle;
+		}
+		level_it->second = std::move(level_terminals);
+		compact_postings();
+		return true;
+	}
+
+	void SearchIndex::remove_level(int level_id)
+	{
+		auto level_it = m_level_terminals.find(level_id);
+		if (level_it == m_level_terminals.end())
+		{
+			return;
+		}
+
+		for (const auto& [current_terminal_id, current_handle] : level_it->second)
+		{
+			remove_terminal_internal(current_handle);
+		}
+		m_level_terminals.erase(level_it);
+		compact_postings();
+	}
+
+	void SearchIndex::clear()
+	{
+		m_terminals.clear();
+		m_level_terminals.clear();
+		m_postings.clear();
+		m_posting_count = 0;
+		m_stale_posting_count = 0;
+	}
+
+	bool SearchIndex::search(const QString& query, std::vector<Hit>& hits, QString& error_msg, int max_hits) const
+	{
+		HUX_TRACE_SCOPE("search", "search");
+		hits.clear();
+
+		const QString trimmed_query = query.trimmed();
+		if (trimmed_query.isEmpty())
+		{
+			return true;
+		}
+
+		// Check for a regular expression first
+		const bool regex_query = (trimmed_query.size() > 2) && trimmed_query.startsWith('/') && trimmed_query.endsWith('/');
+		QRegularExpression query_regex;
+		std::vector<QueryTerm> query_terms;
+		if (regex_query)
+		{
+			query_regex.setPattern(trimmed_query.mid(1, trimmed_query.size() - 2));
+			query_regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+			if (!query_regex.isValid())
+			{
+				error_msg = QStringLiteral("Invalid regular expression: %1").arg(query_regex.errorString());
+				return false;
+			}
+		}
+		else
+		{
+			query_terms = parse_query_terms(trimmed_query);
+			if (query_terms.empty())
+			{
+				return true;
+			}
+		}
+
+		// Narrow down the terminals using the postings (the last word of a term may be incomplete, so it is matched as a prefix)
+		std::vector<TerminalHandle> candidates;
+		bool indexed_query = false;
+		for (const QueryTerm& current_term : query_terms)
+		{
+			for (int word_index = 0; word_index < current_term.m_words.size(); ++word_index)
+			{
+				const bool prefix = (word_index == (current_term.m_words.size() - 1));
+				std::vector<TerminalHandle> word_candidates = get_postings(current_term.m_words[word_index], prefix);
+				candidates = indexed_query ? intersect_handles(candidates, word_candidates) : std::move(word_candidates);
+				indexed_query = true;
+
+				if (candidates.empty())
+				{
+					return true;
+				}
+			}
+		}
+
+		if (!indexed_query)
+		{
+			// Scan all the terminals
+			candidates.reserve(m_terminals.size());
+			for (int value_index = 0; value_index < static_cast<int>(m_terminals.size()); ++value_index)
+			{
+				candidates.push_back(m_terminals.get_handle(value_index));
+			}
+		}
+
+		// Locate the matches in the candidate terminals (all the terms have to be in the same field)
+		for (const TerminalHandle current_handle : candidates)
+		{
+			const IndexedTerminal& indexed_terminal = *m_terminals.get(current_handle);
+			for_each_field(indexed_terminal.m_terminal, [&](Field field, Terminal::BranchType branch, int screen, const QString& text)
+				{
+					if (text.isEmpty() || (static_cast<int>(hits.size()) >= max_hits))
+					{
+						return;
+					}
+
+					qsizetype match_position = -1;
+					qsizetype match_length = 0;
+					if (regex_query)
+					{
+						const QRegularExpressionMatch regex_match = query_regex.match(text);
+						if (regex_match.hasMatch())
+						{
+							match_position = regex_match.capturedStart();
+							match_length = regex_match.capturedLength();
+						}
+					}
+					else
+					{
+						for (const QueryTerm& current_term : query_terms)
+						{
+							qsizetype term_length = 0;
+							const qsizetype term_position = find_term(text, current_term, term_length);
+							if (term_position < 0)
+							{
+								return;
+							}
+
+							if (match_position < 0)
+							{
+								// Report the position of the first term
+								match_position = term_position;
+								match_length = term_length;
+							}
+						}
+					}
+
+					if (match_position < 0)
+					{
+						return;
+					}
+
+					Hit& new_hit = hits.emplace_back();
+					new_hit.m_terminal_id = indexed_terminal.m_id;
+					new_hit.m_field = field;
+					new_hit.m_branch = branch;
+					new_hit.m_screen = screen;
+					new_hit.m_position = static_cast<int>(match_position);
+					new_hit.m_length = static_cast<int>(match_length);
+					new_hit.m_snippet = get_snippet(text, match_position, match_length);
+				}
+			);
+
+			if (static_cast<int>(hits.size()) >= max_hits)
+			{
+				break;
+			}
+		}
+		return true;
+	}
+
+	int SearchIndex::report_memory(MemoryReport& report, int parent) const
+	{
+		// The terminals are shared with the scenario, only the index structures are counted
+		const int index_entry = report.add_entry(QStringLiteral("Search index"), parent);
+		report.add_bytes(index_entry, MemoryReport::Category::STRUCTURE, sizeof(SearchIndex));
+		report.add_slot_map(index_entry, m_terminals);
+		for (const auto& [current_level_id, current_level_terminals] : m_level_terminals)
+		{
+			report.add_hash_map(index_entry, current_level_terminals);
+		}
+		report.add_hash_map(index_entry, m_level_terminals);
+
+		// Tree nodes (the value and three pointers plus the color), the words and the posting lists
+		const qint64 node_size = sizeof(std::pair<const QString, std::vector<TerminalHandle>>) + (4 * sizeof(void*));
+		report.add_bytes(index_entry, MemoryReport::Category::CACHE, static_cast<qint64>(m_postings.size()) * node_size);
+		for (const auto& [current_word, current_postings] : m_postings)
+		{
+			report.add_string(index_entry, MemoryReport::Category::CACHE, current_word);
+			report.add_bytes(index_entry, MemoryReport::Category::CACHE, static_cast<qint64>(current_postings.capacity() * sizeof(TerminalHandle)));
+		}
+		return index_entry;
+	}
+
+	const char* SearchIndex::get_field_name(Field field)
+	{
+		return FIELD_NAMES[Utils::to_integral(field)];
+	}
+
+	void SearchIndex::remove_terminal_internal(TerminalHandle handle)
+	{
+		// The postings are left in place, lookups skip the removed terminals
+		if (const IndexedTerminal* indexed_terminal = m_terminals.get(handle))
+		{
+			m_stale_posting_count += indexed_terminal->m_word_count;
+			m_terminals.erase(handle);
+		}
+	}
+
+	void SearchIndex::compact_postings()
+	{
+		if ((m_stale_posting_count < COMPACTION_MIN_STALE_POSTINGS) || ((m_stale_posting_count * 2) < m_posting_count))
+		{
+			return;
+		}
+
+		HUX_TRACE_SCOPE("search", "compact_postings");
+		for (auto postings_it = m_postings.begin(); postings_it != m_postings.end();)
+		{
+			std::vector<TerminalHandle>& current_postings = postings_it->second;
+			current_postings.erase(std::remove_if(current_postings.begin(), current_postings.end(), [this](TerminalHandle handle) { return !m_terminals.contains(handle); }), current_postings.end());
+			postings_it = current_postings.empty() ? m_postings.erase(postings_it) : std::next(postings_it);
+		}
+
+		m_posting_count -= m_stale_posting_count;
+		m_stale_posting_count = 0;
+	}
+
+	std::vector<SearchIndex::TerminalHandle> SearchIndex::get_postings(const QString& word, bool prefix) const
+	{
+		std::vector<TerminalHandle> handles;
+		auto postings_it = prefix ? m_postings.lower_bound(word) : m_postings.find(word);
+		for (; (postings_it != m_postings.end()) && (prefix ? postings_it->first.startsWith(word) : (postings_it->first == word)); ++postings_it)
+		{
+			for (const TerminalHandle current_handle : postings_it->second)
+			{
+				if (m_terminals.contains(current_handle))
+				{
+					handles.push_back(current_handle);
+				}
+			}
+
+			if (!prefix)
+			{
+				break;
+			}
+		}
+
+		// A terminal can be in the postings of multiple words with the same prefix
+		std::sort(handles.begin(), handles.end());
+		handles.erase(std::unique(handles.begin(), handles.end()), handles.end());
+		return handles;
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <HuxQt/Scenario/Terminal.h>
+#include <HuxQt/Utils/SlotMap.h>
+
+#include <QString>
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace HuxApp
+{
+	class Level;
+	class MemoryReport;
+
+	// Inverted index over the terminal texts (names, comments and screen scripts), which can be updated one terminal at a time
+	// Query syntax: words match the start of words ("dur" finds "Durandal"), quoted text is matched as a phrase (any whitespace between its words matches, e.g line breaks), and /text/ is a regular expression
+	// Formatting tags are separate words, so tagged text (e.g "$BDurandal$b") is found like any other
+	// Regular expressions (and terms without any word characters) cannot use the index, so they fall back to scanning the terminals
+	// The index keeps a copy of each terminal to verify and locate the matches (only shares the data with the scenario, so it costs nothing extra)
+	class SearchIndex
+	{
+	public:
+		enum class Field
+		{
+			TERMINAL_NAME,
+			TERMINAL_COMMENTS,
+			SCREEN_SCRIPT,
+			SCREEN_COMMENTS,
+			FIELD_COUNT
+		};
+
+		struct Hit
+		{
+			TerminalID m_terminal_id;
+			Field m_field = Field::TERMINAL_NAME;
+			Terminal::BranchType m_branch = Terminal::BranchType::TYPE_COUNT; // Only set for the screen fields
+			int m_screen = -1;
+
+			int m_position = 0; // Match in the field text
+			int m_length = 0;
+			QString m_snippet; // Text around the match, on a single line
+		};
+
+		static constexpr int DEFAULT_MAX_HITS = 500;
+
+		void add_terminal(const TerminalID& terminal_id, const Terminal& terminal); // Replaces the terminal if it was already indexed
+		void remove_terminal(const TerminalID& terminal_id);
+
+		// Adds the terminals of a level which has no terminal IDs yet (e.g it was not loaded in the browser), the terminal IDs are the rows
+		void add_level(int level_id, const Level& level);
+		bool set_terminal_ids(int level_id, const std::vector<int>& terminal_ids); // Replaces the row keys once the level has IDs (in row order), returns false if the level is not indexed
+		void remove_level(int level_id);
+
+		void clear();
+
+		// Returns false if the query is invalid (e.g a malformed regular expression), stops after the given number of hits
+		bool search(const QString& query, std::vector<Hit>& hits, QString& error_msg, int max_hits = DEFAULT_MAX_HITS) const;
+
+		int get_terminal_count() const { return static_cast<int>(m_terminals.size()); }
+		int get_word_count() const { return static_cast<int>(m_postings.size()); }
+
+		int report_memory(MemoryReport& report, int parent = -1) const; // Returns the report entry
+
+		static const char* get_field_name(Field field);
+	private:
+		using TerminalHandle = int;
+
+		struct IndexedTerminal
+		{
+			TerminalID m_id;
+			Terminal m_terminal;
+			int m_word_count = 0; // Number of postings pointing to the terminal
+		};
+
+		void remove_terminal_internal(TerminalHandle handle);
+		void compact_postings(); // Drops the postings of removed terminals (once there are enough of them)
+
+		std::vector<TerminalHandle> get_postings(const QString& word, bool prefix) const; // Sorted, only includes indexed terminals
+
+		Utils::SlotMap<IndexedTerminal> m_terminals;
+		std::unordered_map<int, std::unordered_map<int, TerminalHandle>> m_level_terminals; // Level ID -> terminal ID -> handle
+
+		// Ordered by the word, so all the words with a given prefix are a contiguous range
+		// Handles of removed terminals are left in place until the next compaction (the slot map never reuses them)
+		std::map<QString, std::vector<TerminalHandle>> m_postings;
+		qint64 m_posting_count = 0;
+		qint64 m_stale_posting_count = 0;
+	};
+}
@@ -1,5 +1,7 @@
 #include <HuxQt/Scenario/Terminal.h>
 
+#include <utility>
+
 namespace HuxApp
 {
 	void Terminal::Screen::reset()
@@ -12,6 +14,53 @@ namespace HuxApp
 		m_comments.clear();
 	}
 
+	bool Terminal::Screen::operator==(const Screen& rhs) const
+	{
+		return (m_type == rhs.m_type)
+			&& (m_alignment == rhs.m_alignment)
+			&& (m_resource_id == rhs.m_resource_id)
+			&& (m_display_text == rhs.m_display_text)
+			&& (m_script == rhs.m_script)
+			&& (m_comments == rhs.m_comments);
+	}
+
+	Terminal::Terminal()
+		: m_data(get_empty_data())
+	{
+	}
+
+	void Terminal::set_name(const QString& name)
+	{
+		// Check first, so we don't detach for nothing
+		if (get_name() != name)
+		{
+			m_data->m_name = name;
+		}
+	}
+
+	void Terminal::set_teleport(BranchType branch, const Teleport& teleport)
+	{
+		if (std::as_const(*this).get_branch(branch).m_teleport != teleport)
+		{
+			get_branch(branch).m_teleport = teleport;
+		}
+	}
+
+	void Terminal::set_comments(const QString& comments)
+	{
+		if (get_comments() != comments)
+		{
+			m_data->m_comments = comments;
+		}
+	}
+
+	const QSharedDataPointer<Terminal::Data>& Terminal::get_empty_data()
+	{
+		// Shared by all the default constructed terminals (most of them are filled in or overwritten right away)
+		static const QSharedDataPointer<Data> empty_data(new Data());
+		return empty_data;
+	}
+
 	const char* Terminal::get_branch_type_name(BranchType type)
 	{
 		switch (type)
@@ -1,11 +1,16 @@
 #pragma once
 #include <HuxQt/Utils/Utilities.h>
 
+#include <QList>
+#include <QSharedData>
 #include <QString>
+
 #include <array>
 
 namespace HuxApp
 {
+	// Implicitly shared (copies only share the data, which is duplicated on the first modification)
+	// The screen lists are shared the same way, so modifying one branch leaves the others shared with the copies
 	class Terminal
 	{
 	public:
@@ -29,6 +34,9 @@ namespace HuxApp
 		{
 			TeleportType m_type = TeleportType::NONE;
 			int m_index = 0;
+
+			bool operator==(const Teleport& rhs) const { return (m_type == rhs.m_type) && (m_index == rhs.m_index); }
+			bool operator!=(const Teleport& rhs) const { return !(*this == rhs); }
 		};
 
 		enum class ScreenType
@@ -62,9 +70,12 @@ namespace HuxApp
 			QString m_comments;
 
 			void reset();
+
+			bool operator==(const Screen& rhs) const;
+			bool operator!=(const Screen& rhs) const { return !(*this == rhs); }
 		};
 
-		using ScreenVector = std::vector<Screen>;
+		using ScreenVector = QList<Screen>;
 
 		struct Branch
 		{
@@ -76,26 +87,41 @@ namespace HuxApp
 
 		using BranchArray = std::array<Branch, Utils::to_integral(BranchType::TYPE_COUNT)>;
 
-		const QString& get_name() const { return m_name; }
-		void set_name(const QString& name) { m_name = name; }
+		Terminal();
+
+		const QString& get_name() const { return m_data->m_name; }
+		void set_name(const QString& name);
+
+		const BranchArray& get_branches() const { return m_data->m_branches; }
+
+		const Branch& get_branch(BranchType branch) const { return m_data->m_branches[Utils::to_integral(branch)]; }
+		Branch& get_branch(BranchType branch) { return m_data->m_branches[Utils::to_integral(branch)]; } // Detaches the data (use the const version for reading)
 
-		const BranchArray& get_branches() const { return m_branches; }
+		void set_teleport(BranchType branch, const Teleport& teleport);
 
-		const Branch& get_branch(BranchType branch) const { return m_branches[Utils::to_integral(branch)]; }
-		Branch& get_branch(BranchType branch) { return const_cast<Branch&>(const_cast<const Terminal*>(this)->get_branch(branch)); }
+		const QString& get_comments() const { return m_data->m_comments; }
+		void set_comments(const QString& comments);
 
-		const QString& get_comments() const { return m_comments; }
+		bool is_shared_with(const Terminal& other) const { return (m_data == other.m_data); }
 
 		static const char* get_branch_type_name(BranchType type);
 		static QString get_screen_string(const Screen& screen_data);
 	private:
-		QString m_name;
+		struct Data : public QSharedData
+		{
+			QString m_name;
+
+			BranchArray m_branches;
+
+			QString m_comments;
+		};
 
-		BranchArray m_branches;
+		static const QSharedDataPointer<Data>& get_empty_data();
 
-		QString m_comments;
+		QSharedDataPointer<Data> m_data;
 
 		friend class ScenarioManager;
+		friend class MemoryReport;
 	};
 
 	// Utility object for model/view logic
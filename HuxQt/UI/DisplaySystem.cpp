@@ -3,6 +3,11 @@
 
 #include <HuxQt/UI/HuxQt.h>
 
+#include <HuxQt/Scenario/AOText.h>
+#include <HuxQt/Scenario/MemoryReport.h>
+#include <HuxQt/Scenario/ScenarioManager.h>
+
+#include <HuxQt/Utils/Trace.h>
 #include <HuxQt/Utils/Utilities.h>
 
 #include <QTextDocument>
@@ -10,6 +15,9 @@
 #include <QFile>
 #include <QDir>
 #include <QGraphicsItem>
+#include <QCache>
+
+#include <algorithm>
 
 namespace HuxApp
 {
@@ -20,9 +28,6 @@ namespace HuxApp
 		constexpr qreal TERMINAL_HEIGHT = 320.0;
 		constexpr qreal TERMINAL_BORDER = 18;
 
-		// Value taken from the game
-		constexpr int SCREEN_MAX_LINES = 22;
-
 		// Text rendering constants
 		// NOTE: these values are just about good enough to create WYSIWYG between the tool and Aleph One (some of the word wrapping won't be 100% there)
 		// The preview config window can be used for further tweaking
@@ -35,6 +40,14 @@ namespace HuxApp
 		constexpr qreal LINE_NUMBER_LEFT_OFFSET = 1.0;
 		constexpr qreal LINE_NUMBER_RIGHT_OFFSET = TERMINAL_BORDER - 2.0;
 
+		// Decoded PICTs kept in memory (cost is in KB)
+		constexpr int PICT_CACHE_SIZE_KB = 64 * 1024;
+
+		// Performance HUD layout
+		constexpr qreal HUD_MARGIN = 4.0;
+		constexpr qreal HUD_PADDING = 3.0;
+		constexpr int HUD_LABEL_WIDTH = 15;
+
 		constexpr const char* MISSING_RESOURCE_IMAGE = ":/HuxQt/missing.png";
 		constexpr const char* STATIC_SCREEN_IMAGE = ":/HuxQt/static.png";
 
@@ -67,18 +80,19 @@ namespace HuxApp
 			return line_count;
 		}
 
-		int get_screen_character_limit(Terminal::ScreenType screen_type)
+		QString format_hud_time(qint64 duration_ns)
+		{
+			return (duration_ns < 0) ? QStringLiteral("-") : QStringLiteral("%1 ms").arg(duration_ns / 1000000.0, 0, 'f', 2);
+		}
+
+		QString format_hud_hit_rate(int hits, int misses)
 		{
-			switch (screen_type)
+			const int total = hits + misses;
+			if (total == 0)
 			{
-				case Terminal::ScreenType::INFORMATION:
-					return 70;
-				case Terminal::ScreenType::PICT:
-				case Terminal::ScreenType::CHECKPOINT:
-					return 43;
+				return QStringLiteral("-");
 			}
-
-			return -1;
+			return QStringLiteral("%1% (%2/%3)").arg(qRound(100.0 * hits / total)).arg(hits).arg(total);
 		}
 	}
 
@@ -90,12 +104,17 @@ namespace HuxApp
 		QGraphicsPixmapItem* m_image_item = nullptr;
 		QGraphicsTextItem* m_text_item = nullptr;
 		QGraphicsTextItem* m_line_numbers = nullptr;
+
+		QGraphicsRectItem* m_hud_background = nullptr;
+		QGraphicsSimpleTextItem* m_hud_text = nullptr;
+		RefreshStats m_refresh_stats;
 	};
 
 	struct DisplaySystem::Internal
 	{
 		Internal()
 			: m_font("Courier")
+			, m_decoded_pict_cache(PICT_CACHE_SIZE_KB)
 		{
 			// Set the configurations for each scene
 			m_font.setPointSizeF(10.f);
@@ -141,7 +160,7 @@ namespace HuxApp
 			// Set the line number item
 			{
 				QStringList line_number_list;
-				for (int current_line_number = 1; current_line_number <= SCREEN_MAX_LINES; ++current_line_number)
+				for (int current_line_number = 1; current_line_number <= AOText::SCREEN_MAX_LINES; ++current_line_number)
 				{
 					line_number_list << QString::number(current_line_number);
 				}
@@ -158,17 +177,40 @@ namespace HuxApp
 
 				view_data.m_line_numbers->setVisible(false);
 			}
+
+			// Set the performance HUD (drawn over everything else)
+			{
+				view_data.m_hud_background = view_data.m_scene.addRect(QRectF(), Qt::NoPen, QBrush(QColor(0, 0, 0, 200)));
+				view_data.m_hud_background->setZValue(4);
+				view_data.m_hud_background->setVisible(false);
+
+				QFont hud_font("Courier");
+				hud_font.setStyleHint(QFont::Monospace);
+				hud_font.setPointSizeF(7.f);
+
+				view_data.m_hud_text = view_data.m_scene.addSimpleText(QString(), hud_font);
+				view_data.m_hud_text->setBrush(QBrush(Qt::white));
+				view_data.m_hud_text->setZValue(5);
+				view_data.m_hud_text->setVisible(false);
+			}
 		}
 
-		QPixmap get_pict(int pict_id) const
+		QPixmap get_pict(int pict_id, qint64& decode_ns)
 		{
-			if (m_pict_path_cache.contains(pict_id))
+			if (const QPixmap* cached_pict = m_decoded_pict_cache.object(pict_id))
 			{
-				const QString& pict_path = m_pict_path_cache[pict_id];
-				return QPixmap(pict_path);
+				++m_cache_stats.m_pict_hits;
+				return *cached_pict;
 			}
+			++m_cache_stats.m_pict_misses;
+
+			HUX_TRACE_SCOPE_TIMED("display", "decode_pict", decode_ns);
+			QPixmap* decoded_pict = new QPixmap(m_pict_path_cache.contains(pict_id) ? m_pict_path_cache[pict_id] : QString(MISSING_RESOURCE_IMAGE));
+			const QPixmap pict = *decoded_pict;
 
-			return QPixmap(MISSING_RESOURCE_IMAGE);
+			const int cost_kb = std::max(1, static_cast<int>((qint64(pict.width()) * pict.height() * pict.depth()) / (8 * 1024)));
+			m_decoded_pict_cache.insert(pict_id, decoded_pict, cost_kb);
+			return pict;
 		}
 
 		void apply_display_config(const DisplayConfig& config)
@@ -203,6 +245,8 @@ namespace HuxApp
 
 		// Cache for PICT resources used in terminals
 		QMap<int, QString> m_pict_path_cache;
+		QCache<int, QPixmap> m_decoded_pict_cache;
+		CacheStats m_cache_stats;
 		
 		// Store data per-view
 		std::unordered_map<int, ViewData> m_view_data_lookup;
@@ -259,6 +303,8 @@ namespace HuxApp
 	{
 		// Clear the pict cache
 		m_internal->m_pict_path_cache.clear();
+		m_internal->m_decoded_pict_cache.clear();
+		m_internal->m_cache_stats = CacheStats();
 
 		for (auto& current_view_pair : m_internal->m_view_data_lookup)
 		{
@@ -270,44 +316,49 @@ namespace HuxApp
 		}
 
 		// Go through the "PICT" directory
-		const QDir resource_dir(resource_path + "/PICT");
-		assert(resource_dir.exists());
-
-		const QFileInfoList pict_file_list = resource_dir.entryInfoList(QDir::Files);
-		for (const QFileInfo& current_pict_file : pict_file_list)
-		{
-			if (!current_pict_file.isFile())
-			{
-				continue;
-			}
-
-			// Add the pict path to the cache
-			const QString pict_path = current_pict_file.filePath();
-			const int pict_id = current_pict_file.baseName().toInt();
-
-			m_internal->m_pict_path_cache.insert(pict_id, pict_path);
-		}
+		assert(QDir(resource_path + "/PICT").exists());
+		m_internal->m_pict_path_cache = ScenarioManager::find_pict_resources(resource_path);
 	}
 
-	int DisplaySystem::update_display(const ViewID& view_id, const DisplayData& data)
+	int DisplaySystem::update_display(const ViewID& view_id, const DisplayData& data, qint64 ao_conversion_ns)
 	{
 		auto view_it = m_internal->m_view_data_lookup.find(view_id.get_id());
 		assert(view_it != m_internal->m_view_data_lookup.end());
 		ViewData& selected_view = view_it->second;
 
-		if (data != selected_view.m_display_data)
+		RefreshStats& refresh_stats = selected_view.m_refresh_stats;
+		refresh_stats = RefreshStats();
+		refresh_stats.m_ao_conversion_ns = ao_conversion_ns;
+
+		int line_count = 0;
+		qint64 total_ns = 0;
 		{
-			// Update the display contents
-			update_image(selected_view, data);
-			update_text(selected_view, data);
+			HUX_TRACE_SCOPE_TIMED("display", "update_display", total_ns);
+			if (data != selected_view.m_display_data)
+			{
+				// Update the display contents
+				update_image(selected_view, data);
+				update_text(selected_view, data);
+
+				// Update the screen type and alignment
+				selected_view.m_display_data.m_screen_type = data.m_screen_type;
+				selected_view.m_display_data.m_alignment = data.m_alignment;
+			}
 
-			// Update the screen type and alignment
-			selected_view.m_display_data.m_screen_type = data.m_screen_type;
-			selected_view.m_display_data.m_alignment = data.m_alignment;
+			// Count how many lines the current text contains (the document is laid out at this point)
+			qint64 line_count_ns = 0;
+			{
+				HUX_TRACE_SCOPE_TIMED("display", "layout_text", line_count_ns);
+				line_count = get_text_document_line_count(selected_view.m_text_item->document());
+			}
+			refresh_stats.m_text_layout_ns = std::max<qint64>(refresh_stats.m_text_layout_ns, 0) + line_count_ns;
 		}
 
-		// Return how many lines the current text contains
-		return get_text_document_line_count(selected_view.m_text_item->document());
+		// Whatever remains was spent on updating the scene items
+		refresh_stats.m_scene_update_ns = std::max<qint64>(total_ns - refresh_stats.m_text_layout_ns - std::max<qint64>(refresh_stats.m_pict_decode_ns, 0), 0);
+		update_hud(selected_view);
+
+		return line_count;
 	}
 
 	void DisplaySystem::clear_display(const ViewID& view_id)
@@ -319,6 +370,8 @@ namespace HuxApp
 		ViewData& selected_view = view_it->second;
 		selected_view.m_image_item->setVisible(false);
 		selected_view.m_text_item->setVisible(false);
+		selected_view.m_hud_background->setVisible(false);
+		selected_view.m_hud_text->setVisible(false);
 	}
 
 	const DisplaySystem::DisplayConfig& DisplaySystem::get_display_config() const { return m_internal->m_display_config; }
@@ -331,14 +384,53 @@ namespace HuxApp
 		{
 			ViewData& current_view_data = current_view_pair.second;
 			update_text(current_view_data, current_view_data.m_display_data);
+			if (current_view_data.m_text_item->isVisible() || current_view_data.m_image_item->isVisible())
+			{
+				update_hud(current_view_data);
+			}
 		}
 	}
 
 	const QMap<int, QString>& DisplaySystem::get_pict_cache() const { return m_internal->m_pict_path_cache; }
 
+	DisplaySystem::RefreshStats DisplaySystem::get_refresh_stats(const ViewID& view_id) const
+	{
+		auto view_it = m_internal->m_view_data_lookup.find(view_id.get_id());
+		return (view_it != m_internal->m_view_data_lookup.end()) ? view_it->second.m_refresh_stats : RefreshStats();
+	}
+
+	const DisplaySystem::CacheStats& DisplaySystem::get_cache_stats() const { return m_internal->m_cache_stats; }
+
+	int DisplaySystem::report_memory(MemoryReport& report, int parent) const
+	{
+		const int display_entry = report.add_entry(QStringLiteral("Display system"), parent);
+		report.add_bytes(display_entry, MemoryReport::Category::STRUCTURE, sizeof(Internal));
+
+		// Views (the scene items are not included)
+		const int view_entry = report.add_entry(QStringLiteral("Preview views (%1)").arg(m_internal->m_view_data_lookup.size()), display_entry);
+		report.add_hash_map(view_entry, m_internal->m_view_data_lookup);
+		for (const auto& current_view_pair : m_internal->m_view_data_lookup)
+		{
+			report.add_string(view_entry, MemoryReport::Category::DISPLAY_TEXT, current_view_pair.second.m_display_data.m_text);
+		}
+
+		// QMap nodes store the key, the value and the tree links
+		const int path_cache_entry = report.add_entry(QStringLiteral("PICT path cache (%1 files)").arg(m_internal->m_pict_path_cache.size()), display_entry);
+		report.add_bytes(path_cache_entry, MemoryReport::Category::CACHE, m_internal->m_pict_path_cache.size() * (sizeof(int) + sizeof(QString) + (4 * sizeof(void*))));
+		for (const QString& current_path : m_internal->m_pict_path_cache)
+		{
+			report.add_string(path_cache_entry, MemoryReport::Category::CACHE, current_path);
+		}
+
+		// Cost is tracked in KB
+		const int decoded_cache_entry = report.add_entry(QStringLiteral("Decoded PICT cache (%1 images)").arg(m_internal->m_decoded_pict_cache.count()), display_entry);
+		report.add_bytes(decoded_cache_entry, MemoryReport::Category::CACHE, qint64(m_internal->m_decoded_pict_cache.totalCost()) * 1024);
+		return display_entry;
+	}
+
 	int DisplaySystem::get_page_count(int line_count)
 	{
-		return ceil(double(line_count) / double(SCREEN_MAX_LINES));
+		return ceil(double(line_count) / double(AOText::SCREEN_MAX_LINES));
 	}
 
 	DisplaySystem::DisplaySystem(AppCore& core)
@@ -348,6 +440,7 @@ namespace HuxApp
 
 	void DisplaySystem::update_image(ViewData& view, const DisplayData& data)
 	{
+		HUX_TRACE_SCOPE("display", "update_image");
 		switch (data.m_screen_type)
 		{
 		case Terminal::ScreenType::NONE:
@@ -371,7 +464,7 @@ namespace HuxApp
 		if ((data.m_resource_id != view.m_display_data.m_resource_id) || (data.m_resource_id == -1))
 		{
 			// Load the new resource (code is only reachable when the screen has an image)
-			view.m_image_item->setPixmap(m_internal->get_pict(data.m_resource_id));
+			view.m_image_item->setPixmap(m_internal->get_pict(data.m_resource_id, view.m_refresh_stats.m_pict_decode_ns));
 			view.m_display_data.m_resource_id = data.m_resource_id;
 		}
 
@@ -411,6 +504,7 @@ namespace HuxApp
 
 	void DisplaySystem::update_text(ViewData& view, const DisplayData& data)
 	{
+		HUX_TRACE_SCOPE("display", "update_text");
 		switch (data.m_screen_type)
 		{
 		case Terminal::ScreenType::PICT:
@@ -440,9 +534,18 @@ namespace HuxApp
 			break;
 		}
 
-		// Use HTML to handle formatting
-		view.m_display_data.m_text = data.m_text;
-		view.m_text_item->setHtml(view.m_display_data.m_text);
+		// Use HTML to handle formatting (only reset the document if the text changed, otherwise the current layout can be kept)
+		if (data.m_text != view.m_display_data.m_text)
+		{
+			++m_internal->m_cache_stats.m_text_misses;
+			HUX_TRACE_SCOPE_TIMED("display", "set_html", view.m_refresh_stats.m_text_layout_ns);
+			view.m_display_data.m_text = data.m_text;
+			view.m_text_item->setHtml(view.m_display_data.m_text);
+		}
+		else
+		{
+			++m_internal->m_cache_stats.m_text_hits;
+		}
 
 		// Set alignment
 		{
@@ -519,4 +622,33 @@ namespace HuxApp
 		m_internal->update_line_spacing(view.m_text_item);
 		m_internal->update_line_spacing(view.m_line_numbers);
 	}
+
+	void DisplaySystem::update_hud(ViewData& view)
+	{
+		const bool show_hud = m_internal->m_display_config.m_show_performance_hud;
+		view.m_hud_background->setVisible(show_hud);
+		view.m_hud_text->setVisible(show_hud);
+		if (!show_hud)
+		{
+			return;
+		}
+
+		const RefreshStats& refresh_stats = view.m_refresh_stats;
+		const CacheStats& cache_stats = m_internal->m_cache_stats;
+
+		QStringList hud_lines;
+		hud_lines << QStringLiteral("%1%2").arg(QStringLiteral("AO conversion:"), -HUD_LABEL_WIDTH).arg(format_hud_time(refresh_stats.m_ao_conversion_ns));
+		hud_lines << QStringLiteral("%1%2").arg(QStringLiteral("Text layout:"), -HUD_LABEL_WIDTH).arg(format_hud_time(refresh_stats.m_text_layout_ns));
+		hud_lines << QStringLiteral("%1%2").arg(QStringLiteral("PICT decode:"), -HUD_LABEL_WIDTH).arg(format_hud_time(refresh_stats.m_pict_decode_ns));
+		hud_lines << QStringLiteral("%1%2").arg(QStringLiteral("Scene update:"), -HUD_LABEL_WIDTH).arg(format_hud_time(refresh_stats.m_scene_update_ns));
+		hud_lines << QStringLiteral("%1%2").arg(QStringLiteral("PICT cache:"), -HUD_LABEL_WIDTH).arg(format_hud_hit_rate(cache_stats.m_pict_hits, cache_stats.m_pict_misses));
+		hud_lines << QStringLiteral("%1%2").arg(QStringLiteral("Text cache:"), -HUD_LABEL_WIDTH).arg(format_hud_hit_rate(cache_stats.m_text_hits, cache_stats.m_text_misses));
+		view.m_hud_text->setText(hud_lines.join('\n'));
+
+		// Keep the HUD in the top right corner, below the border
+		const QRectF text_rect = view.m_hud_text->boundingRect();
+		const QPointF text_position(TERMINAL_WIDTH - text_rect.width() - HUD_MARGIN - HUD_PADDING, TERMINAL_BORDER + HUD_MARGIN + HUD_PADDING);
+		view.m_hud_text->setPos(text_position);
+		view.m_hud_background->setRect(QRectF(text_position, text_rect.size()).adjusted(-HUD_PADDING, -HUD_PADDING, HUD_PADDING, HUD_PADDING));
+	}
 }
\ No newline at end of file
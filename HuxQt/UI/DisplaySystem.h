@@ -6,6 +6,7 @@ namespace HuxApp
 {
 	class AppCore;
 	class HuxQt;
+	class MemoryReport;
 	struct DisplayData;
 
 	class DisplaySystem
@@ -30,6 +31,25 @@ namespace HuxApp
 			qreal m_horizontal_margin = 0;
 			qreal m_vertical_margin = 0;
 			bool m_show_line_numbers = true;
+			bool m_show_performance_hud = false;
+		};
+
+		// Timings of the last refresh of a view (in nanoseconds, -1 if the step was skipped or cached)
+		struct RefreshStats
+		{
+			qint64 m_ao_conversion_ns = -1;
+			qint64 m_text_layout_ns = -1;
+			qint64 m_pict_decode_ns = -1;
+			qint64 m_scene_update_ns = -1;
+		};
+
+		// Counted since the resources were last updated
+		struct CacheStats
+		{
+			int m_pict_hits = 0;
+			int m_pict_misses = 0;
+			int m_text_hits = 0; // Refreshes that could keep the current text layout
+			int m_text_misses = 0;
 		};
 
 		~DisplaySystem();
@@ -38,7 +58,7 @@ namespace HuxApp
 		void release_graphics_view(const ViewID& view_id, QGraphicsView* graphics_view);
 
 		void update_resources(const QString& resource_path);
-		int update_display(const ViewID& view_id, const DisplayData& data);
+		int update_display(const ViewID& view_id, const DisplayData& data, qint64 ao_conversion_ns = -1); // Conversion time is only used for the stats
 		void clear_display(const ViewID& view_id);
 
 		const DisplayConfig& get_display_config() const;
@@ -46,6 +66,11 @@ namespace HuxApp
 
 		const QMap<int, QString>& get_pict_cache() const;
 
+		RefreshStats get_refresh_stats(const ViewID& view_id) const;
+		const CacheStats& get_cache_stats() const;
+
+		int report_memory(MemoryReport& report, int parent = -1) const; // Returns the report entry
+
 		static int get_page_count(int line_count);
 	private:
 		struct ViewData;
@@ -53,6 +78,7 @@ namespace HuxApp
 		DisplaySystem(AppCore& core);
 		void update_image(ViewData& view, const DisplayData& data);
 		void update_text(ViewData& view, const DisplayData& data);
+		void update_hud(ViewData& view);
 
 		struct Internal;
 		std::unique_ptr<Internal> m_internal;
@@ -29,10 +29,10 @@ namespace HuxApp
 		m_ui.dialog_button_box->button(QDialogButtonBox::StandardButton::Ok)->setEnabled(false);
 
 		const ScenarioManager& scenario_manager = m_core.get_scenario_manager();
-		const ScenarioManager::TextColorArray& text_colors = scenario_manager.get_text_colors();
+		const std::shared_ptr<const ScenarioManager::TextColorArray> text_colors = scenario_manager.get_text_colors();
 
 		int current_color_index = 0;
-		for (const QColor& current_text_color : text_colors)
+		for (const QColor& current_text_color : *text_colors)
 		{
 			QListWidgetItem* current_color_item = new QListWidgetItem(m_ui.color_list);
 			current_color_item->setText(QStringLiteral("C%1").arg(current_color_index));
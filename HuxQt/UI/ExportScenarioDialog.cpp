@@ -2,28 +2,142 @@
 
 #include <HuxQt/Scenario/Scenario.h>
 
+#include <HuxQt/Utils/Utilities.h>
+#include <HuxQt/Utils/LineDiff.h>
+
 #include <QFileDialog>
+#include <QBuffer>
+#include <QtConcurrent>
+
+#include <numeric>
 
 namespace HuxApp
 {
-	ExportScenarioDialog::ExportScenarioDialog(QWidget* parent, const QString& init_path, const QStringList& level_output_list)
+	namespace
+	{
+		constexpr int DIFF_CONTEXT_LINES = 3;
+
+		constexpr const char* SCRIPT_STATUS_LABELS[] = {
+			"unchanged",
+			"modified",
+			"new",
+			"invalid"
+		};
+
+		QString print_script_diff(const QString& old_text, const QString& new_text)
+		{
+			// Diff the lines via their hashes
+			const QStringList old_lines = old_text.split('\n');
+			const QStringList new_lines = new_text.split('\n');
+
+			auto hash_lines = [](const QStringList& lines)
+				{
+					std::vector<size_t> line_hashes;
+					line_hashes.reserve(lines.size());
+					for (const QString& current_line : lines)
+					{
+						line_hashes.push_back(qHash(current_line));
+					}
+					return line_hashes;
+				};
+
+			const std::vector<Utils::LineDiffEdit> edits = Utils::compute_line_diff(hash_lines(old_lines), hash_lines(new_lines));
+			const int edit_count = static_cast<int>(edits.size());
+
+			// Line numbers at each edit (so we can print the hunk headers)
+			std::vector<int> old_line_numbers(edit_count + 1, 0);
+			std::vector<int> new_line_numbers(edit_count + 1, 0);
+			for (int edit_index = 0; edit_index < edit_count; ++edit_index)
+			{
+				const Utils::LineDiffEdit::Type edit_type = edits[edit_index].m_type;
+				old_line_numbers[edit_index + 1] = old_line_numbers[edit_index] + ((edit_type != Utils::LineDiffEdit::Type::INSERT) ? 1 : 0);
+				new_line_numbers[edit_index + 1] = new_line_numbers[edit_index] + ((edit_type != Utils::LineDiffEdit::Type::REMOVE) ? 1 : 0);
+			}
+
+			// Print the changes in hunks (with some unchanged lines around them for context)
+			QString diff_text;
+			int edit_index = 0;
+			while (edit_index < edit_count)
+			{
+				while ((edit_index < edit_count) && (edits[edit_index].m_type == Utils::LineDiffEdit::Type::EQUAL))
+				{
+					++edit_index;
+				}
+
+				if (edit_index >= edit_count)
+				{
+					break;
+				}
+
+				// Extend the hunk until there is a long enough run of unchanged lines
+				const int hunk_start = std::max(0, edit_index - DIFF_CONTEXT_LINES);
+				int hunk_end = edit_index;
+				int equal_run_length = 0;
+				while ((hunk_end < edit_count) && (equal_run_length <= (2 * DIFF_CONTEXT_LINES)))
+				{
+					equal_run_length = (edits[hunk_end].m_type == Utils::LineDiffEdit::Type::EQUAL) ? (equal_run_length + 1) : 0;
+					++hunk_end;
+				}
+				hunk_end -= std::max(0, equal_run_length - DIFF_CONTEXT_LINES);
+
+				diff_text += QStringLiteral("@@ -%1,%2 +%3,%4 @@\n")
+					.arg(old_line_numbers[hunk_start] + 1).arg(old_line_numbers[hunk_end] - old_line_numbers[hunk_start])
+					.arg(new_line_numbers[hunk_start] + 1).arg(new_line_numbers[hunk_end] - new_line_numbers[hunk_start]);
+
+				for (int hunk_edit_index = hunk_start; hunk_edit_index < hunk_end; ++hunk_edit_index)
+				{
+					const Utils::LineDiffEdit& current_edit = edits[hunk_edit_index];
+					switch (current_edit.m_type)
+					{
+					case Utils::LineDiffEdit::Type::EQUAL:
+						diff_text += QStringLiteral(" %1\n").arg(new_lines[current_edit.m_new_index]);
+						break;
+					case Utils::LineDiffEdit::Type::REMOVE:
+						diff_text += QStringLiteral("-%1\n").arg(old_lines[current_edit.m_old_index]);
+						break;
+					case Utils::LineDiffEdit::Type::INSERT:
+						diff_text += QStringLiteral("+%1\n").arg(new_lines[current_edit.m_new_index]);
+						break;
+					}
+				}
+				edit_index = hunk_end;
+			}
+
+			return diff_text;
+		}
+	}
+
+	ExportScenarioDialog::ExportScenarioDialog(QWidget* parent, const ScenarioManager& scenario_manager, const QString& init_path, const std::shared_ptr<const Scenario>& scenario)
 		: QDialog(parent)
 		, m_init_path(init_path)
+		, m_scenario_manager(scenario_manager)
+		, m_scenario(scenario)
 	{
 		m_ui.setupUi(this);
 		setAttribute(Qt::WA_DeleteOnClose, true);
 
-		init_ui(level_output_list);
+		init_ui();
 		connect_signals();
+
+		// Start by comparing with the scenario folder
+		set_compare_path(m_init_path);
+	}
+
+	ExportScenarioDialog::~ExportScenarioDialog()
+	{
+		// Don't bother finishing the comparison (the workers keep the scenario snapshot alive until they are done)
+		m_status_watcher.cancel();
 	}
 
-	void ExportScenarioDialog::init_ui(const QStringList& level_output_list)
+	void ExportScenarioDialog::init_ui()
 	{
-		for (int level_offset = 0; level_offset < level_output_list.length(); level_offset += 2)
+		int level_index = 0;
+		for (const Level& current_level : m_scenario->get_levels())
 		{
 			QListWidgetItem* new_level_item = new QListWidgetItem(m_ui.scenario_level_list);
-			new_level_item->setText(level_output_list.at(level_offset));
-			new_level_item->setData(Qt::UserRole, level_output_list.at(level_offset + 1));
+			new_level_item->setText(current_level.get_name());
+			new_level_item->setData(Qt::UserRole, level_index);
+			++level_index;
 		}
 
 		// Initialize the splitter
@@ -37,11 +151,23 @@ namespace HuxApp
 		connect(m_ui.dialog_button_box, &QDialogButtonBox::rejected, this, &ExportScenarioDialog::reject);
 
 		connect(m_ui.scenario_level_list, &QListWidget::itemClicked, this, &ExportScenarioDialog::level_item_clicked);
+		connect(m_ui.compare_folder_button, &QPushButton::clicked, this, &ExportScenarioDialog::compare_folder_clicked);
+		connect(m_ui.show_changes_checkbox, &QCheckBox::toggled, this, 
+			[this]()
+			{
+				if (m_selected_level >= 0)
+				{
+					display_level_preview(m_selected_level);
+				}
+			}
+		);
+
+		connect(&m_status_watcher, &QFutureWatcher<ScenarioManager::ScriptStatus>::resultReadyAt, this, &ExportScenarioDialog::level_status_ready);
 	}
 
 	void ExportScenarioDialog::ok_clicked()
 	{
-		QString export_dir_path = QFileDialog::getExistingDirectory(this, tr("Select Export Folder"), m_init_path, QFileDialog::ShowDirsOnly | QFileDialog::DontResolveSymlinks);
+		QString export_dir_path = QFileDialog::getExistingDirectory(this, tr("Select Export Folder"), m_compare_path, QFileDialog::ShowDirsOnly | QFileDialog::DontResolveSymlinks);
 		if (!export_dir_path.isEmpty())
 		{
 			// Notify the main window of the selected export path
@@ -50,12 +176,227 @@ namespace HuxApp
 		}
 	}
 
+	void ExportScenarioDialog::compare_folder_clicked()
+	{
+		const QString compare_dir_path = QFileDialog::getExistingDirectory(this, tr("Select Split Folder to Compare"), m_compare_path, QFileDialog::ShowDirsOnly | QFileDialog::DontResolveSymlinks);
+		if (!compare_dir_path.isEmpty() && (compare_dir_path != m_compare_path))
+		{
+			set_compare_path(compare_dir_path);
+		}
+	}
+
 	void ExportScenarioDialog::level_item_clicked(QListWidgetItem* level_item)
 	{
+		m_selected_level = level_item->data(Qt::UserRole).toInt();
+
 		// Display the level name
-		m_ui.script_name_label->setText(level_item->text());
+		m_ui.script_name_label->setText(m_scenario->get_levels()[m_selected_level].get_name());
+
+		if ((m_generated_scripts.find(m_selected_level) != m_generated_scripts.end()) && (m_level_diffs.find(m_selected_level) != m_level_diffs.end()))
+		{
+			display_level_preview(m_selected_level);
+			return;
+		}
+
+		m_ui.script_preview->setPlainText(tr("Generating script..."));
+		generate_level_preview(m_selected_level);
+	}
+
+	void ExportScenarioDialog::set_compare_path(const QString& compare_path)
+	{
+		m_compare_path = compare_path;
+		m_ui.compare_folder_label->setText(compare_path);
+
+		// Previous comparison results are no longer valid
+		m_level_statuses.clear();
+		m_level_diffs.clear();
+
+		const int level_count = static_cast<int>(m_scenario->get_levels().size());
+		for (int level_index = 0; level_index < level_count; ++level_index)
+		{
+			update_level_item(level_index);
+		}
+
+		if (m_selected_level >= 0)
+		{
+			m_ui.script_preview->setPlainText(tr("Generating script..."));
+			generate_level_preview(m_selected_level);
+		}
+
+		// Check all the levels in the background (only compares hashes, so unchanged levels are quick to process)
+		m_status_watcher.cancel();
+
+		std::vector<int> level_indices(level_count);
+		std::iota(level_indices.begin(), level_indices.end(), 0);
+		m_status_watcher.setFuture(QtConcurrent::mapped(std::move(level_indices),
+			[&scenario_manager = m_scenario_manager, scenario = m_scenario, compare_path](int level_index)
+			{
+				return scenario_manager.get_level_script_status(compare_path, scenario->get_levels()[level_index]);
+			}
+		));
+	}
+
+	void ExportScenarioDialog::level_status_ready(int level_index)
+	{
+		m_level_statuses[level_index] = m_status_watcher.resultAt(level_index);
+		update_level_item(level_index);
+	}
+
+	void ExportScenarioDialog::update_level_item(int level_index)
+	{
+		QListWidgetItem* level_item = m_ui.scenario_level_list->item(level_index);
+		const QString& level_name = m_scenario->get_levels()[level_index].get_name();
+
+		auto status_it = m_level_statuses.find(level_index);
+		if (status_it != m_level_statuses.end())
+		{
+			level_item->setText(QStringLiteral("%1 (%2)").arg(level_name, QLatin1String(SCRIPT_STATUS_LABELS[Utils::to_integral(status_it->second)])));
+		}
+		else
+		{
+			level_item->setText(level_name);
+		}
+	}
+
+	void ExportScenarioDialog::generate_level_preview(int level_index)
+	{
+		if (m_pending_levels.contains(level_index))
+		{
+			// Already being generated
+			return;
+		}
+		m_pending_levels.insert(level_index);
+
+		// The scenario snapshot is shared with the worker, so it stays valid even if the dialog is closed in the meantime
+		QFutureWatcher<LevelPreview>* preview_watcher = new QFutureWatcher<LevelPreview>(this);
+		connect(preview_watcher, &QFutureWatcher<LevelPreview>::finished, this, 
+			[this, preview_watcher, level_index]()
+			{
+				level_preview_generated(level_index, preview_watcher->result());
+				preview_watcher->deleteLater();
+			}
+		);
+
+		// Reuse the script if we already generated it
+		auto script_it = m_generated_scripts.find(level_index);
+		const bool script_generated = (script_it != m_generated_scripts.end());
+		const QByteArray generated_script = script_generated ? script_it->second : QByteArray();
+
+		preview_watcher->setFuture(QtConcurrent::run(
+			[&scenario_manager = m_scenario_manager, scenario = m_scenario, compare_path = m_compare_path, level_index, script_generated, generated_script]()
+			{
+				const Level& level = scenario->get_levels()[level_index];
+
+				LevelPreview level_preview;
+				level_preview.m_compare_path = compare_path;
+				if (script_generated)
+				{
+					level_preview.m_script = generated_script;
+				}
+				else
+				{
+					QBuffer level_script_buffer(&level_preview.m_script);
+					level_script_buffer.open(QIODevice::WriteOnly);
 
-		// Display the script contents
-		m_ui.script_preview->setPlainText(level_item->data(Qt::UserRole).toString());
+					QString error_msg;
+					if (!scenario_manager.write_level_script(level_script_buffer, level, error_msg))
+					{
+						level_preview.m_status = ScenarioManager::ScriptStatus::INVALID;
+						level_preview.m_diff = error_msg;
+						return level_preview;
+					}
+				}
+
+				// Compare with the existing file (read in text mode, so line endings match what we would write)
+				QFile existing_level_file(ScenarioManager::get_level_script_path(compare_path, level));
+				if (!existing_level_file.open(QIODevice::ReadOnly | QIODevice::Text))
+				{
+					level_preview.m_status = ScenarioManager::ScriptStatus::NEW;
+					return level_preview;
+				}
+
+				const QByteArray existing_script = existing_level_file.readAll();
+				if (existing_script == level_preview.m_script)
+				{
+					level_preview.m_status = ScenarioManager::ScriptStatus::UNCHANGED;
+					return level_preview;
+				}
+
+				level_preview.m_status = ScenarioManager::ScriptStatus::MODIFIED;
+				level_preview.m_diff = print_script_diff(QString::fromUtf8(existing_script), QString::fromUtf8(level_preview.m_script));
+				return level_preview;
+			}
+		));
+	}
+
+	void ExportScenarioDialog::level_preview_generated(int level_index, const LevelPreview& level_preview)
+	{
+		m_pending_levels.remove(level_index);
+		if (level_preview.m_status != ScenarioManager::ScriptStatus::INVALID)
+		{
+			// Only keep valid scripts, they are reused for the export
+			m_generated_scripts[level_index] = level_preview.m_script;
+		}
+
+		if (level_preview.m_compare_path != m_compare_path)
+		{
+			// Compare folder changed in the meantime, try again (the script will be reused)
+			if (level_index == m_selected_level)
+			{
+				generate_level_preview(level_index);
+			}
+			return;
+		}
+
+		m_level_diffs[level_index] = level_preview.m_diff;
+		m_level_statuses[level_index] = level_preview.m_status;
+		update_level_item(level_index);
+
+		if (level_index == m_selected_level)
+		{
+			display_level_preview(level_index);
+		}
+	}
+
+	void ExportScenarioDialog::display_level_preview(int level_index)
+	{
+		auto script_it = m_generated_scripts.find(level_index);
+		auto diff_it = m_level_diffs.find(level_index);
+		if ((diff_it != m_level_diffs.end()) && (script_it == m_generated_scripts.end()))
+		{
+			// Preview finished without a script, i.e the level could not be loaded (the error is stored instead of the diff)
+			m_ui.script_preview->setPlainText(tr("Unable to generate the script: %1").arg(diff_it->second));
+			return;
+		}
+
+		if ((script_it == m_generated_scripts.end()) || (diff_it == m_level_diffs.end()))
+		{
+			// Still being generated
+			return;
+		}
+
+		const QString script_text = QString::fromUtf8(script_it->second);
+		if (!m_ui.show_changes_checkbox->isChecked())
+		{
+			// Display the script contents
+			m_ui.script_preview->setPlainText(script_text);
+			return;
+		}
+
+		// Display the changes compared to the split folder
+		switch (m_level_statuses.at(level_index))
+		{
+		case ScenarioManager::ScriptStatus::UNCHANGED:
+			m_ui.script_preview->setPlainText(tr("No changes compared to the script in the split folder."));
+			break;
+		case ScenarioManager::ScriptStatus::MODIFIED:
+			m_ui.script_preview->setPlainText(diff_it->second);
+			break;
+		case ScenarioManager::ScriptStatus::NEW:
+			m_ui.script_preview->setPlainText(tr("New script (not found in the split folder):\n\n%1").arg(script_text));
+			break;
+		case ScenarioManager::ScriptStatus::INVALID:
+			break;
+		}
 	}
 }
\ No newline at end of file
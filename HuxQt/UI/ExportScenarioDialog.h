@@ -1,25 +1,66 @@
 #pragma once
 #include <QDialog>
+#include <QSet>
+#include <QFutureWatcher>
 #include <ui_ExportScenarioDialog.h>
 
+#include <HuxQt/Scenario/ScenarioManager.h>
+
 namespace HuxApp
 {
+	class Scenario;
+
 	class ExportScenarioDialog : public QDialog
 	{
 		Q_OBJECT
 	public:
-		ExportScenarioDialog(QWidget* parent, const QString& init_path, const QStringList& level_output_list);
+		// Scripts are only generated (in the background) when a level is selected for preview
+		// The levels are compared to an existing split folder, so the user can see what the export will change
+		ExportScenarioDialog(QWidget* parent, const ScenarioManager& scenario_manager, const QString& init_path, const std::shared_ptr<const Scenario>& scenario);
+		~ExportScenarioDialog();
 
+		const std::shared_ptr<const Scenario>& get_scenario() const { return m_scenario; }
+		const ScenarioManager::LevelScriptCache& get_generated_scripts() const { return m_generated_scripts; } // Scripts which were already previewed (can be reused for the export)
 	signals:
 		void export_path_selected(const QString& path);
 	private:
-		void init_ui(const QStringList& level_output_list);
+		struct LevelPreview
+		{
+			QByteArray m_script;
+			QString m_compare_path;
+			ScenarioManager::ScriptStatus m_status = ScenarioManager::ScriptStatus::NEW;
+			QString m_diff; // Only set if the script was modified (or the error if the level could not be loaded)
+		};
+
+		void init_ui();
 		void connect_signals();
 
 		void ok_clicked();
+		void compare_folder_clicked();
 		void level_item_clicked(QListWidgetItem* level_item);
 
+		void set_compare_path(const QString& compare_path);
+		void level_status_ready(int level_index);
+		void update_level_item(int level_index);
+
+		void generate_level_preview(int level_index);
+		void level_preview_generated(int level_index, const LevelPreview& level_preview);
+		void display_level_preview(int level_index);
+
 		Ui::ExportScenarioDialog m_ui;
 		QString m_init_path;
+
+		const ScenarioManager& m_scenario_manager;
+		std::shared_ptr<const Scenario> m_scenario;
+
+		ScenarioManager::LevelScriptCache m_generated_scripts;
+		QSet<int> m_pending_levels;
+		int m_selected_level = -1;
+
+		// Comparison with the selected split folder (cleared if the folder is changed)
+		QString m_compare_path;
+		QFutureWatcher<ScenarioManager::ScriptStatus> m_status_watcher;
+		std::unordered_map<int, ScenarioManager::ScriptStatus> m_level_statuses;
+		std::unordered_map<int, QString> m_level_diffs;
 	};
 }
\ No newline at end of file
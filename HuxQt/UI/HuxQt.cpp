@@ -6,6 +6,10 @@
 #include <HuxQt/Scenario/ScenarioManager.h>
 #include <HuxQt/Scenario/Scenario.h>
 #include <HuxQt/Scenario/ScenarioBrowserModel.h>
+#include <HuxQt/Scenario/ScenarioJournal.h>
+#include <HuxQt/Scenario/ScenarioHistory.h>
+#include <HuxQt/Scenario/ScenarioSearch.h>
+#include <HuxQt/Scenario/MemoryReport.h>
 
 #include <HuxQt/UI/DisplaySystem.h>
 #include <HuxQt/UI/DisplayData.h>
@@ -15,13 +19,27 @@
 #include <HuxQt/UI/TerminalEditorWindow.h>
 #include <HuxQt/UI/PreviewConfigWindow.h>
 #include <HuxQt/UI/EditTextColorDialog.h>
+#include <HuxQt/UI/SearchPanel.h>
+#include <HuxQt/UI/ReferencePanel.h>
+#include <HuxQt/UI/ProblemPanel.h>
 
+#include <HuxQt/Utils/Trace.h>
 #include <HuxQt/Utils/Utilities.h>
 
 #include <unordered_set>
 
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QProgressBar>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QPlainTextEdit>
+#include <QVBoxLayout>
+#include <QFontDatabase>
+#include <QDockWidget>
+#include <QtConcurrent>
 
 namespace HuxApp
 {
@@ -49,7 +67,37 @@ namespace HuxApp
             "STATIC"
         };
 
+        constexpr int STATUS_MESSAGE_TIMEOUT = 5000;
+        constexpr int JOURNAL_FLUSH_INTERVAL = 5000;
+
         QString get_app_version_string() { return QStringLiteral("%1.%2.%3").arg(APP_VERSION_MAJOR).arg(APP_VERSION_MINOR).arg(APP_VERSION_PATCH); }
+
+        void show_diagnostics(QWidget* parent, const QString& title, const Diagnostics& diagnostics)
+        {
+            if (diagnostics.is_empty())
+            {
+                return;
+            }
+
+            // Show the first entry in the message, the full list goes in the details
+            const Diagnostics::Entry& first_entry = diagnostics.get_entries().front();
+            QMessageBox message_box(diagnostics.has_errors() ? QMessageBox::Critical : QMessageBox::Warning, title, first_entry.m_message, QMessageBox::Ok, parent);
+            if (diagnostics.get_entries().size() > 1)
+            {
+                message_box.setInformativeText(QStringLiteral("%1 problem(s) were found, see the details.").arg(diagnostics.get_entries().size()));
+                message_box.setDetailedText(diagnostics.print());
+            }
+            message_box.exec();
+        }
+
+        ScenarioManager::ProgressCallback get_promise_progress_callback(QPromise<QString>& promise)
+        {
+            return [&promise](int current, int total)
+                {
+                    promise.setProgressRange(0, total);
+                    promise.setProgressValue(current);
+                };
+        }
     }
 
     struct HuxQt::Internal
@@ -70,6 +118,39 @@ namespace HuxApp
 
         DisplaySystem::ViewID m_view_id;
 
+        // Save & export run in the background (only one at a time), the result is the error message (empty on success)
+        enum class BackgroundTask
+        {
+            NONE,
+            SAVE,
+            EXPORT
+        };
+
+        BackgroundTask m_background_task = BackgroundTask::NONE;
+        QFutureWatcher<QString> m_background_task_watcher;
+        QProgressBar* m_background_task_progress = nullptr;
+
+        QFileInfo m_save_file_info;
+        quint64 m_save_revision = 0;
+        QString m_export_path;
+        std::shared_ptr<ScenarioManager::ExportReport> m_export_report;
+
+        // Edit journal (written periodically as autosave)
+        std::unique_ptr<ScenarioJournal> m_journal;
+        QTimer m_journal_timer;
+
+        // Undo stack for the edits made since the scenario was opened
+        ScenarioHistory m_history;
+
+        // Full-text search, cross-references and validation (the indices are built when the scenario is loaded)
+        std::unique_ptr<ScenarioSearch> m_search;
+        SearchPanel* m_search_panel = nullptr;
+        QDockWidget* m_search_dock = nullptr;
+        ReferencePanel* m_reference_panel = nullptr;
+        QDockWidget* m_reference_dock = nullptr;
+        ProblemPanel* m_problem_panel = nullptr;
+        QDockWidget* m_problem_dock = nullptr;
+
         Internal()
         {
             prepare_dark_theme();
@@ -116,6 +197,25 @@ namespace HuxApp
             }
         }
 
+        void set_save_actions_enabled(bool enabled)
+        {
+            m_ui.action_save_scenario->setEnabled(enabled);
+            m_ui.action_save_scenario_as->setEnabled(enabled);
+            m_ui.action_export_scenario_scripts->setEnabled(enabled);
+        }
+
+        void start_background_task(BackgroundTask task, const QFuture<QString>& future, const QString& status_text)
+        {
+            m_background_task = task;
+            set_save_actions_enabled(false);
+
+            m_background_task_progress->setRange(0, 0);
+            m_background_task_progress->setVisible(true);
+            m_ui.status_bar->showMessage(status_text);
+
+            m_background_task_watcher.setFuture(future);
+        }
+
         TerminalEditorWindow* find_terminal_editor(const TerminalID& terminal_id) const
         {
             auto editor_it = std::find_if(m_terminal_editors.begin(), m_terminal_editors.end(),
@@ -336,11 +436,48 @@ namespace HuxApp
         // Register the graphics view in the display system
         m_internal->m_view_id = m_core->get_display_system().register_graphics_view(m_internal->m_ui.terminal_preview);
 
+        // Lazily loaded levels are deserialized the first time they are opened
+        m_internal->m_scenario_browser_model.set_level_loader([this](Level& level)
+            {
+                QString error_msg;
+                if (!m_core->get_scenario_manager().load_level(level, error_msg))
+                {
+                    QMessageBox::warning(this, "Scenario File Error", error_msg);
+                    return false;
+                }
+                return true;
+            }
+        );
+
+        // Periodically write the edit journal to disk
+        m_internal->m_journal = std::make_unique<ScenarioJournal>(m_core->get_scenario_manager());
+        m_internal->m_journal_timer.setInterval(JOURNAL_FLUSH_INTERVAL);
+        connect(&m_internal->m_journal_timer, &QTimer::timeout, this, [this]() { m_internal->m_journal->flush(); });
+        m_internal->m_journal_timer.start();
+
+        // Search index of the opened scenario
+        m_internal->m_search = std::make_unique<ScenarioSearch>(m_core->get_scenario_manager());
+        m_internal->m_search_panel->set_search(m_internal->m_search.get());
+        m_internal->m_reference_panel->set_search(m_internal->m_search.get());
+        m_internal->m_reference_panel->set_pict_files(&m_core->get_display_system().get_pict_cache());
+        m_internal->m_problem_panel->set_search(m_internal->m_search.get());
+        m_internal->m_problem_panel->set_pict_files(&m_core->get_display_system().get_pict_cache());
+
         // TODO: "load" an empty scenario as our starting point
     }
 
     HuxQt::~HuxQt()
     {
+        // Make sure no background task is still using the core
+        m_internal->m_background_task_watcher.waitForFinished();
+        m_internal->m_journal.reset();
+        m_internal->m_search_panel->set_search(nullptr);
+        m_internal->m_reference_panel->set_search(nullptr);
+        m_internal->m_reference_panel->set_pict_files(nullptr);
+        m_internal->m_problem_panel->set_search(nullptr);
+        m_internal->m_problem_panel->set_pict_files(nullptr);
+        m_internal->m_search.reset();
+
         if (m_internal->m_preview_config)
         {
             delete m_internal->m_preview_config;
@@ -390,6 +527,59 @@ namespace HuxApp
 
         // Screen browser
         m_internal->reset_screen_browser();
+
+        // Background task progress
+        m_internal->m_background_task_progress = new QProgressBar(this);
+        m_internal->m_background_task_progress->setMaximumWidth(200);
+        m_internal->m_background_task_progress->setVisible(false);
+        m_internal->m_ui.status_bar->addPermanentWidget(m_internal->m_background_task_progress);
+
+        // Tracing can be compiled out
+        m_internal->m_ui.action_record_trace->setVisible(Trace::is_available());
+
+        // Undo & redo (the actions are enabled and named based on the history)
+        m_internal->m_ui.menu_edit->addAction(m_internal->m_history.create_undo_action(this));
+        m_internal->m_ui.menu_edit->addAction(m_internal->m_history.create_redo_action(this));
+
+        // Search panel (docked below the preview, hidden until the user opens it)
+        m_internal->m_search_panel = new SearchPanel(this);
+        m_internal->m_search_dock = new QDockWidget(tr("Search"), this);
+        m_internal->m_search_dock->setObjectName("search_dock");
+        m_internal->m_search_dock->setWidget(m_internal->m_search_panel);
+        addDockWidget(Qt::BottomDockWidgetArea, m_internal->m_search_dock);
+        m_internal->m_search_dock->hide();
+
+        QAction* find_action = m_internal->m_search_dock->toggleViewAction();
+        find_action->setText(tr("Find..."));
+        find_action->setShortcut(QKeySequence::Find);
+        m_internal->m_ui.menu_edit->addSeparator();
+        m_internal->m_ui.menu_edit->addAction(find_action);
+
+        // Cross-reference panel (tabbed with the search panel)
+        m_internal->m_reference_panel = new ReferencePanel(this);
+        m_internal->m_reference_dock = new QDockWidget(tr("References"), this);
+        m_internal->m_reference_dock->setObjectName("reference_dock");
+        m_internal->m_reference_dock->setWidget(m_internal->m_reference_panel);
+        addDockWidget(Qt::BottomDockWidgetArea, m_internal->m_reference_dock);
+        tabifyDockWidget(m_internal->m_search_dock, m_internal->m_reference_dock);
+        m_internal->m_reference_dock->hide();
+
+        QAction* references_action = m_internal->m_reference_dock->toggleViewAction();
+        references_action->setText(tr("References..."));
+        m_internal->m_ui.menu_edit->addAction(references_action);
+
+        // Problem panel (also tabbed with the search panel)
+        m_internal->m_problem_panel = new ProblemPanel(this);
+        m_internal->m_problem_dock = new QDockWidget(tr("Problems"), this);
+        m_internal->m_problem_dock->setObjectName("problem_dock");
+        m_internal->m_problem_dock->setWidget(m_internal->m_problem_panel);
+        addDockWidget(Qt::BottomDockWidgetArea, m_internal->m_problem_dock);
+        tabifyDockWidget(m_internal->m_search_dock, m_internal->m_problem_dock);
+        m_internal->m_problem_dock->hide();
+
+        QAction* problems_action = m_internal->m_problem_dock->toggleViewAction();
+        problems_action->setText(tr("Problems..."));
+        m_internal->m_ui.menu_edit->addAction(problems_action);
     }
 
     void HuxQt::connect_signals()
@@ -405,6 +595,8 @@ namespace HuxApp
         connect(m_internal->m_ui.action_terminal_preview_config, &QAction::triggered, this, &HuxQt::open_preview_config);
         connect(m_internal->m_ui.action_override_text_colors, &QAction::triggered, this, &HuxQt::override_text_colors);
         connect(m_internal->m_ui.action_use_dark_theme, &QAction::triggered, this, &HuxQt::set_app_theme);
+        connect(m_internal->m_ui.action_record_trace, &QAction::triggered, this, &HuxQt::record_trace);
+        connect(m_internal->m_ui.action_memory_report, &QAction::triggered, this, &HuxQt::show_memory_report);
 
         // Scenario browser
         connect(m_internal->m_ui.scenario_browser, &ScenarioBrowserView::edit_level, this, &HuxQt::edit_level);
@@ -418,11 +610,32 @@ namespace HuxApp
         // Screen browser
         connect(m_internal->m_ui.screen_browser_tree, &QTreeWidget::currentItemChanged, this, &HuxQt::screen_item_selected);
 
+        // Search
+        connect(m_internal->m_search_panel, &SearchPanel::terminal_selected, this, &HuxQt::search_result_selected);
+        connect(m_internal->m_search_panel, &SearchPanel::terminal_opened, this, &HuxQt::terminal_opened);
+        connect(m_internal->m_reference_panel, &ReferencePanel::terminal_selected, this, &HuxQt::search_result_selected);
+        connect(m_internal->m_reference_panel, &ReferencePanel::terminal_opened, this, &HuxQt::terminal_opened);
+        connect(m_internal->m_problem_panel, &ProblemPanel::terminal_selected, this, &HuxQt::search_result_selected);
+        connect(m_internal->m_problem_panel, &ProblemPanel::terminal_opened, this, &HuxQt::terminal_opened);
+        connect(m_internal->m_search_dock, &QDockWidget::visibilityChanged, this, [this](bool visible)
+            {
+                if (visible)
+                {
+                    m_internal->m_search_panel->focus_query();
+                }
+            }
+        );
+
         // Preview buttons
         connect(m_internal->m_ui.terminal_first_button, &QPushButton::clicked, this, &HuxQt::terminal_first_clicked);
         connect(m_internal->m_ui.terminal_prev_button, &QPushButton::clicked, this, &HuxQt::terminal_prev_clicked);
         connect(m_internal->m_ui.terminal_next_button, &QPushButton::clicked, this, &HuxQt::terminal_next_clicked);
         connect(m_internal->m_ui.terminal_last_button, &QPushButton::clicked, this, &HuxQt::terminal_last_clicked);
+
+        // Background tasks
+        connect(&m_internal->m_background_task_watcher, &QFutureWatcher<QString>::finished, this, &HuxQt::background_task_finished);
+        connect(&m_internal->m_background_task_watcher, &QFutureWatcher<QString>::progressRangeChanged, m_internal->m_background_task_progress, &QProgressBar::setRange);
+        connect(&m_internal->m_background_task_watcher, &QFutureWatcher<QString>::progressValueChanged, m_internal->m_background_task_progress, &QProgressBar::setValue);
     }
 
     void HuxQt::clear_preview_display()
@@ -464,14 +677,36 @@ namespace HuxApp
             m_internal->clear_terminal_editors();
 
             Scenario loaded_scenario;
-            if (m_core->get_scenario_manager().load_scenario(scenario_file, loaded_scenario))
+            Diagnostics diagnostics;
+            const bool loaded = m_core->get_scenario_manager().load_scenario(scenario_file, loaded_scenario, diagnostics, true);
+            show_diagnostics(this, "Scenario Load Error", diagnostics);
+            if (loaded)
             {
-                // Load successful, use file path for the load function
+                // Load successful, make sure we have the images for the previews
                 QFileInfo scenario_file_info(scenario_file);
-                scenario_loaded(loaded_scenario, scenario_file_info.absolutePath());
+                if (!scenario_file_info.absoluteDir().exists("Resources"))
+                {
+                    QMessageBox::warning(this, "Scenario Warning", "No Resources folder present for this scenario file! Images will not be available for terminal previews!");
+                }
+
+                // Check if we have unsaved changes from a previous session
+                QList<int> recovered_level_rows;
+                const bool recovered = recover_journal(scenario_file_info.absoluteFilePath(), loaded_scenario, recovered_level_rows);
+
+                // Use file path for the load function
+                if (!scenario_loaded(std::move(loaded_scenario), scenario_file_info.absolutePath()))
+                {
+                    return;
+                }
 
                 // Cache the file name
                 m_internal->m_scenario_browser_model.set_file_name(scenario_file_info.fileName());
+
+                if (recovered)
+                {
+                    m_internal->m_scenario_browser_model.mark_levels_modified(recovered_level_rows);
+                }
+                start_journal(scenario_file_info.absoluteFilePath(), recovered);
             }
         }
     }
@@ -491,17 +726,17 @@ namespace HuxApp
     void HuxQt::export_scenario_scripts()
     {
         // Prepare the export dialog (allows one last check to make sure the scripts we will output are correct, also helps with debugging)
-        QStringList level_output_list;
+        // The scripts are only generated when previewed, and the export reuses them
         const ScenarioManager& scenario_manager = m_core->get_scenario_manager();
-        const Scenario exported_scenario = m_internal->m_scenario_browser_model.export_scenario();
-        for (const Level& current_level : exported_scenario.get_levels())
-        {
-            level_output_list << current_level.get_name();
-            level_output_list << scenario_manager.print_level_script(current_level);
-        }
+        const std::shared_ptr<const Scenario> exported_scenario = std::make_shared<const Scenario>(m_internal->m_scenario_browser_model.export_scenario());
 
-        ExportScenarioDialog* export_dialog = new ExportScenarioDialog(this, m_internal->m_scenario_browser_model.get_path(), level_output_list);
-        connect(export_dialog, &ExportScenarioDialog::export_path_selected, this, &HuxQt::export_scenario);
+        ExportScenarioDialog* export_dialog = new ExportScenarioDialog(this, scenario_manager, m_internal->m_scenario_browser_model.get_path(), exported_scenario);
+        connect(export_dialog, &ExportScenarioDialog::export_path_selected, this,
+            [this, export_dialog](const QString& export_path)
+            {
+                export_scenario(export_path, export_dialog->get_scenario(), export_dialog->get_generated_scripts());
+            }
+        );
         export_dialog->open();
     }
 
@@ -520,10 +755,16 @@ namespace HuxApp
             m_internal->clear_terminal_editors();
 
             Scenario loaded_scenario;
-            if (m_core->get_scenario_manager().import_scenario(scenario_dir, loaded_scenario))
+            Diagnostics diagnostics;
+            const bool imported = m_core->get_scenario_manager().import_scenario(scenario_dir, loaded_scenario, diagnostics);
+            show_diagnostics(this, "Scenario Import", diagnostics);
+            if (imported)
             {
                 // Import successful, use the split folder path for the load function
-                scenario_loaded(loaded_scenario, scenario_dir);
+                if (!scenario_loaded(std::move(loaded_scenario), scenario_dir))
+                {
+                    return;
+                }
 
                 // Clear file name so the user is prompted when saving
                 m_internal->m_scenario_browser_model.set_file_name(QString());
@@ -561,6 +802,70 @@ namespace HuxApp
         m_internal->set_app_theme();
     }
 
+    void HuxQt::record_trace(bool checked)
+    {
+        if (checked)
+        {
+            // Start a new recording
+            Trace::clear();
+            Trace::set_enabled(true);
+            m_internal->m_ui.status_bar->showMessage(tr("Recording performance trace..."), STATUS_MESSAGE_TIMEOUT);
+            return;
+        }
+
+        Trace::set_enabled(false);
+
+        const QString& current_scenario_path = m_internal->m_scenario_browser_model.get_path();
+        const QString init_path = current_scenario_path.isEmpty() ? QStringLiteral("/home/hux_trace.json") : (current_scenario_path + "/hux_trace.json");
+        const QString selected_file_path = QFileDialog::getSaveFileName(this, tr("Save Performance Trace"), init_path, "Chrome Trace (*.json)");
+        if (selected_file_path.isEmpty())
+        {
+            return;
+        }
+
+        QString error_msg;
+        if (Trace::write_chrome_trace(selected_file_path, error_msg))
+        {
+            m_internal->m_ui.status_bar->showMessage(tr("Performance trace saved to \"%1\"").arg(selected_file_path), STATUS_MESSAGE_TIMEOUT);
+        }
+        else
+        {
+            QMessageBox::warning(this, tr("Save Performance Trace"), error_msg);
+        }
+    }
+
+    void HuxQt::show_memory_report()
+    {
+        MemoryReport report;
+        m_internal->m_scenario_browser_model.report_memory(report);
+        m_internal->m_history.report_memory(report);
+        m_internal->m_search->report_memory(report);
+        m_core->get_scenario_manager().report_memory(report);
+        m_core->get_display_system().report_memory(report);
+
+        // Same snapshot as the one taken for saving and exporting (only the data it does not share with the models counts towards it)
+        report.add_scenario(m_internal->m_scenario_browser_model.export_scenario(), QStringLiteral("Save/export snapshot (temporary)"));
+
+        QDialog* report_dialog = new QDialog(this);
+        report_dialog->setAttribute(Qt::WA_DeleteOnClose);
+        report_dialog->setWindowTitle(tr("Memory Report"));
+        report_dialog->resize(700, 500);
+
+        QPlainTextEdit* report_text = new QPlainTextEdit(report.print(2), report_dialog);
+        report_text->setReadOnly(true);
+        report_text->setLineWrapMode(QPlainTextEdit::NoWrap);
+        report_text->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+        QDialogButtonBox* button_box = new QDialogButtonBox(QDialogButtonBox::Close, report_dialog);
+        connect(button_box, &QDialogButtonBox::rejected, report_dialog, &QDialog::reject);
+
+        QVBoxLayout* dialog_layout = new QVBoxLayout(report_dialog);
+        dialog_layout->addWidget(report_text);
+        dialog_layout->addWidget(button_box);
+
+        report_dialog->show();
+    }
+
     void HuxQt::edit_level(int level_id)
     {
         const LevelInfo level_info = m_internal->m_scenario_browser_model.get_level_info(level_id);
@@ -591,6 +896,7 @@ namespace HuxApp
 
     void HuxQt::terminal_selected(int level_id, int terminal_id)
     {
+        HUX_TRACE_SCOPE("ui", "terminal_selected");
         TerminalID selected_terminal_id{ level_id, terminal_id };
         if (m_internal->m_selected_terminal != selected_terminal_id)
         {
@@ -616,6 +922,20 @@ namespace HuxApp
         }
     }
 
+    void HuxQt::search_result_selected(int level_id, int terminal_id, Terminal::BranchType branch, int screen)
+    {
+        terminal_selected(level_id, terminal_id);
+
+        // Jump to the screen of the hit (if any)
+        if ((branch != Terminal::BranchType::TYPE_COUNT) && (screen >= 0))
+        {
+            if (QTreeWidgetItem* branch_item = m_internal->m_ui.screen_browser_tree->topLevelItem(Utils::to_integral(branch)))
+            {
+                m_internal->set_current_screen(branch_item->child(screen));
+            }
+        }
+    }
+
     void HuxQt::terminal_opened(int level_id, int terminal_id)
     {
         // First check if we already have an editor open for this item
@@ -770,6 +1090,9 @@ namespace HuxApp
 
     bool HuxQt::close_current_scenario()
     {
+        // Let any pending save finish first (may clear the modified state)
+        wait_for_background_task();
+
         if (!m_internal->save_terminal_editors())
         {
             return false;
@@ -783,18 +1106,29 @@ namespace HuxApp
             switch (user_response)
             {
             case QMessageBox::Yes:
-                return save_scenario(m_internal->m_scenario_browser_model.get_file_name());
+                if (!save_scenario(m_internal->m_scenario_browser_model.get_file_name(), false))
+                {
+                    return false;
+                }
+                break;
             case QMessageBox::No:
-                return true;
+                break;
             case QMessageBox::Cancel:
                 return false;
             }
         }
 
+        // Scenario is closed, the journal, the history and the search indices are no longer needed
+        m_internal->m_journal->stop(true);
+        m_internal->m_history.stop();
+        m_internal->m_search->stop();
+        m_internal->m_search_panel->clear();
+        m_internal->m_reference_panel->clear();
+        m_internal->m_problem_panel->clear();
         return true;
     }
 
-    bool HuxQt::save_scenario(const QString& file_name)
+    bool HuxQt::save_scenario(const QString& file_name, bool background)
     {
         // Check if there is a selected save file (if not, prompt user)
         const QString& current_scenario_path = m_internal->m_scenario_browser_model.get_path();
@@ -815,44 +1149,231 @@ namespace HuxApp
             }
         }
 
-        ScenarioManager& scenario_manager = m_core->get_scenario_manager();
-        const Scenario exported_scenario = m_internal->m_scenario_browser_model.export_scenario();
-        if (!scenario_manager.save_scenario(file_info.absoluteFilePath(), exported_scenario))
+        // Snapshot the scenario, so the user can keep editing while it is being saved
+        Scenario exported_scenario = m_internal->m_scenario_browser_model.export_scenario();
+        const quint64 saved_revision = m_internal->m_scenario_browser_model.get_revision();
+
+        if (!background)
+        {
+            wait_for_background_task();
+
+            ScenarioManager& scenario_manager = m_core->get_scenario_manager();
+            Diagnostics diagnostics;
+            if (!scenario_manager.save_scenario(file_info.absoluteFilePath(), exported_scenario, diagnostics))
+            {
+                show_diagnostics(this, "File I/O Error", diagnostics);
+                return false;
+            }
+
+            scenario_save_completed(file_info, saved_revision);
+            return true;
+        }
+
+        if (m_internal->m_background_task != Internal::BackgroundTask::NONE)
         {
+            // Should not happen (actions are disabled while a task is running)
             return false;
         }
 
+        m_internal->m_save_file_info = file_info;
+        m_internal->m_save_revision = saved_revision;
+
+        const ScenarioManager& scenario_manager = m_core->get_scenario_manager();
+        QFuture<QString> save_future = QtConcurrent::run(
+            [&scenario_manager, file_path = file_info.absoluteFilePath(), exported_scenario = std::move(exported_scenario)](QPromise<QString>& promise)
+            {
+                // Nothing is written if a level could not be serialized (the previous file stays intact)
+                QString error_msg;
+                QByteArray scenario_data;
+                if (scenario_manager.serialize_scenario(exported_scenario, scenario_data, error_msg, get_promise_progress_callback(promise)))
+                {
+                    scenario_manager.write_scenario_file(file_path, scenario_data, error_msg);
+                }
+                promise.addResult(error_msg);
+            }
+        );
+
+        m_internal->start_background_task(Internal::BackgroundTask::SAVE, save_future, tr("Saving scenario..."));
+        return true;
+    }
+
+    bool HuxQt::export_scenario(const QString& export_path, const std::shared_ptr<const Scenario>& exported_scenario, const ScenarioManager::LevelScriptCache& script_cache)
+    {
+        if (m_internal->m_background_task != Internal::BackgroundTask::NONE)
+        {
+            QMessageBox::warning(this, "Export Error", "Cannot export while another save or export is in progress!");
+            return false;
+        }
+
+        m_internal->m_export_path = export_path;
+        m_internal->m_export_report = std::make_shared<ScenarioManager::ExportReport>();
+
+        const ScenarioManager& scenario_manager = m_core->get_scenario_manager();
+        QFuture<QString> export_future = QtConcurrent::run(
+            [&scenario_manager, export_path, export_report = m_internal->m_export_report, exported_scenario, script_cache](QPromise<QString>& promise)
+            {
+                // Level failures are listed in the report (shown once the export is finished)
+                scenario_manager.write_scenario_scripts(export_path, *exported_scenario, *export_report, get_promise_progress_callback(promise), script_cache);
+                promise.addResult(QString());
+            }
+        );
+
+        m_internal->start_background_task(Internal::BackgroundTask::EXPORT, export_future, tr("Exporting scenario scripts..."));
+        return true;
+    }
+
+    void HuxQt::scenario_save_completed(const QFileInfo& file_info, quint64 saved_revision)
+    {
         // Save successful, cache the file location and overwrite the name
         m_internal->m_scenario_browser_model.set_name(file_info.baseName());
         m_internal->m_scenario_browser_model.set_path(file_info.absoluteDir().absolutePath());
         m_internal->m_scenario_browser_model.set_file_name(file_info.fileName());
 
+        // The saved file is the new base for the journal (if the scenario was edited while saving, the new journal starts with a snapshot to keep the edits)
+        const bool edited_while_saving = (m_internal->m_scenario_browser_model.get_revision() != saved_revision);
+        if (m_internal->m_journal->is_active())
+        {
+            QString error_msg;
+            if (!m_internal->m_journal->rebase(file_info.absoluteFilePath(), edited_while_saving, error_msg))
+            {
+                QMessageBox::warning(this, "Autosave Error", QStringLiteral("Unable to update the journal of unsaved changes, the previous one was kept: %1").arg(error_msg));
+            }
+        }
+        else
+        {
+            start_journal(file_info.absoluteFilePath(), false);
+            if (edited_while_saving && m_internal->m_journal->is_active() && !m_internal->m_journal->compact())
+            {
+                QMessageBox::warning(this, "Autosave Error", "Unable to record the changes made while saving in the journal!");
+            }
+        }
+
+        if (edited_while_saving)
+        {
+            // Scenario was edited while saving, the saved file is already out of date
+            update_title(QStringLiteral("%1 (Modified)").arg(m_internal->m_scenario_browser_model.get_name()));
+            return;
+        }
+
         // Clear all the UI modifications
         m_internal->m_scenario_browser_model.clear_modified();
         m_internal->m_scenario_modified = false;
         
         update_title(m_internal->m_scenario_browser_model.get_name());
-        return true;
     }
 
-    bool HuxQt::export_scenario(const QString& export_path)
+    void HuxQt::background_task_finished()
+    {
+        // Check if the task was already handled (i.e we had to wait for it)
+        const Internal::BackgroundTask finished_task = m_internal->m_background_task;
+        if ((finished_task == Internal::BackgroundTask::NONE) || !m_internal->m_background_task_watcher.isFinished())
+        {
+            return;
+        }
+
+        m_internal->m_background_task = Internal::BackgroundTask::NONE;
+        m_internal->m_background_task_progress->setVisible(false);
+        m_internal->set_save_actions_enabled(true);
+
+        const QFuture<QString> task_future = m_internal->m_background_task_watcher.future();
+        const QString error_msg = (task_future.resultCount() > 0) ? task_future.result() : QStringLiteral("Task was interrupted!");
+        const bool success = error_msg.isEmpty();
+        if (!success)
+        {
+            m_internal->m_ui.status_bar->clearMessage();
+            QMessageBox::warning(this, "File I/O Error", error_msg);
+        }
+
+        switch (finished_task)
+        {
+        case Internal::BackgroundTask::SAVE:
+        {
+            const QString file_path = m_internal->m_save_file_info.absoluteFilePath();
+            if (success)
+            {
+                scenario_save_completed(m_internal->m_save_file_info, m_internal->m_save_revision);
+                m_internal->m_ui.status_bar->showMessage(tr("Scenario saved to \"%1\"").arg(file_path), STATUS_MESSAGE_TIMEOUT);
+            }
+            emit(scenario_saved(file_path, success));
+        }
+        break;
+        case Internal::BackgroundTask::EXPORT:
+        {
+            const std::shared_ptr<ScenarioManager::ExportReport> export_report = std::move(m_internal->m_export_report);
+            const bool export_success = success && !export_report->has_failures();
+            if (success)
+            {
+                m_internal->m_ui.status_bar->showMessage(tr("Scenario scripts exported to \"%1\": %2").arg(m_internal->m_export_path, export_report->get_summary()), STATUS_MESSAGE_TIMEOUT);
+                show_export_report(*export_report);
+            }
+            emit(scenario_exported(m_internal->m_export_path, export_success));
+        }
+        break;
+        }
+    }
+
+    void HuxQt::wait_for_background_task()
     {
-        ScenarioManager& scenario_manager = m_core->get_scenario_manager();
-        const Scenario exported_scenario = m_internal->m_scenario_browser_model.export_scenario();
-        if (!scenario_manager.export_scenario(export_path, exported_scenario))
+        if (m_internal->m_background_task != Internal::BackgroundTask::NONE)
+        {
+            m_internal->m_background_task_watcher.waitForFinished();
+            background_task_finished();
+        }
+    }
+
+    void HuxQt::show_export_report(const ScenarioManager::ExportReport& report)
+    {
+        QMessageBox* report_box = new QMessageBox(report.has_failures() ? QMessageBox::Warning : QMessageBox::Information, tr("Export Report"), 
+            tr("Exported scenario scripts to \"%1\"\n%2").arg(m_internal->m_export_path, report.get_summary()), QMessageBox::Ok, this);
+        report_box->setDetailedText(report.print());
+        report_box->setAttribute(Qt::WA_DeleteOnClose);
+        report_box->open();
+    }
+
+    bool HuxQt::recover_journal(const QString& file_path, Scenario& scenario, QList<int>& modified_level_rows)
+    {
+        if (!ScenarioJournal::has_records(file_path))
+        {
+            return false;
+        }
+
+        const QMessageBox::StandardButton user_response = QMessageBox::question(this, "Unsaved Changes", "Found unsaved changes from a previous session for this scenario. Recover them?",
+            QMessageBox::StandardButtons(QMessageBox::Yes | QMessageBox::No));
+        if (user_response != QMessageBox::Yes)
         {
             return false;
         }
 
+        QString error_msg;
+        if (!m_internal->m_journal->replay(file_path, scenario, modified_level_rows, error_msg))
+        {
+            QMessageBox::warning(this, "Recovery Error", QStringLiteral("Unable to recover changes: %1").arg(error_msg));
+            return false;
+        }
         return true;
     }
 
-    void HuxQt::scenario_loaded(const Scenario& scenario, const QString& path)
+    void HuxQt::start_journal(const QString& file_path, bool keep_records)
+    {
+        QString error_msg;
+        if (!m_internal->m_journal->start(m_internal->m_scenario_browser_model, file_path, keep_records, error_msg))
+        {
+            m_internal->m_ui.status_bar->showMessage(QStringLiteral("Autosave disabled: %1").arg(error_msg), STATUS_MESSAGE_TIMEOUT);
+        }
+    }
+
+    bool HuxQt::scenario_loaded(Scenario scenario, const QString& path)
     {
+        HUX_TRACE_SCOPE("ui", "scenario_loaded");
         // Update the model and view
         reset_ui();
 
-        m_internal->m_scenario_browser_model.load_scenario(scenario);
+        // The loaded scenario is not needed afterwards, so its contents are moved into the model
+        if (!m_internal->m_scenario_browser_model.load_scenario(std::move(scenario)))
+        {
+            QMessageBox::warning(this, "Scenario Load Error", "The scenario has too many levels to be opened!");
+            return false;
+        }
         m_internal->m_ui.scenario_browser->set_model(&m_internal->m_scenario_browser_model);
 
         // Update the UI (TODO: this can be deprecated, since we can start with an empty scenario)
@@ -867,7 +1388,14 @@ namespace HuxApp
         m_internal->m_scenario_browser_model.set_path(path);
 
         // Set the title
-        update_title(scenario.get_name());
+        update_title(m_internal->m_scenario_browser_model.get_name());
         m_internal->m_scenario_modified = false;
+
+        // Start a new history for the scenario
+        m_internal->m_history.start(m_internal->m_scenario_browser_model);
+
+        // Index the scenario in the background (search & cross-references)
+        m_internal->m_search->start(m_internal->m_scenario_browser_model);
+        return true;
     }
 }
\ No newline at end of file
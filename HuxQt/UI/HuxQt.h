@@ -1,9 +1,11 @@
 #pragma once
 #include <HuxQt/Scenario/Terminal.h>
+#include <HuxQt/Scenario/ScenarioManager.h>
 
 #include <QtWidgets/QMainWindow>
 #include <QGraphicsView>
 #include <QTreeWidgetItem>
+#include <QFileInfo>
 
 namespace HuxApp
 {
@@ -20,6 +22,9 @@ namespace HuxApp
         ~HuxQt();
 
         QGraphicsView* get_graphics_view();
+    signals:
+        void scenario_saved(const QString& file_path, bool success);
+        void scenario_exported(const QString& export_path, bool success);
     protected:
         void closeEvent(QCloseEvent* event) override;
     private:
@@ -39,6 +44,8 @@ namespace HuxApp
         void preview_config_closed();
         void override_text_colors();
         void set_app_theme();
+        void record_trace(bool checked);
+        void show_memory_report();
 
         // Scenario browser
         void edit_level(int level_id);
@@ -48,6 +55,9 @@ namespace HuxApp
         void screen_item_selected(QTreeWidgetItem* current, QTreeWidgetItem* previous);
         void scenario_modified();
 
+        // Search
+        void search_result_selected(int level_id, int terminal_id, Terminal::BranchType branch, int screen);
+
         // Terminal preview
         void display_current_screen();
         void terminal_first_clicked();
@@ -60,9 +70,15 @@ namespace HuxApp
         // Misc.
         void terminal_editor_closed(QObject* object);
         bool close_current_scenario();
-        bool save_scenario(const QString& file_name);
-        bool export_scenario(const QString& export_path);
-        void scenario_loaded(const Scenario& scenario, const QString& path);
+        bool save_scenario(const QString& file_name, bool background = true);
+        bool export_scenario(const QString& export_path, const std::shared_ptr<const Scenario>& exported_scenario, const ScenarioManager::LevelScriptCache& script_cache);
+        void scenario_save_completed(const QFileInfo& file_info, quint64 saved_revision);
+        void background_task_finished();
+        void wait_for_background_task();
+        void show_export_report(const ScenarioManager::ExportReport& report);
+        bool recover_journal(const QString& file_path, Scenario& scenario, QList<int>& modified_level_rows);
+        void start_journal(const QString& file_path, bool keep_records);
+        bool scenario_loaded(Scenario scenario, const QString& path); // Returns false if the scenario could not be opened in the browser
 
         struct Internal;
         std::unique_ptr<Internal> m_internal;
@@ -20,6 +20,7 @@ namespace HuxApp
 		m_ui.horizontal_margin_spinbox->setValue(current_config.m_horizontal_margin);
 		m_ui.vertical_margin_spinbox->setValue(current_config.m_vertical_margin);
 		m_ui.line_numbers_checkbox->setChecked(current_config.m_show_line_numbers);
+		m_ui.performance_hud_checkbox->setChecked(current_config.m_show_performance_hud);
 
 		connect(m_ui.line_spacing_spinbox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &PreviewConfigWindow::config_changed);
 		connect(m_ui.word_spacing_spinbox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &PreviewConfigWindow::config_changed);
@@ -27,6 +28,7 @@ namespace HuxApp
 		connect(m_ui.horizontal_margin_spinbox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &PreviewConfigWindow::config_changed);
 		connect(m_ui.vertical_margin_spinbox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &PreviewConfigWindow::config_changed);
 		connect(m_ui.line_numbers_checkbox, &QCheckBox::stateChanged, this, &PreviewConfigWindow::config_changed);
+		connect(m_ui.performance_hud_checkbox, &QCheckBox::stateChanged, this, &PreviewConfigWindow::config_changed);
 	}
 
 	PreviewConfigWindow::~PreviewConfigWindow()
@@ -44,6 +46,7 @@ namespace HuxApp
 		new_config.m_horizontal_margin = m_ui.horizontal_margin_spinbox->value();
 		new_config.m_vertical_margin = m_ui.vertical_margin_spinbox->value();
 		new_config.m_show_line_numbers = m_ui.line_numbers_checkbox->isChecked();
+		new_config.m_show_performance_hud = m_ui.performance_hud_checkbox->isChecked();
 
 		m_core.get_display_system().set_display_config(new_config);
 
@@ -0,0 +1,332 @@
+#include <HuxQt/UI/ProblemPanel.h>
+
+#include <HuxQt/Scenario/ScenarioSearch.h>
+
+#include <HuxQt/Utils/Trace.h>
+
+#include <QComboBox>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QHeaderView>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QStyle>
+#include <QTimer>
+
+#include <array>
+#include <tuple>
+
+namespace HuxApp
+{
+	namespace
+	{
+		// Edits come in bursts (e.g pasting terminals), so the list is only rebuilt once they settle
+		constexpr int REFRESH_DELAY = 250;
+
+		enum class ProblemColumn
+		{
+			SEVERITY,
+			LEVEL,
+			TERMINAL,
+			LOCATION,
+			PROBLEM,
+			COLUMN_COUNT
+		};
+
+		constexpr const char* PROBLEM_COLUMN_LABELS[Utils::to_integral(ProblemColumn::COLUMN_COUNT)] =
+		{
+			"Severity",
+			"Level",
+			"Terminal",
+			"Location",
+			"Problem"
+		};
+
+		// Lowest severity listed by each filter option
+		constexpr Diagnostics::Severity SEVERITY_FILTERS[] = {
+			Diagnostics::Severity::INFO,
+			Diagnostics::Severity::WARNING,
+			Diagnostics::Severity::ERROR
+		};
+
+		constexpr const char* SEVERITY_FILTER_LABELS[] = {
+			"All problems",
+			"Errors and warnings",
+			"Errors only"
+		};
+
+		QString get_location_label(const ScenarioValidator::Problem& problem)
+		{
+			if (problem.m_branch == Terminal::BranchType::TYPE_COUNT)
+			{
+				return QString();
+			}
+
+			const QLatin1String branch_name(Terminal::get_branch_type_name(problem.m_branch));
+			if (problem.m_screen >= 0)
+			{
+				return QStringLiteral("%1 / screen %2").arg(branch_name).arg(problem.m_screen);
+			}
+			return branch_name;
+		}
+
+		QStyle::StandardPixmap get_severity_icon(Diagnostics::Severity severity)
+		{
+			switch (severity)
+			{
+			case Diagnostics::Severity::ERROR:
+				return QStyle::SP_MessageBoxCritical;
+			case Diagnostics::Severity::WARNING:
+				return QStyle::SP_MessageBoxWarning;
+			}
+			return QStyle::SP_MessageBoxInformation;
+		}
+
+		// Identifies a problem across refreshes (the list is rebuilt after each edit)
+		using ProblemKey = std::tuple<int, int, Terminal::BranchType, int, ScenarioValidator::Rule>;
+
+		ProblemKey get_problem_key(const ScenarioValidator::TerminalProblem& problem)
+		{
+			return std::make_tuple(problem.m_terminal_id.m_level_id, problem.m_terminal_id.m_terminal_id, problem.m_problem.m_branch, problem.m_problem.m_screen, problem.m_problem.m_rule);
+		}
+	}
+
+	struct ProblemPanel::Internal
+	{
+		ScenarioSearch* m_search = nullptr;
+		const QMap<int, QString>* m_pict_files = nullptr;
+
+		QComboBox* m_filter_combo = nullptr;
+		QLabel* m_status_label = nullptr;
+		QTreeWidget* m_problem_tree = nullptr;
+
+		QTimer m_refresh_timer; // Hidden panels are refreshed once they are shown
+
+		std::vector<ScenarioSearch::ProblemResult> m_problems; // Items store the index of their problem
+
+		const ScenarioSearch::ProblemResult* get_problem(QTreeWidgetItem* item) const
+		{
+			if (item)
+			{
+				const int problem_index = item->data(0, Qt::UserRole).toInt();
+				if ((problem_index >= 0) && (problem_index < static_cast<int>(m_problems.size())))
+				{
+					return &m_problems[problem_index];
+				}
+			}
+			return nullptr;
+		}
+
+		void clear_list()
+		{
+			m_problem_tree->clear();
+			m_problems.clear();
+		}
+	};
+
+	ProblemPanel::ProblemPanel(QWidget* parent)
+		: QWidget(parent)
+		, m_internal(std::make_unique<Internal>())
+	{
+		init_ui();
+		connect_signals();
+	}
+
+	ProblemPanel::~ProblemPanel() = default;
+
+	void ProblemPanel::set_search(ScenarioSearch* search)
+	{
+		if (m_internal->m_search)
+		{
+			disconnect(m_internal->m_search, nullptr, this, nullptr);
+		}
+
+		m_internal->m_search = search;
+		if (search)
+		{
+			connect(search, &ScenarioSearch::index_ready, this, &ProblemPanel::index_updated);
+			connect(search, &ScenarioSearch::index_updated, this, &ProblemPanel::index_updated);
+		}
+		clear();
+	}
+
+	void ProblemPanel::set_pict_files(const QMap<int, QString>* pict_files)
+	{
+		m_internal->m_pict_files = pict_files;
+		index_updated();
+	}
+
+	void ProblemPanel::clear()
+	{
+		m_internal->m_refresh_timer.stop();
+		m_internal->clear_list();
+		m_internal->m_status_label->clear();
+	}
+
+	void ProblemPanel::showEvent(QShowEvent* event)
+	{
+		QWidget::showEvent(event);
+		refresh();
+	}
+
+	void ProblemPanel::init_ui()
+	{
+		m_internal->m_filter_combo = new QComboBox(this);
+		for (const char* current_label : SEVERITY_FILTER_LABELS)
+		{
+			m_internal->m_filter_combo->addItem(current_label);
+		}
+		m_internal->m_filter_combo->setCurrentIndex(1);
+
+		m_internal->m_status_label = new QLabel(this);
+
+		QHBoxLayout* filter_layout = new QHBoxLayout();
+		filter_layout->addWidget(m_internal->m_filter_combo);
+		filter_layout->addWidget(m_internal->m_status_label, 1);
+
+		m_internal->m_problem_tree = new QTreeWidget(this);
+		m_internal->m_problem_tree->setRootIsDecorated(false);
+		m_internal->m_problem_tree->setUniformRowHeights(true);
+		m_internal->m_problem_tree->setColumnCount(Utils::to_integral(ProblemColumn::COLUMN_COUNT));
+
+		QStringList header_labels;
+		for (const char* current_label : PROBLEM_COLUMN_LABELS)
+		{
+			header_labels << current_label;
+		}
+		m_internal->m_problem_tree->setHeaderLabels(header_labels);
+		m_internal->m_problem_tree->header()->setStretchLastSection(true);
+
+		QVBoxLayout* panel_layout = new QVBoxLayout(this);
+		panel_layout->setContentsMargins(0, 0, 0, 0);
+		panel_layout->addLayout(filter_layout);
+		panel_layout->addWidget(m_internal->m_problem_tree);
+
+		m_internal->m_refresh_timer.setSingleShot(true);
+		m_internal->m_refresh_timer.setInterval(REFRESH_DELAY);
+	}
+
+	void ProblemPanel::connect_signals()
+	{
+		connect(m_internal->m_filter_combo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ProblemPanel::refresh);
+		connect(&m_internal->m_refresh_timer, &QTimer::timeout, this, &ProblemPanel::refresh);
+
+		connect(m_internal->m_problem_tree, &QTreeWidget::currentItemChanged, this, &ProblemPanel::problem_item_selected);
+		connect(m_internal->m_problem_tree, &QTreeWidget::itemActivated, this, &ProblemPanel::problem_item_activated);
+	}
+
+	void ProblemPanel::refresh()
+	{
+		HUX_TRACE_SCOPE("ui", "refresh_problems");
+		m_internal->m_refresh_timer.stop();
+
+		// Keep the selected problem (if it is still listed)
+		const ScenarioSearch::ProblemResult* previous_problem = m_internal->get_problem(m_internal->m_problem_tree->currentItem());
+		const bool had_selection = (previous_problem != nullptr);
+		const ProblemKey selected_key = had_selection ? get_problem_key(previous_problem->m_problem) : ProblemKey();
+
+		// Selecting items while the list is rebuilt would jump to the terminals
+		const QSignalBlocker tree_blocker(m_internal->m_problem_tree);
+		m_internal->clear_list();
+
+		if (!m_internal->m_search || !m_internal->m_search->is_ready())
+		{
+			const bool building = m_internal->m_search && m_internal->m_search->is_active();
+			m_internal->m_status_label->setText(building ? tr("Validating the scenario...") : QString());
+			return;
+		}
+
+		// Without any images every PICT would be reported as missing
+		const QMap<int, QString>* pict_files = (m_internal->m_pict_files && !m_internal->m_pict_files->isEmpty()) ? m_internal->m_pict_files : nullptr;
+
+		std::vector<ScenarioSearch::ProblemResult> all_problems;
+		m_internal->m_search->find_problems(pict_files, all_problems);
+
+		// Count every problem, even the ones which are filtered out
+		std::array<int, Utils::to_integral(Diagnostics::Severity::SEVERITY_COUNT)> severity_counts = {};
+		const Diagnostics::Severity min_severity = SEVERITY_FILTERS[m_internal->m_filter_combo->currentIndex()];
+		for (ScenarioSearch::ProblemResult& current_problem : all_problems)
+		{
+			const Diagnostics::Severity severity = current_problem.m_problem.m_problem.m_severity;
+			++severity_counts[Utils::to_integral(severity)];
+			if (severity >= min_severity)
+			{
+				m_internal->m_problems.push_back(std::move(current_problem));
+			}
+		}
+
+		QList<QTreeWidgetItem*> problem_items;
+		problem_items.reserve(static_cast<qsizetype>(m_internal->m_problems.size()));
+		QTreeWidgetItem* selected_item = nullptr;
+		for (int problem_index = 0; problem_index < static_cast<int>(m_internal->m_problems.size()); ++problem_index)
+		{
+			const ScenarioSearch::ProblemResult& current_result = m_internal->m_problems[problem_index];
+			const ScenarioValidator::Problem& current_problem = current_result.m_problem.m_problem;
+
+			QTreeWidgetItem* problem_item = new QTreeWidgetItem();
+			problem_item->setIcon(Utils::to_integral(ProblemColumn::SEVERITY), style()->standardIcon(get_severity_icon(current_problem.m_severity)));
+			problem_item->setText(Utils::to_integral(ProblemColumn::SEVERITY), QString::fromLatin1(Diagnostics::get_severity_label(current_problem.m_severity)).toLower());
+			problem_item->setText(Utils::to_integral(ProblemColumn::LEVEL), current_result.m_location.m_level_name);
+			problem_item->setText(Utils::to_integral(ProblemColumn::TERMINAL), current_result.m_location.m_terminal_name);
+			problem_item->setText(Utils::to_integral(ProblemColumn::LOCATION), get_location_label(current_problem));
+			problem_item->setText(Utils::to_integral(ProblemColumn::PROBLEM), current_problem.m_message);
+			problem_item->setData(0, Qt::UserRole, problem_index);
+			problem_items.append(problem_item);
+
+			if (had_selection && (get_problem_key(current_result.m_problem) == selected_key))
+			{
+				selected_item = problem_item;
+			}
+		}
+		m_internal->m_problem_tree->addTopLevelItems(problem_items);
+
+		m_internal->m_status_label->setText(tr("%1 error(s), %2 warning(s), %3 note(s)")
+			.arg(severity_counts[Utils::to_integral(Diagnostics::Severity::ERROR)])
+			.arg(severity_counts[Utils::to_integral(Diagnostics::Severity::WARNING)])
+			.arg(severity_counts[Utils::to_integral(Diagnostics::Severity::INFO)])
+			+ (pict_files ? QString() : tr(" (PICTs are not checked without resources)")));
+
+		if (selected_item)
+		{
+			m_internal->m_problem_tree->setCurrentItem(selected_item);
+		}
+	}
+
+	void ProblemPanel::index_updated()
+	{
+		if (isVisible())
+		{
+			m_internal->m_refresh_timer.start();
+		}
+	}
+
+	void ProblemPanel::problem_item_selected(QTreeWidgetItem* current, QTreeWidgetItem* previous)
+	{
+		const ScenarioSearch::ProblemResult* selected_problem = m_internal->get_problem(current);
+		if (!selected_problem || !m_internal->m_search)
+		{
+			return;
+		}
+
+		const TerminalID terminal_id = m_internal->m_search->get_terminal_id(selected_problem->m_problem.m_terminal_id);
+		if (terminal_id.is_valid())
+		{
+			emit(terminal_selected(terminal_id.m_level_id, terminal_id.m_terminal_id, selected_problem->m_problem.m_problem.m_branch, selected_problem->m_problem.m_problem.m_screen));
+		}
+	}
+
+	void ProblemPanel::problem_item_activated(QTreeWidgetItem* item, int column)
+	{
+		const ScenarioSearch::ProblemResult* activated_problem = m_internal->get_problem(item);
+		if (!activated_problem || !m_internal->m_search)
+		{
+			return;
+		}
+
+		const TerminalID terminal_id = m_internal->m_search->get_terminal_id(activated_problem->m_problem.m_terminal_id);
+		if (terminal_id.is_valid())
+		{
+			emit(terminal_opened(terminal_id.m_level_id, terminal_id.m_terminal_id));
+		}
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <HuxQt/Scenario/Terminal.h>
+
+#include <QMap>
+#include <QWidget>
+
+class QTreeWidgetItem;
+
+namespace HuxApp
+{
+	class ScenarioSearch;
+
+	// Lists the problems found by the scenario validation (kept up to date as the terminals are edited)
+	class ProblemPanel : public QWidget
+	{
+		Q_OBJECT
+	public:
+		ProblemPanel(QWidget* parent = nullptr);
+		~ProblemPanel();
+
+		void set_search(ScenarioSearch* search);
+		void set_pict_files(const QMap<int, QString>* pict_files); // Used to find the missing PICTs (e.g the display system cache)
+		void clear();
+	signals:
+		void terminal_selected(int level_id, int terminal_id, Terminal::BranchType branch, int screen); // Branch & screen are only valid for screen problems
+		void terminal_opened(int level_id, int terminal_id);
+	protected:
+		void showEvent(QShowEvent* event) override;
+	private:
+		void init_ui();
+		void connect_signals();
+
+		void refresh();
+		void index_updated();
+
+		void problem_item_selected(QTreeWidgetItem* current, QTreeWidgetItem* previous);
+		void problem_item_activated(QTreeWidgetItem* item, int column);
+
+		struct Internal;
+		std::unique_ptr<Internal> m_internal;
+	};
+}
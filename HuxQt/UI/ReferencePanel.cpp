@@ -0,0 +1,351 @@
+#include <HuxQt/UI/ReferencePanel.h>
+
+#include <HuxQt/Scenario/ScenarioSearch.h>
+
+#include <QComboBox>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QHeaderView>
+#include <QSplitter>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QTimer>
+
+namespace HuxApp
+{
+	namespace
+	{
+		// Edits come in bursts (e.g pasting terminals), so the lists are only rebuilt once they settle
+		constexpr int REFRESH_DELAY = 250;
+
+		// The first views are the reference types
+		enum class ReferenceView
+		{
+			PICT,
+			CHECKPOINT,
+			TAG,
+			LEVEL_TELEPORT,
+			POLYGON_TELEPORT,
+			MISSING_PICTS,
+			UNUSED_PICTS,
+			VIEW_COUNT
+		};
+
+		static_assert(Utils::to_integral(ReferenceView::MISSING_PICTS) == Utils::to_integral(CrossReferenceIndex::ReferenceType::TYPE_COUNT));
+
+		QString get_view_label(ReferenceView view)
+		{
+			switch (view)
+			{
+			case ReferenceView::MISSING_PICTS:
+				return QStringLiteral("Missing PICTs");
+			case ReferenceView::UNUSED_PICTS:
+				return QStringLiteral("Unused PICTs");
+			default:
+				return CrossReferenceIndex::get_reference_type_name(Utils::to_enum<CrossReferenceIndex::ReferenceType>(Utils::to_integral(view)));
+			}
+		}
+
+		// Missing PICTs list the references of the PICTs (unused ones have none)
+		CrossReferenceIndex::ReferenceType get_reference_type(ReferenceView view)
+		{
+			return (view == ReferenceView::MISSING_PICTS) ? CrossReferenceIndex::ReferenceType::PICT : Utils::to_enum<CrossReferenceIndex::ReferenceType>(Utils::to_integral(view));
+		}
+
+		QString get_location_label(const CrossReferenceIndex::Reference& reference)
+		{
+			const QLatin1String branch_name(Terminal::get_branch_type_name(reference.m_branch));
+			if (reference.m_screen >= 0)
+			{
+				return QStringLiteral("%1 / screen %2").arg(branch_name).arg(reference.m_screen);
+			}
+			return QStringLiteral("%1 / teleport").arg(branch_name);
+		}
+	}
+
+	struct ReferencePanel::Internal
+	{
+		ScenarioSearch* m_search = nullptr;
+		const QMap<int, QString>* m_pict_files = nullptr;
+
+		QComboBox* m_view_combo = nullptr;
+		QLabel* m_status_label = nullptr;
+		QTreeWidget* m_id_tree = nullptr;
+		QTreeWidget* m_reference_tree = nullptr;
+
+		QTimer m_refresh_timer; // Hidden panels are refreshed once they are shown
+
+		std::vector<ScenarioSearch::ReferenceResult> m_references; // Items store the index of their reference
+
+		ReferenceView get_current_view() const { return Utils::to_enum<ReferenceView>(m_view_combo->currentIndex()); }
+
+		const ScenarioSearch::ReferenceResult* get_reference(QTreeWidgetItem* item) const
+		{
+			if (item)
+			{
+				const int reference_index = item->data(0, Qt::UserRole).toInt();
+				if ((reference_index >= 0) && (reference_index < static_cast<int>(m_references.size())))
+				{
+					return &m_references[reference_index];
+				}
+			}
+			return nullptr;
+		}
+
+		void clear_lists()
+		{
+			m_id_tree->clear();
+			m_reference_tree->clear();
+			m_references.clear();
+		}
+	};
+
+	ReferencePanel::ReferencePanel(QWidget* parent)
+		: QWidget(parent)
+		, m_internal(std::make_unique<Internal>())
+	{
+		init_ui();
+		connect_signals();
+	}
+
+	ReferencePanel::~ReferencePanel() = default;
+
+	void ReferencePanel::set_search(ScenarioSearch* search)
+	{
+		if (m_internal->m_search)
+		{
+			disconnect(m_internal->m_search, nullptr, this, nullptr);
+		}
+
+		m_internal->m_search = search;
+		if (search)
+		{
+			connect(search, &ScenarioSearch::index_ready, this, &ReferencePanel::index_updated);
+			connect(search, &ScenarioSearch::index_updated, this, &ReferencePanel::index_updated);
+		}
+		clear();
+	}
+
+	void ReferencePanel::set_pict_files(const QMap<int, QString>* pict_files)
+	{
+		m_internal->m_pict_files = pict_files;
+		index_updated();
+	}
+
+	void ReferencePanel::clear()
+	{
+		m_internal->m_refresh_timer.stop();
+		m_internal->clear_lists();
+		m_internal->m_status_label->clear();
+	}
+
+	void ReferencePanel::showEvent(QShowEvent* event)
+	{
+		QWidget::showEvent(event);
+		refresh();
+	}
+
+	void ReferencePanel::init_ui()
+	{
+		m_internal->m_view_combo = new QComboBox(this);
+		for (int view_index = 0; view_index < Utils::to_integral(ReferenceView::VIEW_COUNT); ++view_index)
+		{
+			m_internal->m_view_combo->addItem(get_view_label(Utils::to_enum<ReferenceView>(view_index)));
+		}
+
+		m_internal->m_status_label = new QLabel(this);
+
+		QHBoxLayout* view_layout = new QHBoxLayout();
+		view_layout->addWidget(m_internal->m_view_combo);
+		view_layout->addWidget(m_internal->m_status_label, 1);
+
+		QSplitter* list_splitter = new QSplitter(Qt::Horizontal, this);
+
+		m_internal->m_id_tree = new QTreeWidget(list_splitter);
+		m_internal->m_id_tree->setRootIsDecorated(false);
+		m_internal->m_id_tree->setUniformRowHeights(true);
+		m_internal->m_id_tree->setHeaderLabels({ "ID", "Uses" });
+
+		m_internal->m_reference_tree = new QTreeWidget(list_splitter);
+		m_internal->m_reference_tree->setRootIsDecorated(false);
+		m_internal->m_reference_tree->setUniformRowHeights(true);
+		m_internal->m_reference_tree->setHeaderLabels({ "Level", "Terminal", "Location" });
+		m_internal->m_reference_tree->header()->setStretchLastSection(true);
+
+		list_splitter->setStretchFactor(1, 2);
+
+		QVBoxLayout* panel_layout = new QVBoxLayout(this);
+		panel_layout->setContentsMargins(0, 0, 0, 0);
+		panel_layout->addLayout(view_layout);
+		panel_layout->addWidget(list_splitter);
+
+		m_internal->m_refresh_timer.setSingleShot(true);
+		m_internal->m_refresh_timer.setInterval(REFRESH_DELAY);
+	}
+
+	void ReferencePanel::connect_signals()
+	{
+		connect(m_internal->m_view_combo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]()
+			{
+				// IDs of the other views are unrelated, so the selection is not kept
+				m_internal->clear_lists();
+				refresh();
+			}
+		);
+		connect(&m_internal->m_refresh_timer, &QTimer::timeout, this, &ReferencePanel::refresh);
+
+		connect(m_internal->m_id_tree, &QTreeWidget::currentItemChanged, this, &ReferencePanel::id_item_selected);
+		connect(m_internal->m_reference_tree, &QTreeWidget::currentItemChanged, this, &ReferencePanel::reference_item_selected);
+		connect(m_internal->m_reference_tree, &QTreeWidget::itemActivated, this, &ReferencePanel::reference_item_activated);
+	}
+
+	void ReferencePanel::refresh()
+	{
+		m_internal->m_refresh_timer.stop();
+
+		// Keep the selected ID (if it is still listed)
+		QTreeWidgetItem* previous_id_item = m_internal->m_id_tree->currentItem();
+		const bool had_selection = (previous_id_item != nullptr);
+		const int selected_id = had_selection ? previous_id_item->data(0, Qt::UserRole).toInt() : 0;
+		m_internal->clear_lists();
+
+		if (!m_internal->m_search || !m_internal->m_search->is_ready())
+		{
+			const bool building = m_internal->m_search && m_internal->m_search->is_active();
+			m_internal->m_status_label->setText(building ? tr("Building the index...") : QString());
+			return;
+		}
+
+		const CrossReferenceIndex& cross_references = m_internal->m_search->get_cross_references();
+		const ReferenceView current_view = m_internal->get_current_view();
+
+		std::vector<int> listed_ids;
+		switch (current_view)
+		{
+		case ReferenceView::MISSING_PICTS:
+		case ReferenceView::UNUSED_PICTS:
+			if (!m_internal->m_pict_files)
+			{
+				m_internal->m_status_label->setText(tr("No resources loaded"));
+				return;
+			}
+			listed_ids = (current_view == ReferenceView::MISSING_PICTS) ? cross_references.find_missing_picts(*m_internal->m_pict_files) : cross_references.find_unused_picts(*m_internal->m_pict_files);
+			break;
+		default:
+			listed_ids = cross_references.get_ids(get_reference_type(current_view));
+			break;
+		}
+
+		// Unused PICTs have no references, so the file is listed instead
+		const bool unused_view = (current_view == ReferenceView::UNUSED_PICTS);
+		m_internal->m_id_tree->setHeaderLabels({ "ID", unused_view ? "File" : "Uses" });
+
+		QList<QTreeWidgetItem*> id_items;
+		id_items.reserve(static_cast<qsizetype>(listed_ids.size()));
+		QTreeWidgetItem* selected_item = nullptr;
+		for (const int current_id : listed_ids)
+		{
+			QTreeWidgetItem* id_item = new QTreeWidgetItem();
+			id_item->setText(0, QString::number(current_id));
+			id_item->setData(0, Qt::UserRole, current_id);
+			if (unused_view)
+			{
+				id_item->setText(1, QFileInfo(m_internal->m_pict_files->value(current_id)).fileName());
+			}
+			else
+			{
+				id_item->setText(1, QString::number(cross_references.get_references(get_reference_type(current_view), current_id).size()));
+			}
+			id_items.append(id_item);
+
+			if (had_selection && (current_id == selected_id))
+			{
+				selected_item = id_item;
+			}
+		}
+		m_internal->m_id_tree->addTopLevelItems(id_items);
+		m_internal->m_status_label->setText(tr("%n ID(s)", nullptr, static_cast<int>(listed_ids.size())));
+
+		if (selected_item)
+		{
+			m_internal->m_id_tree->setCurrentItem(selected_item);
+		}
+	}
+
+	void ReferencePanel::index_updated()
+	{
+		if (isVisible())
+		{
+			m_internal->m_refresh_timer.start();
+		}
+	}
+
+	void ReferencePanel::show_references()
+	{
+		m_internal->m_reference_tree->clear();
+		m_internal->m_references.clear();
+
+		const ReferenceView current_view = m_internal->get_current_view();
+		QTreeWidgetItem* id_item = m_internal->m_id_tree->currentItem();
+		if (!id_item || !m_internal->m_search || (current_view == ReferenceView::UNUSED_PICTS))
+		{
+			return;
+		}
+
+		if (!m_internal->m_search->find_references(get_reference_type(current_view), id_item->data(0, Qt::UserRole).toInt(), m_internal->m_references))
+		{
+			return;
+		}
+
+		QList<QTreeWidgetItem*> reference_items;
+		reference_items.reserve(static_cast<qsizetype>(m_internal->m_references.size()));
+		for (int reference_index = 0; reference_index < static_cast<int>(m_internal->m_references.size()); ++reference_index)
+		{
+			const ScenarioSearch::ReferenceResult& current_reference = m_internal->m_references[reference_index];
+
+			QTreeWidgetItem* reference_item = new QTreeWidgetItem();
+			reference_item->setText(0, current_reference.m_location.m_level_name);
+			reference_item->setText(1, current_reference.m_location.m_terminal_name);
+			reference_item->setText(2, get_location_label(current_reference.m_reference));
+			reference_item->setData(0, Qt::UserRole, reference_index);
+			reference_items.append(reference_item);
+		}
+		m_internal->m_reference_tree->addTopLevelItems(reference_items);
+	}
+
+	void ReferencePanel::id_item_selected(QTreeWidgetItem* current, QTreeWidgetItem* previous)
+	{
+		show_references();
+	}
+
+	void ReferencePanel::reference_item_selected(QTreeWidgetItem* current, QTreeWidgetItem* previous)
+	{
+		const ScenarioSearch::ReferenceResult* selected_reference = m_internal->get_reference(current);
+		if (!selected_reference || !m_internal->m_search)
+		{
+			return;
+		}
+
+		const TerminalID terminal_id = m_internal->m_search->get_terminal_id(selected_reference->m_reference.m_terminal_id);
+		if (terminal_id.is_valid())
+		{
+			emit(terminal_selected(terminal_id.m_level_id, terminal_id.m_terminal_id, selected_reference->m_reference.m_branch, selected_reference->m_reference.m_screen));
+		}
+	}
+
+	void ReferencePanel::reference_item_activated(QTreeWidgetItem* item, int column)
+	{
+		const ScenarioSearch::ReferenceResult* activated_reference = m_internal->get_reference(item);
+		if (!activated_reference || !m_internal->m_search)
+		{
+			return;
+		}
+
+		const TerminalID terminal_id = m_internal->m_search->get_terminal_id(activated_reference->m_reference.m_terminal_id);
+		if (terminal_id.is_valid())
+		{
+			emit(terminal_opened(terminal_id.m_level_id, terminal_id.m_terminal_id));
+		}
+	}
+}
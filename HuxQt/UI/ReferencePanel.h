@@ -0,0 +1,44 @@
+#pragma once
+#include <HuxQt/Scenario/Terminal.h>
+
+#include <QMap>
+#include <QWidget>
+
+class QTreeWidgetItem;
+
+namespace HuxApp
+{
+	class ScenarioSearch;
+
+	// Lists the IDs referenced in the scenario (images, checkpoints, tags and teleports) and the screens which use them
+	class ReferencePanel : public QWidget
+	{
+		Q_OBJECT
+	public:
+		ReferencePanel(QWidget* parent = nullptr);
+		~ReferencePanel();
+
+		void set_search(ScenarioSearch* search);
+		void set_pict_files(const QMap<int, QString>* pict_files); // Used to find the missing and unused PICTs (e.g the display system cache)
+		void clear();
+	signals:
+		void terminal_selected(int level_id, int terminal_id, Terminal::BranchType branch, int screen); // Screen is only valid for screen references
+		void terminal_opened(int level_id, int terminal_id);
+	protected:
+		void showEvent(QShowEvent* event) override;
+	private:
+		void init_ui();
+		void connect_signals();
+
+		void refresh();
+		void index_updated();
+		void show_references();
+
+		void id_item_selected(QTreeWidgetItem* current, QTreeWidgetItem* previous);
+		void reference_item_selected(QTreeWidgetItem* current, QTreeWidgetItem* previous);
+		void reference_item_activated(QTreeWidgetItem* item, int column);
+
+		struct Internal;
+		std::unique_ptr<Internal> m_internal;
+	};
+}
@@ -4,6 +4,7 @@
 #include <HuxQt/Scenario/ScenarioBrowserModel.h>
 
 #include <QMenu>
+#include <QMessageBox>
 
 namespace HuxApp
 {
@@ -218,24 +219,30 @@ namespace HuxApp
 
 	void ScenarioBrowserView::terminal_item_selected(const QModelIndex& index)
 	{
-		const int terminal_id = m_internal->m_opened_level->get_custom_data(index.row(), LevelModel::TerminalDataRoles::TERMINAL_ID).toInt();
+		const int terminal_id = m_internal->m_opened_level->get_terminal_id(index.row());
 		emit(terminal_selected(m_internal->m_opened_level->get_id(), terminal_id));
 	}
 
 	void ScenarioBrowserView::terminal_item_double_clicked(const QModelIndex& index)
 	{
-		const int terminal_id = m_internal->m_opened_level->get_custom_data(index.row(), LevelModel::TerminalDataRoles::TERMINAL_ID).toInt();
+		const int terminal_id = m_internal->m_opened_level->get_terminal_id(index.row());
 		emit(terminal_opened(m_internal->m_opened_level->get_id(), terminal_id));
 	}
 
 	void ScenarioBrowserView::add_level()
 	{
-		m_internal->m_model->add_level();
+		if (!m_internal->m_model->add_level())
+		{
+			QMessageBox::warning(this, "Add Level", "The scenario cannot hold any more levels!");
+		}
 	}
 
 	void ScenarioBrowserView::add_terminal()
 	{
-		m_internal->m_opened_level->add_terminal();
+		if (!m_internal->m_opened_level->add_terminal())
+		{
+			QMessageBox::warning(this, "Add Terminal", "The level cannot hold any more terminals!");
+		}
 	}
 
 	void ScenarioBrowserView::remove_level()
@@ -311,7 +318,10 @@ namespace HuxApp
 			if (selection_model)
 			{
 				const QModelIndexList selected_indices = selection_model->selectedIndexes(); // No need to check for empty selection here
-				m_internal->m_model->paste_terminals(m_internal->m_opened_level->get_id(), selected_indices);
+				if (!m_internal->m_model->paste_terminals(m_internal->m_opened_level->get_id(), selected_indices))
+				{
+					QMessageBox::warning(this, "Paste Terminals", "The level cannot hold the pasted terminals!");
+				}
 			}
 		}
 	}
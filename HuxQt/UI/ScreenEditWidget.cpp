@@ -6,6 +6,7 @@
 
 #include <HuxQt/UI/BrowsePictDialog.h>
 
+#include <HuxQt/Utils/Trace.h>
 #include <HuxQt/Utils/Utilities.h>
 #include <HuxQt/Utils/Color.h>
 
@@ -144,15 +145,18 @@ namespace HuxApp
         return true;
     }
 
-    void ScreenEditWidget::update_display_text()
+    qint64 ScreenEditWidget::update_display_text()
     {
+        qint64 conversion_ns = -1;
         if (m_text_dirty)
         {
+            HUX_TRACE_SCOPE_TIMED("text", "update_display_text", conversion_ns);
             const ScenarioManager& scenario_manager = m_core->get_scenario_manager();
 
             m_screen_data.m_display_text = scenario_manager.convert_ao_to_html(m_screen_data.m_script, Utils::to_integral(m_screen_data.m_type));
             m_text_dirty = false;
         }
+        return conversion_ns;
     }
 
     void ScreenEditWidget::connect_signals()
@@ -193,10 +197,10 @@ namespace HuxApp
         }
 
         const ScenarioManager& scenario_manager = m_core->get_scenario_manager();
-        const ScenarioManager::TextColorArray& text_colors = scenario_manager.get_text_colors();
+        const std::shared_ptr<const ScenarioManager::TextColorArray> text_colors = scenario_manager.get_text_colors();
 
         int current_color_index = 0;
-        for (const QColor& current_text_color : text_colors)
+        for (const QColor& current_text_color : *text_colors)
         {
             m_ui.text_color_combo->addItem(QStringLiteral("C%1").arg(current_color_index));
             m_ui.text_color_combo->setItemData(current_color_index, current_text_color, Qt::BackgroundRole);
@@ -307,11 +311,11 @@ namespace HuxApp
     void ScreenEditWidget::color_combo_activated(int index)
     {
         const ScenarioManager& scenario_manager = m_core->get_scenario_manager();
-        const ScenarioManager::TextColorArray& text_colors = scenario_manager.get_text_colors();
+        const std::shared_ptr<const ScenarioManager::TextColorArray> text_colors = scenario_manager.get_text_colors();
 
         // Generate the icon for the button
         QPixmap button_icon_pixmap(100, 100);
-        button_icon_pixmap.fill(text_colors[index]);
+        button_icon_pixmap.fill((*text_colors)[index]);
 
         QIcon button_icon(button_icon_pixmap);
         m_ui.text_color_button->setIcon(button_icon);
@@ -23,7 +23,7 @@ namespace HuxApp
 		bool is_modified() const { return m_modified; }
 		
 		bool save_screen();
-		void update_display_text();
+		qint64 update_display_text(); // Returns how long the conversion took in nanoseconds (-1 if the text was up to date)
 	signals:
 		void screen_edited(bool attributes);
 	private:
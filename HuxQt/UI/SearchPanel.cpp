@@ -0,0 +1,256 @@
+#include <HuxQt/UI/SearchPanel.h>
+
+#include <HuxQt/Scenario/ScenarioSearch.h>
+
+#include <HuxQt/Utils/Trace.h>
+
+#include <QLineEdit>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <QTimer>
+#include <QElapsedTimer>
+
+namespace HuxApp
+{
+	namespace
+	{
+		// Wait for the user to stop typing before running the query
+		constexpr int QUERY_DELAY = 150;
+
+		enum class ResultColumn
+		{
+			LEVEL,
+			TERMINAL,
+			LOCATION,
+			TEXT,
+			COLUMN_COUNT
+		};
+
+		constexpr const char* RESULT_COLUMN_LABELS[Utils::to_integral(ResultColumn::COLUMN_COUNT)] =
+		{
+			"Level",
+			"Terminal",
+			"Location",
+			"Text"
+		};
+
+		QString get_location_label(const SearchIndex::Hit& hit)
+		{
+			switch (hit.m_field)
+			{
+			case SearchIndex::Field::SCREEN_SCRIPT:
+			case SearchIndex::Field::SCREEN_COMMENTS:
+				return QStringLiteral("%1 / screen %2 (%3)").arg(QLatin1String(Terminal::get_branch_type_name(hit.m_branch))).arg(hit.m_screen).arg(QLatin1String(SearchIndex::get_field_name(hit.m_field)));
+			default:
+				return SearchIndex::get_field_name(hit.m_field);
+			}
+		}
+	}
+
+	struct SearchPanel::Internal
+	{
+		ScenarioSearch* m_search = nullptr;
+
+		QLineEdit* m_query_edit = nullptr;
+		QLabel* m_status_label = nullptr;
+		QTreeWidget* m_result_tree = nullptr;
+		QTimer m_query_timer;
+
+		std::vector<ScenarioSearch::Result> m_results; // Items store the index of their result
+
+		const ScenarioSearch::Result* get_result(QTreeWidgetItem* item) const
+		{
+			if (item)
+			{
+				const int result_index = item->data(0, Qt::UserRole).toInt();
+				if ((result_index >= 0) && (result_index < static_cast<int>(m_results.size())))
+				{
+					return &m_results[result_index];
+				}
+			}
+			return nullptr;
+		}
+
+		void clear_results()
+		{
+			m_result_tree->clear();
+			m_results.clear();
+		}
+	};
+
+	SearchPanel::SearchPanel(QWidget* parent)
+		: QWidget(parent)
+		, m_internal(std::make_unique<Internal>())
+	{
+		init_ui();
+		connect_signals();
+	}
+
+	SearchPanel::~SearchPanel() = default;
+
+	void SearchPanel::set_search(ScenarioSearch* search)
+	{
+		if (m_internal->m_search)
+		{
+			disconnect(m_internal->m_search, nullptr, this, nullptr);
+		}
+
+		m_internal->m_search = search;
+		if (search)
+		{
+			connect(search, &ScenarioSearch::index_ready, this, &SearchPanel::index_ready);
+		}
+		clear();
+	}
+
+	void SearchPanel::clear()
+	{
+		m_internal->m_query_timer.stop();
+		m_internal->clear_results();
+		m_internal->m_status_label->clear();
+	}
+
+	void SearchPanel::focus_query()
+	{
+		m_internal->m_query_edit->setFocus();
+		m_internal->m_query_edit->selectAll();
+	}
+
+	void SearchPanel::init_ui()
+	{
+		m_internal->m_query_edit = new QLineEdit(this);
+		m_internal->m_query_edit->setPlaceholderText(tr("Search the scenario (\"phrase\", /regex/)"));
+		m_internal->m_query_edit->setClearButtonEnabled(true);
+
+		m_internal->m_status_label = new QLabel(this);
+
+		m_internal->m_result_tree = new QTreeWidget(this);
+		m_internal->m_result_tree->setRootIsDecorated(false);
+		m_internal->m_result_tree->setUniformRowHeights(true);
+		m_internal->m_result_tree->setColumnCount(Utils::to_integral(ResultColumn::COLUMN_COUNT));
+
+		QStringList header_labels;
+		for (const char* current_label : RESULT_COLUMN_LABELS)
+		{
+			header_labels << current_label;
+		}
+		m_internal->m_result_tree->setHeaderLabels(header_labels);
+		m_internal->m_result_tree->header()->setStretchLastSection(true);
+
+		QVBoxLayout* panel_layout = new QVBoxLayout(this);
+		panel_layout->setContentsMargins(0, 0, 0, 0);
+		panel_layout->addWidget(m_internal->m_query_edit);
+		panel_layout->addWidget(m_internal->m_status_label);
+		panel_layout->addWidget(m_internal->m_result_tree);
+
+		m_internal->m_query_timer.setSingleShot(true);
+		m_internal->m_query_timer.setInterval(QUERY_DELAY);
+	}
+
+	void SearchPanel::connect_signals()
+	{
+		connect(m_internal->m_query_edit, &QLineEdit::textChanged, &m_internal->m_query_timer, qOverload<>(&QTimer::start));
+		connect(m_internal->m_query_edit, &QLineEdit::returnPressed, this, &SearchPanel::run_query);
+		connect(&m_internal->m_query_timer, &QTimer::timeout, this, &SearchPanel::run_query);
+
+		connect(m_internal->m_result_tree, &QTreeWidget::currentItemChanged, this, &SearchPanel::result_item_selected);
+		connect(m_internal->m_result_tree, &QTreeWidget::itemActivated, this, &SearchPanel::result_item_activated);
+	}
+
+	void SearchPanel::run_query()
+	{
+		HUX_TRACE_SCOPE("ui", "search_query");
+		m_internal->m_query_timer.stop();
+		m_internal->clear_results();
+
+		const QString query = m_internal->m_query_edit->text().trimmed();
+		if (query.isEmpty() || !m_internal->m_search || !m_internal->m_search->is_active())
+		{
+			m_internal->m_status_label->clear();
+			return;
+		}
+
+		if (!m_internal->m_search->is_ready())
+		{
+			// Query is run again once the index is built
+			m_internal->m_status_label->setText(tr("Building the search index..."));
+			return;
+		}
+
+		QElapsedTimer query_timer;
+		query_timer.start();
+
+		QString error_msg;
+		if (!m_internal->m_search->search(query, m_internal->m_results, error_msg))
+		{
+			m_internal->m_status_label->setText(error_msg);
+			return;
+		}
+
+		const qint64 elapsed_ms = query_timer.elapsed();
+
+		QList<QTreeWidgetItem*> result_items;
+		result_items.reserve(static_cast<qsizetype>(m_internal->m_results.size()));
+		for (int result_index = 0; result_index < static_cast<int>(m_internal->m_results.size()); ++result_index)
+		{
+			const ScenarioSearch::Result& current_result = m_internal->m_results[result_index];
+
+			QTreeWidgetItem* result_item = new QTreeWidgetItem();
+			result_item->setText(Utils::to_integral(ResultColumn::LEVEL), current_result.m_location.m_level_name);
+			result_item->setText(Utils::to_integral(ResultColumn::TERMINAL), current_result.m_location.m_terminal_name);
+			result_item->setText(Utils::to_integral(ResultColumn::LOCATION), get_location_label(current_result.m_hit));
+			result_item->setText(Utils::to_integral(ResultColumn::TEXT), current_result.m_hit.m_snippet);
+			result_item->setData(0, Qt::UserRole, result_index);
+			result_items.append(result_item);
+		}
+		m_internal->m_result_tree->addTopLevelItems(result_items);
+
+		QString status_text = tr("%n result(s) in %1 ms", nullptr, static_cast<int>(m_internal->m_results.size())).arg(elapsed_ms);
+		if (static_cast<int>(m_internal->m_results.size()) >= SearchIndex::DEFAULT_MAX_HITS)
+		{
+			status_text += tr(" (only the first %1 are listed)").arg(SearchIndex::DEFAULT_MAX_HITS);
+		}
+		m_internal->m_status_label->setText(status_text);
+	}
+
+	void SearchPanel::index_ready()
+	{
+		// Run the query which was typed while the index was being built
+		if (!m_internal->m_query_edit->text().trimmed().isEmpty())
+		{
+			run_query();
+		}
+	}
+
+	void SearchPanel::result_item_selected(QTreeWidgetItem* current, QTreeWidgetItem* previous)
+	{
+		const ScenarioSearch::Result* selected_result = m_internal->get_result(current);
+		if (!selected_result || !m_internal->m_search)
+		{
+			return;
+		}
+
+		const TerminalID terminal_id = m_internal->m_search->get_terminal_id(selected_result->m_hit.m_terminal_id);
+		if (terminal_id.is_valid())
+		{
+			emit(terminal_selected(terminal_id.m_level_id, terminal_id.m_terminal_id, selected_result->m_hit.m_branch, selected_result->m_hit.m_screen));
+		}
+	}
+
+	void SearchPanel::result_item_activated(QTreeWidgetItem* item, int column)
+	{
+		const ScenarioSearch::Result* activated_result = m_internal->get_result(item);
+		if (!activated_result || !m_internal->m_search)
+		{
+			return;
+		}
+
+		const TerminalID terminal_id = m_internal->m_search->get_terminal_id(activated_result->m_hit.m_terminal_id);
+		if (terminal_id.is_valid())
+		{
+			emit(terminal_opened(terminal_id.m_level_id, terminal_id.m_terminal_id));
+		}
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <HuxQt/Scenario/Terminal.h>
+
+#include <QWidget>
+
+class QTreeWidgetItem;
+
+namespace HuxApp
+{
+	class ScenarioSearch;
+
+	// Search box and result list for the scenario-wide text search
+	class SearchPanel : public QWidget
+	{
+		Q_OBJECT
+	public:
+		SearchPanel(QWidget* parent = nullptr);
+		~SearchPanel();
+
+		void set_search(ScenarioSearch* search);
+		void clear(); // Clears the results (e.g when the scenario is closed)
+		void focus_query();
+	signals:
+		void terminal_selected(int level_id, int terminal_id, Terminal::BranchType branch, int screen); // Branch & screen are only valid for screen hits
+		void terminal_opened(int level_id, int terminal_id);
+	private:
+		void init_ui();
+		void connect_signals();
+
+		void run_query();
+		void index_ready();
+
+		void result_item_selected(QTreeWidgetItem* current, QTreeWidgetItem* previous);
+		void result_item_activated(QTreeWidgetItem* item, int column);
+
+		struct Internal;
+		std::unique_ptr<Internal> m_internal;
+	};
+}
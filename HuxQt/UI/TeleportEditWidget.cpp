@@ -25,11 +25,7 @@ namespace HuxApp
             m_ui.type_combo->addItem(TELEPORT_TYPE_LABELS[teleport_type_index]);
         }
 
-        m_ui.type_combo->setCurrentIndex(Utils::to_integral(teleport_info.m_type));
-        if (teleport_info.m_type != Terminal::TeleportType::NONE)
-        {
-            m_ui.index_edit->setText(QString::number(teleport_info.m_index));
-        }
+        set_teleport_info(teleport_info);
 	}
 
 	Terminal::Teleport TeleportEditWidget::get_teleport_info() const
@@ -58,6 +54,12 @@ namespace HuxApp
         return teleport_info;
 	}
 
+    void TeleportEditWidget::set_teleport_info(const Terminal::Teleport& teleport_info)
+    {
+        m_ui.type_combo->setCurrentIndex(Utils::to_integral(teleport_info.m_type));
+        m_ui.index_edit->setText((teleport_info.m_type != Terminal::TeleportType::NONE) ? QString::number(teleport_info.m_index) : QString());
+    }
+
     bool TeleportEditWidget::is_valid() const
     {
         Terminal::TeleportType teleport_type = Utils::to_enum<Terminal::TeleportType>(m_ui.type_combo->currentIndex());
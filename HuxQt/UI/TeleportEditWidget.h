@@ -12,6 +12,7 @@ namespace HuxApp
 		TeleportEditWidget(const QString& label, const Terminal::Teleport& teleport_info);
 
 		Terminal::Teleport get_teleport_info() const;
+		void set_teleport_info(const Terminal::Teleport& teleport_info);
 		bool is_valid() const;
 	signals:
 		void teleport_info_modified();
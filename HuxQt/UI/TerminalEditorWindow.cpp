@@ -9,9 +9,12 @@
 #include <HuxQt/UI/TeleportEditWidget.h>
 #include <HuxQt/UI/ScreenEditWidget.h>
 
+#include <HuxQt/Utils/Trace.h>
 #include <HuxQt/Utils/Utilities.h>
 
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 
 #include <QMenu>
 #include <QTimer>
@@ -91,11 +94,25 @@ namespace HuxApp
                 for (int current_branch_index = 0; current_branch_index < Utils::to_integral(Terminal::BranchType::TYPE_COUNT); ++current_branch_index)
                 {
                     const ScreenGroup& current_screen_group = m_screen_groups[current_branch_index];
-
                     const Terminal::BranchType current_branch_type = Utils::to_enum<Terminal::BranchType>(current_branch_index);
-                    Terminal::Branch& current_branch = terminal_data.get_branch(current_branch_type);
 
+                    // Leave the unchanged branches alone, so they keep sharing their data with the model
+                    const Terminal::ScreenVector& prev_screens = std::as_const(terminal_data).get_branch(current_branch_type).m_screens;
+                    const bool screens_changed = (static_cast<size_t>(prev_screens.size()) != current_screen_group.m_screens.size())
+                        || !std::equal(prev_screens.begin(), prev_screens.end(), current_screen_group.m_screens.begin(),
+                            [](const Terminal::Screen& prev_screen, const Screen& current_screen)
+                            {
+                                return (prev_screen == current_screen.m_data);
+                            }
+                        );
+                    if (!screens_changed)
+                    {
+                        continue;
+                    }
+
+                    Terminal::Branch& current_branch = terminal_data.get_branch(current_branch_type);
                     current_branch.m_screens.clear();
+                    current_branch.m_screens.reserve(current_screen_group.m_screens.size());
                     for (const Screen& current_screen_data : current_screen_group.m_screens)
                     {
                         current_branch.m_screens.push_back(current_screen_data.m_data);
@@ -109,18 +126,22 @@ namespace HuxApp
                 assert(new_id_list.size() == screen_group.m_screens.size());
 
                 const std::vector<Screen> screen_group_copy = screen_group.m_screens;
+
+                // Index the previous positions so we don't have to search for each screen
+                std::unordered_map<int, size_t> screen_id_index;
+                screen_id_index.reserve(screen_group_copy.size());
+                for (size_t current_index = 0; current_index < screen_group_copy.size(); ++current_index)
+                {
+                    screen_id_index[screen_group_copy[current_index].m_id] = current_index;
+                }
+
                 auto screen_it = screen_group.m_screens.begin();
                 for (int current_id : new_id_list)
                 {
-                    auto moving_screen_it = std::find_if(screen_group_copy.begin(), screen_group_copy.end(),
-                        [current_id](const Screen& current_screen)
-                        {
-                            return (current_screen.m_id == current_id);
-                        }
-                    );
-                    assert(moving_screen_it != screen_group_copy.end());
+                    auto moving_screen_it = screen_id_index.find(current_id);
+                    assert(moving_screen_it != screen_id_index.end());
 
-                    *screen_it = *moving_screen_it;
+                    *screen_it = screen_group_copy[moving_screen_it->second];
                     // Indicate which terminals were moved
                     if (moved_ids.find(current_id) != moved_ids.end())
                     {
@@ -144,7 +165,7 @@ namespace HuxApp
                 screen_group.m_modified = true;
             }
 
-            void add_screens(const std::vector<Terminal::Screen>& new_screens, Terminal::BranchType branch, int index)
+            void add_screens(const Terminal::ScreenVector& new_screens, Terminal::BranchType branch, int index)
             {
                 ScreenGroup& screen_group = get_screen_group(branch);
                 const size_t screen_index = clamp(size_t(index), size_t(0), screen_group.m_screens.size());
@@ -168,12 +189,13 @@ namespace HuxApp
             {
                 ScreenGroup& screen_group = get_screen_group(branch);
                 const std::vector<Screen> prev_screens = screen_group.m_screens;
+                const std::unordered_set<int> removed_indices(screen_indices.begin(), screen_indices.end());
                 screen_group.m_screens.clear();
 
                 int current_index = 0;
                 for (const Screen& current_screen : prev_screens)
                 {
-                    if (std::find(screen_indices.begin(), screen_indices.end(), current_index) == screen_indices.end())
+                    if (removed_indices.find(current_index) == removed_indices.end())
                     {
                         // Index not among those to be removed
                         screen_group.m_screens.push_back(current_screen);
@@ -253,6 +275,8 @@ namespace HuxApp
 
         // Flags
         bool m_modified = false;
+        bool m_saving = false; // Set while our own changes are written to the model
+        bool m_reload_pending = false;
 
         // Timer that updates the UI after an edit (delays the full update so we don't change the display immediately on every slight change)
         QTimer m_edit_timer;
@@ -411,10 +435,9 @@ namespace HuxApp
             for (int current_branch_index = 0; current_branch_index < Utils::to_integral(Terminal::BranchType::TYPE_COUNT); ++current_branch_index)
             {
                 const Terminal::BranchType current_branch_type = Utils::to_enum<Terminal::BranchType>(current_branch_index);
-                Terminal::Branch& current_branch = m_terminal_data.get_branch(current_branch_type);
     
                 const TeleportEditWidget* teleport_edit_widget = m_screen_data.m_screen_groups[current_branch_index].m_teleport_widget;
-                current_branch.m_teleport = teleport_edit_widget->get_teleport_info();
+                m_terminal_data.set_teleport(current_branch_type, teleport_edit_widget->get_teleport_info());
             }
         }
 
@@ -481,11 +504,48 @@ namespace HuxApp
                 // Save the teleport info
                 save_teleport_info();
 
+                m_saving = true;
                 m_model.update_terminal_data(m_terminal_id, m_terminal_data);
+                m_saving = false;
 
                 m_modified = false;
             }
         }
+
+        void reload_terminal(const Terminal& terminal_data)
+        {
+            // Discard the edits and start over from the given data
+            m_terminal_data = terminal_data;
+            m_modified = false;
+
+            reset_edit_notification();
+            clear_screen_editor();
+            m_selected_screen_id = -1;
+
+            // The teleport editors are kept, only their contents are reset
+            for (int current_branch_index = 0; current_branch_index < Utils::to_integral(Terminal::BranchType::TYPE_COUNT); ++current_branch_index)
+            {
+                const Terminal::BranchType current_branch_type = Utils::to_enum<Terminal::BranchType>(current_branch_index);
+                ScreenGroup& current_screen_group = m_screen_data.m_screen_groups[current_branch_index];
+                current_screen_group.m_screens.clear();
+                current_screen_group.m_modified = false;
+                current_screen_group.m_teleport_widget->set_teleport_info(std::as_const(m_terminal_data).get_branch(current_branch_type).m_teleport);
+            }
+            m_screen_data.init(m_terminal_data);
+
+            m_ui.name_edit->setText(m_terminal_data.get_name());
+            m_ui.dialog_button_box->button(QDialogButtonBox::StandardButton::Ok)->setEnabled(false);
+
+            // Stay in the same screen group
+            if (m_screen_browser_state == ScreenBrowserState::SCREEN_LIST)
+            {
+                open_screen_group(m_current_branch);
+            }
+            else
+            {
+                show_screen_groups();
+            }
+        }
 	};
 
 	TerminalEditorWindow::TerminalEditorWindow(AppCore& core, ScenarioBrowserModel& model, const TerminalID& terminal_id)
@@ -558,6 +618,7 @@ namespace HuxApp
         LevelModel* selected_level = m_internal->m_model.get_level_model(m_internal->m_terminal_id.m_level_id);
         connect(selected_level, &QObject::destroyed, this, &QObject::deleteLater);
         connect(selected_level, &LevelModel::terminals_removed, this, &TerminalEditorWindow::terminals_removed);
+        connect(&m_internal->m_model, &ScenarioBrowserModel::terminal_data_updated, this, &TerminalEditorWindow::terminal_data_updated); // E.g undo & redo
 
         // Terminal info controls
         connect(m_internal->m_ui.dialog_button_box, &QDialogButtonBox::accepted, this, &TerminalEditorWindow::ok_clicked);
@@ -584,11 +645,7 @@ namespace HuxApp
 
     void TerminalEditorWindow::init_ui()
     {
-        // Set the title
-        const QString terminal_name = m_internal->m_terminal_data.get_name().isEmpty() ? QStringLiteral("TERMINAL (%1)").arg(m_internal->m_terminal_id.m_terminal_id) : m_internal->m_terminal_data.get_name();
-
-        const LevelInfo level_info = m_internal->m_model.get_level_info(m_internal->m_terminal_id.m_level_id);
-        setWindowTitle(QStringLiteral("%1 / %2").arg(level_info.m_name).arg(terminal_name));
+        update_title();
 
         init_terminal_info();
         init_screen_editor();
@@ -611,7 +668,7 @@ namespace HuxApp
             const Terminal::BranchType current_branch_type = Utils::to_enum<Terminal::BranchType>(current_branch_index);
             ScreenGroup& current_screen_group = m_internal->m_screen_data.m_screen_groups[current_branch_index];
 
-            current_screen_group.m_teleport_widget = new TeleportEditWidget(QString(Terminal::get_branch_type_name(current_branch_type)), m_internal->m_terminal_data.get_branch(current_branch_type).m_teleport);
+            current_screen_group.m_teleport_widget = new TeleportEditWidget(QString(Terminal::get_branch_type_name(current_branch_type)), std::as_const(m_internal->m_terminal_data).get_branch(current_branch_type).m_teleport);
 
             connect(current_screen_group.m_teleport_widget, &TeleportEditWidget::teleport_info_modified, this, &TerminalEditorWindow::terminal_data_modified);
 
@@ -647,7 +704,7 @@ namespace HuxApp
             m_internal->m_modified = true;
 
             // Adjust title
-            setWindowTitle(QStringLiteral("%1 (Modified)").arg(windowTitle()));
+            update_title();
         }
     }
 
@@ -686,10 +743,11 @@ namespace HuxApp
 
     void TerminalEditorWindow::update_preview()
     {
+        HUX_TRACE_SCOPE("display", "terminal_editor_update_preview");
         if (m_internal->m_selected_screen_id >= 0)
         {
             // Update the HTML text based on the AO script
-            m_internal->m_ui.screen_edit_widget->update_display_text();
+            const qint64 conversion_ns = m_internal->m_ui.screen_edit_widget->update_display_text();
 
             // Update the preview based on the screen data
             const Terminal::Screen& current_screen_data = m_internal->m_ui.screen_edit_widget->get_screen_data();
@@ -702,7 +760,7 @@ namespace HuxApp
                 display_data.m_screen_type = current_screen_data.m_type;
                 display_data.m_alignment = current_screen_data.m_alignment;
 
-                const int line_count = m_core.get_display_system().update_display(m_internal->m_view_id, display_data);
+                const int line_count = m_core.get_display_system().update_display(m_internal->m_view_id, display_data, conversion_ns);
                 const int page_count = DisplaySystem::get_page_count(line_count);
                 if (page_count > 1)
                 {
@@ -740,8 +798,7 @@ namespace HuxApp
         {
             const Terminal::BranchType current_branch_type = Utils::to_enum<Terminal::BranchType>(current_branch_index);
 
-            Terminal::Branch& current_branch = m_internal->m_terminal_data.get_branch(current_branch_type);
-            current_branch.m_teleport = current_screen_group.m_teleport_widget->get_teleport_info();
+            m_internal->m_terminal_data.set_teleport(current_branch_type, current_screen_group.m_teleport_widget->get_teleport_info());
 
             if (!current_screen_group.m_teleport_widget->is_valid())
             {
@@ -978,6 +1035,63 @@ namespace HuxApp
         }
     }
 
+    void TerminalEditorWindow::update_title()
+    {
+        const QString terminal_name = LevelModel::get_terminal_label(m_internal->m_terminal_id.m_terminal_id, m_internal->m_terminal_data);
+
+        const LevelInfo level_info = m_internal->m_model.get_level_info(m_internal->m_terminal_id.m_level_id);
+        const QString title = QStringLiteral("%1 / %2").arg(level_info.m_name).arg(terminal_name);
+        setWindowTitle(m_internal->m_modified ? QStringLiteral("%1 (Modified)").arg(title) : title);
+    }
+
+    void TerminalEditorWindow::terminal_data_updated(int level_id, int terminal_id)
+    {
+        if ((TerminalID{ level_id, terminal_id } != m_internal->m_terminal_id) || m_internal->m_saving || m_internal->m_reload_pending)
+        {
+            return;
+        }
+
+        // Reload once control returns to the event loop (the model is still in the middle of the change, e.g an undo step)
+        m_internal->m_reload_pending = true;
+        QMetaObject::invokeMethod(this, &TerminalEditorWindow::reload_terminal, Qt::QueuedConnection);
+    }
+
+    void TerminalEditorWindow::reload_terminal()
+    {
+        m_internal->m_reload_pending = false;
+
+        const LevelModel* level_model = std::as_const(m_internal->m_model).get_level_model(m_internal->m_terminal_id.m_level_id);
+        const Terminal* terminal_data = level_model ? level_model->get_terminal(m_internal->m_terminal_id) : nullptr;
+        if (!terminal_data)
+        {
+            // Terminal was removed in the meantime (the window is closed)
+            return;
+        }
+
+        if (m_internal->m_modified)
+        {
+            // Saving would silently overwrite the change, so let the user decide
+            const QMessageBox::StandardButton user_response = QMessageBox::question(this, "Terminal Changed",
+                QStringLiteral("This terminal was changed outside of the editor (e.g by undo or redo). Reload it and discard the changes made in the editor?"),
+                QMessageBox::StandardButtons(QMessageBox::Yes | QMessageBox::No));
+            if (user_response != QMessageBox::Yes)
+            {
+                return;
+            }
+
+            // Terminal may have been removed while the prompt was open
+            level_model = std::as_const(m_internal->m_model).get_level_model(m_internal->m_terminal_id.m_level_id);
+            terminal_data = level_model ? level_model->get_terminal(m_internal->m_terminal_id) : nullptr;
+            if (!terminal_data)
+            {
+                return;
+            }
+        }
+
+        m_internal->reload_terminal(*terminal_data);
+        update_title();
+    }
+
     void TerminalEditorWindow::terminals_removed(int level_id, const QList<int>& terminal_ids)
     {
         if (terminal_ids.indexOf(m_internal->m_terminal_id.m_terminal_id) >= 0)
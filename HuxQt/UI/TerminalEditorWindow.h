@@ -56,7 +56,10 @@ namespace HuxApp
 		void remove_screen_clicked();
 
 		// Misc.
+		void update_title();
 		void update_edit_notification();
+		void terminal_data_updated(int level_id, int terminal_id);
+		void reload_terminal(); // Picks up the changes made to the terminal outside of the editor (asks first if there are unsaved edits)
 		void terminals_removed(int level_id, const QList<int>& terminal_ids);
 
 		AppCore& m_core;
@@ -0,0 +1,144 @@
+#pragma once
+#include <vector>
+
+namespace HuxApp
+{
+	namespace Utils
+	{
+		// Single step of a line diff (indices refer to the lines of the old and new text respectively, -1 if not applicable)
+		struct LineDiffEdit
+		{
+			enum class Type
+			{
+				EQUAL,
+				REMOVE,
+				INSERT
+			};
+
+			Type m_type;
+			int m_old_index;
+			int m_new_index;
+		};
+
+		// Myers' O(ND) diff, where lines are compared via their hashes (so we never compare the actual strings)
+		template<typename HASH>
+		std::vector<LineDiffEdit> compute_line_diff(const std::vector<HASH>& old_lines, const std::vector<HASH>& new_lines)
+		{
+			std::vector<LineDiffEdit> edits;
+			const int old_count = static_cast<int>(old_lines.size());
+			const int new_count = static_cast<int>(new_lines.size());
+
+			// Skip the common prefix and suffix (usually most of the text)
+			int prefix_length = 0;
+			while ((prefix_length < old_count) && (prefix_length < new_count) && (old_lines[prefix_length] == new_lines[prefix_length]))
+			{
+				++prefix_length;
+			}
+
+			int suffix_length = 0;
+			while (((prefix_length + suffix_length) < old_count) && ((prefix_length + suffix_length) < new_count)
+				&& (old_lines[old_count - suffix_length - 1] == new_lines[new_count - suffix_length - 1]))
+			{
+				++suffix_length;
+			}
+
+			for (int line_index = 0; line_index < prefix_length; ++line_index)
+			{
+				edits.push_back({ LineDiffEdit::Type::EQUAL, line_index, line_index });
+			}
+
+			const int old_middle_count = old_count - prefix_length - suffix_length;
+			const int new_middle_count = new_count - prefix_length - suffix_length;
+			auto old_line_equals_new = [&](int old_index, int new_index) { return old_lines[prefix_length + old_index] == new_lines[prefix_length + new_index]; };
+
+			// Forward pass: find the furthest reaching path on each diagonal for increasing edit distances
+			// We only store the diagonals which can be reached with the given distance, so memory is quadratic in the distance (not the line count)
+			std::vector<std::vector<int>> trace;
+			const int max_distance = old_middle_count + new_middle_count;
+			std::vector<int> furthest_x(2 * max_distance + 3, 0);
+			auto get_furthest_x = [&furthest_x, max_distance](int diagonal) -> int& { return furthest_x[diagonal + max_distance + 1]; };
+
+			bool found_path = (max_distance == 0);
+			for (int distance = 0; !found_path && (distance <= max_distance); ++distance)
+			{
+				std::vector<int>& current_trace = trace.emplace_back(2 * distance + 1);
+				for (int diagonal = -distance; diagonal <= distance; ++diagonal)
+				{
+					current_trace[diagonal + distance] = get_furthest_x(diagonal);
+				}
+
+				for (int diagonal = -distance; diagonal <= distance; diagonal += 2)
+				{
+					int x = 0;
+					if ((diagonal == -distance) || ((diagonal != distance) && (get_furthest_x(diagonal - 1) < get_furthest_x(diagonal + 1))))
+					{
+						x = get_furthest_x(diagonal + 1); // Insertion
+					}
+					else
+					{
+						x = get_furthest_x(diagonal - 1) + 1; // Removal
+					}
+
+					int y = x - diagonal;
+					while ((x < old_middle_count) && (y < new_middle_count) && old_line_equals_new(x, y))
+					{
+						++x;
+						++y;
+					}
+					get_furthest_x(diagonal) = x;
+
+					if ((x >= old_middle_count) && (y >= new_middle_count))
+					{
+						found_path = true;
+						break;
+					}
+				}
+			}
+
+			// Backtrack to recover the edits (in reverse order)
+			std::vector<LineDiffEdit> middle_edits;
+			int x = old_middle_count;
+			int y = new_middle_count;
+			for (int distance = static_cast<int>(trace.size()) - 1; distance >= 0; --distance)
+			{
+				const std::vector<int>& current_trace = trace[distance];
+				auto get_trace_x = [&current_trace, distance](int diagonal) { return current_trace[diagonal + distance]; };
+
+				const int diagonal = x - y;
+				const bool was_insertion = (diagonal == -distance) || ((diagonal != distance) && (get_trace_x(diagonal - 1) < get_trace_x(diagonal + 1)));
+				const int prev_diagonal = was_insertion ? (diagonal + 1) : (diagonal - 1);
+				const int prev_x = (distance > 0) ? get_trace_x(prev_diagonal) : 0;
+				const int prev_y = (distance > 0) ? (prev_x - prev_diagonal) : 0;
+
+				while ((x > prev_x) && (y > prev_y))
+				{
+					--x;
+					--y;
+					middle_edits.push_back({ LineDiffEdit::Type::EQUAL, prefix_length + x, prefix_length + y });
+				}
+
+				if (distance > 0)
+				{
+					if (was_insertion)
+					{
+						middle_edits.push_back({ LineDiffEdit::Type::INSERT, -1, prefix_length + prev_y });
+					}
+					else
+					{
+						middle_edits.push_back({ LineDiffEdit::Type::REMOVE, prefix_length + prev_x, -1 });
+					}
+				}
+				x = prev_x;
+				y = prev_y;
+			}
+			edits.insert(edits.end(), middle_edits.rbegin(), middle_edits.rend());
+
+			for (int line_index = 0; line_index < suffix_length; ++line_index)
+			{
+				edits.push_back({ LineDiffEdit::Type::EQUAL, old_count - suffix_length + line_index, new_count - suffix_length + line_index });
+			}
+
+			return edits;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,173 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace HuxApp
+{
+	namespace Utils
+	{
+		// Dense storage addressed by stable handles (O(1) insert, erase and lookup, the values are contiguous so iterating over them is cache-friendly)
+		// Handles are non-negative ints (slot index in the low bits, generation in the high bits), so they fit into the existing IDs and signals
+		// Erasing a value bumps the generation of its slot, so handles to erased values are detected instead of aliasing the next value in the slot
+		// NOTE: erasing moves the last value into the erased position, so pointers to the values are only valid until the next insert or erase
+		template<typename T>
+		class SlotMap
+		{
+		public:
+			using Handle = int;
+			static constexpr Handle INVALID_HANDLE = -1;
+
+			static constexpr int INDEX_BITS = 20;
+			static constexpr int GENERATION_BITS = 11;
+			static constexpr uint32_t MAX_SLOT_COUNT = (1u << INDEX_BITS);
+			static constexpr uint32_t MAX_GENERATION = (1u << GENERATION_BITS) - 1;
+
+			using iterator = typename std::vector<T>::iterator;
+			using const_iterator = typename std::vector<T>::const_iterator;
+
+			// Returns INVALID_HANDLE if every slot is in use or retired (the value is not inserted), otherwise the index would overflow into the generation
+			Handle insert(T value)
+			{
+				uint32_t slot_index;
+				if (m_free_head != INVALID_INDEX)
+				{
+					// Reuse the most recently freed slot
+					slot_index = m_free_head;
+					m_free_head = m_slots[slot_index].m_index;
+					--m_free_count;
+				}
+				else if (m_slots.size() < MAX_SLOT_COUNT)
+				{
+					slot_index = static_cast<uint32_t>(m_slots.size());
+					m_slots.emplace_back();
+				}
+				else
+				{
+					return INVALID_HANDLE;
+				}
+
+				Slot& slot = m_slots[slot_index];
+				slot.m_index = static_cast<uint32_t>(m_values.size());
+				slot.m_occupied = true;
+				m_values.push_back(std::move(value));
+				m_value_slots.push_back(slot_index);
+				return make_handle(slot_index, slot.m_generation);
+			}
+
+			bool erase(Handle handle)
+			{
+				if (!contains(handle))
+				{
+					return false;
+				}
+
+				const uint32_t slot_index = get_slot_index(handle);
+				const uint32_t value_index = m_slots[slot_index].m_index;
+				const uint32_t last_value_index = static_cast<uint32_t>(m_values.size()) - 1;
+				if (value_index != last_value_index)
+				{
+					// Fill the gap with the last value
+					m_values[value_index] = std::move(m_values[last_value_index]);
+					m_value_slots[value_index] = m_value_slots[last_value_index];
+					m_slots[m_value_slots[value_index]].m_index = value_index;
+				}
+				m_values.pop_back();
+				m_value_slots.pop_back();
+
+				free_slot(slot_index);
+				return true;
+			}
+
+			bool contains(Handle handle) const
+			{
+				if (handle < 0)
+				{
+					return false;
+				}
+
+				const size_t slot_index = get_slot_index(handle);
+				return (slot_index < m_slots.size()) && (m_slots[slot_index].m_generation == get_generation(handle)) && m_slots[slot_index].m_occupied;
+			}
+
+			T* get(Handle handle) { return contains(handle) ? &m_values[m_slots[get_slot_index(handle)].m_index] : nullptr; }
+			const T* get(Handle handle) const { return contains(handle) ? &m_values[m_slots[get_slot_index(handle)].m_index] : nullptr; }
+
+			// Handle of the value at the position in the dense storage (matches the iteration order)
+			Handle get_handle(int value_index) const
+			{
+				const uint32_t slot_index = m_value_slots[value_index];
+				return make_handle(slot_index, m_slots[slot_index].m_generation);
+			}
+
+			// Erases all the values, the slots are kept (with their generations bumped), so the existing handles stay invalid
+			void clear()
+			{
+				for (const uint32_t current_slot_index : m_value_slots)
+				{
+					free_slot(current_slot_index);
+				}
+				m_values.clear();
+				m_value_slots.clear();
+			}
+
+			void reserve(size_t count)
+			{
+				m_values.reserve(count);
+				m_value_slots.reserve(count);
+				m_slots.reserve(count);
+			}
+
+			size_t size() const { return m_values.size(); }
+			size_t get_available_count() const { return (MAX_SLOT_COUNT - m_slots.size()) + m_free_count; } // Number of values that can still be inserted
+			bool empty() const { return m_values.empty(); }
+
+			// Heap memory used by the storage (not including what the values allocate)
+			size_t get_allocated_bytes() const { return (m_values.capacity() * sizeof(T)) + (m_value_slots.capacity() * sizeof(uint32_t)) + (m_slots.capacity() * sizeof(Slot)); }
+
+			// Index of the slot (stable while the value exists, e.g for display purposes)
+			static int get_slot_index(Handle handle) { return static_cast<int>(static_cast<uint32_t>(handle) & (MAX_SLOT_COUNT - 1)); }
+
+			iterator begin() { return m_values.begin(); }
+			iterator end() { return m_values.end(); }
+			const_iterator begin() const { return m_values.begin(); }
+			const_iterator end() const { return m_values.end(); }
+		private:
+			static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+			struct Slot
+			{
+				uint32_t m_index = 0; // Position in the dense storage while occupied, next free slot otherwise
+				uint32_t m_generation = 0;
+				bool m_occupied = false;
+			};
+
+			static Handle make_handle(uint32_t slot_index, uint32_t generation) { return static_cast<Handle>((generation << INDEX_BITS) | slot_index); }
+			static uint32_t get_generation(Handle handle) { return static_cast<uint32_t>(handle) >> INDEX_BITS; }
+
+			void free_slot(uint32_t slot_index)
+			{
+				Slot& slot = m_slots[slot_index];
+				slot.m_occupied = false;
+				if (slot.m_generation == MAX_GENERATION)
+				{
+					// Retire the slot instead of wrapping the generation (otherwise old handles could become valid again)
+					slot.m_index = INVALID_INDEX;
+					return;
+				}
+
+				++slot.m_generation;
+				slot.m_index = m_free_head;
+				m_free_head = slot_index;
+				++m_free_count;
+			}
+
+			std::vector<T> m_values;
+			std::vector<uint32_t> m_value_slots; // Slot of each value (needed to patch the slot when a value is moved)
+			std::vector<Slot> m_slots;
+			uint32_t m_free_head = INVALID_INDEX;
+			size_t m_free_count = 0; // Length of the free list
+		};
+	}
+}
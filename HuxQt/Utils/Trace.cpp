@@ -0,0 +1,299 @@
+#include <HuxQt/Utils/Trace.h>
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace HuxApp
+{
+	namespace Trace
+	{
+		namespace
+		{
+			struct Event
+			{
+				const char* m_category = nullptr;
+				const char* m_name = nullptr;
+				qint64 m_start_ns = 0;
+				qint64 m_duration_ns = 0;
+			};
+
+			// Slot of the ring buffer, the fields are atomic so they can be read while the owner thread overwrites them
+			struct EventSlot
+			{
+				std::atomic<quint64> m_sequence{ 0 }; // Index of the stored event + 1, 0 while it is being written
+				std::atomic<const char*> m_category{ nullptr };
+				std::atomic<const char*> m_name{ nullptr };
+				std::atomic<qint64> m_start_ns{ 0 };
+				std::atomic<qint64> m_duration_ns{ 0 };
+			};
+
+			// Ring buffer written only by its own thread, so recording needs no locks
+			struct ThreadBuffer
+			{
+				int m_thread_id = 0;
+				QString m_thread_name;
+
+				std::array<EventSlot, EVENT_CAPACITY> m_events;
+				std::atomic<quint64> m_write_count{ 0 }; // Total number of events written (the index wraps around), only changed by the owner thread
+				std::atomic<quint64> m_clear_count{ 0 }; // Write count when the buffer was last cleared (older events are not exported)
+
+				void add_event(const Event& event)
+				{
+					const quint64 write_count = m_write_count.load(std::memory_order_relaxed);
+					EventSlot& slot = m_events[write_count % EVENT_CAPACITY];
+
+					// Unpublish the slot before overwriting it (the fence keeps the field stores after this one)
+					slot.m_sequence.store(0, std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_release);
+					slot.m_category.store(event.m_category, std::memory_order_relaxed);
+					slot.m_name.store(event.m_name, std::memory_order_relaxed);
+					slot.m_start_ns.store(event.m_start_ns, std::memory_order_relaxed);
+					slot.m_duration_ns.store(event.m_duration_ns, std::memory_order_relaxed);
+					slot.m_sequence.store(write_count + 1, std::memory_order_release);
+
+					m_write_count.store(write_count + 1, std::memory_order_release);
+				}
+
+				// Returns false if the event was overwritten (or is still being written)
+				bool read_event(quint64 event_index, Event& event) const
+				{
+					const EventSlot& slot = m_events[event_index % EVENT_CAPACITY];
+					if (slot.m_sequence.load(std::memory_order_acquire) != (event_index + 1))
+					{
+						return false;
+					}
+
+					event.m_category = slot.m_category.load(std::memory_order_relaxed);
+					event.m_name = slot.m_name.load(std::memory_order_relaxed);
+					event.m_start_ns = slot.m_start_ns.load(std::memory_order_relaxed);
+					event.m_duration_ns = slot.m_duration_ns.load(std::memory_order_relaxed);
+
+					// Check that the writer did not start on the slot while we were copying it
+					std::atomic_thread_fence(std::memory_order_acquire);
+					return (slot.m_sequence.load(std::memory_order_relaxed) == (event_index + 1));
+				}
+
+				void clear() { m_clear_count.store(m_write_count.load(std::memory_order_acquire), std::memory_order_release); }
+			};
+
+			std::atomic<bool> g_enabled{ false };
+
+			qint64 get_time_ns()
+			{
+				static const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+				return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count();
+			}
+
+			// Buffers of all the threads that recorded anything
+			// The buffer of a thread which exited is kept (so its events can still be exported) until another thread needs one, so the memory is bounded by the number of threads running at the same time
+			struct BufferRegistry
+			{
+				QMutex m_mutex;
+				std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+				std::vector<std::shared_ptr<ThreadBuffer>> m_free_buffers; // Buffers of the threads which exited
+				int m_thread_count = 0;
+			};
+
+			BufferRegistry& get_registry()
+			{
+				static BufferRegistry registry;
+				return registry;
+			}
+
+			// Owns the buffer of a thread, returning it to the registry when the thread exits
+			class ThreadBufferOwner
+			{
+			public:
+				ThreadBufferOwner()
+				{
+					const QThread* current_thread = QThread::currentThread();
+					const bool is_main_thread = QCoreApplication::instance() && (current_thread == QCoreApplication::instance()->thread());
+
+					BufferRegistry& registry = get_registry();
+					QMutexLocker lock(&registry.m_mutex);
+					if (registry.m_free_buffers.empty())
+					{
+						m_buffer = std::make_shared<ThreadBuffer>();
+						registry.m_buffers.push_back(m_buffer);
+					}
+					else
+					{
+						// Reuse the buffer of an exited thread (its events are dropped, nothing writes to it anymore)
+						m_buffer = std::move(registry.m_free_buffers.back());
+						registry.m_free_buffers.pop_back();
+						m_buffer->clear();
+					}
+
+					m_buffer->m_thread_id = ++registry.m_thread_count;
+					if (is_main_thread)
+					{
+						m_buffer->m_thread_name = QStringLiteral("Main thread");
+					}
+					else
+					{
+						m_buffer->m_thread_name = current_thread->objectName().isEmpty() ? QStringLiteral("Worker %1").arg(m_buffer->m_thread_id) : current_thread->objectName();
+					}
+				}
+
+				~ThreadBufferOwner()
+				{
+					BufferRegistry& registry = get_registry();
+					QMutexLocker lock(&registry.m_mutex);
+					registry.m_free_buffers.push_back(std::move(m_buffer));
+				}
+
+				ThreadBufferOwner(const ThreadBufferOwner&) = delete;
+				ThreadBufferOwner& operator=(const ThreadBufferOwner&) = delete;
+
+				ThreadBuffer& get_buffer() { return *m_buffer; }
+			private:
+				std::shared_ptr<ThreadBuffer> m_buffer;
+			};
+
+			ThreadBuffer& get_thread_buffer()
+			{
+				// Only locks the first time a thread records an event (and when it exits)
+				thread_local ThreadBufferOwner buffer_owner;
+				return buffer_owner.get_buffer();
+			}
+		}
+
+		void set_enabled(bool enabled)
+		{
+			if (enabled)
+			{
+				// Make sure the clock starts before the first event
+				get_time_ns();
+			}
+			g_enabled.store(enabled && is_available(), std::memory_order_relaxed);
+		}
+
+		bool is_enabled()
+		{
+			return g_enabled.load(std::memory_order_relaxed);
+		}
+
+		void clear()
+		{
+			BufferRegistry& registry = get_registry();
+			QMutexLocker lock(&registry.m_mutex);
+			for (const std::shared_ptr<ThreadBuffer>& current_buffer : registry.m_buffers)
+			{
+				// Only moves the start of the exported range, the write counts are never touched by other threads
+				current_buffer->clear();
+			}
+		}
+
+		QByteArray export_chrome_trace()
+		{
+			QJsonArray event_json_array;
+
+			BufferRegistry& registry = get_registry();
+			QMutexLocker lock(&registry.m_mutex);
+			for (const std::shared_ptr<ThreadBuffer>& current_buffer : registry.m_buffers)
+			{
+				QJsonObject thread_name_json;
+				thread_name_json["name"] = "thread_name";
+				thread_name_json["ph"] = "M";
+				thread_name_json["pid"] = 1;
+				thread_name_json["tid"] = current_buffer->m_thread_id;
+				thread_name_json["args"] = QJsonObject{ { "name", current_buffer->m_thread_name } };
+				event_json_array.append(thread_name_json);
+
+				const quint64 write_count = current_buffer->m_write_count.load(std::memory_order_acquire);
+				const quint64 clear_count = std::min(current_buffer->m_clear_count.load(std::memory_order_acquire), write_count);
+				const quint64 first_event = std::max((write_count > EVENT_CAPACITY) ? (write_count - EVENT_CAPACITY) : 0, clear_count);
+
+				for (quint64 event_index = first_event; event_index < write_count; ++event_index)
+				{
+					// If the thread is still recording, skip the events it overwrote while we were exporting
+					Event event;
+					if (!current_buffer->read_event(event_index, event))
+					{
+						continue;
+					}
+
+					// Timestamps are in microseconds
+					QJsonObject event_json;
+					event_json["name"] = QLatin1String(event.m_name);
+					event_json["cat"] = QLatin1String(event.m_category);
+					event_json["ph"] = "X";
+					event_json["ts"] = event.m_start_ns / 1000.0;
+					event_json["dur"] = event.m_duration_ns / 1000.0;
+					event_json["pid"] = 1;
+					event_json["tid"] = current_buffer->m_thread_id;
+					event_json_array.append(event_json);
+				}
+			}
+
+			QJsonObject trace_json;
+			trace_json["traceEvents"] = event_json_array;
+			trace_json["displayTimeUnit"] = "ms";
+			return QJsonDocument(trace_json).toJson(QJsonDocument::Compact);
+		}
+
+		bool write_chrome_trace(const QString& file_path, QString& error_msg)
+		{
+			QSaveFile trace_file(file_path);
+			if (!trace_file.open(QIODevice::WriteOnly))
+			{
+				error_msg = QStringLiteral("Unable to open file \"%1\"!").arg(file_path);
+				return false;
+			}
+
+			const QByteArray trace_data = export_chrome_trace();
+			if (trace_file.write(trace_data) != trace_data.size())
+			{
+				// The save file is discarded, so a partial trace never replaces the file
+				error_msg = QStringLiteral("Error writing to file \"%1\"! Error: \"%2\"").arg(file_path, trace_file.errorString());
+				trace_file.cancelWriting();
+				return false;
+			}
+			if (!trace_file.commit())
+			{
+				error_msg = QStringLiteral("Error writing to file \"%1\"! Error: \"%2\"").arg(file_path, trace_file.errorString());
+				return false;
+			}
+			return true;
+		}
+
+		ScopedTimer::ScopedTimer(const char* category, const char* name, qint64* duration_ns)
+			: m_category(category)
+			, m_name(name)
+			, m_duration_ns(duration_ns)
+			, m_recording(is_enabled())
+		{
+			m_start_ns = (m_recording || m_duration_ns) ? get_time_ns() : -1;
+		}
+
+		ScopedTimer::~ScopedTimer()
+		{
+			if (m_start_ns < 0)
+			{
+				return;
+			}
+
+			const qint64 duration_ns = get_time_ns() - m_start_ns;
+			if (m_duration_ns)
+			{
+				*m_duration_ns = duration_ns;
+			}
+			if (m_recording)
+			{
+				get_thread_buffer().add_event({ m_category, m_name, m_start_ns, duration_ns });
+			}
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+
+// Scoped tracing, exported in the Chrome trace_event format (chrome://tracing, Perfetto)
+// Compiled out when HUX_ENABLE_TRACING is not defined, otherwise each scope costs an atomic check while recording is off
+
+#define HUX_TRACE_CONCAT_INNER(a, b) a##b
+#define HUX_TRACE_CONCAT(a, b) HUX_TRACE_CONCAT_INNER(a, b)
+
+#ifdef HUX_ENABLE_TRACING
+#define HUX_TRACE_SCOPE(category, name) const HuxApp::Trace::ScopedTimer HUX_TRACE_CONCAT(hux_trace_scope_, __LINE__)(category, name)
+#else
+#define HUX_TRACE_SCOPE(category, name) ((void)0)
+#endif
+
+// Same as above, but also writes the duration of the scope (in nanoseconds) to a qint64 when it ends, even while not recording (or with tracing compiled out)
+#define HUX_TRACE_SCOPE_TIMED(category, name, duration_ns) const HuxApp::Trace::ScopedTimer HUX_TRACE_CONCAT(hux_trace_scope_, __LINE__)(category, name, &(duration_ns))
+
+namespace HuxApp
+{
+	namespace Trace
+	{
+		constexpr bool is_available()
+		{
+#ifdef HUX_ENABLE_TRACING
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		// Events are only recorded while enabled (each thread keeps the last EVENT_CAPACITY events, the buffers of exited threads are reused)
+		constexpr int EVENT_CAPACITY = 1 << 14;
+
+		void set_enabled(bool enabled);
+		bool is_enabled();
+		void clear(); // Drops the recorded events (safe while recording, events added at the same time may still be exported)
+
+		QByteArray export_chrome_trace(); // JSON
+		bool write_chrome_trace(const QString& file_path, QString& error_msg);
+
+		// Names must be string literals (only the pointers are stored)
+		class ScopedTimer
+		{
+		public:
+			ScopedTimer(const char* category, const char* name, qint64* duration_ns = nullptr);
+			~ScopedTimer();
+
+			ScopedTimer(const ScopedTimer&) = delete;
+			ScopedTimer& operator=(const ScopedTimer&) = delete;
+		private:
+			const char* m_category;
+			const char* m_name;
+			qint64* m_duration_ns;
+			qint64 m_start_ns; // Negative if the scope is not measured
+			bool m_recording;
+		};
+	}
+}
@@ -1,5 +1,7 @@
 #pragma once
+#include <algorithm>
 #include <type_traits>
+#include <vector>
 
 namespace HuxApp
 {
@@ -17,5 +19,20 @@ namespace HuxApp
             static_assert(std::is_enum_v<ENUM>);
 			return static_cast<ENUM>(value);
 		}
+
+		// Moves the range in front of the destination index (same as QAbstractItemModel::moveRows, the destination is given before the move), returns the new index of the first element
+		template<typename T>
+		int move_range(std::vector<T>& elements, int first, int count, int destination)
+		{
+			auto range_begin = elements.begin() + first;
+			auto range_end = range_begin + count;
+			if (destination < first)
+			{
+				std::rotate(elements.begin() + destination, range_begin, range_end);
+				return destination;
+			}
+			std::rotate(range_begin, range_end, elements.begin() + destination);
+			return destination - count;
+		}
 	}
 }
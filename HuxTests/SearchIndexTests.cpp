@@ -0,0 +1,133 @@
+#include <HuxQt/Scenario/SearchIndex.h>
+
+#include <QTest>
+
+#include <algorithm>
+#include <vector>
+
+namespace HuxApp
+{
+	class SearchIndexTests : public QObject
+	{
+		Q_OBJECT
+	private slots:
+		void init()
+		{
+			Terminal terminal;
+			terminal.set_name(QStringLiteral("Lower Decks"));
+
+			Terminal::Screen screen;
+			screen.m_type = Terminal::ScreenType::INFORMATION;
+			screen.m_script = QStringLiteral("The Pfhor have taken the lower\ndecks.  Proceed to the\r\n\tcontrol   room.");
+			terminal.get_branch(Terminal::BranchType::UNFINISHED).m_screens.push_back(screen);
+
+			m_index.clear();
+			m_index.add_terminal(TerminalID{ 0, 0 }, terminal);
+		}
+
+		void phrase_matches_across_whitespace_data()
+		{
+			QTest::addColumn<QString>("query");
+			QTest::addColumn<QString>("matched_text");
+
+			QTest::newRow("line break") << QStringLiteral("\"taken the lower decks\"") << QStringLiteral("taken the lower\ndecks");
+			QTest::newRow("multiple spaces") << QStringLiteral("\"decks. proceed\"") << QStringLiteral("decks.  Proceed");
+			QTest::newRow("mixed whitespace") << QStringLiteral("\"the control room\"") << QStringLiteral("the\r\n\tcontrol   room");
+			QTest::newRow("whitespace in query") << QStringLiteral("\"  control \t room \"") << QStringLiteral("control   room");
+		}
+
+		void phrase_matches_across_whitespace()
+		{
+			QFETCH(QString, query);
+			QFETCH(QString, matched_text);
+
+			const std::vector<SearchIndex::Hit> hits = search(query);
+			QCOMPARE(hits.size(), size_t(1));
+
+			const SearchIndex::Hit& hit = hits.front();
+			QCOMPARE(hit.m_field, SearchIndex::Field::SCREEN_SCRIPT);
+			QCOMPARE(hit.m_branch, Terminal::BranchType::UNFINISHED);
+			QCOMPARE(hit.m_screen, 0);
+
+			// The match covers the whitespace of the text, not that of the query
+			const QString script = QStringLiteral("The Pfhor have taken the lower\ndecks.  Proceed to the\r\n\tcontrol   room.");
+			QCOMPARE(script.mid(hit.m_position, hit.m_length), matched_text);
+		}
+
+		void phrase_matches_single_line_field()
+		{
+			const std::vector<SearchIndex::Hit> hits = search(QStringLiteral("\"lower decks\""));
+			QCOMPARE(hits.size(), size_t(2));
+			QCOMPARE(hits.front().m_field, SearchIndex::Field::TERMINAL_NAME);
+		}
+
+		void phrase_needs_whitespace_between_words()
+		{
+			QVERIFY(search(QStringLiteral("\"lowerdecks\"")).empty());
+			QVERIFY(search(QStringLiteral("\"taken lower\"")).empty());
+			QVERIFY(search(QStringLiteral("\"control room proceed\"")).empty());
+		}
+		void tagged_words_data()
+		{
+			QTest::addColumn<QString>("script");
+			QTest::addColumn<QString>("query");
+			QTest::addColumn<QString>("matched_text");
+
+			QTest::newRow("bold") << QStringLiteral("Hello, $BDurandal$b speaking.") << QStringLiteral("durandal") << QStringLiteral("Durandal");
+			QTest::newRow("color") << QStringLiteral("$C1Leela$C0 is waiting.") << QStringLiteral("Leela") << QStringLiteral("Leela");
+			QTest::newRow("prefix") << QStringLiteral("$IDurandal$i") << QStringLiteral("dur") << QStringLiteral("Dur");
+			QTest::newRow("phrase") << QStringLiteral("The $Ulower$u decks.") << QStringLiteral("\"lower decks\"") << QStringLiteral("lower$u decks");
+			QTest::newRow("phrase across tags") << QStringLiteral("Call $BLeela$b\n$C2Durandal$C0") << QStringLiteral("\"leela durandal\"") << QStringLiteral("Leela$b\n$C2Durandal");
+			QTest::newRow("tag in query") << QStringLiteral("Hello, $BDurandal$b speaking.") << QStringLiteral("$BDurandal") << QStringLiteral("$BDurandal");
+		}
+
+		void tagged_words()
+		{
+			QFETCH(QString, script);
+			QFETCH(QString, query);
+			QFETCH(QString, matched_text);
+
+			Terminal terminal;
+			Terminal::Screen screen;
+			screen.m_type = Terminal::ScreenType::INFORMATION;
+			screen.m_script = script;
+			terminal.get_branch(Terminal::BranchType::UNFINISHED).m_screens.push_back(screen);
+			m_index.add_terminal(TerminalID{ 0, 1 }, terminal);
+
+			std::vector<SearchIndex::Hit> hits = search(query);
+			hits.erase(std::remove_if(hits.begin(), hits.end(), [](const SearchIndex::Hit& hit) { return hit.m_terminal_id.m_terminal_id != 1; }), hits.end());
+			QCOMPARE(hits.size(), size_t(1));
+			QCOMPARE(script.mid(hits.front().m_position, hits.front().m_length), matched_text);
+		}
+
+		void tags_do_not_start_words()
+		{
+			Terminal terminal;
+			Terminal::Screen screen;
+			screen.m_type = Terminal::ScreenType::INFORMATION;
+			screen.m_script = QStringLiteral("$BDurandal$b");
+			terminal.get_branch(Terminal::BranchType::UNFINISHED).m_screens.push_back(screen);
+			m_index.add_terminal(TerminalID{ 0, 1 }, terminal);
+
+			// Only the start of words matches
+			QVERIFY(search(QStringLiteral("randal")).empty());
+			QVERIFY(search(QStringLiteral("bdurandal")).empty());
+		}
+	private:
+		std::vector<SearchIndex::Hit> search(const QString& query) const
+		{
+			std::vector<SearchIndex::Hit> hits;
+			QString error_msg;
+			if (!m_index.search(query, hits, error_msg))
+			{
+				qWarning("%s", qUtf8Printable(error_msg));
+			}
+			return hits;
+		}
+
+		SearchIndex m_index;
+	};
+}
+
+QTEST_GUILESS_MAIN(HuxApp::SearchIndexTests)
+#include "SearchIndexTests.moc"
@@ -0,0 +1,179 @@
+#include <HuxQt/AppCore.h>
+#include <HuxQt/Scenario/Scenario.h>
+#include <HuxQt/Scenario/ScenarioBrowserModel.h>
+#include <HuxQt/Scenario/ScenarioHistory.h>
+#include <HuxQt/UI/TerminalEditorWindow.h>
+
+#include <QApplication>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPointer>
+#include <QPushButton>
+#include <QTest>
+#include <QTimer>
+#include <QUndoStack>
+
+#include <memory>
+#include <utility>
+
+namespace HuxApp
+{
+	// Edits made outside of an open terminal editor (e.g undo & redo) must show up in the editor, otherwise saving it would revert them
+	class TerminalEditorTests : public QObject
+	{
+		Q_OBJECT
+	private slots:
+		void init()
+		{
+			Terminal terminal;
+			terminal.set_name(QStringLiteral("Original"));
+
+			Level level;
+			level.set_name(QStringLiteral("Level"));
+			level.set_terminals({ terminal });
+
+			Scenario scenario;
+			scenario.set_name(QStringLiteral("Scenario"));
+			scenario.set_levels({ level });
+
+			m_core = std::make_unique<AppCore>(nullptr);
+			m_model = std::make_unique<ScenarioBrowserModel>();
+			QVERIFY(m_model->load_scenario(std::move(scenario)));
+
+			m_history = std::make_unique<ScenarioHistory>();
+			m_history->start(*m_model);
+
+			const LevelModel* level_model = m_model->get_level_model(m_model->get_level_id(0));
+			m_terminal_id = TerminalID{ level_model->get_id(), level_model->get_terminal_id(0) };
+
+			// Make an edit we can undo (the step is pushed once control returns to the event loop)
+			set_model_terminal_name(QStringLiteral("Edited"));
+			QCoreApplication::processEvents();
+			QCOMPARE(m_history->get_undo_stack().count(), 1);
+
+			m_editor = new TerminalEditorWindow(*m_core, *m_model, m_terminal_id);
+			QCOMPARE(get_editor_name(), QStringLiteral("Edited"));
+		}
+
+		void cleanup()
+		{
+			delete m_editor.data();
+			m_history.reset();
+			m_model.reset();
+			m_core.reset();
+		}
+
+		void undo_redo_reloads_editor()
+		{
+			m_history->get_undo_stack().undo();
+			QTRY_COMPARE(get_editor_name(), QStringLiteral("Original"));
+
+			m_history->get_undo_stack().redo();
+			QTRY_COMPARE(get_editor_name(), QStringLiteral("Edited"));
+
+			// Saving the (unmodified) editor must not write anything
+			m_history->get_undo_stack().undo();
+			QTRY_COMPARE(get_editor_name(), QStringLiteral("Original"));
+			m_editor->force_save();
+			QCOMPARE(get_model_terminal_name(), QStringLiteral("Original"));
+		}
+
+		void undo_with_unsaved_edits_reloads_if_confirmed()
+		{
+			edit_editor_name(QStringLiteral("Unsaved"));
+
+			answer_message_box(QMessageBox::Yes);
+			m_history->get_undo_stack().undo();
+			QTRY_COMPARE(get_editor_name(), QStringLiteral("Original"));
+
+			m_editor->force_save();
+			QCOMPARE(get_model_terminal_name(), QStringLiteral("Original"));
+		}
+
+		void undo_with_unsaved_edits_keeps_edits_if_declined()
+		{
+			edit_editor_name(QStringLiteral("Unsaved"));
+
+			bool answered = false;
+			answer_message_box(QMessageBox::No, &answered);
+			m_history->get_undo_stack().undo();
+			QTRY_VERIFY(answered);
+			QCOMPARE(get_editor_name(), QStringLiteral("Unsaved"));
+			QCOMPARE(get_model_terminal_name(), QStringLiteral("Original"));
+
+			// The user chose to keep the edits, so saving applies them
+			m_editor->force_save();
+			QCOMPARE(get_model_terminal_name(), QStringLiteral("Unsaved"));
+		}
+
+		void own_save_does_not_reload()
+		{
+			edit_editor_name(QStringLiteral("Saved"));
+			m_editor->force_save();
+			QCOMPARE(get_model_terminal_name(), QStringLiteral("Saved"));
+
+			// No prompt may show up for our own change
+			QCoreApplication::processEvents();
+			QVERIFY(!QApplication::activeModalWidget());
+			QCOMPARE(get_editor_name(), QStringLiteral("Saved"));
+		}
+	private:
+		QLineEdit* get_name_edit() const
+		{
+			QLineEdit* name_edit = m_editor->findChild<QLineEdit*>(QStringLiteral("name_edit"));
+			Q_ASSERT(name_edit);
+			return name_edit;
+		}
+
+		QString get_editor_name() const { return get_name_edit()->text(); }
+
+		void edit_editor_name(const QString& name)
+		{
+			// Typing marks the editor as modified
+			QLineEdit* name_edit = get_name_edit();
+			name_edit->clear();
+			QTest::keyClicks(name_edit, name);
+		}
+
+		QString get_model_terminal_name() const
+		{
+			return std::as_const(*m_model).get_level_model(m_terminal_id.m_level_id)->get_terminal(m_terminal_id)->get_name();
+		}
+
+		void set_model_terminal_name(const QString& name)
+		{
+			Terminal terminal = *std::as_const(*m_model).get_level_model(m_terminal_id.m_level_id)->get_terminal(m_terminal_id);
+			terminal.set_name(name);
+			QVERIFY(m_model->update_terminal_data(m_terminal_id, terminal));
+		}
+
+		void answer_message_box(QMessageBox::StandardButton button, bool* answered = nullptr)
+		{
+			// The prompt is modal, so it has to be answered from a timer once it shows up
+			QTimer* answer_timer = new QTimer(this);
+			connect(answer_timer, &QTimer::timeout, answer_timer, [answer_timer, button, answered]()
+				{
+					if (QMessageBox* message_box = qobject_cast<QMessageBox*>(QApplication::activeModalWidget()))
+					{
+						message_box->button(button)->click();
+						if (answered)
+						{
+							*answered = true;
+						}
+						answer_timer->deleteLater();
+					}
+				}
+			);
+			answer_timer->start(10);
+		}
+
+		std::unique_ptr<AppCore> m_core;
+		std::unique_ptr<ScenarioBrowserModel> m_model;
+		std::unique_ptr<ScenarioHistory> m_history;
+		QPointer<TerminalEditorWindow> m_editor;
+		TerminalID m_terminal_id;
+	};
+}
+
+QTEST_MAIN(HuxApp::TerminalEditorTests)
+#include "TerminalEditorTests.moc"